@@ -0,0 +1,24 @@
+# Shared settings for the benchmark programs.  Each benchmark links the application sources
+# directly (everything except main.cpp) so it measures the same code the application runs.
+
+TEMPLATE = app
+
+DESTDIR = $$OUT_PWD/../bin
+INCLUDEPATH += $$PWD/../source
+
+CONFIG += release warn_on c++11 qt console testcase
+CONFIG -= debug app_bundle
+QT += widgets printsupport svg concurrent testlib
+
+INCLUDEPATH += $$PWD/../../libjade/include
+LIBS += -L$$PWD/../../libjade/lib/ -ljade
+
+# QuaZIP
+INCLUDEPATH += C:/Development/quazip-0.7.1/quazip $$[QT_INSTALL_HEADERS]/QtZlib
+LIBS += -LC:/Development/quazip-0.7.1/quazip/release/ -lquazip
+
+SOURCES += $$files($$PWD/../source/*.cpp)
+SOURCES -= $$PWD/../source/main.cpp
+HEADERS += $$files($$PWD/../source/*.h)
+
+RESOURCES += $$PWD/../icons/icons.qrc
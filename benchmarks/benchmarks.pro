@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+	connections \
+	dispatch \
+	odg \
+	png
@@ -0,0 +1,187 @@
+/* ConnectionsBenchmark.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramReader.h"
+#include "ElectricItems.h"
+#include <QtTest>
+
+// Times the connection resolver that runs after a drawing is loaded.  Each netlist is a grid of
+// resistors joined by wires whose ends sit exactly on the resistor terminals, so the number of
+// connections the resolver should find is known in advance.
+class ConnectionsBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void resolve_data();
+	void resolve();
+	void pairwise_data();
+	void pairwise();
+
+private:
+	QList<DrawingItem*> createNetlist(int itemCount, int& expectedConnections) const;
+	int countConnections(const QList<DrawingItem*>& items) const;
+	void connectItemsPairwise(const QList<DrawingItem*>& items) const;
+};
+
+//==================================================================================================
+
+void ConnectionsBenchmark::resolve_data()
+{
+	QTest::addColumn<int>("itemCount");
+
+	QTest::newRow("1k") << 1000;
+	QTest::newRow("10k") << 10000;
+	QTest::newRow("100k") << 100000;
+}
+
+void ConnectionsBenchmark::resolve()
+{
+	QFETCH(int, itemCount);
+
+	int expectedConnections = 0;
+	QList<DrawingItem*> items = createNetlist(itemCount, expectedConnections);
+
+	// Connections accumulate on the item points, so the resolver can only run once per netlist
+	QBENCHMARK_ONCE
+	{
+		DiagramReader::connectItems(items);
+	}
+
+	QCOMPARE(countConnections(items), expectedConnections);
+	qDeleteAll(items);
+}
+
+void ConnectionsBenchmark::pairwise_data()
+{
+	QTest::addColumn<int>("itemCount");
+
+	QTest::newRow("1k") << 1000;
+	QTest::newRow("10k") << 10000;
+}
+
+void ConnectionsBenchmark::pairwise()
+{
+	QFETCH(int, itemCount);
+
+	int expectedConnections = 0;
+	QList<DrawingItem*> items = createNetlist(itemCount, expectedConnections);
+
+	QBENCHMARK_ONCE
+	{
+		connectItemsPairwise(items);
+	}
+
+	QCOMPARE(countConnections(items), expectedConnections);
+	qDeleteAll(items);
+}
+
+//==================================================================================================
+
+QList<DrawingItem*> ConnectionsBenchmark::createNetlist(int itemCount, int& expectedConnections) const
+{
+	QList<DrawingItem*> items;
+	const int resistorsPerRow = 50;
+	int resistorCount = itemCount / 2;
+	qreal x, y;
+
+	expectedConnections = 0;
+
+	for(int i = 0; i < resistorCount; i++)
+	{
+		x = (i % resistorsPerRow) * 600;
+		y = (i / resistorsPerRow) * 400;
+
+		DrawingPathItem* resistor = ElectricItems::createResistor1();
+		resistor->setX(x);
+		resistor->setY(y);
+		items.append(resistor);
+
+		// The wire after the last resistor in each row only touches one terminal
+		DrawingLineItem* wire = new DrawingLineItem();
+		wire->setX(x + 200);
+		wire->setY(y);
+		wire->setLine(QLineF(0, 0, 200, 0));
+		items.append(wire);
+
+		expectedConnections += (i % resistorsPerRow == resistorsPerRow - 1 || i == resistorCount - 1) ? 2 : 4;
+	}
+
+	return items;
+}
+
+int ConnectionsBenchmark::countConnections(const QList<DrawingItem*>& items) const
+{
+	QList<DrawingItemPoint*> itemPoints;
+	int connections = 0;
+
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		itemPoints = (*itemIter)->points();
+		for(auto itemPointIter = itemPoints.begin(); itemPointIter != itemPoints.end(); itemPointIter++)
+			connections += (*itemPointIter)->connections().size();
+	}
+
+	return connections;
+}
+
+void ConnectionsBenchmark::connectItemsPairwise(const QList<DrawingItem*>& items) const
+{
+	// The all-pairs comparison the reader used before the spatial hash, kept as a reference
+	QList<DrawingItemPoint*> itemPoints, otherItemPoints;
+	qreal distance, threshold = 0.01;
+	QPointF vec;
+
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		for(auto otherItemIter = itemIter + 1; otherItemIter != items.end(); otherItemIter++)
+		{
+			itemPoints = (*itemIter)->points();
+			otherItemPoints = (*otherItemIter)->points();
+
+			for(auto itemPointIter = itemPoints.begin(); itemPointIter != itemPoints.end(); itemPointIter++)
+			{
+				for(auto otherItemPointIter = otherItemPoints.begin();
+					otherItemPointIter != otherItemPoints.end(); otherItemPointIter++)
+				{
+					if (((*itemPointIter)->flags() & DrawingItemPoint::Connection) && ((*otherItemPointIter)->flags() & DrawingItemPoint::Connection) &&
+						(((*itemPointIter)->flags() & DrawingItemPoint::Free) || ((*otherItemPointIter)->flags() & DrawingItemPoint::Free)))
+					{
+						vec = (*itemIter)->mapToScene((*itemPointIter)->position()) -
+							(*otherItemIter)->mapToScene((*otherItemPointIter)->position());
+						distance = qSqrt(vec.x() * vec.x() + vec.y() * vec.y());
+
+						if (distance <= threshold)
+						{
+							(*itemPointIter)->addConnection(*otherItemPointIter);
+							(*otherItemPointIter)->addConnection(*itemPointIter);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+//==================================================================================================
+
+QTEST_MAIN(ConnectionsBenchmark)
+
+#include "ConnectionsBenchmark.moc"
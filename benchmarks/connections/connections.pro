@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = connections
+
+SOURCES += ConnectionsBenchmark.cpp
@@ -0,0 +1,187 @@
+/* DispatchBenchmark.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramItemType.h"
+#include <QtTest>
+
+// Compares the per-item cost of classifying drawing items with the dynamic_casts the writers used
+// before against the cached type table in diagramItemType().  Like the writers, the cast version
+// tries all thirteen item classes for every item before it branches on the results.  The items
+// cycle through every item class.  The benchmark result is the time for one pass over all of the
+// items.
+class DispatchBenchmark : public QObject
+{
+	Q_OBJECT
+
+private:
+	QList<DrawingItem*> mItems;
+
+private slots:
+	void initTestCase();
+	void cleanupTestCase();
+
+	void allCasts_data();
+	void allCasts();
+	void typeTable_data();
+	void typeTable();
+
+private:
+	void addItemCountRows();
+	QList<DrawingItem*> itemsForRow(int itemCount) const;
+	static DiagramItemType classifyByCasts(DrawingItem* item);
+};
+
+//==================================================================================================
+
+void DispatchBenchmark::initTestCase()
+{
+	const int maxItemCount = 100000;
+
+	for(int i = 0; i < maxItemCount; i++)
+	{
+		switch (i % 13)
+		{
+		case 0: mItems.append(new DrawingLineItem()); break;
+		case 1: mItems.append(new DrawingArcItem()); break;
+		case 2: mItems.append(new DrawingPolylineItem()); break;
+		case 3: mItems.append(new DrawingCurveItem()); break;
+		case 4: mItems.append(new DrawingRectItem()); break;
+		case 5: mItems.append(new DrawingEllipseItem()); break;
+		case 6: mItems.append(new DrawingPolygonItem()); break;
+		case 7: mItems.append(new DrawingTextItem()); break;
+		case 8: mItems.append(new DrawingTextRectItem()); break;
+		case 9: mItems.append(new DrawingTextEllipseItem()); break;
+		case 10: mItems.append(new DrawingTextPolygonItem()); break;
+		case 11: mItems.append(new DrawingPathItem()); break;
+		default: mItems.append(new DrawingItemGroup()); break;
+		}
+	}
+}
+
+void DispatchBenchmark::cleanupTestCase()
+{
+	qDeleteAll(mItems);
+	mItems.clear();
+}
+
+//==================================================================================================
+
+void DispatchBenchmark::allCasts_data()
+{
+	addItemCountRows();
+}
+
+void DispatchBenchmark::allCasts()
+{
+	QFETCH(int, itemCount);
+
+	QList<DrawingItem*> items = itemsForRow(itemCount);
+	int checksum = 0;
+
+	QBENCHMARK
+	{
+		for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+			checksum += classifyByCasts(*itemIter);
+	}
+
+	QVERIFY(checksum > 0);
+}
+
+void DispatchBenchmark::typeTable_data()
+{
+	addItemCountRows();
+}
+
+void DispatchBenchmark::typeTable()
+{
+	QFETCH(int, itemCount);
+
+	QList<DrawingItem*> items = itemsForRow(itemCount);
+	int checksum = 0;
+
+	// Both approaches must agree before the timing means anything
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+		QCOMPARE(diagramItemType(*itemIter), classifyByCasts(*itemIter));
+
+	QBENCHMARK
+	{
+		for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+			checksum += diagramItemType(*itemIter);
+	}
+
+	QVERIFY(checksum > 0);
+}
+
+//==================================================================================================
+
+void DispatchBenchmark::addItemCountRows()
+{
+	QTest::addColumn<int>("itemCount");
+
+	QTest::newRow("1k") << 1000;
+	QTest::newRow("10k") << 10000;
+	QTest::newRow("100k") << 100000;
+}
+
+QList<DrawingItem*> DispatchBenchmark::itemsForRow(int itemCount) const
+{
+	return mItems.mid(0, itemCount);
+}
+
+DiagramItemType DispatchBenchmark::classifyByCasts(DrawingItem* item)
+{
+	// The casts the writers ran for every item before diagramItemType() was added
+	DrawingLineItem* lineItem = dynamic_cast<DrawingLineItem*>(item);
+	DrawingArcItem* arcItem = dynamic_cast<DrawingArcItem*>(item);
+	DrawingPolylineItem* polylineItem = dynamic_cast<DrawingPolylineItem*>(item);
+	DrawingCurveItem* curveItem = dynamic_cast<DrawingCurveItem*>(item);
+	DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(item);
+	DrawingEllipseItem* ellipseItem = dynamic_cast<DrawingEllipseItem*>(item);
+	DrawingPolygonItem* polygonItem = dynamic_cast<DrawingPolygonItem*>(item);
+	DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(item);
+	DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
+	DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(item);
+	DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(item);
+	DrawingPathItem* pathItem = dynamic_cast<DrawingPathItem*>(item);
+	DrawingItemGroup* groupItem = dynamic_cast<DrawingItemGroup*>(item);
+	DiagramItemType type = DiagramUnknownItemType;
+
+	if (lineItem) type = DiagramLineItemType;
+	else if (arcItem) type = DiagramArcItemType;
+	else if (polylineItem) type = DiagramPolylineItemType;
+	else if (curveItem) type = DiagramCurveItemType;
+	else if (rectItem) type = DiagramRectItemType;
+	else if (ellipseItem) type = DiagramEllipseItemType;
+	else if (polygonItem) type = DiagramPolygonItemType;
+	else if (textItem) type = DiagramTextItemType;
+	else if (textRectItem) type = DiagramTextRectItemType;
+	else if (textEllipseItem) type = DiagramTextEllipseItemType;
+	else if (textPolygonItem) type = DiagramTextPolygonItemType;
+	else if (pathItem) type = DiagramPathItemType;
+	else if (groupItem) type = DiagramItemGroupType;
+
+	return type;
+}
+
+//==================================================================================================
+
+QTEST_MAIN(DispatchBenchmark)
+
+#include "DispatchBenchmark.moc"
@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = dispatch
+
+SOURCES += DispatchBenchmark.cpp
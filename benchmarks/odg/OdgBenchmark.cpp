@@ -0,0 +1,178 @@
+/* OdgBenchmark.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "ElectricItems.h"
+#include "OdgWriter.h"
+#include <QtTest>
+#include <QPrinter>
+
+// Regression benchmark for the streaming ODG export.  A synthetic schematic is written to a
+// temporary file and the benchmark reports the output rate in bytes per second.  On Linux the
+// peak resident memory of the export is also measured; since the package parts are streamed into
+// the zip file it has to stay well below the size of the uncompressed content.  Writing the same
+// diagram a second time has to give a byte-identical file.
+class OdgBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void write_data();
+	void write();
+
+private:
+	void createSchematic(DiagramWidget* diagram, int itemCount) const;
+	static bool resetPeakMemory();
+	static qint64 peakMemory();
+};
+
+//==================================================================================================
+
+void OdgBenchmark::write_data()
+{
+	QTest::addColumn<int>("itemCount");
+
+	QTest::newRow("10k") << 10000;
+	QTest::newRow("100k") << 100000;
+}
+
+void OdgBenchmark::write()
+{
+	QFETCH(int, itemCount);
+
+	const qint64 maxMemoryGrowth = 64 * 1024 * 1024;
+	DiagramWidget diagram;
+	QPrinter printer;
+	QTemporaryDir dir;
+	QElapsedTimer timer;
+	qint64 elapsed, fileSize, memoryBefore = -1, memoryGrowth = -1;
+	bool ok;
+
+	QVERIFY(dir.isValid());
+
+	printer.setOutputFormat(QPrinter::PdfFormat);
+	printer.setPageOrientation(QPageLayout::Landscape);
+	printer.setPageSize(QPageSize(QPageSize::Letter));
+	printer.setPageMargins(QMarginsF(0.5, 0.5, 0.5, 0.5), QPageLayout::Inch);
+
+	createSchematic(&diagram, itemCount);
+
+	QString filePath = dir.filePath("benchmark.odg");
+	if (resetPeakMemory()) memoryBefore = peakMemory();
+
+	OdgWriter writer;
+	timer.start();
+	ok = writer.write(&diagram, &printer, filePath);
+	elapsed = qMax(timer.nsecsElapsed(), (qint64)1);
+
+	if (memoryBefore >= 0) memoryGrowth = peakMemory() - memoryBefore;
+
+	QVERIFY2(ok, qPrintable(writer.errorMessage()));
+
+	fileSize = QFileInfo(filePath).size();
+	QVERIFY(fileSize > 0);
+
+	qDebug("%d items: %.1f MB in %.1f ms, %.2f MB/s, peak memory growth %s", itemCount,
+		fileSize / 1048576.0, elapsed / 1e6, (fileSize / 1048576.0) / (elapsed / 1e9),
+		(memoryGrowth >= 0) ? qPrintable(QString::number(memoryGrowth / 1048576.0, 'f', 1) + " MB") : "n/a");
+
+	QTest::setBenchmarkResult(fileSize / (elapsed / 1e9), QTest::BytesPerSecond);
+
+	if (memoryGrowth >= 0) QVERIFY(memoryGrowth < maxMemoryGrowth);
+
+	QString secondFilePath = dir.filePath("benchmark2.odg");
+	QFile file(filePath), secondFile(secondFilePath);
+
+	OdgWriter secondWriter;
+	ok = secondWriter.write(&diagram, &printer, secondFilePath);
+	QVERIFY2(ok, qPrintable(secondWriter.errorMessage()));
+
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QVERIFY(secondFile.open(QIODevice::ReadOnly));
+	QVERIFY(file.readAll() == secondFile.readAll());
+}
+
+//==================================================================================================
+
+void OdgBenchmark::createSchematic(DiagramWidget* diagram, int itemCount) const
+{
+	// Rows of resistors joined by wires, with a label over every resistor
+	const int resistorsPerRow = 50;
+	DrawingScene* scene = diagram->scene();
+	qreal x, y;
+
+	for(int i = 0; i < itemCount / 3; i++)
+	{
+		x = (i % resistorsPerRow) * 600;
+		y = (i / resistorsPerRow) * 600;
+
+		DrawingPathItem* resistor = ElectricItems::createResistor1();
+		resistor->setX(x);
+		resistor->setY(y);
+		scene->addItem(resistor);
+
+		DrawingLineItem* wire = new DrawingLineItem();
+		wire->setX(x + 200);
+		wire->setY(y);
+		wire->setLine(QLineF(0, 0, 200, 0));
+		scene->addItem(wire);
+
+		DrawingTextItem* label = new DrawingTextItem();
+		label->setX(x);
+		label->setY(y - 150);
+		label->setCaption("R" + QString::number(i + 1));
+		scene->addItem(label);
+	}
+
+	QRectF sceneRect = scene->sceneRect();
+	sceneRect.setWidth(resistorsPerRow * 600);
+	sceneRect.setHeight((itemCount / 3 / resistorsPerRow + 1) * 600);
+	scene->setSceneRect(sceneRect);
+}
+
+bool OdgBenchmark::resetPeakMemory()
+{
+	// Writing 5 to clear_refs resets the peak resident set size reported as VmHWM
+	QFile file("/proc/self/clear_refs");
+	return (file.open(QIODevice::WriteOnly) && file.write("5") == 1);
+}
+
+qint64 OdgBenchmark::peakMemory()
+{
+	qint64 peak = -1;
+	QFile file("/proc/self/status");
+
+	if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		QList<QByteArray> lines = file.readAll().split('\n');
+		for(auto lineIter = lines.begin(); lineIter != lines.end(); lineIter++)
+		{
+			if (lineIter->startsWith("VmHWM:"))
+				peak = lineIter->mid(6).simplified().split(' ').first().toLongLong() * 1024;
+		}
+	}
+
+	return peak;
+}
+
+//==================================================================================================
+
+QTEST_MAIN(OdgBenchmark)
+
+#include "OdgBenchmark.moc"
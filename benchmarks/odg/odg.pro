@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = odg
+
+SOURCES += OdgBenchmark.cpp
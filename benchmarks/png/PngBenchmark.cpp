@@ -0,0 +1,162 @@
+/* PngBenchmark.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramImageRenderer.h"
+#include "ElectricItems.h"
+#include <QtTest>
+
+// Checks that the tiled PNG export renders exactly the same pixels as drawing the whole image with
+// a single painter, and reports how long each takes.  Small and
+// odd tile sizes are used so that many items cross tile edges.
+class PngBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void compare_data();
+	void compare();
+
+private:
+	void createSchematic(DiagramWidget* diagram, int itemCount) const;
+	QImage renderSinglePainter(const DiagramImageRenderer& renderer) const;
+	int countDifferences(const QImage& image1, const QImage& image2) const;
+};
+
+//==================================================================================================
+
+void PngBenchmark::compare_data()
+{
+	QTest::addColumn<int>("itemCount");
+	QTest::addColumn<qreal>("scale");
+	QTest::addColumn<int>("tileSize");
+
+	QTest::newRow("1k, 0.2, 64 px tiles") << 1000 << 0.2 << 64;
+	QTest::newRow("1k, 0.37, 101 px tiles") << 1000 << 0.37 << 101;
+	QTest::newRow("10k, 0.1, 1024 px tiles") << 10000 << 0.1 << 1024;
+}
+
+void PngBenchmark::compare()
+{
+	QFETCH(int, itemCount);
+	QFETCH(qreal, scale);
+	QFETCH(int, tileSize);
+
+	DiagramWidget diagram;
+	QElapsedTimer timer;
+	qint64 tiledElapsed, singleElapsed;
+
+	createSchematic(&diagram, itemCount);
+
+	QRectF sceneRect = diagram.scene()->sceneRect();
+	QSize size(qMax(1, (int)(sceneRect.width() * scale)), qMax(1, (int)(sceneRect.height() * scale)));
+
+	timer.start();
+	DiagramImageRenderer renderer(&diagram, size, sceneRect, tileSize);
+	QImage tiledImage = renderer.render(QRect(QPoint(0, 0), size));
+	tiledElapsed = timer.nsecsElapsed();
+
+	timer.restart();
+	QImage singleImage = renderSinglePainter(renderer);
+	singleElapsed = timer.nsecsElapsed();
+
+	qDebug("%d items, %dx%d px: tiled %.1f ms, single painter %.1f ms", itemCount,
+		size.width(), size.height(), tiledElapsed / 1e6, singleElapsed / 1e6);
+
+	QCOMPARE(tiledImage.size(), singleImage.size());
+	QCOMPARE(countDifferences(tiledImage, singleImage), 0);
+}
+
+//==================================================================================================
+
+void PngBenchmark::createSchematic(DiagramWidget* diagram, int itemCount) const
+{
+	// Rows of resistors joined by wires, with a label over every resistor
+	const int resistorsPerRow = 20;
+	DrawingScene* scene = diagram->scene();
+	qreal x, y;
+
+	for(int i = 0; i < itemCount / 3; i++)
+	{
+		x = (i % resistorsPerRow) * 600;
+		y = (i / resistorsPerRow) * 600;
+
+		DrawingPathItem* resistor = ElectricItems::createResistor1();
+		resistor->setX(x);
+		resistor->setY(y);
+		scene->addItem(resistor);
+
+		DrawingLineItem* wire = new DrawingLineItem();
+		wire->setX(x + 200);
+		wire->setY(y);
+		wire->setLine(QLineF(0, 0, 200, 0));
+		scene->addItem(wire);
+
+		DrawingTextItem* label = new DrawingTextItem();
+		label->setX(x);
+		label->setY(y - 150);
+		label->setCaption("R" + QString::number(i + 1));
+		scene->addItem(label);
+	}
+
+	QRectF sceneRect = scene->sceneRect();
+	sceneRect.setWidth(resistorsPerRow * 600);
+	sceneRect.setHeight((itemCount / 3 / resistorsPerRow + 1) * 600);
+	scene->setSceneRect(sceneRect);
+}
+
+QImage PngBenchmark::renderSinglePainter(const DiagramImageRenderer& renderer) const
+{
+	// The same recorded items and transform the renderer uses for each tile, applied to the whole
+	// image at once
+	QImage image(renderer.size(), QImage::Format_ARGB32);
+	image.fill(Qt::transparent);
+
+	QPainter painter(&image);
+	painter.setTransform(renderer.imageTransform());
+	painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
+	renderer.draw(&painter);
+	painter.end();
+
+	return image;
+}
+
+int PngBenchmark::countDifferences(const QImage& image1, const QImage& image2) const
+{
+	int differences = 0;
+
+	for(int y = 0; y < image1.height(); y++)
+	{
+		const QRgb* line1 = (const QRgb*)image1.constScanLine(y);
+		const QRgb* line2 = (const QRgb*)image2.constScanLine(y);
+
+		for(int x = 0; x < image1.width(); x++)
+		{
+			if (line1[x] != line2[x]) differences++;
+		}
+	}
+
+	return differences;
+}
+
+//==================================================================================================
+
+QTEST_MAIN(PngBenchmark)
+
+#include "PngBenchmark.moc"
@@ -0,0 +1,5 @@
+include(../benchmarks.pri)
+
+TARGET = png
+
+SOURCES += PngBenchmark.cpp
@@ -8,7 +8,7 @@ INCLUDEPATH += source
 
 CONFIG += release warn_on embed_manifest_dll c++11 qt
 CONFIG -= debug
-QT += widgets printsupport svg
+QT += widgets printsupport svg concurrent
 
 !win32:MOC_DIR = release
 !win32:OBJECTS_DIR = release
@@ -25,10 +25,28 @@ LIBS += -LC:/Development/quazip-0.7.1/quazip/release/ -lquazip
 
 SOURCES += \
 	source/AboutDialog.cpp \
+	source/DiagramBatchExporter.cpp \
+	source/DiagramBinaryReader.cpp \
+	source/DiagramBinaryWriter.cpp \
+	source/DiagramExportStyle.cpp \
+	source/DiagramGridRenderer.cpp \
+	source/DiagramImageRenderer.cpp \
+	source/DiagramItemIndex.cpp \
+	source/DiagramItemPlacement.cpp \
+	source/DiagramItemType.cpp \
+	source/DiagramLevelOfDetail.cpp \
+	source/DiagramNumberFormat.cpp \
+	source/DiagramOutputStream.cpp \
+	source/DiagramPathScanner.cpp \
+	source/DiagramPerformanceHud.cpp \
+	source/DiagramPngWriter.cpp \
 	source/DiagramReader.cpp \
+	source/DiagramSymbolCache.cpp \
+	source/DiagramTileCache.cpp \
 	source/DiagramUndo.cpp \
     source/DiagramWidget.cpp \
     source/DiagramWriter.cpp \
+	source/DiagramZipWriter.cpp \
     source/DynamicPropertiesWidget.cpp \
 	source/ElectricItems.cpp \
 	source/ExportOptionsDialog.cpp \
@@ -36,16 +54,36 @@ SOURCES += \
 	source/LogicItems.cpp \
 	source/MainWindow.cpp \
 	source/OdgWriter.cpp \
+	source/PdfWriter.cpp \
 	source/PreferencesDialog.cpp \
+	source/SvgWriter.cpp \
     source/VsdxWriter.cpp \
     source/main.cpp
 
 HEADERS += \
 	source/AboutDialog.h \
+	source/DiagramBatchExporter.h \
+	source/DiagramBinaryReader.h \
+	source/DiagramBinaryWriter.h \
+	source/DiagramExportStyle.h \
+	source/DiagramGridRenderer.h \
+	source/DiagramImageRenderer.h \
+	source/DiagramItemIndex.h \
+	source/DiagramItemPlacement.h \
+	source/DiagramItemType.h \
+	source/DiagramLevelOfDetail.h \
+	source/DiagramNumberFormat.h \
+	source/DiagramOutputStream.h \
+	source/DiagramPathScanner.h \
+	source/DiagramPerformanceHud.h \
+	source/DiagramPngWriter.h \
 	source/DiagramReader.h \
+	source/DiagramSymbolCache.h \
+	source/DiagramTileCache.h \
 	source/DiagramUndo.h \
     source/DiagramWidget.h \
     source/DiagramWriter.h \
+	source/DiagramZipWriter.h \
     source/DynamicPropertiesWidget.h \
 	source/ElectricItems.h \
 	source/ExportOptionsDialog.h \
@@ -53,7 +91,9 @@ HEADERS += \
 	source/LogicItems.h \
 	source/MainWindow.h \
 	source/OdgWriter.h \
+	source/PdfWriter.h \
     source/PreferencesDialog.h \
+	source/SvgWriter.h \
     source/VsdxWriter.h
 
 RESOURCES += icons/icons.qrc
@@ -0,0 +1,344 @@
+/* DiagramBatchExporter.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramBatchExporter.h"
+#include "DiagramReader.h"
+#include "DiagramBinaryReader.h"
+#include "DiagramImageRenderer.h"
+#include "DiagramPngWriter.h"
+#include "OdgWriter.h"
+#include "PdfWriter.h"
+#include "SvgWriter.h"
+#include "VsdxWriter.h"
+#include <QtPrintSupport>
+
+DiagramBatchExporter::DiagramBatchExporter()
+{
+	mFormat = PngFormat;
+	mScale = 0;
+	mJobs = QThread::idealThreadCount();
+}
+
+DiagramBatchExporter::~DiagramBatchExporter() { }
+
+//==================================================================================================
+
+void DiagramBatchExporter::setFormat(Format format)
+{
+	mFormat = format;
+}
+
+void DiagramBatchExporter::setOutputPath(const QString& path)
+{
+	mOutputPath = path;
+}
+
+void DiagramBatchExporter::setScale(qreal scale)
+{
+	mScale = scale;
+}
+
+void DiagramBatchExporter::setJobs(int jobs)
+{
+	mJobs = qMax(1, jobs);
+}
+
+DiagramBatchExporter::Format DiagramBatchExporter::format() const
+{
+	return mFormat;
+}
+
+QString DiagramBatchExporter::outputPath() const
+{
+	return mOutputPath;
+}
+
+qreal DiagramBatchExporter::scale() const
+{
+	return mScale;
+}
+
+int DiagramBatchExporter::jobs() const
+{
+	return mJobs;
+}
+
+//==================================================================================================
+
+int DiagramBatchExporter::exportFiles(const QStringList& filePaths)
+{
+	// Returns the number of files that could not be exported
+	if (mJobs > 1 && filePaths.size() > 1) return exportFilesInProcesses(filePaths);
+
+	int failures = 0;
+	QTextStream errorStream(stderr);
+
+	for(auto pathIter = filePaths.begin(); pathIter != filePaths.end(); pathIter++)
+	{
+		if (!exportFile(*pathIter))
+		{
+			errorStream << "jade: " << *pathIter << ": " << mErrorMessage << endl;
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+bool DiagramBatchExporter::exportFile(const QString& filePath)
+{
+	DiagramWidget diagram;
+	QPrinter printer;
+	QString outputFilePath = DiagramBatchExporter::outputFilePath(filePath);
+	bool ok = false;
+
+	mErrorMessage.clear();
+	setupPrinter(&printer);
+
+	if (loadFile(&diagram, filePath))
+	{
+		diagram.selectNone();
+		diagram.loadAllItems();
+
+		switch (mFormat)
+		{
+		case PngFormat:
+			ok = exportPng(&diagram, outputFilePath);
+			break;
+		case SvgFormat:
+			ok = exportSvg(&diagram, outputFilePath);
+			break;
+		case PdfFormat:
+			{
+				PdfWriter writer;
+				ok = writer.write(&diagram, &printer, outputFilePath);
+				if (!ok) mErrorMessage = writer.errorMessage();
+			}
+			break;
+		case OdgFormat:
+			{
+				OdgWriter writer;
+				ok = writer.write(&diagram, &printer, outputFilePath);
+				if (!ok) mErrorMessage = writer.errorMessage();
+			}
+			break;
+		case VsdxFormat:
+			{
+				VsdxWriter writer;
+				ok = writer.write(&diagram, &printer, outputFilePath);
+				if (!ok) mErrorMessage = writer.errorMessage();
+			}
+			break;
+		default:
+			mErrorMessage = "Unknown export format.";
+			break;
+		}
+	}
+
+	return ok;
+}
+
+//==================================================================================================
+
+QString DiagramBatchExporter::errorMessage() const
+{
+	return mErrorMessage;
+}
+
+//==================================================================================================
+
+DiagramBatchExporter::Format DiagramBatchExporter::formatFromString(const QString& str)
+{
+	QString lowerStr = str.toLower();
+	Format format = UnknownFormat;
+
+	if (lowerStr == "png") format = PngFormat;
+	else if (lowerStr == "svg") format = SvgFormat;
+	else if (lowerStr == "pdf") format = PdfFormat;
+	else if (lowerStr == "odg") format = OdgFormat;
+	else if (lowerStr == "vsdx") format = VsdxFormat;
+
+	return format;
+}
+
+QString DiagramBatchExporter::formatToString(Format format)
+{
+	QString str;
+
+	switch (format)
+	{
+	case PngFormat: str = "png"; break;
+	case SvgFormat: str = "svg"; break;
+	case PdfFormat: str = "pdf"; break;
+	case OdgFormat: str = "odg"; break;
+	case VsdxFormat: str = "vsdx"; break;
+	default: break;
+	}
+
+	return str;
+}
+
+//==================================================================================================
+
+int DiagramBatchExporter::exportFilesInProcesses(const QStringList& filePaths)
+{
+	QList<QProcess*> processes;
+	QStringList arguments;
+	QEventLoop eventLoop;
+	int failures = 0;
+
+	// The children share the cores, so each gets an even part of the thread pool
+	int threads = qMax(1, QThread::idealThreadCount() / qMin(mJobs, filePaths.size()));
+
+	arguments << "--export" << formatToString(mFormat) << "--jobs" << "1" << "--threads" << QString::number(threads);
+	if (!mOutputPath.isEmpty()) arguments << "--out" << mOutputPath;
+	if (mScale > 0) arguments << "--scale" << QString::number(mScale);
+
+	for(auto pathIter = filePaths.begin(); pathIter != filePaths.end() || !processes.isEmpty(); )
+	{
+		while (pathIter != filePaths.end() && processes.size() < mJobs)
+		{
+			// The child reports its own errors on the shared stderr
+			QProcess* process = new QProcess();
+			process->setProcessChannelMode(QProcess::ForwardedChannels);
+			QObject::connect(process, SIGNAL(finished(int,QProcess::ExitStatus)), &eventLoop, SLOT(quit()));
+			QObject::connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), &eventLoop, SLOT(quit()));
+			process->start(QCoreApplication::applicationFilePath(), QStringList(arguments) << *pathIter);
+			processes.append(process);
+			pathIter++;
+		}
+
+		// Sleep until one of the children exits or fails to start
+		bool running = true;
+		for(auto processIter = processes.begin(); processIter != processes.end() && running; processIter++)
+			running = ((*processIter)->state() != QProcess::NotRunning);
+		if (running) eventLoop.exec();
+
+		for(auto processIter = processes.begin(); processIter != processes.end(); )
+		{
+			QProcess* process = *processIter;
+
+			if (process->state() == QProcess::NotRunning)
+			{
+				if (process->error() == QProcess::FailedToStart || process->exitStatus() != QProcess::NormalExit ||
+					process->exitCode() != 0)
+				{
+					if (process->exitStatus() != QProcess::NormalExit || process->error() == QProcess::FailedToStart)
+						QTextStream(stderr) << "jade: " << process->arguments().last() << ": export process failed" << endl;
+					failures++;
+				}
+
+				delete process;
+				processIter = processes.erase(processIter);
+			}
+			else processIter++;
+		}
+	}
+
+	return failures;
+}
+
+//==================================================================================================
+
+bool DiagramBatchExporter::loadFile(DiagramWidget* diagram, const QString& filePath)
+{
+	QFile dataFile(filePath);
+	bool ok = dataFile.open(QIODevice::ReadOnly);
+
+	if (ok)
+	{
+		if (filePath.endsWith(".jdmb", Qt::CaseInsensitive))
+		{
+			DiagramBinaryReader reader(&dataFile);
+			reader.read(diagram);
+			ok = (reader.status() == QDataStream::Ok);
+		}
+		else
+		{
+			DiagramReader reader(&dataFile);
+			reader.read(diagram);
+			ok = !reader.hasError();
+		}
+
+		dataFile.close();
+
+		if (!ok) mErrorMessage = "Unable to read the drawing.";
+	}
+	else mErrorMessage = "Unable to open the file for reading.";
+
+	return ok;
+}
+
+bool DiagramBatchExporter::exportPng(DiagramWidget* diagram, const QString& filePath)
+{
+	QRectF sceneRect = diagram->scene()->sceneRect();
+	qreal scale = (mScale > 0) ? mScale : 0.2;
+	QSize exportSize(qMax(1, (int)(sceneRect.width() * scale)), qMax(1, (int)(sceneRect.height() * scale)));
+	QFile pngFile(filePath);
+
+	if (!pngFile.open(QIODevice::WriteOnly))
+	{
+		mErrorMessage = "Unable to open " + filePath + " for writing.";
+		return false;
+	}
+
+	DiagramImageRenderer renderer(diagram, exportSize, sceneRect);
+	DiagramPngWriter pngWriter(&pngFile);
+
+	bool ok = renderer.writePng(&pngWriter);
+	pngFile.close();
+
+	if (!ok) mErrorMessage = pngWriter.errorMessage();
+	return ok;
+}
+
+bool DiagramBatchExporter::exportSvg(DiagramWidget* diagram, const QString& filePath)
+{
+	QRectF sceneRect = diagram->scene()->sceneRect();
+	qreal scale = (mScale > 0) ? mScale : 0.1;
+	QSize exportSize(qMax(1, (int)(sceneRect.width() * scale)), qMax(1, (int)(sceneRect.height() * scale)));
+	SvgWriter writer;
+
+	bool ok = writer.write(diagram, exportSize, filePath);
+	if (!ok) mErrorMessage = writer.errorMessage();
+
+	return ok;
+}
+
+//==================================================================================================
+
+QString DiagramBatchExporter::outputFilePath(const QString& filePath) const
+{
+	QFileInfo fileInfo(filePath);
+	QDir outputDir = (mOutputPath.isEmpty()) ? fileInfo.absoluteDir() : QDir(mOutputPath);
+
+	return outputDir.absoluteFilePath(fileInfo.completeBaseName() + "." + formatToString(mFormat));
+}
+
+void DiagramBatchExporter::setupPrinter(QPrinter* printer) const
+{
+	// Matches the defaults of the main window's printer; writing to PDF keeps the printer from
+	// looking for a print system
+	printer->setOutputFormat(QPrinter::PdfFormat);
+	printer->setPageOrientation(QPageLayout::Landscape);
+	printer->setPageSize(QPageSize(QPageSize::Letter));
+	printer->setPageMargins(QMarginsF(0.5, 0.5, 0.5, 0.5), QPageLayout::Inch);
+	printer->setResolution(600);
+}
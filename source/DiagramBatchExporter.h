@@ -0,0 +1,78 @@
+/* DiagramBatchExporter.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMBATCHEXPORTER_H
+#define DIAGRAMBATCHEXPORTER_H
+
+#include <DiagramWidget.h>
+
+class QPrinter;
+
+// Exports drawings from the command line without showing any windows.  Each file is loaded into
+// its own hidden DiagramWidget and written through the same writers and renderExport path as the
+// GUI.  Widgets can only live on the GUI thread, so files are spread across cores by running one
+// child process per file, up to the given number of jobs at a time, with the thread pool split
+// evenly between them.
+class DiagramBatchExporter
+{
+public:
+	enum Format { PngFormat, SvgFormat, PdfFormat, OdgFormat, VsdxFormat, UnknownFormat };
+
+private:
+	Format mFormat;
+	QString mOutputPath;
+	qreal mScale;
+	int mJobs;
+
+	QString mErrorMessage;
+
+public:
+	DiagramBatchExporter();
+	~DiagramBatchExporter();
+
+	void setFormat(Format format);
+	void setOutputPath(const QString& path);
+	void setScale(qreal scale);
+	void setJobs(int jobs);
+	Format format() const;
+	QString outputPath() const;
+	qreal scale() const;
+	int jobs() const;
+
+	int exportFiles(const QStringList& filePaths);
+	bool exportFile(const QString& filePath);
+
+	QString errorMessage() const;
+
+	static Format formatFromString(const QString& str);
+	static QString formatToString(Format format);
+
+private:
+	int exportFilesInProcesses(const QStringList& filePaths);
+
+	bool loadFile(DiagramWidget* diagram, const QString& filePath);
+	bool exportPng(DiagramWidget* diagram, const QString& filePath);
+	bool exportSvg(DiagramWidget* diagram, const QString& filePath);
+
+	QString outputFilePath(const QString& filePath) const;
+	void setupPrinter(QPrinter* printer) const;
+};
+
+#endif
@@ -0,0 +1,416 @@
+/* DiagramBinaryReader.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramBinaryReader.h"
+#include "DiagramReader.h"
+
+DiagramBinaryReader::DiagramBinaryReader(QIODevice* device) : QDataStream(device)
+{
+	prepareStream(*this);
+}
+
+DiagramBinaryReader::~DiagramBinaryReader() { }
+
+//==================================================================================================
+
+void DiagramBinaryReader::read(DiagramWidget* diagram)
+{
+	QByteArray pageRecord, styleRecord;
+	quint32 magic = 0, numberOfStyles = 0;
+	quint16 version = 0;
+
+	mStyles.clear();
+
+	*this >> magic >> version;
+	if (magic != DiagramBinaryMagic || version == 0 || version > DiagramBinaryVersion)
+	{
+		setStatus(QDataStream::ReadCorruptData);
+		return;
+	}
+
+	*this >> pageRecord;
+	*this >> numberOfStyles;
+	for(quint32 i = 0; status() == QDataStream::Ok && i < numberOfStyles; i++)
+	{
+		*this >> styleRecord;
+		readStyleRecord(styleRecord);
+	}
+
+	if (diagram && status() == QDataStream::Ok)
+	{
+		DrawingScene* scene = diagram->scene();
+
+		QDataStream pageStream(pageRecord);
+		prepareStream(pageStream);
+		readPageRecord(pageStream, diagram);
+
+		QList<DrawingItem*> items = readItemRecords(*this);
+		for(auto itemIter = items.begin(); scene && itemIter != items.end(); itemIter++)
+			scene->addItem(*itemIter);
+	}
+}
+
+//==================================================================================================
+
+void DiagramBinaryReader::readPageRecord(QDataStream& stream, DiagramWidget* diagram)
+{
+	DrawingScene* scene = diagram->scene();
+	QRectF sceneRect;
+	QColor backgroundColor, gridColor;
+	qreal grid = 0;
+	quint8 gridStyle = 0;
+	qint32 gridSpacingMajor = 0, gridSpacingMinor = 0;
+
+	stream >> sceneRect >> backgroundColor >> grid >> gridColor >> gridStyle;
+	stream >> gridSpacingMajor >> gridSpacingMinor;
+
+	if (stream.status() == QDataStream::Ok)
+	{
+		if (scene)
+		{
+			scene->setSceneRect(sceneRect);
+			scene->setBackgroundBrush(backgroundColor);
+		}
+
+		diagram->setGrid(grid);
+		diagram->setGridBrush(gridColor);
+		diagram->setGridStyle((DiagramWidget::GridRenderStyle)gridStyle);
+		diagram->setGridSpacing(gridSpacingMajor, gridSpacingMinor);
+	}
+}
+
+QList<DrawingItem*> DiagramBinaryReader::readItemRecords(QDataStream& stream)
+{
+	QList<DrawingItem*> items;
+	DrawingItem* newItem = nullptr;
+	QByteArray record;
+	quint32 numberOfItems = 0;
+	quint8 type;
+
+	stream >> numberOfItems;
+
+	for(quint32 i = 0; stream.status() == QDataStream::Ok && i < numberOfItems; i++)
+	{
+		stream >> type >> record;
+		if (stream.status() != QDataStream::Ok) break;
+
+		QDataStream recordStream(record);
+		prepareStream(recordStream);
+
+		// Records with an unknown type tag are skipped so that newer files can still be opened
+		switch (type)
+		{
+		case DiagramBinaryLineItem: newItem = readLineItem(recordStream); break;
+		case DiagramBinaryArcItem: newItem = readArcItem(recordStream); break;
+		case DiagramBinaryPolylineItem: newItem = readPolylineItem(recordStream); break;
+		case DiagramBinaryCurveItem: newItem = readCurveItem(recordStream); break;
+		case DiagramBinaryRectItem: newItem = readRectItem(recordStream); break;
+		case DiagramBinaryEllipseItem: newItem = readEllipseItem(recordStream); break;
+		case DiagramBinaryPolygonItem: newItem = readPolygonItem(recordStream); break;
+		case DiagramBinaryTextItem: newItem = readTextItem(recordStream); break;
+		case DiagramBinaryTextRectItem: newItem = readTextRectItem(recordStream); break;
+		case DiagramBinaryTextEllipseItem: newItem = readTextEllipseItem(recordStream); break;
+		case DiagramBinaryTextPolygonItem: newItem = readTextPolygonItem(recordStream); break;
+		case DiagramBinaryPathItem: newItem = readPathItem(recordStream); break;
+		case DiagramBinaryItemGroup: newItem = readItemGroup(recordStream); break;
+		default: newItem = nullptr; break;
+		}
+
+		if (newItem) items.append(newItem);
+	}
+
+	DiagramReader::connectItems(items);
+
+	return items;
+}
+
+//==================================================================================================
+
+DrawingLineItem* DiagramBinaryReader::readLineItem(QDataStream& stream)
+{
+	DrawingLineItem* item = new DrawingLineItem();
+	QLineF line;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> line;
+	item->setLine(line);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingArcItem* DiagramBinaryReader::readArcItem(QDataStream& stream)
+{
+	DrawingArcItem* item = new DrawingArcItem();
+	QLineF arc;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> arc;
+	item->setArc(arc);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingPolylineItem* DiagramBinaryReader::readPolylineItem(QDataStream& stream)
+{
+	DrawingPolylineItem* item = new DrawingPolylineItem();
+	QPolygonF polyline;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> polyline;
+	if (!polyline.isEmpty()) item->setPolyline(polyline);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingCurveItem* DiagramBinaryReader::readCurveItem(QDataStream& stream)
+{
+	DrawingCurveItem* item = new DrawingCurveItem();
+	QPointF p1, cp1, cp2, p2;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> p1 >> cp1 >> cp2 >> p2;
+	item->setCurve(p1, cp1, cp2, p2);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingRectItem* DiagramBinaryReader::readRectItem(QDataStream& stream)
+{
+	DrawingRectItem* item = new DrawingRectItem();
+	QRectF rect;
+	qreal radiusX = 0, radiusY = 0;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> rect >> radiusX >> radiusY;
+	item->setRect(rect);
+	item->setCornerRadii(radiusX, radiusY);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingEllipseItem* DiagramBinaryReader::readEllipseItem(QDataStream& stream)
+{
+	DrawingEllipseItem* item = new DrawingEllipseItem();
+	QRectF rect;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> rect;
+	item->setEllipse(rect);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingPolygonItem* DiagramBinaryReader::readPolygonItem(QDataStream& stream)
+{
+	DrawingPolygonItem* item = new DrawingPolygonItem();
+	QPolygonF polygon;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> polygon;
+	if (!polygon.isEmpty()) item->setPolygon(polygon);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingTextItem* DiagramBinaryReader::readTextItem(QDataStream& stream)
+{
+	DrawingTextItem* item = new DrawingTextItem();
+	QString caption;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	applyItemStyle(styleIndex, item->style());
+
+	stream >> caption;
+	item->setCaption(caption);
+
+	return item;
+}
+
+DrawingTextRectItem* DiagramBinaryReader::readTextRectItem(QDataStream& stream)
+{
+	DrawingTextRectItem* item = new DrawingTextRectItem();
+	QRectF rect;
+	qreal radiusX = 0, radiusY = 0;
+	QString caption;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> rect >> radiusX >> radiusY;
+	item->setRect(rect);
+	item->setCornerRadii(radiusX, radiusY);
+
+	applyItemStyle(styleIndex, item->style());
+
+	stream >> caption;
+	item->setCaption(caption);
+
+	return item;
+}
+
+DrawingTextEllipseItem* DiagramBinaryReader::readTextEllipseItem(QDataStream& stream)
+{
+	DrawingTextEllipseItem* item = new DrawingTextEllipseItem();
+	QRectF rect;
+	QString caption;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> rect;
+	item->setEllipse(rect);
+
+	applyItemStyle(styleIndex, item->style());
+
+	stream >> caption;
+	item->setCaption(caption);
+
+	return item;
+}
+
+DrawingTextPolygonItem* DiagramBinaryReader::readTextPolygonItem(QDataStream& stream)
+{
+	DrawingTextPolygonItem* item = new DrawingTextPolygonItem();
+	QPolygonF polygon;
+	QString caption;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> polygon;
+	if (!polygon.isEmpty()) item->setPolygon(polygon);
+
+	applyItemStyle(styleIndex, item->style());
+
+	stream >> caption;
+	item->setCaption(caption);
+
+	return item;
+}
+
+DrawingPathItem* DiagramBinaryReader::readPathItem(QDataStream& stream)
+{
+	DrawingPathItem* item = new DrawingPathItem();
+	QString name;
+	QRectF rect, pathRect;
+	QPainterPath path;
+	QPolygonF connectionPoints;
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	stream >> name >> rect >> pathRect >> path >> connectionPoints;
+	item->setName(name);
+	item->setPath(path, pathRect);
+	item->setRect(rect);
+	if (!connectionPoints.isEmpty()) item->addConnectionPoints(connectionPoints);
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+DrawingItemGroup* DiagramBinaryReader::readItemGroup(QDataStream& stream)
+{
+	DrawingItemGroup* item = new DrawingItemGroup();
+
+	quint32 styleIndex = readItemHeader(stream, item);
+
+	item->setItems(readItemRecords(stream));
+
+	applyItemStyle(styleIndex, item->style());
+
+	return item;
+}
+
+//==================================================================================================
+
+quint32 DiagramBinaryReader::readItemHeader(QDataStream& stream, DrawingItem* item)
+{
+	quint32 styleIndex = 0;
+	QPointF position;
+	QTransform transform;
+
+	stream >> styleIndex >> position >> transform;
+	item->setX(position.x());
+	item->setY(position.y());
+	item->setTransform(transform, false);
+
+	return styleIndex;
+}
+
+void DiagramBinaryReader::readStyleRecord(const QByteArray& record)
+{
+	QList< QPair<DrawingItemStyle::Property,QVariant> > properties;
+	quint8 property;
+	QVariant value;
+
+	QDataStream styleStream(record);
+	prepareStream(styleStream);
+
+	while (!styleStream.atEnd() && styleStream.status() == QDataStream::Ok)
+	{
+		styleStream >> property >> value;
+		if (styleStream.status() == QDataStream::Ok && property < DrawingItemStyle::NumberOfProperties)
+			properties.append(qMakePair((DrawingItemStyle::Property)property, value));
+	}
+
+	mStyles.append(properties);
+}
+
+void DiagramBinaryReader::applyItemStyle(quint32 index, DrawingItemStyle* style)
+{
+	if (style && index < (quint32)mStyles.size())
+	{
+		const QList< QPair<DrawingItemStyle::Property,QVariant> >& properties = mStyles[index];
+
+		for(auto propertyIter = properties.begin(); propertyIter != properties.end(); propertyIter++)
+		{
+			if (style->hasValue(propertyIter->first)) style->setValue(propertyIter->first, propertyIter->second);
+		}
+	}
+}
+
+//==================================================================================================
+
+void DiagramBinaryReader::prepareStream(QDataStream& stream) const
+{
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
@@ -0,0 +1,62 @@
+/* DiagramBinaryReader.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMBINARYREADER_H
+#define DIAGRAMBINARYREADER_H
+
+#include <DiagramBinaryWriter.h>
+
+class DiagramBinaryReader : public QDataStream
+{
+private:
+	QList< QList< QPair<DrawingItemStyle::Property,QVariant> > > mStyles;
+
+public:
+	DiagramBinaryReader(QIODevice* device);
+	~DiagramBinaryReader();
+
+	void read(DiagramWidget* diagram);
+
+private:
+	void readPageRecord(QDataStream& stream, DiagramWidget* diagram);
+	QList<DrawingItem*> readItemRecords(QDataStream& stream);
+
+	DrawingLineItem* readLineItem(QDataStream& stream);
+	DrawingArcItem* readArcItem(QDataStream& stream);
+	DrawingPolylineItem* readPolylineItem(QDataStream& stream);
+	DrawingCurveItem* readCurveItem(QDataStream& stream);
+	DrawingRectItem* readRectItem(QDataStream& stream);
+	DrawingEllipseItem* readEllipseItem(QDataStream& stream);
+	DrawingPolygonItem* readPolygonItem(QDataStream& stream);
+	DrawingTextItem* readTextItem(QDataStream& stream);
+	DrawingTextRectItem* readTextRectItem(QDataStream& stream);
+	DrawingTextEllipseItem* readTextEllipseItem(QDataStream& stream);
+	DrawingTextPolygonItem* readTextPolygonItem(QDataStream& stream);
+	DrawingPathItem* readPathItem(QDataStream& stream);
+	DrawingItemGroup* readItemGroup(QDataStream& stream);
+
+	quint32 readItemHeader(QDataStream& stream, DrawingItem* item);
+	void readStyleRecord(const QByteArray& record);
+	void applyItemStyle(quint32 index, DrawingItemStyle* style);
+
+	void prepareStream(QDataStream& stream) const;
+};
+
+#endif
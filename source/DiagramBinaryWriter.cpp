@@ -0,0 +1,251 @@
+/* DiagramBinaryWriter.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramBinaryWriter.h"
+#include "DiagramItemType.h"
+
+DiagramBinaryWriter::DiagramBinaryWriter(QIODevice* device) : QDataStream(device)
+{
+	prepareStream(*this);
+}
+
+DiagramBinaryWriter::~DiagramBinaryWriter() { }
+
+//==================================================================================================
+
+void DiagramBinaryWriter::write(DiagramWidget* diagram)
+{
+	QByteArray pageRecord, itemRecords;
+
+	mStyles.clear();
+	mStyleIndices.clear();
+
+	if (diagram)
+	{
+		QDataStream pageStream(&pageRecord, QIODevice::WriteOnly);
+		prepareStream(pageStream);
+		writePageRecord(pageStream, diagram);
+
+		// The items are serialized first so that the style dictionary is complete before it is
+		// written ahead of them
+		QDataStream itemStream(&itemRecords, QIODevice::WriteOnly);
+		prepareStream(itemStream);
+		writeItemRecords(itemStream, (diagram->scene()) ? diagram->scene()->items() : QList<DrawingItem*>());
+	}
+
+	*this << DiagramBinaryMagic << DiagramBinaryVersion;
+	*this << pageRecord;
+
+	*this << (quint32)mStyles.size();
+	for(auto styleIter = mStyles.begin(); styleIter != mStyles.end(); styleIter++)
+		*this << *styleIter;
+
+	writeRawData(itemRecords.constData(), itemRecords.size());
+}
+
+//==================================================================================================
+
+void DiagramBinaryWriter::writePageRecord(QDataStream& stream, DiagramWidget* diagram)
+{
+	DrawingScene* scene = diagram->scene();
+
+	stream << ((scene) ? scene->sceneRect() : QRectF());
+	stream << ((scene) ? scene->backgroundBrush().color() : QColor(255, 255, 255));
+	stream << diagram->grid();
+	stream << diagram->gridBrush().color();
+	stream << (quint8)diagram->gridStyle();
+	stream << (qint32)diagram->gridSpacingMajor() << (qint32)diagram->gridSpacingMinor();
+}
+
+void DiagramBinaryWriter::writeItemRecords(QDataStream& stream, const QList<DrawingItem*>& items)
+{
+	QByteArray record;
+	quint8 type;
+
+	stream << (quint32)items.size();
+
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		record.clear();
+		QDataStream recordStream(&record, QIODevice::WriteOnly);
+		prepareStream(recordStream);
+
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramLineItemType: type = DiagramBinaryLineItem; writeLineItem(recordStream, static_cast<DrawingLineItem*>(*itemIter)); break;
+		case DiagramArcItemType: type = DiagramBinaryArcItem; writeArcItem(recordStream, static_cast<DrawingArcItem*>(*itemIter)); break;
+		case DiagramPolylineItemType: type = DiagramBinaryPolylineItem; writePolylineItem(recordStream, static_cast<DrawingPolylineItem*>(*itemIter)); break;
+		case DiagramCurveItemType: type = DiagramBinaryCurveItem; writeCurveItem(recordStream, static_cast<DrawingCurveItem*>(*itemIter)); break;
+		case DiagramRectItemType: type = DiagramBinaryRectItem; writeRectItem(recordStream, static_cast<DrawingRectItem*>(*itemIter)); break;
+		case DiagramEllipseItemType: type = DiagramBinaryEllipseItem; writeEllipseItem(recordStream, static_cast<DrawingEllipseItem*>(*itemIter)); break;
+		case DiagramPolygonItemType: type = DiagramBinaryPolygonItem; writePolygonItem(recordStream, static_cast<DrawingPolygonItem*>(*itemIter)); break;
+		case DiagramTextItemType: type = DiagramBinaryTextItem; writeTextItem(recordStream, static_cast<DrawingTextItem*>(*itemIter)); break;
+		case DiagramTextRectItemType: type = DiagramBinaryTextRectItem; writeTextRectItem(recordStream, static_cast<DrawingTextRectItem*>(*itemIter)); break;
+		case DiagramTextEllipseItemType: type = DiagramBinaryTextEllipseItem; writeTextEllipseItem(recordStream, static_cast<DrawingTextEllipseItem*>(*itemIter)); break;
+		case DiagramTextPolygonItemType: type = DiagramBinaryTextPolygonItem; writeTextPolygonItem(recordStream, static_cast<DrawingTextPolygonItem*>(*itemIter)); break;
+		case DiagramPathItemType: type = DiagramBinaryPathItem; writePathItem(recordStream, static_cast<DrawingPathItem*>(*itemIter)); break;
+		case DiagramItemGroupType: type = DiagramBinaryItemGroup; writeItemGroup(recordStream, static_cast<DrawingItemGroup*>(*itemIter)); break;
+		default: type = DiagramBinaryUnknownItem; break;
+		}
+
+		stream << type << record;
+	}
+}
+
+//==================================================================================================
+
+void DiagramBinaryWriter::writeLineItem(QDataStream& stream, DrawingLineItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->line();
+}
+
+void DiagramBinaryWriter::writeArcItem(QDataStream& stream, DrawingArcItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->arc();
+}
+
+void DiagramBinaryWriter::writePolylineItem(QDataStream& stream, DrawingPolylineItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << itemPointPositions(item);
+}
+
+void DiagramBinaryWriter::writeCurveItem(QDataStream& stream, DrawingCurveItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->curveStartPos() << item->curveStartControlPos();
+	stream << item->curveEndControlPos() << item->curveEndPos();
+}
+
+void DiagramBinaryWriter::writeRectItem(QDataStream& stream, DrawingRectItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->rect() << item->cornerRadiusX() << item->cornerRadiusY();
+}
+
+void DiagramBinaryWriter::writeEllipseItem(QDataStream& stream, DrawingEllipseItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->ellipse();
+}
+
+void DiagramBinaryWriter::writePolygonItem(QDataStream& stream, DrawingPolygonItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << itemPointPositions(item);
+}
+
+void DiagramBinaryWriter::writeTextItem(QDataStream& stream, DrawingTextItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->caption();
+}
+
+void DiagramBinaryWriter::writeTextRectItem(QDataStream& stream, DrawingTextRectItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->rect() << item->cornerRadiusX() << item->cornerRadiusY();
+	stream << item->caption();
+}
+
+void DiagramBinaryWriter::writeTextEllipseItem(QDataStream& stream, DrawingTextEllipseItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->ellipse();
+	stream << item->caption();
+}
+
+void DiagramBinaryWriter::writeTextPolygonItem(QDataStream& stream, DrawingTextPolygonItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << itemPointPositions(item);
+	stream << item->caption();
+}
+
+void DiagramBinaryWriter::writePathItem(QDataStream& stream, DrawingPathItem* item)
+{
+	writeItemHeader(stream, item);
+	stream << item->name() << item->rect();
+	stream << item->pathRect() << item->path();
+	stream << item->connectionPoints();
+}
+
+void DiagramBinaryWriter::writeItemGroup(QDataStream& stream, DrawingItemGroup* item)
+{
+	writeItemHeader(stream, item);
+	writeItemRecords(stream, item->items());
+}
+
+//==================================================================================================
+
+void DiagramBinaryWriter::writeItemHeader(QDataStream& stream, DrawingItem* item)
+{
+	stream << styleIndex(item->style());
+	stream << item->position() << item->transform();
+}
+
+quint32 DiagramBinaryWriter::styleIndex(DrawingItemStyle* style)
+{
+	QByteArray styleRecord;
+	quint32 index = 0;
+
+	QDataStream styleStream(&styleRecord, QIODevice::WriteOnly);
+	prepareStream(styleStream);
+
+	for(int i = 0; style && i < DrawingItemStyle::NumberOfProperties; i++)
+	{
+		if (style->hasValue((DrawingItemStyle::Property)i))
+			styleStream << (quint8)i << style->value((DrawingItemStyle::Property)i);
+	}
+
+	// Items with identical styles share a single entry in the style dictionary
+	auto indexIter = mStyleIndices.constFind(styleRecord);
+	if (indexIter != mStyleIndices.constEnd()) index = indexIter.value();
+	else
+	{
+		index = mStyles.size();
+		mStyles.append(styleRecord);
+		mStyleIndices.insert(styleRecord, index);
+	}
+
+	return index;
+}
+
+//==================================================================================================
+
+QPolygonF DiagramBinaryWriter::itemPointPositions(DrawingItem* item) const
+{
+	QPolygonF polygon;
+
+	QList<DrawingItemPoint*> points = item->points();
+	for(auto pointIter = points.begin(); pointIter != points.end(); pointIter++)
+		polygon.append((*pointIter)->position());
+
+	return polygon;
+}
+
+void DiagramBinaryWriter::prepareStream(QDataStream& stream) const
+{
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
@@ -0,0 +1,71 @@
+/* DiagramBinaryWriter.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMBINARYWRITER_H
+#define DIAGRAMBINARYWRITER_H
+
+#include <DiagramWidget.h>
+
+const quint32 DiagramBinaryMagic = 0x4A444D42;
+const quint16 DiagramBinaryVersion = 1;
+
+enum DiagramBinaryItemType { DiagramBinaryUnknownItem, DiagramBinaryLineItem, DiagramBinaryArcItem,
+	DiagramBinaryPolylineItem, DiagramBinaryCurveItem, DiagramBinaryRectItem, DiagramBinaryEllipseItem,
+	DiagramBinaryPolygonItem, DiagramBinaryTextItem, DiagramBinaryTextRectItem, DiagramBinaryTextEllipseItem,
+	DiagramBinaryTextPolygonItem, DiagramBinaryPathItem, DiagramBinaryItemGroup };
+
+class DiagramBinaryWriter : public QDataStream
+{
+private:
+	QList<QByteArray> mStyles;
+	QHash<QByteArray,quint32> mStyleIndices;
+
+public:
+	DiagramBinaryWriter(QIODevice* device);
+	~DiagramBinaryWriter();
+
+	void write(DiagramWidget* diagram);
+
+private:
+	void writePageRecord(QDataStream& stream, DiagramWidget* diagram);
+	void writeItemRecords(QDataStream& stream, const QList<DrawingItem*>& items);
+
+	void writeLineItem(QDataStream& stream, DrawingLineItem* item);
+	void writeArcItem(QDataStream& stream, DrawingArcItem* item);
+	void writePolylineItem(QDataStream& stream, DrawingPolylineItem* item);
+	void writeCurveItem(QDataStream& stream, DrawingCurveItem* item);
+	void writeRectItem(QDataStream& stream, DrawingRectItem* item);
+	void writeEllipseItem(QDataStream& stream, DrawingEllipseItem* item);
+	void writePolygonItem(QDataStream& stream, DrawingPolygonItem* item);
+	void writeTextItem(QDataStream& stream, DrawingTextItem* item);
+	void writeTextRectItem(QDataStream& stream, DrawingTextRectItem* item);
+	void writeTextEllipseItem(QDataStream& stream, DrawingTextEllipseItem* item);
+	void writeTextPolygonItem(QDataStream& stream, DrawingTextPolygonItem* item);
+	void writePathItem(QDataStream& stream, DrawingPathItem* item);
+	void writeItemGroup(QDataStream& stream, DrawingItemGroup* item);
+
+	void writeItemHeader(QDataStream& stream, DrawingItem* item);
+	quint32 styleIndex(DrawingItemStyle* style);
+
+	QPolygonF itemPointPositions(DrawingItem* item) const;
+	void prepareStream(QDataStream& stream) const;
+};
+
+#endif
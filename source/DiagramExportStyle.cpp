@@ -0,0 +1,152 @@
+/* DiagramExportStyle.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+#include "DiagramExportStyle.h"
+
+QVariant diagramStyleValue(DrawingItemStyle* style, DrawingItemStyle::Property property)
+{
+	return (style && style->hasValue(property)) ? style->value(property) : DrawingItemStyle::defaultValue(property);
+}
+
+QPolygonF diagramItemPolygon(const QList<DrawingItemPoint*>& points)
+{
+	QPolygonF polygon;
+
+	for(auto pointIter = points.begin(); pointIter != points.end(); pointIter++)
+		polygon.append((*pointIter)->position());
+
+	return polygon;
+}
+
+//==================================================================================================
+
+QVector<qreal> diagramDashPattern(Qt::PenStyle penStyle, qreal penWidth)
+{
+	// Qt dash patterns are in units of the pen width
+	QVector<qreal> pattern;
+
+	switch (penStyle)
+	{
+	case Qt::DashLine: pattern << 4 << 2; break;
+	case Qt::DotLine: pattern << 1 << 2; break;
+	case Qt::DashDotLine: pattern << 4 << 2 << 1 << 2; break;
+	case Qt::DashDotDotLine: pattern << 4 << 2 << 1 << 2 << 1 << 2; break;
+	default: break;
+	}
+
+	if (penWidth <= 0) penWidth = 1;
+
+	for(auto patternIter = pattern.begin(); patternIter != pattern.end(); patternIter++)
+		*patternIter *= penWidth;
+
+	return pattern;
+}
+
+//==================================================================================================
+
+QPainterPath diagramArrowPath(DrawingItemStyle::ArrowStyle arrowStyle, qreal size)
+{
+	QPainterPath path;
+
+	switch (arrowStyle)
+	{
+	case DrawingItemStyle::ArrowNormal:
+		path.moveTo(-size, -size / 2);
+		path.lineTo(0, 0);
+		path.lineTo(-size, size / 2);
+		break;
+	case DrawingItemStyle::ArrowReverse:
+		path.moveTo(0, -size / 2);
+		path.lineTo(-size, 0);
+		path.lineTo(0, size / 2);
+		break;
+	case DrawingItemStyle::ArrowTriangle:
+	case DrawingItemStyle::ArrowTriangleFilled:
+		path.moveTo(0, 0);
+		path.lineTo(-size, -size / 2);
+		path.lineTo(-size, size / 2);
+		path.closeSubpath();
+		break;
+	case DrawingItemStyle::ArrowConcave:
+	case DrawingItemStyle::ArrowConcaveFilled:
+		path.moveTo(0, 0);
+		path.lineTo(-size, -size / 2);
+		path.lineTo(-size * 3 / 4, 0);
+		path.lineTo(-size, size / 2);
+		path.closeSubpath();
+		break;
+	case DrawingItemStyle::ArrowHarpoon:
+		path.moveTo(0, 0);
+		path.lineTo(-size, -size / 2);
+		break;
+	case DrawingItemStyle::ArrowHarpoonMirrored:
+		path.moveTo(0, 0);
+		path.lineTo(-size, size / 2);
+		break;
+	case DrawingItemStyle::ArrowCircle:
+	case DrawingItemStyle::ArrowCircleFilled:
+		path.addEllipse(QPointF(0, 0), size / 2, size / 2);
+		break;
+	case DrawingItemStyle::ArrowDiamond:
+	case DrawingItemStyle::ArrowDiamondFilled:
+		path.moveTo(size / 2, 0);
+		path.lineTo(0, -size / 2);
+		path.lineTo(-size / 2, 0);
+		path.lineTo(0, size / 2);
+		path.closeSubpath();
+		break;
+	case DrawingItemStyle::ArrowX:
+		path.moveTo(-size / 2, -size / 2);
+		path.lineTo(size / 2, size / 2);
+		path.moveTo(-size / 2, size / 2);
+		path.lineTo(size / 2, -size / 2);
+		break;
+	default:
+		break;
+	}
+
+	return path;
+}
+
+QColor diagramArrowFillColor(DrawingItemStyle::ArrowStyle arrowStyle, const QColor& penColor,
+	const QColor& backgroundColor)
+{
+	// Hollow arrows are filled with the background so that the line does not show through
+	QColor fillColor;
+
+	switch (arrowStyle)
+	{
+	case DrawingItemStyle::ArrowTriangleFilled:
+	case DrawingItemStyle::ArrowConcaveFilled:
+	case DrawingItemStyle::ArrowCircleFilled:
+	case DrawingItemStyle::ArrowDiamondFilled:
+		fillColor = penColor;
+		break;
+	case DrawingItemStyle::ArrowTriangle:
+	case DrawingItemStyle::ArrowConcave:
+	case DrawingItemStyle::ArrowCircle:
+	case DrawingItemStyle::ArrowDiamond:
+		fillColor = (backgroundColor.alpha() > 0) ? backgroundColor : QColor(Qt::white);
+		break;
+	default:
+		break;
+	}
+
+	return fillColor;
+}
@@ -0,0 +1,40 @@
+/* DiagramExportStyle.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+#ifndef DIAGRAMEXPORTSTYLE_H
+#define DIAGRAMEXPORTSTYLE_H
+
+#include <Drawing.h>
+
+// Style and geometry rules shared by the writers that translate the item model into another
+// format, so that their output matches what DrawingView draws.
+
+QVariant diagramStyleValue(DrawingItemStyle* style, DrawingItemStyle::Property property);
+QPolygonF diagramItemPolygon(const QList<DrawingItemPoint*>& points);
+
+// Dash pattern of a Qt pen style in scene units; empty for solid and custom lines.
+QVector<qreal> diagramDashPattern(Qt::PenStyle penStyle, qreal penWidth);
+
+// Arrow outline with its tip at the origin pointing along +x.  The fill color is invalid for
+// arrows that are only stroked.
+QPainterPath diagramArrowPath(DrawingItemStyle::ArrowStyle arrowStyle, qreal size);
+QColor diagramArrowFillColor(DrawingItemStyle::ArrowStyle arrowStyle, const QColor& penColor,
+	const QColor& backgroundColor);
+
+#endif
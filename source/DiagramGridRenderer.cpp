@@ -0,0 +1,256 @@
+/* DiagramGridRenderer.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramGridRenderer.h"
+
+// Grid spacings closer than this on screen (in logical pixels) are thinned out
+static const qreal DiagramGridMinimumPitch = 6;
+
+// Largest number of grid periods combined into one pattern to reach a whole number of pixels
+static const int DiagramGridMaximumPatternPeriods = 16;
+
+// Patterns smaller than this (in device pixels) are repeated to make the fill more efficient
+static const int DiagramGridMinimumPatternSize = 64;
+
+DiagramGridRenderer::DiagramGridRenderer(DiagramWidget* widget)
+{
+	mWidget = widget;
+
+	mPatternUsable = false;
+	mPatternScale = 0;
+	mPatternDevicePixelRatio = 1.0;
+	mPatternGridStyle = DiagramWidget::GridNone;
+	mPatternGrid = 0;
+	mPatternGridSpacingMajor = 0;
+	mPatternGridSpacingMinor = 0;
+}
+
+DiagramGridRenderer::~DiagramGridRenderer() { }
+
+//==================================================================================================
+
+void DiagramGridRenderer::draw(QPainter* painter, const QRectF& visibleRect)
+{
+	drawBackground(painter, visibleRect);
+
+	if (painter->device() != mWidget->viewport() || painter->transform().type() > QTransform::TxScale ||
+		!drawGridPattern(painter))
+	{
+		drawGrid(painter, visibleRect, painter->transform().m11());
+	}
+}
+
+//==================================================================================================
+
+bool DiagramGridRenderer::drawGridPattern(QPainter* painter)
+{
+	QTransform deviceTransform = painter->deviceTransform();
+	qreal devicePixelRatio = mWidget->devicePixelRatio();
+
+	if (deviceTransform.m11() != deviceTransform.m22()) return false;
+
+	// The pattern is anchored to the scene origin, split into a whole device pixel offset for the
+	// brush and a sub-pixel phase that is rendered into the pattern itself
+	QPointF origin(qFloor(deviceTransform.dx()), qFloor(deviceTransform.dy()));
+	QPointF phase(deviceTransform.dx() - origin.x(), deviceTransform.dy() - origin.y());
+
+	if (!isPatternValid(deviceTransform.m11(), phase, devicePixelRatio))
+		updatePattern(deviceTransform.m11(), phase, devicePixelRatio);
+
+	if (mPatternUsable && mPattern.style() == Qt::TexturePattern)
+	{
+		QBrush brush = mPattern;
+		brush.setTransform(QTransform::fromTranslate(origin.x(), origin.y()));
+
+		painter->save();
+		painter->setTransform(QTransform::fromScale(1 / devicePixelRatio, 1 / devicePixelRatio));
+		painter->fillRect(QRect(QPoint(0, 0), mWidget->viewport()->size() * devicePixelRatio), brush);
+		painter->restore();
+	}
+
+	return mPatternUsable;
+}
+
+bool DiagramGridRenderer::isPatternValid(qreal scale, const QPointF& phase, qreal devicePixelRatio) const
+{
+	return (scale == mPatternScale && devicePixelRatio == mPatternDevicePixelRatio &&
+		qAbs(phase.x() - mPatternPhase.x()) < 1E-3 && qAbs(phase.y() - mPatternPhase.y()) < 1E-3 &&
+		mWidget->gridBrush() == mPatternGridBrush && mWidget->gridStyle() == mPatternGridStyle &&
+		mWidget->grid() == mPatternGrid && mWidget->gridSpacingMajor() == mPatternGridSpacingMajor &&
+		mWidget->gridSpacingMinor() == mPatternGridSpacingMinor);
+}
+
+void DiagramGridRenderer::updatePattern(qreal scale, const QPointF& phase, qreal devicePixelRatio)
+{
+	mPatternScale = scale;
+	mPatternPhase = phase;
+	mPatternDevicePixelRatio = devicePixelRatio;
+	mPatternGridBrush = mWidget->gridBrush();
+	mPatternGridStyle = mWidget->gridStyle();
+	mPatternGrid = mWidget->grid();
+	mPatternGridSpacingMajor = mWidget->gridSpacingMajor();
+	mPatternGridSpacingMinor = mWidget->gridSpacingMinor();
+
+	mPattern = QBrush();
+	mPatternUsable = true;
+
+	if (mPatternGridStyle == DiagramWidget::GridNone || mPatternGrid <= 0 || scale <= 0) return;
+
+	// Find the period of everything drawGrid would draw at this zoom level
+	qreal minimumSpacing = DiagramGridMinimumPitch / (scale / devicePixelRatio);
+	qreal period = 0;
+
+	if (mPatternGridSpacingMajor > 0) period = thinnedSpacing(mPatternGrid * mPatternGridSpacingMajor, minimumSpacing);
+
+	if (mPatternGridStyle == DiagramWidget::GridGraphPaper && mPatternGridSpacingMinor > 0)
+	{
+		qreal minorSpacing = thinnedSpacing(mPatternGrid * mPatternGridSpacingMinor, minimumSpacing);
+
+		if (period <= 0) period = minorSpacing;
+		else if (minorSpacing < period && qAbs(period / minorSpacing - qRound(period / minorSpacing)) > 1E-6)
+			mPatternUsable = false;
+	}
+
+	if (!mPatternUsable || period <= 0) return;
+
+	// The pattern has to cover a whole number of device pixels or it would drift across the view
+	qreal devicePeriod = period * scale;
+	int patternSize = 0;
+
+	for(int periods = 1; periods <= DiagramGridMaximumPatternPeriods && patternSize == 0; periods++)
+	{
+		if (qAbs(periods * devicePeriod - qRound(periods * devicePeriod)) < 0.01)
+			patternSize = qRound(periods * devicePeriod);
+	}
+
+	mPatternUsable = (patternSize > 0 && patternSize <= 1024);
+	if (!mPatternUsable) return;
+
+	// Repeat small patterns, and make the size a multiple of the dotted minor line's dash period
+	int dashPeriod = qMax(1, qRound(2 * devicePixelRatio)), repeats = 1;
+	while (patternSize * repeats < DiagramGridMinimumPatternSize || (patternSize * repeats) % dashPeriod != 0)
+		repeats++;
+	patternSize *= repeats;
+
+	QPixmap pattern(patternSize, patternSize);
+	pattern.setDevicePixelRatio(devicePixelRatio);
+	pattern.fill(Qt::transparent);
+
+	QTransform patternTransform = QTransform::fromScale(scale, scale) *
+		QTransform::fromTranslate(phase.x(), phase.y()) *
+		QTransform::fromScale(1 / devicePixelRatio, 1 / devicePixelRatio);
+
+	// Lines are drawn one period past the edges so that they are complete where the pattern wraps
+	QRectF sceneRect = patternTransform.inverted().mapRect(QRectF(QPointF(0, 0), QSizeF(pattern.size()) / devicePixelRatio));
+	sceneRect.adjust(-period, -period, period, period);
+
+	QPainter patternPainter(&pattern);
+	patternPainter.setTransform(patternTransform);
+	drawGrid(&patternPainter, sceneRect, scale / devicePixelRatio);
+	patternPainter.end();
+
+	// The brush is used in device pixels, so the texture itself must not be scaled again
+	pattern.setDevicePixelRatio(1.0);
+	mPattern = QBrush(pattern);
+}
+
+//==================================================================================================
+
+void DiagramGridRenderer::drawBackground(QPainter* painter, const QRectF& rect)
+{
+	painter->setBrush(mWidget->scene()->backgroundBrush());
+	painter->setPen(Qt::NoPen);
+	painter->drawRect(rect);
+}
+
+void DiagramGridRenderer::drawGrid(QPainter* painter, const QRectF& rect, qreal scale)
+{
+	DiagramWidget::GridRenderStyle gridStyle = mWidget->gridStyle();
+	qreal grid = mWidget->grid();
+	int spacingMajor = mWidget->gridSpacingMajor();
+	int spacingMinor = mWidget->gridSpacingMinor();
+
+	if (gridStyle != DiagramWidget::GridNone && grid > 0 && scale > 0)
+	{
+		qreal minimumSpacing = DiagramGridMinimumPitch / scale;
+
+		QPen gridPen(mWidget->gridBrush(), mWidget->devicePixelRatio());
+		gridPen.setCosmetic(true);
+
+		if (gridStyle == DiagramWidget::GridDots && spacingMajor > 0)
+		{
+			qreal spacing = thinnedSpacing(grid * spacingMajor, minimumSpacing);
+			static thread_local QVector<QPointF> points;
+
+			points.resize(0);
+			for(qreal y = qCeil(rect.top() / spacing) * spacing; y < rect.bottom(); y += spacing)
+			{
+				for(qreal x = qCeil(rect.left() / spacing) * spacing; x < rect.right(); x += spacing)
+					points.append(QPointF(x, y));
+			}
+
+			painter->setPen(gridPen);
+			painter->drawPoints(points.constData(), points.size());
+		}
+
+		if (gridStyle == DiagramWidget::GridGraphPaper && spacingMinor > 0)
+		{
+			// Minor lines thinned out to the major spacing would only duplicate the major lines
+			qreal spacing = thinnedSpacing(grid * spacingMinor, minimumSpacing);
+
+			if (spacingMajor <= 0 || spacing < thinnedSpacing(grid * spacingMajor, minimumSpacing))
+			{
+				gridPen.setStyle(Qt::DotLine);
+				painter->setPen(gridPen);
+				drawGridLines(painter, rect, spacing);
+			}
+		}
+
+		if ((gridStyle == DiagramWidget::GridLines || gridStyle == DiagramWidget::GridGraphPaper) && spacingMajor > 0)
+		{
+			gridPen.setStyle(Qt::SolidLine);
+			painter->setPen(gridPen);
+			drawGridLines(painter, rect, thinnedSpacing(grid * spacingMajor, minimumSpacing));
+		}
+	}
+}
+
+void DiagramGridRenderer::drawGridLines(QPainter* painter, const QRectF& rect, qreal spacing)
+{
+	static thread_local QVector<QLineF> lines;
+
+	lines.resize(0);
+
+	for(qreal y = qCeil(rect.top() / spacing) * spacing; y < rect.bottom(); y += spacing)
+		lines.append(QLineF(rect.left(), y, rect.right(), y));
+	for(qreal x = qCeil(rect.left() / spacing) * spacing; x < rect.right(); x += spacing)
+		lines.append(QLineF(x, rect.top(), x, rect.bottom()));
+
+	painter->drawLines(lines.constData(), lines.size());
+}
+
+//==================================================================================================
+
+qreal DiagramGridRenderer::thinnedSpacing(qreal spacing, qreal minimumSpacing) const
+{
+	// Doubling keeps the remaining lines on the same positions while zooming out
+	while (spacing < minimumSpacing) spacing *= 2;
+	return spacing;
+}
@@ -0,0 +1,66 @@
+/* DiagramGridRenderer.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMGRIDRENDERER_H
+#define DIAGRAMGRIDRENDERER_H
+
+#include <DiagramWidget.h>
+
+// Draws the diagram background and grid.  Grid primitives are batched into a single drawPoints or
+// drawLines call per pen, and spacings that would fall below a minimum on-screen pitch are thinned
+// out.  The scratch vectors are per thread, so tiles can be drawn from worker threads.  When
+// drawing to the widget's viewport, one period of the grid is rendered into a small device-pixel
+// pattern, keyed by zoom, sub-pixel phase, style, spacing and device pixel ratio, and the view is
+// filled with it as a texture brush.  Grids whose period does not come out to a whole number of
+// device pixels within a few repeats are drawn directly.
+class DiagramGridRenderer
+{
+private:
+	DiagramWidget* mWidget;
+
+	QBrush mPattern;
+	bool mPatternUsable;
+	qreal mPatternScale;
+	QPointF mPatternPhase;
+	qreal mPatternDevicePixelRatio;
+	QBrush mPatternGridBrush;
+	DiagramWidget::GridRenderStyle mPatternGridStyle;
+	qreal mPatternGrid;
+	int mPatternGridSpacingMajor, mPatternGridSpacingMinor;
+
+public:
+	DiagramGridRenderer(DiagramWidget* widget);
+	~DiagramGridRenderer();
+
+	void draw(QPainter* painter, const QRectF& visibleRect);
+
+private:
+	bool drawGridPattern(QPainter* painter);
+	bool isPatternValid(qreal scale, const QPointF& phase, qreal devicePixelRatio) const;
+	void updatePattern(qreal scale, const QPointF& phase, qreal devicePixelRatio);
+
+	void drawBackground(QPainter* painter, const QRectF& rect);
+	void drawGrid(QPainter* painter, const QRectF& rect, qreal scale);
+	void drawGridLines(QPainter* painter, const QRectF& rect, qreal spacing);
+
+	qreal thinnedSpacing(qreal spacing, qreal minimumSpacing) const;
+};
+
+#endif
@@ -0,0 +1,191 @@
+/* DiagramImageRenderer.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramImageRenderer.h"
+#include "DiagramItemPlacement.h"
+#include "DiagramPngWriter.h"
+#include <QtConcurrent>
+
+DiagramImageRenderer::DiagramImageRenderer(DiagramWidget* widget, const QSize& size, const QRectF& sceneRect, int tileSize)
+{
+	mSize = size;
+	mSceneRect = sceneRect;
+	mTileSize = tileSize;
+
+	// The workers only replay these recordings and never read the scene, so it is free to change
+	// once the renderer has been created
+	widget->loadAllItems();
+
+	DrawingScene* scene = widget->scene();
+	QList<DrawingItem*> items = (scene) ? scene->items() : QList<DrawingItem*>();
+
+	if (scene)
+	{
+		mBackgroundBrush = scene->backgroundBrush();
+		mBackgroundRect = scene->sceneRect();
+	}
+
+	mItems.reserve(items.size());
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		if ((*itemIter)->isVisible())
+		{
+			ItemEntry entry;
+
+			QPainter picturePainter(&entry.picture);
+			renderDiagramItem(&picturePainter, *itemIter);
+			picturePainter.end();
+
+			// The recorded extent includes pens; the item's own rect guards against rounding in it
+			entry.rect = (*itemIter)->mapToScene((*itemIter)->boundingRect()).boundingRect();
+			entry.rect = entry.rect.united(QRectF(entry.picture.boundingRect()).adjusted(-1, -1, 1, 1));
+			mItems.append(entry);
+		}
+	}
+}
+
+DiagramImageRenderer::~DiagramImageRenderer() { }
+
+//==================================================================================================
+
+QSize DiagramImageRenderer::size() const
+{
+	return mSize;
+}
+
+//==================================================================================================
+
+QImage DiagramImageRenderer::render(const QRect& rect)
+{
+	QImage image(rect.size(), QImage::Format_ARGB32);
+	QList<QRect> tileRects;
+	QList< QFuture<QImage> > jobs;
+	QList<QRect> jobRects;
+	int maximumJobs = 2 * qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+
+	for(int y = rect.top(); y <= rect.bottom(); y += mTileSize)
+	{
+		for(int x = rect.left(); x <= rect.right(); x += mTileSize)
+			tileRects.append(QRect(x, y, qMin(mTileSize, rect.right() + 1 - x), qMin(mTileSize, rect.bottom() + 1 - y)));
+	}
+
+	// Only a bounded number of tiles are in flight so that memory stays close to the final image
+	for(auto tileIter = tileRects.begin(); tileIter != tileRects.end() || !jobs.isEmpty(); )
+	{
+		if (tileIter != tileRects.end() && jobs.size() < maximumJobs)
+		{
+			jobs.append(QtConcurrent::run(this, &DiagramImageRenderer::renderTile, *tileIter));
+			jobRects.append(*tileIter);
+			tileIter++;
+		}
+		else
+		{
+			QImage tile = jobs.takeFirst().result();
+			QRect tileRect = jobRects.takeFirst().translated(-rect.topLeft());
+
+			for(int y = 0; y < tile.height(); y++)
+			{
+				memcpy(image.scanLine(tileRect.top() + y) + tileRect.left() * sizeof(QRgb),
+					tile.constScanLine(y), tile.width() * sizeof(QRgb));
+			}
+		}
+	}
+
+	return image;
+}
+
+bool DiagramImageRenderer::writePng(DiagramPngWriter* writer, int stripHeight)
+{
+	// The image is rendered and encoded in strips, so memory use depends on the width of the
+	// image but not its height
+	bool ok = writer->begin(mSize);
+
+	mRowsRendered.store(0);
+
+	for(int y = 0; ok && y < mSize.height() && !mCancelled.load(); y += stripHeight)
+	{
+		ok = writer->writeRows(render(QRect(0, y, mSize.width(), qMin(stripHeight, mSize.height() - y))));
+		mRowsRendered.store(qMin(y + stripHeight, mSize.height()));
+	}
+
+	return (ok && !mCancelled.load() && writer->finish());
+}
+
+int DiagramImageRenderer::rowsRendered() const
+{
+	return mRowsRendered.load();
+}
+
+void DiagramImageRenderer::cancel()
+{
+	mCancelled.store(1);
+}
+
+bool DiagramImageRenderer::isCancelled() const
+{
+	return (mCancelled.load() != 0);
+}
+
+//==================================================================================================
+
+QImage DiagramImageRenderer::renderTile(const QRect& rect) const
+{
+	QImage image(rect.size(), QImage::Format_ARGB32);
+	image.fill(Qt::transparent);
+
+	// The tile's offset is applied to the image transform's translation only, so the scaling of
+	// every coordinate is the same as for the whole image
+	QTransform transform = imageTransform();
+	QPainter painter(&image);
+	painter.setTransform(QTransform(transform.m11(), transform.m12(), transform.m21(), transform.m22(),
+		transform.dx() - rect.left(), transform.dy() - rect.top()));
+	painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
+
+	// Items just outside the tile can still touch its edge pixels through antialiasing
+	QRectF exposedRect = transform.inverted().mapRect(QRectF(rect.adjusted(-2, -2, 2, 2)));
+
+	draw(&painter, exposedRect);
+	painter.end();
+
+	return image;
+}
+
+void DiagramImageRenderer::draw(QPainter* painter, const QRectF& exposedRect) const
+{
+	// Draws the recorded scene in scene coordinates, limited to the items that overlap exposedRect
+	// if it is given; the same for every tile and for a painter covering the whole image
+	painter->setBrush(mBackgroundBrush);
+	painter->setPen(Qt::NoPen);
+	painter->drawRect(mBackgroundRect);
+
+	for(auto itemIter = mItems.begin(); itemIter != mItems.end(); itemIter++)
+	{
+		if (exposedRect.isNull() || itemIter->rect.intersects(exposedRect))
+			painter->drawPicture(QPointF(0, 0), itemIter->picture);
+	}
+}
+
+QTransform DiagramImageRenderer::imageTransform() const
+{
+	QTransform transform;
+	transform.scale(mSize.width() / mSceneRect.width(), mSize.height() / mSceneRect.height());
+	transform.translate(-mSceneRect.left(), -mSceneRect.top());
+	return transform;
+}
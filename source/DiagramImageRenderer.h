@@ -0,0 +1,75 @@
+/* DiagramImageRenderer.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMIMAGERENDERER_H
+#define DIAGRAMIMAGERENDERER_H
+
+#include <DiagramWidget.h>
+
+class DiagramPngWriter;
+
+// Renders a region of the scene to a raster image for export.  Every visible item is recorded into
+// a picture on the GUI thread when the renderer is created, so the diagram may be edited, loaded
+// or unloaded while it runs.  The image is split into tiles that are drawn on the global thread
+// pool, each with only the pictures that overlap it, and copied into place.  Each tile's painter
+// uses imageTransform() shifted by whole pixels, so the pixels are the same as those of one painter
+// drawing the whole image with draw() and imageTransform().  writePng()
+// may run on a worker thread while the GUI thread shows its progress and cancels it.
+class DiagramImageRenderer
+{
+private:
+	struct ItemEntry
+	{
+		QPicture picture;
+		QRectF rect;
+	};
+
+	QSize mSize;
+	QRectF mSceneRect;
+	int mTileSize;
+
+	QBrush mBackgroundBrush;
+	QRectF mBackgroundRect;
+	QVector<ItemEntry> mItems;
+
+	QAtomicInt mRowsRendered;
+	QAtomicInt mCancelled;
+
+public:
+	DiagramImageRenderer(DiagramWidget* widget, const QSize& size, const QRectF& sceneRect, int tileSize = 1024);
+	~DiagramImageRenderer();
+
+	QSize size() const;
+
+	QImage render(const QRect& rect);
+	void draw(QPainter* painter, const QRectF& exposedRect = QRectF()) const;
+	QTransform imageTransform() const;
+
+	bool writePng(DiagramPngWriter* writer, int stripHeight = 1024);
+
+	int rowsRendered() const;
+	void cancel();
+	bool isCancelled() const;
+
+private:
+	QImage renderTile(const QRect& rect) const;
+};
+
+#endif
@@ -0,0 +1,782 @@
+/* DiagramItemIndex.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramItemIndex.h"
+#include "DiagramReader.h"
+#include <cctype>
+
+DiagramItemIndex::DiagramItemIndex()
+{
+	mData = nullptr;
+	mSize = 0;
+	mNumberOfUnloadedItems = 0;
+	mSceneIndicesValid = false;
+	mUseStamp = 0;
+	mQueryStamp = 0;
+	mCellSize = 1;
+	mGridColumns = 0;
+	mGridRows = 0;
+}
+
+DiagramItemIndex::~DiagramItemIndex()
+{
+	close();
+}
+
+//==================================================================================================
+
+bool DiagramItemIndex::open(const QString& filePath)
+{
+	bool fileOpened = false;
+
+	close();
+
+	mFile.setFileName(filePath);
+	if (mFile.open(QIODevice::ReadOnly))
+	{
+		mSize = mFile.size();
+		mData = (const char*)mFile.map(0, mSize);
+
+		fileOpened = (mData && indexItems());
+		if (!fileOpened) close();
+	}
+
+	return fileOpened;
+}
+
+void DiagramItemIndex::close()
+{
+	if (mData) mFile.unmap((uchar*)mData);
+	mFile.close();
+
+	mData = nullptr;
+	mSize = 0;
+	mPageData.clear();
+	mEntries.clear();
+	mNumberOfUnloadedItems = 0;
+
+	mItemEntries.clear();
+	mSceneIndicesValid = false;
+	mGridRect = QRectF();
+	mGridColumns = 0;
+	mGridRows = 0;
+	mGrid.clear();
+	mLargeEntries.clear();
+}
+
+//==================================================================================================
+
+void DiagramItemIndex::readPage(DiagramWidget* diagram)
+{
+	DiagramReader reader(QString::fromUtf8(mPageData));
+	reader.read(diagram);
+}
+
+//==================================================================================================
+
+int DiagramItemIndex::numberOfUnloadedItems() const
+{
+	return mNumberOfUnloadedItems;
+}
+
+QList<DrawingItem*> DiagramItemIndex::loadItems(DrawingScene* scene, const QRectF& rect)
+{
+	QVector<int> entryIndices;
+	QVector<int> visibleEntries = findEntries(rect);
+
+	// Entries in the rect count as used whether or not they still have to be loaded
+	mUseStamp++;
+	for(auto indexIter = visibleEntries.begin(); indexIter != visibleEntries.end(); indexIter++)
+	{
+		Entry& entry = mEntries[*indexIter];
+
+		entry.lastUsed = mUseStamp;
+		if (!entry.loaded) entryIndices.append(*indexIter);
+	}
+
+	return loadEntries(scene, entryIndices);
+}
+
+QList<DrawingItem*> DiagramItemIndex::loadAllItems(DrawingScene* scene)
+{
+	QVector<int> entryIndices;
+
+	for(int i = 0; i < mEntries.size(); i++)
+	{
+		if (!mEntries[i].loaded) entryIndices.append(i);
+	}
+
+	return loadEntries(scene, entryIndices);
+}
+
+QList<DrawingItem*> DiagramItemIndex::unloadItems(DrawingScene* scene, const QRectF& keepRect, int maxLoadedItems)
+{
+	QList<DrawingItem*> unloadedItems;
+	int numberLoaded = mEntries.size() - mNumberOfUnloadedItems;
+
+	if (scene && numberLoaded > maxLoadedItems)
+	{
+		// Drop the least recently visible items outside keepRect until the budget is met.  Items that
+		// were ever selected or changed, or are connected to such items, stay loaded because the undo
+		// stack may refer to them.  The removed items are returned to the caller to be deleted.
+		QVector< QPair<quint32,int> > candidates;
+
+		for(int i = 0; i < mEntries.size(); i++)
+		{
+			const Entry& entry = mEntries[i];
+
+			// Lines and text anchors have rects without width or height, which QRectF::intersects()
+			// never reports as overlapping, so the edges are compared the same way as in findEntries()
+			bool visible = (entry.boundingRect.left() <= keepRect.right() && entry.boundingRect.right() >= keepRect.left() &&
+				entry.boundingRect.top() <= keepRect.bottom() && entry.boundingRect.bottom() >= keepRect.top());
+
+			if (entry.item && !visible && canUnloadEntry(entry))
+				candidates.append(qMakePair(entry.lastUsed, i));
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+
+		for(auto candidateIter = candidates.begin();
+			candidateIter != candidates.end() && numberLoaded > maxLoadedItems; candidateIter++)
+		{
+			unloadedItems.append(unloadEntry(scene, candidateIter->second));
+			numberLoaded--;
+		}
+	}
+
+	return unloadedItems;
+}
+
+void DiagramItemIndex::pinItems(const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		auto entryIter = mItemEntries.constFind(*itemIter);
+		if (entryIter != mItemEntries.constEnd()) mEntries[entryIter.value()].pinned = true;
+	}
+}
+
+//==================================================================================================
+
+bool DiagramItemIndex::indexItems()
+{
+	QList<QByteArray> elementNames;
+	QList<ElementFrame> frames;
+	DrawingItemGroup probe;
+	qint64 position = 0, tagStart, tagEnd, entryOffset = 0;
+	bool itemsFound = false, itemsClosed = false, selfClosing;
+	QByteArray name;
+	QHash<QByteArray,QByteArray> attributes;
+
+	// Walk the tags of the mapped file without decoding any text.  Everything up to the <items> tag
+	// is kept so that the page properties can be read normally; each direct child of <items> becomes
+	// an entry holding its byte range and the scene bounding rect of its geometry.
+	while (!itemsClosed && position < mSize)
+	{
+		const char* nextTag = (const char*)memchr(mData + position, '<', mSize - position);
+		if (!nextTag) break;
+		tagStart = nextTag - mData;
+
+		if (startsWith(tagStart, "<!--")) position = skipPast(tagStart, "-->");
+		else if (startsWith(tagStart, "<![CDATA[")) position = skipPast(tagStart, "]]>");
+		else if (startsWith(tagStart, "<?") || startsWith(tagStart, "<!")) position = skipPast(tagStart, ">");
+		else if (startsWith(tagStart, "</"))
+		{
+			position = skipPast(tagStart, ">");
+
+			if (!itemsFound)
+			{
+				if (!elementNames.isEmpty()) elementNames.removeLast();
+			}
+			else if (frames.isEmpty()) itemsClosed = true;
+			else
+			{
+				ElementFrame frame = frames.takeLast();
+				if (isItemElement(frame.name)) finishElement(frames, frame, entryOffset, position, &probe);
+			}
+		}
+		else
+		{
+			tagEnd = findTagEnd(tagStart);
+			if (tagEnd < 0) return false;
+
+			selfClosing = (mData[tagEnd - 1] == '/');
+			parseStartTag(tagStart + 1, (selfClosing) ? tagEnd - 1 : tagEnd, name, attributes);
+			position = tagEnd + 1;
+
+			if (!itemsFound)
+			{
+				if (name == "items" && elementNames.size() == 2 &&
+					elementNames[0] == "jade-drawing" && elementNames[1] == "page")
+				{
+					mPageData = QByteArray(mData, position);
+					if (!selfClosing) mPageData += "</items>";
+					mPageData += "</page></jade-drawing>";
+
+					itemsFound = true;
+					itemsClosed = selfClosing;
+				}
+				else if (!selfClosing) elementNames.append(name);
+			}
+			else
+			{
+				ElementFrame frame;
+				frame.name = name;
+				frame.attributes = attributes;
+				frame.hasRect = (isItemElement(name) && name != "group");
+				if (frame.hasRect) frame.rect = itemRect(attributes);
+				frame.contentStart = position;
+
+				if (frames.isEmpty()) entryOffset = tagStart;
+
+				if (!selfClosing) frames.append(frame);
+				else if (isItemElement(name)) finishElement(frames, frame, entryOffset, position, &probe);
+			}
+		}
+	}
+
+	mNumberOfUnloadedItems = mEntries.size();
+	indexEntries();
+
+	return itemsFound;
+}
+
+void DiagramItemIndex::indexEntries()
+{
+	// Bucket the entries into a uniform grid sized for a few entries per cell.  Entries that would
+	// cover many cells are kept in a separate list that every query checks.
+	const int maxCellsPerEntry = 16;
+
+	mGrid.clear();
+	mLargeEntries.clear();
+
+	if (!mEntries.isEmpty())
+	{
+		mGridRect = mEntries.first().boundingRect;
+		for(auto entryIter = mEntries.begin(); entryIter != mEntries.end(); entryIter++)
+		{
+			mGridRect.setCoords(qMin(mGridRect.left(), entryIter->boundingRect.left()),
+				qMin(mGridRect.top(), entryIter->boundingRect.top()),
+				qMax(mGridRect.right(), entryIter->boundingRect.right()),
+				qMax(mGridRect.bottom(), entryIter->boundingRect.bottom()));
+		}
+
+		int cellsPerSide = qBound(1, (int)qSqrt(mEntries.size() / 4.0), 1024);
+		mCellSize = qMax(mGridRect.width(), mGridRect.height()) / cellsPerSide;
+		if (mCellSize <= 0) mCellSize = 1;
+
+		mGridColumns = qFloor(mGridRect.width() / mCellSize) + 1;
+		mGridRows = qFloor(mGridRect.height() / mCellSize) + 1;
+		mGrid.resize(mGridColumns * mGridRows);
+
+		for(int i = 0; i < mEntries.size(); i++)
+		{
+			QRect cells = cellRange(mEntries[i].boundingRect);
+
+			if (cells.width() * cells.height() > maxCellsPerEntry) mLargeEntries.append(i);
+			else
+			{
+				for(int row = cells.top(); row <= cells.bottom(); row++)
+				{
+					for(int column = cells.left(); column <= cells.right(); column++)
+						mGrid[row * mGridColumns + column].append(i);
+				}
+			}
+		}
+	}
+}
+
+QVector<int> DiagramItemIndex::findEntries(const QRectF& rect)
+{
+	QVector<int> entryIndices;
+
+	if (!mGrid.isEmpty())
+	{
+		QVector<int> candidates = mLargeEntries;
+
+		if (rect.left() <= mGridRect.right() && rect.right() >= mGridRect.left() &&
+			rect.top() <= mGridRect.bottom() && rect.bottom() >= mGridRect.top())
+		{
+			QRect cells = cellRange(rect);
+
+			for(int row = cells.top(); row <= cells.bottom(); row++)
+			{
+				for(int column = cells.left(); column <= cells.right(); column++)
+					candidates += mGrid[row * mGridColumns + column];
+			}
+		}
+
+		// An entry can be in several of the cells; the stamp makes sure it is only tested once
+		mQueryStamp++;
+		for(auto indexIter = candidates.begin(); indexIter != candidates.end(); indexIter++)
+		{
+			Entry& entry = mEntries[*indexIter];
+
+			if (entry.queryStamp != mQueryStamp)
+			{
+				entry.queryStamp = mQueryStamp;
+
+				if (entry.boundingRect.left() <= rect.right() && entry.boundingRect.right() >= rect.left() &&
+					entry.boundingRect.top() <= rect.bottom() && entry.boundingRect.bottom() >= rect.top())
+				{
+					entryIndices.append(*indexIter);
+				}
+			}
+		}
+
+		std::sort(entryIndices.begin(), entryIndices.end());
+	}
+
+	return entryIndices;
+}
+
+QRect DiagramItemIndex::cellRange(const QRectF& rect) const
+{
+	int left = qBound(0, qFloor((rect.left() - mGridRect.left()) / mCellSize), mGridColumns - 1);
+	int top = qBound(0, qFloor((rect.top() - mGridRect.top()) / mCellSize), mGridRows - 1);
+	int right = qBound(0, qFloor((rect.right() - mGridRect.left()) / mCellSize), mGridColumns - 1);
+	int bottom = qBound(0, qFloor((rect.bottom() - mGridRect.top()) / mCellSize), mGridRows - 1);
+
+	return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+QList<DrawingItem*> DiagramItemIndex::loadEntries(DrawingScene* scene, const QVector<int>& entryIndices)
+{
+	QList<DrawingItem*> newItems;
+
+	if (scene && !entryIndices.isEmpty())
+	{
+		QList<DrawingItem*> sceneItems = scene->items();
+		int insertIndex = 0, numberInserted = 0;
+
+		// Each loaded entry remembers where its item is in the scene.  Check the entries that the new
+		// items will be placed after and only rescan the scene if an edit has moved them.
+		if (mSceneIndicesValid)
+		{
+			const Entry* previousEntry = nullptr;
+			auto indexIter = entryIndices.begin();
+
+			for(int i = 0; i < mEntries.size() && indexIter != entryIndices.end() && mSceneIndicesValid; i++)
+			{
+				if (i == *indexIter)
+				{
+					if (previousEntry)
+					{
+						mSceneIndicesValid = (previousEntry->sceneIndex >= 0 &&
+							previousEntry->sceneIndex < sceneItems.size() &&
+							sceneItems[previousEntry->sceneIndex] == previousEntry->item);
+					}
+					indexIter++;
+				}
+				else if (mEntries[i].item && mEntries[i].sceneIndex >= 0) previousEntry = &mEntries[i];
+			}
+		}
+
+		if (!mSceneIndicesValid) updateSceneIndices(sceneItems);
+
+		// Insert each new item just above the closest preceding entry that is already in the scene so
+		// that the items keep the z-order they have in the file
+		auto indexIter = entryIndices.begin();
+		for(int i = 0; i < mEntries.size(); i++)
+		{
+			Entry& entry = mEntries[i];
+
+			if (indexIter != entryIndices.end() && i == *indexIter)
+			{
+				DiagramReader reader(QString::fromUtf8(mData + entry.offset, entry.length));
+				entry.item = reader.readItem();
+				entry.loaded = true;
+				mNumberOfUnloadedItems--;
+
+				if (entry.item)
+				{
+					scene->insertItem(insertIndex, entry.item);
+					mItemEntries.insert(entry.item, i);
+					entry.sceneIndex = insertIndex;
+					newItems.append(entry.item);
+					insertIndex++;
+					numberInserted++;
+				}
+
+				indexIter++;
+			}
+			else if (entry.item && entry.sceneIndex >= 0)
+			{
+				insertIndex = entry.sceneIndex + numberInserted + 1;
+				entry.sceneIndex += numberInserted;
+			}
+		}
+
+		// Connect the new items to each other and to the loaded items around them.  When the scene
+		// only holds items from this index the grid finds the neighbors; otherwise the scene is
+		// searched so that items added since loading are included.
+		QList<DrawingItem*> connectionItems;
+		QRectF newItemsRect;
+		int firstNewItem;
+
+		for(auto itemIter = newItems.begin(); itemIter != newItems.end(); itemIter++)
+		{
+			newItemsRect = newItemsRect.united(
+				(*itemIter)->mapToScene((*itemIter)->boundingRect()).boundingRect().adjusted(-1, -1, 1, 1));
+		}
+
+		if (sceneItems.size() + numberInserted == mItemEntries.size())
+		{
+			QVector<int> nearbyEntries = findEntries(newItemsRect);
+
+			for(auto indexIter = nearbyEntries.begin(); indexIter != nearbyEntries.end(); indexIter++)
+			{
+				if (mEntries[*indexIter].item && !std::binary_search(entryIndices.begin(), entryIndices.end(), *indexIter))
+					connectionItems.append(mEntries[*indexIter].item);
+			}
+		}
+		else
+		{
+			for(auto itemIter = sceneItems.begin(); itemIter != sceneItems.end(); itemIter++)
+			{
+				if (newItemsRect.intersects((*itemIter)->mapToScene((*itemIter)->boundingRect()).boundingRect()))
+					connectionItems.append(*itemIter);
+			}
+		}
+
+		firstNewItem = connectionItems.size();
+		connectionItems.append(newItems);
+		DiagramReader::connectItems(connectionItems, firstNewItem);
+	}
+
+	return newItems;
+}
+
+void DiagramItemIndex::updateSceneIndices(const QList<DrawingItem*>& sceneItems)
+{
+	for(auto entryIter = mEntries.begin(); entryIter != mEntries.end(); entryIter++)
+		entryIter->sceneIndex = -1;
+
+	for(int i = 0; i < sceneItems.size(); i++)
+	{
+		auto entryIter = mItemEntries.constFind(sceneItems[i]);
+		if (entryIter != mItemEntries.constEnd()) mEntries[entryIter.value()].sceneIndex = i;
+	}
+
+	mSceneIndicesValid = true;
+}
+
+bool DiagramItemIndex::canUnloadEntry(const Entry& entry) const
+{
+	bool canUnload = (entry.loaded && entry.item && !entry.pinned && !entry.item->isSelected());
+
+	if (canUnload)
+	{
+		QList<DrawingItemPoint*> itemPoints = entry.item->points();
+
+		for(auto itemPointIter = itemPoints.begin(); canUnload && itemPointIter != itemPoints.end(); itemPointIter++)
+		{
+			QList<DrawingItemPoint*> connections = (*itemPointIter)->connections();
+
+			for(auto connectionIter = connections.begin(); canUnload && connectionIter != connections.end(); connectionIter++)
+			{
+				auto entryIter = mItemEntries.constFind((*connectionIter)->item());
+				canUnload = (entryIter != mItemEntries.constEnd() && !mEntries[entryIter.value()].pinned);
+			}
+		}
+	}
+
+	return canUnload;
+}
+
+DrawingItem* DiagramItemIndex::unloadEntry(DrawingScene* scene, int entryIndex)
+{
+	Entry& entry = mEntries[entryIndex];
+	DrawingItem* item = entry.item;
+	QList<DrawingItemPoint*> itemPoints = entry.item->points();
+
+	// Disconnect the item from its neighbors; loadEntries connects it again when it is reloaded
+	for(auto itemPointIter = itemPoints.begin(); itemPointIter != itemPoints.end(); itemPointIter++)
+	{
+		QList<DrawingItemPoint*> connections = (*itemPointIter)->connections();
+
+		for(auto connectionIter = connections.begin(); connectionIter != connections.end(); connectionIter++)
+		{
+			(*connectionIter)->removeConnection(*itemPointIter);
+			(*itemPointIter)->removeConnection(*connectionIter);
+		}
+	}
+
+	scene->removeItem(entry.item);
+	mItemEntries.remove(entry.item);
+
+	entry.item = nullptr;
+	entry.loaded = false;
+	entry.sceneIndex = -1;
+	mNumberOfUnloadedItems++;
+	mSceneIndicesValid = false;
+
+	return item;
+}
+
+//==================================================================================================
+
+qint64 DiagramItemIndex::findTagEnd(qint64 position) const
+{
+	char quote = 0;
+
+	for(position++; position < mSize; position++)
+	{
+		if (quote)
+		{
+			if (mData[position] == quote) quote = 0;
+		}
+		else if (mData[position] == '"' || mData[position] == '\'') quote = mData[position];
+		else if (mData[position] == '>') return position;
+	}
+
+	return -1;
+}
+
+qint64 DiagramItemIndex::skipPast(qint64 position, const char* str) const
+{
+	int index = QByteArray::fromRawData(mData, (int)mSize).indexOf(str, (int)position);
+	return (index >= 0) ? index + qstrlen(str) : mSize;
+}
+
+bool DiagramItemIndex::startsWith(qint64 position, const char* str) const
+{
+	qint64 length = qstrlen(str);
+	return (position + length <= mSize && memcmp(mData + position, str, length) == 0);
+}
+
+void DiagramItemIndex::parseStartTag(qint64 start, qint64 end, QByteArray& name,
+	QHash<QByteArray,QByteArray>& attributes) const
+{
+	qint64 position = start, nameStart, valueStart;
+	char quote;
+
+	attributes.clear();
+
+	while (position < end && !isspace((uchar)mData[position])) position++;
+	name = QByteArray(mData + start, position - start);
+
+	while (position < end)
+	{
+		while (position < end && isspace((uchar)mData[position])) position++;
+
+		nameStart = position;
+		while (position < end && mData[position] != '=' && !isspace((uchar)mData[position])) position++;
+		QByteArray attributeName(mData + nameStart, position - nameStart);
+
+		while (position < end && mData[position] != '"' && mData[position] != '\'') position++;
+		if (position >= end) break;
+
+		quote = mData[position++];
+		valueStart = position;
+		while (position < end && mData[position] != quote) position++;
+
+		attributes.insert(attributeName, QByteArray(mData + valueStart, position - valueStart));
+		position++;
+	}
+}
+
+//==================================================================================================
+
+void DiagramItemIndex::finishElement(QList<ElementFrame>& frames, const ElementFrame& element, qint64 entryOffset,
+	qint64 endPosition, DrawingItem* probe)
+{
+	// Groups accumulate the rects of their children; an empty group still covers its own position.
+	// Other items cover their stroke, arrowheads and caption as well as their geometry.
+	QRectF rect = (element.hasRect) ? element.rect : QRectF();
+
+	if (element.name != "group")
+	{
+		qreal margin = strokeMargin(element.attributes);
+
+		rect = rect.normalized().adjusted(-margin, -margin, margin, margin);
+		if (element.name.startsWith("text"))
+			rect = rect.united(captionRect(element.attributes, element.rect, element.contentStart, endPosition));
+	}
+
+	rect = mapItemRect(element.attributes, rect, probe);
+
+	if (frames.isEmpty())
+	{
+		Entry entry;
+		entry.offset = entryOffset;
+		entry.length = endPosition - entryOffset;
+		entry.boundingRect = rect;
+		entry.loaded = false;
+		entry.pinned = false;
+		entry.item = nullptr;
+		entry.sceneIndex = -1;
+		entry.lastUsed = 0;
+		entry.queryStamp = 0;
+		mEntries.append(entry);
+	}
+	else
+	{
+		ElementFrame& parent = frames.last();
+
+		if (parent.hasRect)
+		{
+			parent.rect.setCoords(qMin(parent.rect.left(), rect.left()), qMin(parent.rect.top(), rect.top()),
+				qMax(parent.rect.right(), rect.right()), qMax(parent.rect.bottom(), rect.bottom()));
+		}
+		else parent.rect = rect;
+
+		parent.hasRect = true;
+	}
+}
+
+QRectF DiagramItemIndex::itemRect(const QHash<QByteArray,QByteArray>& attributes) const
+{
+	static const char* coordinateNames[][2] = { { "x1", "y1" }, { "x2", "y2" }, { "cx1", "cy1" }, { "cx2", "cy2" } };
+	QPolygonF points;
+
+	if (attributes.contains("points"))
+	{
+		QList<QByteArray> tokens = attributes.value("points").split(' ');
+		for(auto tokenIter = tokens.begin(); tokenIter != tokens.end(); tokenIter++)
+		{
+			QList<QByteArray> coords = tokenIter->split(',');
+			if (coords.size() == 2) points.append(QPointF(coords.first().toDouble(), coords.last().toDouble()));
+		}
+	}
+	else if (attributes.contains("left"))
+	{
+		return QRectF(attributes.value("left").toDouble(), attributes.value("top").toDouble(),
+			attributes.value("width").toDouble(), attributes.value("height").toDouble()).normalized();
+	}
+	else
+	{
+		for(int i = 0; i < 4; i++)
+		{
+			if (attributes.contains(coordinateNames[i][0]) || attributes.contains(coordinateNames[i][1]))
+			{
+				points.append(QPointF(attributes.value(coordinateNames[i][0]).toDouble(),
+					attributes.value(coordinateNames[i][1]).toDouble()));
+			}
+		}
+	}
+
+	return (points.isEmpty()) ? QRectF() : points.boundingRect();
+}
+
+QRectF DiagramItemIndex::captionRect(const QHash<QByteArray,QByteArray>& attributes, const QRectF& rect,
+	qint64 start, qint64 end) const
+{
+	// Estimates the caption's extent from its raw text without decoding it: every character is
+	// taken to be as wide as the font is high and the caption may extend to either side of its
+	// anchor, so the estimate errs on the large side
+	const qreal lineSpacing = 1.5;
+	qreal fontSize = (attributes.contains("font-size")) ? attributes.value("font-size").toDouble() :
+		DrawingItemStyle::defaultValue(DrawingItemStyle::FontSize).toReal();
+	int numberOfLines = 0, lineLength = 0, maxLineLength = 0;
+
+	// The text ends where the element's end tag starts
+	while (end > start && mData[end - 1] != '<') end--;
+	if (end > start) end--;
+
+	for(qint64 position = start; position < end; position++)
+	{
+		if (mData[position] == '\n')
+		{
+			numberOfLines++;
+			lineLength = 0;
+		}
+		else if (((uchar)mData[position] & 0xC0) != 0x80)
+		{
+			// UTF-8 continuation bytes belong to the preceding character
+			lineLength++;
+			maxLineLength = qMax(maxLineLength, lineLength);
+		}
+	}
+
+	if (maxLineLength == 0) return rect;
+
+	qreal width = maxLineLength * fontSize;
+	qreal height = (numberOfLines + 1) * fontSize * lineSpacing;
+	QPointF center = rect.center();
+
+	return QRectF(center.x() - width, center.y() - height, 2 * width, 2 * height);
+}
+
+qreal DiagramItemIndex::strokeMargin(const QHash<QByteArray,QByteArray>& attributes) const
+{
+	// Room for the pen, including miter joins, and for arrowheads drawn past the end points
+	qreal penWidth = (attributes.contains("stroke-width")) ? attributes.value("stroke-width").toDouble() :
+		DrawingItemStyle::defaultValue(DrawingItemStyle::PenWidth).toReal();
+	qreal arrowSize = 0;
+
+	if (attributes.contains("arrow-start-style"))
+		arrowSize = qMax(arrowSize, attributes.value("arrow-start-size").toDouble());
+	if (attributes.contains("arrow-end-style"))
+		arrowSize = qMax(arrowSize, attributes.value("arrow-end-size").toDouble());
+
+	return qAbs(penWidth) + qAbs(arrowSize);
+}
+
+QRectF DiagramItemIndex::mapItemRect(const QHash<QByteArray,QByteArray>& attributes, const QRectF& rect,
+	DrawingItem* probe) const
+{
+	// Apply the transform to a scratch item so that the index uses exactly the same mapping as the
+	// items that are eventually loaded
+	probe->setX(0);
+	probe->setY(0);
+	probe->setTransform(QTransform(), false);
+
+	QList<QByteArray> tokens = attributes.value("transform").simplified().split(' ');
+	for(auto tokenIter = tokens.begin(); tokenIter != tokens.end(); tokenIter++)
+	{
+		int endIndex = tokenIter->indexOf(')');
+
+		if (tokenIter->startsWith("translate("))
+		{
+			QList<QByteArray> coords = tokenIter->mid(10, endIndex - 10).split(',');
+			if (coords.size() == 2)
+			{
+				probe->setX(coords.first().toDouble());
+				probe->setY(coords.last().toDouble());
+			}
+		}
+		else if (tokenIter->startsWith("rotate("))
+		{
+			QTransform transform;
+			transform.rotate(tokenIter->mid(7, endIndex - 7).toDouble());
+			probe->setTransform(transform, true);
+		}
+		else if (tokenIter->startsWith("scale("))
+		{
+			QList<QByteArray> coords = tokenIter->mid(6, endIndex - 6).split(',');
+			if (coords.size() == 2)
+			{
+				QTransform transform;
+				transform.scale(coords.first().toDouble(), coords.last().toDouble());
+				probe->setTransform(transform, true);
+			}
+		}
+	}
+
+	return probe->mapToScene(rect).boundingRect();
+}
+
+bool DiagramItemIndex::isItemElement(const QByteArray& name) const
+{
+	return (name == "line" || name == "arc" || name == "polyline" || name == "curve" || name == "rect" ||
+		name == "ellipse" || name == "polygon" || name == "text" || name == "text-rect" ||
+		name == "text-ellipse" || name == "text-polygon" || name == "path" || name == "group");
+}
@@ -0,0 +1,111 @@
+/* DiagramItemIndex.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMITEMINDEX_H
+#define DIAGRAMITEMINDEX_H
+
+#include <DiagramWidget.h>
+
+class DiagramItemIndex
+{
+private:
+	struct Entry
+	{
+		qint64 offset;
+		qint64 length;
+		QRectF boundingRect;
+		bool loaded;
+		bool pinned;
+		DrawingItem* item;
+		int sceneIndex;
+		quint32 lastUsed;
+		quint32 queryStamp;
+	};
+
+	struct ElementFrame
+	{
+		QByteArray name;
+		QHash<QByteArray,QByteArray> attributes;
+		bool hasRect;
+		QRectF rect;
+		qint64 contentStart;
+	};
+
+	QFile mFile;
+	const char* mData;
+	qint64 mSize;
+	QByteArray mPageData;
+	QVector<Entry> mEntries;
+	int mNumberOfUnloadedItems;
+
+	QHash<DrawingItem*,int> mItemEntries;
+	bool mSceneIndicesValid;
+	quint32 mUseStamp;
+	quint32 mQueryStamp;
+
+	QRectF mGridRect;
+	qreal mCellSize;
+	int mGridColumns, mGridRows;
+	QVector< QVector<int> > mGrid;
+	QVector<int> mLargeEntries;
+
+public:
+	DiagramItemIndex();
+	~DiagramItemIndex();
+
+	bool open(const QString& filePath);
+	void close();
+
+	void readPage(DiagramWidget* diagram);
+
+	int numberOfUnloadedItems() const;
+	QList<DrawingItem*> loadItems(DrawingScene* scene, const QRectF& rect);
+	QList<DrawingItem*> loadAllItems(DrawingScene* scene);
+	QList<DrawingItem*> unloadItems(DrawingScene* scene, const QRectF& keepRect, int maxLoadedItems);
+
+	void pinItems(const QList<DrawingItem*>& items);
+
+private:
+	bool indexItems();
+	void indexEntries();
+	QVector<int> findEntries(const QRectF& rect);
+	QRect cellRange(const QRectF& rect) const;
+
+	QList<DrawingItem*> loadEntries(DrawingScene* scene, const QVector<int>& entryIndices);
+	void updateSceneIndices(const QList<DrawingItem*>& sceneItems);
+	bool canUnloadEntry(const Entry& entry) const;
+	DrawingItem* unloadEntry(DrawingScene* scene, int entryIndex);
+
+	qint64 findTagEnd(qint64 position) const;
+	qint64 skipPast(qint64 position, const char* str) const;
+	bool startsWith(qint64 position, const char* str) const;
+	void parseStartTag(qint64 start, qint64 end, QByteArray& name, QHash<QByteArray,QByteArray>& attributes) const;
+
+	void finishElement(QList<ElementFrame>& frames, const ElementFrame& element, qint64 entryOffset,
+		qint64 endPosition, DrawingItem* probe);
+	QRectF itemRect(const QHash<QByteArray,QByteArray>& attributes) const;
+	QRectF captionRect(const QHash<QByteArray,QByteArray>& attributes, const QRectF& rect, qint64 start,
+		qint64 end) const;
+	qreal strokeMargin(const QHash<QByteArray,QByteArray>& attributes) const;
+	QRectF mapItemRect(const QHash<QByteArray,QByteArray>& attributes, const QRectF& rect, DrawingItem* probe) const;
+	bool isItemElement(const QByteArray& name) const;
+};
+
+#endif
@@ -0,0 +1,34 @@
+/* DiagramItemPlacement.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMITEMPLACEMENT_H
+#define DIAGRAMITEMPLACEMENT_H
+
+#include <Drawing.h>
+
+// Maps an item's local coordinates to the scene: its transform followed by its position.  This is
+// the placement DrawingView uses, and everything else that draws items must match it exactly.
+QTransform diagramItemTransform(DrawingItem* item);
+
+// Draws an item at its place in the scene with the painter's current transform as the scene
+// transform.  The painter's state is left unchanged.
+void renderDiagramItem(QPainter* painter, DrawingItem* item);
+
+#endif
@@ -0,0 +1,80 @@
+/* DiagramItemType.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramItemType.h"
+#include <typeindex>
+#include <unordered_map>
+
+static DiagramItemType classifyItem(DrawingItem* item)
+{
+	DiagramItemType type = DiagramUnknownItemType;
+
+	if (dynamic_cast<DrawingLineItem*>(item)) type = DiagramLineItemType;
+	else if (dynamic_cast<DrawingArcItem*>(item)) type = DiagramArcItemType;
+	else if (dynamic_cast<DrawingPolylineItem*>(item)) type = DiagramPolylineItemType;
+	else if (dynamic_cast<DrawingCurveItem*>(item)) type = DiagramCurveItemType;
+	else if (dynamic_cast<DrawingRectItem*>(item)) type = DiagramRectItemType;
+	else if (dynamic_cast<DrawingEllipseItem*>(item)) type = DiagramEllipseItemType;
+	else if (dynamic_cast<DrawingPolygonItem*>(item)) type = DiagramPolygonItemType;
+	else if (dynamic_cast<DrawingTextItem*>(item)) type = DiagramTextItemType;
+	else if (dynamic_cast<DrawingTextRectItem*>(item)) type = DiagramTextRectItemType;
+	else if (dynamic_cast<DrawingTextEllipseItem*>(item)) type = DiagramTextEllipseItemType;
+	else if (dynamic_cast<DrawingTextPolygonItem*>(item)) type = DiagramTextPolygonItemType;
+	else if (dynamic_cast<DrawingPathItem*>(item)) type = DiagramPathItemType;
+	else if (dynamic_cast<DrawingItemGroup*>(item)) type = DiagramItemGroupType;
+
+	return type;
+}
+
+//==================================================================================================
+
+DiagramItemType diagramItemType(DrawingItem* item)
+{
+	// The cast ladder is only evaluated the first time each concrete class is seen on a thread;
+	// after that the type is a single hash lookup on the item's typeid
+	thread_local std::unordered_map<std::type_index,DiagramItemType> itemTypes;
+	DiagramItemType type = DiagramUnknownItemType;
+
+	if (item)
+	{
+		std::type_index typeIndex(typeid(*item));
+
+		auto typeIter = itemTypes.find(typeIndex);
+		if (typeIter != itemTypes.end()) type = typeIter->second;
+		else
+		{
+			type = classifyItem(item);
+			itemTypes.insert(std::make_pair(typeIndex, type));
+		}
+	}
+
+	return type;
+}
+
+bool diagramItemHasCaption(DiagramItemType type)
+{
+	return (type == DiagramTextItemType || type == DiagramTextRectItemType ||
+		type == DiagramTextEllipseItemType || type == DiagramTextPolygonItemType);
+}
+
+bool diagramItemHasCornerRadius(DiagramItemType type)
+{
+	return (type == DiagramRectItemType || type == DiagramTextRectItemType);
+}
@@ -0,0 +1,269 @@
+/* DiagramLevelOfDetail.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramLevelOfDetail.h"
+#include "DiagramItemPlacement.h"
+#include "DiagramItemType.h"
+
+DiagramLevelOfDetail::DiagramLevelOfDetail()
+{
+	mMinimumItemSize = 3;
+	mMinimumTextSize = 5;
+	mMinimumArrowSize = 4;
+	mMinimumSymbolSize = 16;
+}
+
+//==================================================================================================
+
+void DiagramLevelOfDetail::setMinimumItemSize(qreal size)
+{
+	mMinimumItemSize = size;
+}
+
+void DiagramLevelOfDetail::setMinimumTextSize(qreal size)
+{
+	mMinimumTextSize = size;
+}
+
+void DiagramLevelOfDetail::setMinimumArrowSize(qreal size)
+{
+	mMinimumArrowSize = size;
+}
+
+void DiagramLevelOfDetail::setMinimumSymbolSize(qreal size)
+{
+	mMinimumSymbolSize = size;
+}
+
+qreal DiagramLevelOfDetail::minimumItemSize() const
+{
+	return mMinimumItemSize;
+}
+
+qreal DiagramLevelOfDetail::minimumTextSize() const
+{
+	return mMinimumTextSize;
+}
+
+qreal DiagramLevelOfDetail::minimumArrowSize() const
+{
+	return mMinimumArrowSize;
+}
+
+qreal DiagramLevelOfDetail::minimumSymbolSize() const
+{
+	return mMinimumSymbolSize;
+}
+
+//==================================================================================================
+
+void DiagramLevelOfDetail::renderItem(QPainter* painter, DrawingItem* item, const QRectF& sceneRect, qreal scale) const
+{
+	DiagramItemType type = diagramItemType(item);
+	DrawingItemStyle* style = item->style();
+	qreal projectedSize = qMax(sceneRect.width(), sceneRect.height()) * scale;
+
+	if (projectedSize < mMinimumItemSize && type != DiagramItemGroupType)
+	{
+		// Draw at least one device pixel so that the item does not disappear entirely
+		QSizeF pixelSize(qMax(sceneRect.width(), 1 / scale), qMax(sceneRect.height(), 1 / scale));
+		QRectF pixelRect(QPointF(0, 0), pixelSize);
+		pixelRect.moveCenter(sceneRect.center());
+
+		if (type == DiagramTextItemType)
+			painter->fillRect(pixelRect, styleColor(style, DrawingItemStyle::TextColor, DrawingItemStyle::TextOpacity));
+		else
+			painter->fillRect(pixelRect, styleColor(style, DrawingItemStyle::PenColor, DrawingItemStyle::PenOpacity));
+		return;
+	}
+
+	painter->save();
+	painter->setTransform(diagramItemTransform(item), true);
+
+	switch (type)
+	{
+	case DiagramLineItemType:
+	case DiagramPolylineItemType:
+	case DiagramCurveItemType:
+		if (arrowsVisible(style, scale)) item->render(painter);
+		else
+		{
+			painter->setPen(stylePen(style));
+			painter->setBrush(Qt::NoBrush);
+
+			if (type == DiagramLineItemType)
+				painter->drawLine(static_cast<DrawingLineItem*>(item)->line());
+			else if (type == DiagramPolylineItemType)
+				painter->drawPolyline(static_cast<DrawingPolylineItem*>(item)->polyline());
+			else
+			{
+				DrawingCurveItem* curveItem = static_cast<DrawingCurveItem*>(item);
+				QPainterPath path;
+				path.moveTo(curveItem->curveStartPos());
+				path.cubicTo(curveItem->curveStartControlPos(), curveItem->curveEndControlPos(), curveItem->curveEndPos());
+				painter->drawPath(path);
+			}
+		}
+		break;
+	case DiagramTextItemType:
+		if (captionVisible(style, scale)) item->render(painter);
+		else
+		{
+			// Greek the text as a faint block in its text color
+			QColor color = styleColor(style, DrawingItemStyle::TextColor, DrawingItemStyle::TextOpacity);
+			color.setAlphaF(color.alphaF() * 0.25);
+			painter->fillRect(item->boundingRect(), color);
+		}
+		break;
+	case DiagramTextRectItemType:
+	case DiagramTextEllipseItemType:
+	case DiagramTextPolygonItemType:
+		if (captionVisible(style, scale)) item->render(painter);
+		else
+		{
+			painter->setPen(stylePen(style));
+			painter->setBrush(styleBrush(style));
+
+			if (type == DiagramTextRectItemType)
+			{
+				DrawingTextRectItem* rectItem = static_cast<DrawingTextRectItem*>(item);
+				painter->drawRoundedRect(rectItem->rect(), rectItem->cornerRadiusX(), rectItem->cornerRadiusY());
+			}
+			else if (type == DiagramTextEllipseItemType)
+				painter->drawEllipse(static_cast<DrawingTextEllipseItem*>(item)->ellipse());
+			else
+				painter->drawPolygon(static_cast<DrawingTextPolygonItem*>(item)->polygon());
+		}
+		break;
+	case DiagramPathItemType:
+		if (projectedSize >= mMinimumSymbolSize) item->render(painter);
+		else
+		{
+			painter->setPen(stylePen(style));
+			painter->setBrush(Qt::NoBrush);
+			painter->drawRect(static_cast<DrawingPathItem*>(item)->rect());
+		}
+		break;
+	default:
+		item->render(painter);
+		break;
+	}
+
+	painter->restore();
+}
+
+bool DiagramLevelOfDetail::isSymbol(DrawingItem* item, const QRectF& sceneRect, qreal scale) const
+{
+	// Path items drawn at full detail can be drawn from a DiagramSymbolCache sprite instead
+	return (diagramItemType(item) == DiagramPathItemType &&
+		qMax(sceneRect.width(), sceneRect.height()) * scale >= mMinimumSymbolSize);
+}
+
+int DiagramLevelOfDetail::detailLevel(DrawingItem* item, const QRectF& sceneRect, qreal scale) const
+{
+	// renderItem() records the same drawing at two zoom levels with the same detail level, except
+	// for the placeholders, which are sized in device pixels and are returned as -1
+	DiagramItemType type = diagramItemType(item);
+	DrawingItemStyle* style = item->style();
+	qreal projectedSize = qMax(sceneRect.width(), sceneRect.height()) * scale;
+	int level = 1;
+
+	if (projectedSize < mMinimumItemSize && type != DiagramItemGroupType) return -1;
+
+	switch (type)
+	{
+	case DiagramLineItemType:
+	case DiagramPolylineItemType:
+	case DiagramCurveItemType:
+		if (!arrowsVisible(style, scale)) level = 0;
+		break;
+	case DiagramTextItemType:
+	case DiagramTextRectItemType:
+	case DiagramTextEllipseItemType:
+	case DiagramTextPolygonItemType:
+		if (!captionVisible(style, scale)) level = 0;
+		break;
+	case DiagramPathItemType:
+		if (projectedSize < mMinimumSymbolSize) level = 0;
+		break;
+	default:
+		break;
+	}
+
+	return level;
+}
+
+//==================================================================================================
+
+bool DiagramLevelOfDetail::captionVisible(DrawingItemStyle* style, qreal scale) const
+{
+	return (styleValue(style, DrawingItemStyle::FontSize).toReal() * scale >= mMinimumTextSize);
+}
+
+bool DiagramLevelOfDetail::arrowsVisible(DrawingItemStyle* style, qreal scale) const
+{
+	bool hasArrows = false, visible = false;
+
+	if ((DrawingItemStyle::ArrowStyle)styleValue(style, DrawingItemStyle::StartArrowStyle).toUInt() != DrawingItemStyle::ArrowNone)
+	{
+		hasArrows = true;
+		visible = (visible || styleValue(style, DrawingItemStyle::StartArrowSize).toReal() * scale >= mMinimumArrowSize);
+	}
+	if ((DrawingItemStyle::ArrowStyle)styleValue(style, DrawingItemStyle::EndArrowStyle).toUInt() != DrawingItemStyle::ArrowNone)
+	{
+		hasArrows = true;
+		visible = (visible || styleValue(style, DrawingItemStyle::EndArrowSize).toReal() * scale >= mMinimumArrowSize);
+	}
+
+	return (!hasArrows || visible);
+}
+
+//==================================================================================================
+
+QVariant DiagramLevelOfDetail::styleValue(DrawingItemStyle* style, DrawingItemStyle::Property property)
+{
+	return (style->hasValue(property)) ? style->value(property) : DrawingItemStyle::defaultValue(property);
+}
+
+QColor DiagramLevelOfDetail::styleColor(DrawingItemStyle* style, DrawingItemStyle::Property colorProperty,
+	DrawingItemStyle::Property opacityProperty)
+{
+	QColor color = styleValue(style, colorProperty).value<QColor>();
+	QVariant opacity = styleValue(style, opacityProperty);
+	if (opacity.isValid()) color.setAlphaF(color.alphaF() * opacity.toReal());
+	return color;
+}
+
+QPen DiagramLevelOfDetail::stylePen(DrawingItemStyle* style)
+{
+	QPen pen(styleColor(style, DrawingItemStyle::PenColor, DrawingItemStyle::PenOpacity),
+		styleValue(style, DrawingItemStyle::PenWidth).toReal(),
+		(Qt::PenStyle)styleValue(style, DrawingItemStyle::PenStyle).toUInt(),
+		(Qt::PenCapStyle)styleValue(style, DrawingItemStyle::PenCapStyle).toUInt(),
+		(Qt::PenJoinStyle)styleValue(style, DrawingItemStyle::PenJoinStyle).toUInt());
+	return pen;
+}
+
+QBrush DiagramLevelOfDetail::styleBrush(DrawingItemStyle* style)
+{
+	QBrush brush(styleColor(style, DrawingItemStyle::BrushColor, DrawingItemStyle::BrushOpacity),
+		(Qt::BrushStyle)styleValue(style, DrawingItemStyle::BrushStyle).toUInt());
+	return brush;
+}
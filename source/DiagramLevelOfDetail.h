@@ -0,0 +1,66 @@
+/* DiagramLevelOfDetail.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMLEVELOFDETAIL_H
+#define DIAGRAMLEVELOFDETAIL_H
+
+#include <Drawing.h>
+
+// Level-of-detail policy for drawing items into the view.  All thresholds are in device pixels:
+// items smaller than the minimum item size are drawn as a filled rect, captions whose font would
+// be smaller than the minimum text size are skipped, arrowheads smaller than the minimum arrow
+// size are left off, and path symbols smaller than the minimum symbol size are drawn as their
+// outline only.  Exports do not use this class and are always drawn at full detail.
+class DiagramLevelOfDetail
+{
+private:
+	qreal mMinimumItemSize;
+	qreal mMinimumTextSize;
+	qreal mMinimumArrowSize;
+	qreal mMinimumSymbolSize;
+
+public:
+	DiagramLevelOfDetail();
+
+	void setMinimumItemSize(qreal size);
+	void setMinimumTextSize(qreal size);
+	void setMinimumArrowSize(qreal size);
+	void setMinimumSymbolSize(qreal size);
+	qreal minimumItemSize() const;
+	qreal minimumTextSize() const;
+	qreal minimumArrowSize() const;
+	qreal minimumSymbolSize() const;
+
+	void renderItem(QPainter* painter, DrawingItem* item, const QRectF& sceneRect, qreal scale) const;
+	bool isSymbol(DrawingItem* item, const QRectF& sceneRect, qreal scale) const;
+	int detailLevel(DrawingItem* item, const QRectF& sceneRect, qreal scale) const;
+
+private:
+	bool captionVisible(DrawingItemStyle* style, qreal scale) const;
+	bool arrowsVisible(DrawingItemStyle* style, qreal scale) const;
+
+	static QVariant styleValue(DrawingItemStyle* style, DrawingItemStyle::Property property);
+	static QColor styleColor(DrawingItemStyle* style, DrawingItemStyle::Property colorProperty,
+		DrawingItemStyle::Property opacityProperty);
+	static QPen stylePen(DrawingItemStyle* style);
+	static QBrush styleBrush(DrawingItemStyle* style);
+};
+
+#endif
@@ -0,0 +1,375 @@
+/* DiagramNumberFormat.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramNumberFormat.h"
+#include <QColor>
+
+static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+static double scaleByPowerOfTen(double value, int exponent)
+{
+	if (exponent >= 0)
+	{
+		while (exponent > 22) { value *= powersOfTen[22]; exponent -= 22; }
+		value *= powersOfTen[exponent];
+	}
+	else
+	{
+		while (exponent < -22) { value /= powersOfTen[22]; exponent += 22; }
+		value /= powersOfTen[-exponent];
+	}
+
+	return value;
+}
+
+static char* writeLiteral(char* ptr, const char* str)
+{
+	while (*str) *ptr++ = *str++;
+	return ptr;
+}
+
+//==================================================================================================
+
+int formatDiagramNumber(qreal value, char* buffer)
+{
+	char* ptr = buffer;
+
+	if (qIsNaN(value)) return writeLiteral(ptr, "nan") - buffer;
+
+	if (std::signbit(value))
+	{
+		*ptr++ = '-';
+		value = -value;
+	}
+
+	if (qIsInf(value)) return writeLiteral(ptr, "inf") - buffer;
+
+	if (value == 0)
+	{
+		*ptr++ = '0';
+		return ptr - buffer;
+	}
+
+	// Round to six significant digits, correcting the estimated exponent if log10 was off by one
+	int exponent = (int)qFloor(std::log10(value));
+	double scaled = scaleByPowerOfTen(value, 5 - exponent);
+
+	if (scaled < 99999.5)
+	{
+		exponent--;
+		scaled = scaleByPowerOfTen(value, 5 - exponent);
+	}
+	else if (scaled >= 999999.5)
+	{
+		exponent++;
+		scaled = scaleByPowerOfTen(value, 5 - exponent);
+	}
+
+	char digits[6];
+	int numberOfDigits = 6;
+
+	if (qAbs(scaled - qFloor(scaled) - 0.5) < 1E-6)
+	{
+		// Too close to a rounding boundary for the scaled product to be trusted; let the C library
+		// round the exact binary value instead.  Only the digits and exponent are used, so the
+		// locale's decimal separator does not matter.
+		char scratch[DiagramNumberMaxLength];
+		qsnprintf(scratch, DiagramNumberMaxLength, "%.5e", value);
+
+		char* scratchPtr = scratch;
+		int digitIndex = 0;
+		while (*scratchPtr && *scratchPtr != 'e')
+		{
+			if (*scratchPtr >= '0' && *scratchPtr <= '9' && digitIndex < 6) digits[digitIndex++] = *scratchPtr;
+			scratchPtr++;
+		}
+		exponent = (*scratchPtr == 'e') ? atoi(scratchPtr + 1) : 0;
+	}
+	else
+	{
+		qint64 mantissa = qRound64(scaled);
+		if (mantissa >= 1000000)
+		{
+			mantissa /= 10;
+			exponent++;
+		}
+
+		for(int i = 5; i >= 0; i--)
+		{
+			digits[i] = (char)('0' + mantissa % 10);
+			mantissa /= 10;
+		}
+	}
+
+	while (numberOfDigits > 1 && digits[numberOfDigits - 1] == '0') numberOfDigits--;
+
+	if (exponent < -4 || exponent >= 6)
+	{
+		*ptr++ = digits[0];
+		if (numberOfDigits > 1)
+		{
+			*ptr++ = '.';
+			for(int i = 1; i < numberOfDigits; i++) *ptr++ = digits[i];
+		}
+
+		*ptr++ = 'e';
+		*ptr++ = (exponent < 0) ? '-' : '+';
+		if (exponent < 0) exponent = -exponent;
+		if (exponent >= 100) *ptr++ = (char)('0' + exponent / 100);
+		*ptr++ = (char)('0' + (exponent / 10) % 10);
+		*ptr++ = (char)('0' + exponent % 10);
+	}
+	else if (exponent >= 0)
+	{
+		for(int i = 0; i <= exponent; i++) *ptr++ = digits[i];
+		if (numberOfDigits > exponent + 1)
+		{
+			*ptr++ = '.';
+			for(int i = exponent + 1; i < numberOfDigits; i++) *ptr++ = digits[i];
+		}
+	}
+	else
+	{
+		*ptr++ = '0';
+		*ptr++ = '.';
+		for(int i = exponent + 1; i < 0; i++) *ptr++ = '0';
+		for(int i = 0; i < numberOfDigits; i++) *ptr++ = digits[i];
+	}
+
+	return ptr - buffer;
+}
+
+void appendDiagramNumber(QString& str, qreal value)
+{
+	char buffer[DiagramNumberMaxLength];
+	int length = formatDiagramNumber(value, buffer);
+	str.append(QLatin1String(buffer, length));
+}
+
+void appendDiagramNumber(QString& str, int value)
+{
+	char buffer[DiagramNumberMaxLength];
+	int length = formatDiagramInteger(value, buffer);
+	str.append(QLatin1String(buffer, length));
+}
+
+int formatDiagramInteger(int value, char* buffer)
+{
+	char digits[DiagramNumberMaxLength];
+	int numberOfDigits = 0;
+	qint64 magnitude = qAbs((qint64)value);
+	char* ptr = buffer;
+
+	do
+	{
+		digits[numberOfDigits++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+
+	if (value < 0) *ptr++ = '-';
+	while (numberOfDigits > 0) *ptr++ = digits[--numberOfDigits];
+
+	return ptr - buffer;
+}
+
+int formatDiagramColor(const QColor& color, char* buffer)
+{
+	// Writes "#RRGGBB" with uppercase hex digits
+	static const char hexDigits[] = "0123456789ABCDEF";
+	int components[3] = { color.red(), color.green(), color.blue() };
+	char* ptr = buffer;
+
+	*ptr++ = '#';
+	for(int i = 0; i < 3; i++)
+	{
+		*ptr++ = hexDigits[(components[i] >> 4) & 0xF];
+		*ptr++ = hexDigits[components[i] & 0xF];
+	}
+
+	return ptr - buffer;
+}
+
+static bool isDigit(const QChar* position, const QChar* end)
+{
+	return (position < end && position->unicode() >= '0' && position->unicode() <= '9');
+}
+
+bool parseDiagramNumber(const QChar*& position, const QChar* end, qreal& value)
+{
+	const QChar* ptr = position;
+	bool negative = false;
+	bool hasDigits = false;
+	quint64 mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+
+	if (ptr < end && (ptr->unicode() == '+' || ptr->unicode() == '-'))
+	{
+		negative = (ptr->unicode() == '-');
+		ptr++;
+	}
+
+	for( ; isDigit(ptr, end); ptr++)
+	{
+		hasDigits = true;
+		if (significantDigits < 19)
+		{
+			mantissa = mantissa * 10 + (ptr->unicode() - '0');
+			if (mantissa > 0) significantDigits++;
+		}
+		else exponent++;
+	}
+
+	if (ptr < end && ptr->unicode() == '.')
+	{
+		ptr++;
+		for( ; isDigit(ptr, end); ptr++)
+		{
+			hasDigits = true;
+			if (significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + (ptr->unicode() - '0');
+				if (mantissa > 0) significantDigits++;
+				exponent--;
+			}
+		}
+	}
+
+	if (!hasDigits) return false;
+
+	// Only consume an exponent if it is complete, so "2e" leaves the "e" for the caller
+	if (ptr < end && (ptr->unicode() == 'e' || ptr->unicode() == 'E'))
+	{
+		const QChar* exponentPtr = ptr + 1;
+		bool negativeExponent = false;
+
+		if (exponentPtr < end && (exponentPtr->unicode() == '+' || exponentPtr->unicode() == '-'))
+		{
+			negativeExponent = (exponentPtr->unicode() == '-');
+			exponentPtr++;
+		}
+
+		if (isDigit(exponentPtr, end))
+		{
+			int explicitExponent = 0;
+			for( ; isDigit(exponentPtr, end); exponentPtr++)
+			{
+				if (explicitExponent < 10000)
+					explicitExponent = explicitExponent * 10 + (exponentPtr->unicode() - '0');
+			}
+
+			exponent += (negativeExponent) ? -explicitExponent : explicitExponent;
+			ptr = exponentPtr;
+		}
+	}
+
+	if (mantissa <= (Q_UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22)
+	{
+		// Both operands are exact doubles, so a single multiply or divide is correctly rounded
+		value = (qreal)mantissa;
+		value = (exponent >= 0) ? value * powersOfTen[exponent] : value / powersOfTen[-exponent];
+		if (negative) value = -value;
+	}
+	else value = QString::fromRawData(position, ptr - position).toDouble();
+
+	position = ptr;
+	return true;
+}
+
+//==================================================================================================
+
+DiagramNumberBuffer::DiagramNumberBuffer()
+{
+	// Reserving marks the capacity as reserved, so clearing the string never frees it
+	mString.reserve(256);
+}
+
+DiagramNumberBuffer::~DiagramNumberBuffer() { }
+
+//==================================================================================================
+
+void DiagramNumberBuffer::clear()
+{
+	// resize() keeps the allocated capacity as long as the string is not shared
+	mString.resize(0);
+}
+
+void DiagramNumberBuffer::reserve(int size)
+{
+	mString.reserve(size);
+}
+
+//==================================================================================================
+
+void DiagramNumberBuffer::append(qreal value)
+{
+	appendDiagramNumber(mString, value);
+}
+
+void DiagramNumberBuffer::append(const QPointF& point, char separator)
+{
+	append(point.x());
+	mString.append(QLatin1Char(separator));
+	append(point.y());
+}
+
+void DiagramNumberBuffer::append(const QColor& color)
+{
+	char buffer[DiagramNumberMaxLength];
+	int length = formatDiagramColor(color, buffer);
+	mString.append(QLatin1String(buffer, length));
+}
+
+void DiagramNumberBuffer::append(char character)
+{
+	mString.append(QLatin1Char(character));
+}
+
+void DiagramNumberBuffer::append(const char* str)
+{
+	mString.append(QLatin1String(str));
+}
+
+void DiagramNumberBuffer::append(const QString& str)
+{
+	mString.append(str);
+}
+
+//==================================================================================================
+
+bool DiagramNumberBuffer::isEmpty() const
+{
+	return mString.isEmpty();
+}
+
+const QString& DiagramNumberBuffer::string() const
+{
+	return mString;
+}
+
+//==================================================================================================
+
+const QString& DiagramNumberBuffer::number(qreal value)
+{
+	clear();
+	append(value);
+	return mString;
+}
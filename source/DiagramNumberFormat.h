@@ -0,0 +1,67 @@
+/* DiagramNumberFormat.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMNUMBERFORMAT_H
+#define DIAGRAMNUMBERFORMAT_H
+
+#include <QtCore>
+
+class QColor;
+
+const int DiagramNumberMaxLength = 32;
+
+// Writes value into buffer using the same notation as QString::number(value) and returns the
+// number of characters written.  Independent of the C locale and never allocates.
+int formatDiagramNumber(qreal value, char* buffer);
+int formatDiagramInteger(int value, char* buffer);
+int formatDiagramColor(const QColor& color, char* buffer);
+void appendDiagramNumber(QString& str, qreal value);
+void appendDiagramNumber(QString& str, int value);
+
+// Reads a decimal number in SVG/XML notation starting at position and advances position past it.
+// Returns false and leaves position unchanged if no number starts there.
+bool parseDiagramNumber(const QChar*& position, const QChar* end, qreal& value);
+
+class DiagramNumberBuffer
+{
+private:
+	QString mString;
+
+public:
+	DiagramNumberBuffer();
+	~DiagramNumberBuffer();
+
+	void clear();
+	void reserve(int size);
+
+	void append(qreal value);
+	void append(const QPointF& point, char separator);
+	void append(const QColor& color);
+	void append(char character);
+	void append(const char* str);
+	void append(const QString& str);
+
+	bool isEmpty() const;
+	const QString& string() const;
+
+	const QString& number(qreal value);
+};
+
+#endif
@@ -0,0 +1,128 @@
+/* DiagramOutputStream.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramOutputStream.h"
+#include "DiagramNumberFormat.h"
+
+DiagramOutputStream::DiagramOutputStream(QIODevice* device, int bufferSize)
+{
+	mDevice = device;
+	mBufferSize = bufferSize;
+	mError = false;
+
+	mBuffer.reserve(mBufferSize);
+}
+
+DiagramOutputStream::~DiagramOutputStream()
+{
+	flush();
+}
+
+//==================================================================================================
+
+DiagramOutputStream& DiagramOutputStream::operator<<(const char* str)
+{
+	write(str, (int)qstrlen(str));
+	return *this;
+}
+
+DiagramOutputStream& DiagramOutputStream::operator<<(const QString& str)
+{
+	const QChar* data = str.constData();
+	bool ascii = true;
+
+	for(int i = 0; ascii && i < str.size(); i++) ascii = (data[i].unicode() < 0x80);
+
+	if (ascii)
+	{
+		char buffer[256];
+		int length = 0;
+
+		for(int i = 0; i < str.size(); i++)
+		{
+			buffer[length++] = (char)data[i].unicode();
+			if (length == (int)sizeof(buffer))
+			{
+				write(buffer, length);
+				length = 0;
+			}
+		}
+
+		write(buffer, length);
+	}
+	else
+	{
+		QByteArray utf8 = str.toUtf8();
+		write(utf8.constData(), utf8.size());
+	}
+
+	return *this;
+}
+
+DiagramOutputStream& DiagramOutputStream::operator<<(qreal value)
+{
+	char buffer[DiagramNumberMaxLength];
+	write(buffer, formatDiagramNumber(value, buffer));
+	return *this;
+}
+
+DiagramOutputStream& DiagramOutputStream::operator<<(int value)
+{
+	char buffer[DiagramNumberMaxLength];
+	write(buffer, formatDiagramInteger(value, buffer));
+	return *this;
+}
+
+DiagramOutputStream& DiagramOutputStream::operator<<(const QColor& color)
+{
+	char buffer[DiagramNumberMaxLength];
+	write(buffer, formatDiagramColor(color, buffer));
+	return *this;
+}
+
+//==================================================================================================
+
+bool DiagramOutputStream::flush()
+{
+	if (!mBuffer.isEmpty() && !mError)
+		mError = (mDevice->write(mBuffer) != mBuffer.size());
+
+	mBuffer.resize(0);
+
+	return !mError;
+}
+
+bool DiagramOutputStream::hasError() const
+{
+	return mError;
+}
+
+//==================================================================================================
+
+void DiagramOutputStream::write(const char* data, int length)
+{
+	if (mBuffer.size() + length > mBufferSize) flush();
+
+	if (length > mBufferSize)
+	{
+		if (!mError) mError = (mDevice->write(data, length) != length);
+	}
+	else mBuffer.append(data, length);
+}
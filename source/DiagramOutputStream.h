@@ -0,0 +1,56 @@
+/* DiagramOutputStream.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMOUTPUTSTREAM_H
+#define DIAGRAMOUTPUTSTREAM_H
+
+#include <QtCore>
+
+class QColor;
+
+// Buffered UTF-8 text output for writers that emit large, mostly fixed markup.  String literals
+// and numbers are copied straight into a reusable byte buffer that is handed to the device in
+// large blocks.
+class DiagramOutputStream
+{
+private:
+	QIODevice* mDevice;
+	QByteArray mBuffer;
+	int mBufferSize;
+	bool mError;
+
+public:
+	DiagramOutputStream(QIODevice* device, int bufferSize = 65536);
+	~DiagramOutputStream();
+
+	DiagramOutputStream& operator<<(const char* str);
+	DiagramOutputStream& operator<<(const QString& str);
+	DiagramOutputStream& operator<<(qreal value);
+	DiagramOutputStream& operator<<(int value);
+	DiagramOutputStream& operator<<(const QColor& color);
+
+	bool flush();
+	bool hasError() const;
+
+private:
+	void write(const char* data, int length);
+};
+
+#endif
@@ -0,0 +1,315 @@
+/* DiagramPathScanner.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramPathScanner.h"
+#include "DiagramNumberFormat.h"
+
+DiagramPathScanner::DiagramPathScanner(const QString& str)
+{
+	mPosition = str.constData();
+	mEnd = mPosition + str.size();
+}
+
+DiagramPathScanner::DiagramPathScanner(const QStringRef& str)
+{
+	mPosition = str.constData();
+	mEnd = mPosition + str.size();
+}
+
+DiagramPathScanner::~DiagramPathScanner() { }
+
+//==================================================================================================
+
+QPainterPath DiagramPathScanner::readPath()
+{
+	QPainterPath path;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+	path.reserve(countNumbers() / 2 + 1);
+#endif
+
+	QPointF currentPoint, subpathStartPoint, lastControlPoint;
+	char command = 0, previousCommand = 0;
+	qreal values[7];
+	bool largeArc, sweep;
+	bool ok = true;
+
+	skipSeparators();
+	while (ok && mPosition < mEnd)
+	{
+		char character = mPosition->toLatin1();
+
+		if (character != 0 && strchr("MmLlHhVvCcSsQqTtAaZz", character))
+		{
+			command = character;
+			mPosition++;
+		}
+		else if (command == 0 || command == 'Z' || command == 'z') break;
+
+		bool relative = (command >= 'a');
+		QPointF origin = (relative) ? currentPoint : QPointF();
+		char absoluteCommand = (relative) ? (char)(command - 'a' + 'A') : command;
+		QPointF controlPoint1, controlPoint2, endPoint;
+
+		switch (absoluteCommand)
+		{
+		case 'M':
+			ok = readNumbers(values, 2);
+			if (ok)
+			{
+				currentPoint = origin + QPointF(values[0], values[1]);
+				subpathStartPoint = currentPoint;
+				path.moveTo(currentPoint);
+
+				// Further coordinate pairs after a moveto are implicit linetos
+				command = (relative) ? 'l' : 'L';
+			}
+			break;
+		case 'L':
+			ok = readNumbers(values, 2);
+			if (ok)
+			{
+				currentPoint = origin + QPointF(values[0], values[1]);
+				path.lineTo(currentPoint);
+			}
+			break;
+		case 'H':
+			ok = readNumbers(values, 1);
+			if (ok)
+			{
+				currentPoint.setX(origin.x() + values[0]);
+				path.lineTo(currentPoint);
+			}
+			break;
+		case 'V':
+			ok = readNumbers(values, 1);
+			if (ok)
+			{
+				currentPoint.setY(origin.y() + values[0]);
+				path.lineTo(currentPoint);
+			}
+			break;
+		case 'C':
+			ok = readNumbers(values, 6);
+			if (ok)
+			{
+				controlPoint1 = origin + QPointF(values[0], values[1]);
+				lastControlPoint = origin + QPointF(values[2], values[3]);
+				currentPoint = origin + QPointF(values[4], values[5]);
+				path.cubicTo(controlPoint1, lastControlPoint, currentPoint);
+			}
+			break;
+		case 'S':
+			ok = readNumbers(values, 4);
+			if (ok)
+			{
+				controlPoint1 = (previousCommand == 'C' || previousCommand == 'S') ?
+					2 * currentPoint - lastControlPoint : currentPoint;
+				lastControlPoint = origin + QPointF(values[0], values[1]);
+				currentPoint = origin + QPointF(values[2], values[3]);
+				path.cubicTo(controlPoint1, lastControlPoint, currentPoint);
+			}
+			break;
+		case 'Q':
+			ok = readNumbers(values, 4);
+			if (ok)
+			{
+				lastControlPoint = origin + QPointF(values[0], values[1]);
+				currentPoint = origin + QPointF(values[2], values[3]);
+				path.quadTo(lastControlPoint, currentPoint);
+			}
+			break;
+		case 'T':
+			ok = readNumbers(values, 2);
+			if (ok)
+			{
+				lastControlPoint = (previousCommand == 'Q' || previousCommand == 'T') ?
+					2 * currentPoint - lastControlPoint : currentPoint;
+				currentPoint = origin + QPointF(values[0], values[1]);
+				path.quadTo(lastControlPoint, currentPoint);
+			}
+			break;
+		case 'A':
+			ok = (readNumbers(values, 3) && readFlag(largeArc) && readFlag(sweep) && readNumbers(values + 3, 2));
+			if (ok)
+			{
+				endPoint = origin + QPointF(values[3], values[4]);
+				arcTo(path, currentPoint, values[0], values[1], values[2], largeArc, sweep, endPoint);
+				currentPoint = endPoint;
+			}
+			break;
+		case 'Z':
+			path.closeSubpath();
+			currentPoint = subpathStartPoint;
+			break;
+		default:
+			ok = false;
+			break;
+		}
+
+		previousCommand = absoluteCommand;
+		skipSeparators();
+	}
+
+	return path;
+}
+
+QPolygonF DiagramPathScanner::readPoints()
+{
+	QPolygonF points;
+	points.reserve(countNumbers() / 2);
+
+	qreal values[2];
+
+	skipSeparators();
+	while (mPosition < mEnd && readNumbers(values, 2))
+	{
+		points.append(QPointF(values[0], values[1]));
+		skipSeparators();
+	}
+
+	return points;
+}
+
+//==================================================================================================
+
+void DiagramPathScanner::skipSeparators()
+{
+	while (mPosition < mEnd && (mPosition->isSpace() || mPosition->unicode() == ','))
+		mPosition++;
+}
+
+bool DiagramPathScanner::readNumber(qreal& value)
+{
+	skipSeparators();
+	return parseDiagramNumber(mPosition, mEnd, value);
+}
+
+bool DiagramPathScanner::readNumbers(qreal* values, int count)
+{
+	bool ok = true;
+	for(int i = 0; ok && i < count; i++) ok = readNumber(values[i]);
+	return ok;
+}
+
+bool DiagramPathScanner::readFlag(bool& flag)
+{
+	// Arc flags may be packed without separators, e.g. "a5 5 0 01 10 0"
+	skipSeparators();
+
+	bool ok = (mPosition < mEnd && (mPosition->unicode() == '0' || mPosition->unicode() == '1'));
+	if (ok)
+	{
+		flag = (mPosition->unicode() == '1');
+		mPosition++;
+	}
+
+	return ok;
+}
+
+//==================================================================================================
+
+int DiagramPathScanner::countNumbers() const
+{
+	const QChar* position = mPosition;
+	int count = 0;
+	bool inNumber = false;
+
+	for( ; position < mEnd; position++)
+	{
+		ushort character = position->unicode();
+		bool numberCharacter = ((character >= '0' && character <= '9') || character == '.');
+
+		if (numberCharacter && !inNumber) count++;
+		inNumber = numberCharacter;
+	}
+
+	return count;
+}
+
+//==================================================================================================
+
+void DiagramPathScanner::arcTo(QPainterPath& path, const QPointF& startPoint, qreal radiusX, qreal radiusY,
+	qreal rotation, bool largeArc, bool sweep, const QPointF& endPoint) const
+{
+	// Endpoint to center parameterization from the SVG implementation notes, then one cubic
+	// per quarter turn
+	if (startPoint == endPoint) return;
+
+	radiusX = qAbs(radiusX);
+	radiusY = qAbs(radiusY);
+	if (radiusX == 0 || radiusY == 0)
+	{
+		path.lineTo(endPoint);
+		return;
+	}
+
+	qreal angle = qDegreesToRadians(rotation);
+	qreal cosAngle = qCos(angle), sinAngle = qSin(angle);
+
+	qreal dx = (startPoint.x() - endPoint.x()) / 2, dy = (startPoint.y() - endPoint.y()) / 2;
+	qreal x1 = cosAngle * dx + sinAngle * dy;
+	qreal y1 = -sinAngle * dx + cosAngle * dy;
+
+	qreal lambda = (x1 * x1) / (radiusX * radiusX) + (y1 * y1) / (radiusY * radiusY);
+	if (lambda > 1)
+	{
+		radiusX *= qSqrt(lambda);
+		radiusY *= qSqrt(lambda);
+	}
+
+	qreal rx2 = radiusX * radiusX, ry2 = radiusY * radiusY;
+	qreal denominator = rx2 * y1 * y1 + ry2 * x1 * x1;
+	qreal coefficient = (denominator > 0) ? qSqrt(qMax(0.0, (rx2 * ry2 - denominator) / denominator)) : 0;
+	if (largeArc == sweep) coefficient = -coefficient;
+
+	qreal cx1 = coefficient * radiusX * y1 / radiusY;
+	qreal cy1 = -coefficient * radiusY * x1 / radiusX;
+	qreal centerX = cosAngle * cx1 - sinAngle * cy1 + (startPoint.x() + endPoint.x()) / 2;
+	qreal centerY = sinAngle * cx1 + cosAngle * cy1 + (startPoint.y() + endPoint.y()) / 2;
+
+	qreal ux = (x1 - cx1) / radiusX, uy = (y1 - cy1) / radiusY;
+	qreal vx = (-x1 - cx1) / radiusX, vy = (-y1 - cy1) / radiusY;
+	qreal startAngle = qAtan2(uy, ux);
+	qreal sweepAngle = qAtan2(ux * vy - uy * vx, ux * vx + uy * vy);
+
+	if (!sweep && sweepAngle > 0) sweepAngle -= 2 * M_PI;
+	else if (sweep && sweepAngle < 0) sweepAngle += 2 * M_PI;
+
+	int segments = qMax(1, (int)qCeil(qAbs(sweepAngle) / (M_PI / 2) - 1E-9));
+	qreal segmentAngle = sweepAngle / segments;
+	qreal handle = 4.0 / 3.0 * qTan(segmentAngle / 4);
+
+	auto mapPoint = [&](qreal x, qreal y) {
+		return QPointF(centerX + radiusX * x * cosAngle - radiusY * y * sinAngle,
+			centerY + radiusX * x * sinAngle + radiusY * y * cosAngle);
+	};
+
+	for(int i = 0; i < segments; i++)
+	{
+		qreal angle1 = startAngle + i * segmentAngle;
+		qreal angle2 = angle1 + segmentAngle;
+		qreal cos1 = qCos(angle1), sin1 = qSin(angle1);
+		qreal cos2 = qCos(angle2), sin2 = qSin(angle2);
+
+		path.cubicTo(mapPoint(cos1 - handle * sin1, sin1 + handle * cos1),
+			mapPoint(cos2 + handle * sin2, sin2 - handle * cos2),
+			(i == segments - 1) ? endPoint : mapPoint(cos2, sin2));
+	}
+}
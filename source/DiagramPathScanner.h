@@ -0,0 +1,54 @@
+/* DiagramPathScanner.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMPATHSCANNER_H
+#define DIAGRAMPATHSCANNER_H
+
+#include <QtGui>
+
+// Single pass parser for the "d" and "points" attributes.  Accepts the full SVG path syntax:
+// absolute and relative commands, implicit command repeats, and comma or whitespace separators.
+class DiagramPathScanner
+{
+private:
+	const QChar* mPosition;
+	const QChar* mEnd;
+
+public:
+	DiagramPathScanner(const QString& str);
+	DiagramPathScanner(const QStringRef& str);
+	~DiagramPathScanner();
+
+	QPainterPath readPath();
+	QPolygonF readPoints();
+
+private:
+	void skipSeparators();
+	bool readNumber(qreal& value);
+	bool readNumbers(qreal* values, int count);
+	bool readFlag(bool& flag);
+
+	int countNumbers() const;
+
+	void arcTo(QPainterPath& path, const QPointF& startPoint, qreal radiusX, qreal radiusY,
+		qreal rotation, bool largeArc, bool sweep, const QPointF& endPoint) const;
+};
+
+#endif
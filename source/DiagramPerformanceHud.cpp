@@ -0,0 +1,210 @@
+/* DiagramPerformanceHud.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramPerformanceHud.h"
+
+DiagramPerformanceHud::DiagramPerformanceHud()
+{
+	mVisible = false;
+	mRecording = false;
+	mRefreshPending = false;
+
+	for(int i = 0; i < NumberOfStages; i++) mStageTimes[i] = -1;
+	mFrameTime = 0;
+	mAverageFrameTime = 0;
+
+	mItemsVisited = mItemsDrawn = 0;
+	mTileHits = mTileMisses = 0;
+	mSymbolHits = mSymbolMisses = 0;
+	mRegionRects = 0;
+	mRegionArea = 0;
+}
+
+DiagramPerformanceHud::~DiagramPerformanceHud() { }
+
+//==================================================================================================
+
+void DiagramPerformanceHud::setVisible(bool visible)
+{
+	mVisible = visible;
+	mAverageFrameTime = 0;
+}
+
+bool DiagramPerformanceHud::isVisible() const
+{
+	return mVisible;
+}
+
+//==================================================================================================
+
+void DiagramPerformanceHud::beginFrame(const QRegion& region)
+{
+	if (!mVisible) return;
+
+	// A repaint of just the overlay itself would otherwise replace the numbers it is showing
+	mRecording = !(mRefreshPending && mRefreshRect.contains(region.boundingRect()));
+	mRefreshPending = false;
+
+	if (mRecording)
+	{
+		for(int i = 0; i < NumberOfStages; i++) mStageTimes[i] = -1;
+		mItemsVisited = mItemsDrawn = -1;
+		mTileHits = mTileMisses = -1;
+		mSymbolHits = mSymbolMisses = -1;
+
+		mRegionBounds = region.boundingRect();
+		mRegionRects = region.rectCount();
+		mRegionArea = 0;
+		for(auto rectIter = region.begin(); rectIter != region.end(); rectIter++)
+			mRegionArea += (qint64)rectIter->width() * rectIter->height();
+
+		mFrameTimer.start();
+	}
+}
+
+void DiagramPerformanceHud::beginStage()
+{
+	if (mVisible && mRecording) mStageTimer.start();
+}
+
+void DiagramPerformanceHud::endStage(Stage stage)
+{
+	if (mVisible && mRecording) mStageTimes[stage] = mStageTimer.nsecsElapsed();
+}
+
+void DiagramPerformanceHud::endFrame()
+{
+	if (mVisible && mRecording)
+	{
+		mFrameTime = mFrameTimer.nsecsElapsed();
+		mAverageFrameTime = (mAverageFrameTime > 0) ? 0.9 * mAverageFrameTime + 0.1 * mFrameTime : mFrameTime;
+	}
+}
+
+//==================================================================================================
+
+void DiagramPerformanceHud::setItemCounts(int visited, int drawn)
+{
+	if (mVisible && mRecording)
+	{
+		mItemsVisited = visited;
+		mItemsDrawn = drawn;
+	}
+}
+
+void DiagramPerformanceHud::setTileCounts(int hits, int misses)
+{
+	if (mVisible && mRecording)
+	{
+		mTileHits = hits;
+		mTileMisses = misses;
+	}
+}
+
+void DiagramPerformanceHud::setSymbolCounts(int hits, int misses)
+{
+	if (mVisible && mRecording)
+	{
+		mSymbolHits = hits;
+		mSymbolMisses = misses;
+	}
+}
+
+//==================================================================================================
+
+bool DiagramPerformanceHud::draw(QPainter* painter)
+{
+	// Returns true if the overlay was not fully covered by this frame's repaint region and needs
+	// to be repainted to show the new numbers
+	if (!mVisible) return false;
+
+	QStringList lines = DiagramPerformanceHud::lines();
+	QFont font("Monospace");
+	font.setStyleHint(QFont::TypeWriter);
+	QFontMetrics fontMetrics(font);
+
+	int width = 0;
+	for(auto lineIter = lines.begin(); lineIter != lines.end(); lineIter++)
+		width = qMax(width, fontMetrics.width(*lineIter));
+
+	QRect previousRect = mRect;
+	mRect = QRect(8, 8, width + 16, lines.size() * fontMetrics.lineSpacing() + 12);
+
+	painter->save();
+	painter->resetTransform();
+	painter->setRenderHints(QPainter::Antialiasing, false);
+	painter->setFont(font);
+	painter->fillRect(mRect, QColor(0, 0, 0, 176));
+	painter->setPen(Qt::white);
+
+	for(int i = 0; i < lines.size(); i++)
+	{
+		painter->drawText(mRect.left() + 8, mRect.top() + 6 + i * fontMetrics.lineSpacing() + fontMetrics.ascent(),
+			lines[i]);
+	}
+
+	painter->restore();
+
+	mRefreshRect = mRect.united(previousRect);
+	mRefreshPending = (mRecording && !mRegionBounds.contains(mRefreshRect));
+	return mRefreshPending;
+}
+
+QRect DiagramPerformanceHud::refreshRect() const
+{
+	return mRefreshRect;
+}
+
+//==================================================================================================
+
+QStringList DiagramPerformanceHud::lines() const
+{
+	QStringList lines;
+	QString stages;
+
+	lines << QString("Frame: %1 ms (avg %2 ms)").arg(mFrameTime / 1E6, 0, 'f', 2).arg(mAverageFrameTime / 1E6, 0, 'f', 2);
+
+	if (mStageTimes[TilesStage] >= 0)
+		stages += QString("tiles %1  ").arg(mStageTimes[TilesStage] / 1E6, 0, 'f', 2);
+	if (mStageTimes[BackgroundStage] >= 0)
+		stages += QString("background %1  ").arg(mStageTimes[BackgroundStage] / 1E6, 0, 'f', 2);
+	if (mStageTimes[ItemsStage] >= 0)
+		stages += QString("items %1  ").arg(mStageTimes[ItemsStage] / 1E6, 0, 'f', 2);
+	if (mStageTimes[ForegroundStage] >= 0)
+		stages += QString("foreground %1  ").arg(mStageTimes[ForegroundStage] / 1E6, 0, 'f', 2);
+	lines << ((stages.isEmpty()) ? QString("Stages: n/a") : "Stages (ms): " + stages.trimmed());
+
+	if (mItemsVisited >= 0)
+		lines << QString("Items: %1 visited, %2 drawn").arg(mItemsVisited).arg(mItemsDrawn);
+	if (mTileHits >= 0)
+		lines << QString("Tiles: %1 cached, %2 pending (%3)").arg(mTileHits).arg(mTileMisses).arg(percentage(mTileHits, mTileMisses));
+	if (mSymbolHits >= 0)
+		lines << QString("Symbols: %1 hits, %2 misses (%3)").arg(mSymbolHits).arg(mSymbolMisses).arg(percentage(mSymbolHits, mSymbolMisses));
+
+	lines << QString("Repaint: %1x%2, %3 rects, %4 px").arg(mRegionBounds.width()).arg(mRegionBounds.height())
+		.arg(mRegionRects).arg(mRegionArea);
+
+	return lines;
+}
+
+QString DiagramPerformanceHud::percentage(int hits, int misses) const
+{
+	return (hits + misses > 0) ? QString::number(100.0 * hits / (hits + misses), 'f', 1) + "%" : QString("n/a");
+}
@@ -0,0 +1,78 @@
+/* DiagramPerformanceHud.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMPERFORMANCEHUD_H
+#define DIAGRAMPERFORMANCEHUD_H
+
+#include <QtWidgets>
+
+// Performance overlay for the diagram view.  The view reports the timing of each stage of a
+// frame along with item and cache counts, and the overlay draws the numbers from the last frame
+// in the corner of the viewport.  Every method returns immediately while the overlay is hidden.
+class DiagramPerformanceHud
+{
+public:
+	enum Stage { BackgroundStage, ItemsStage, TilesStage, ForegroundStage, NumberOfStages };
+
+private:
+	bool mVisible;
+	bool mRecording;
+	bool mRefreshPending;
+	QRect mRect;
+	QRect mRefreshRect;
+
+	QElapsedTimer mFrameTimer;
+	QElapsedTimer mStageTimer;
+	qint64 mStageTimes[NumberOfStages];
+	qint64 mFrameTime;
+	qreal mAverageFrameTime;
+
+	int mItemsVisited, mItemsDrawn;
+	int mTileHits, mTileMisses;
+	int mSymbolHits, mSymbolMisses;
+	QRect mRegionBounds;
+	int mRegionRects;
+	qint64 mRegionArea;
+
+public:
+	DiagramPerformanceHud();
+	~DiagramPerformanceHud();
+
+	void setVisible(bool visible);
+	bool isVisible() const;
+
+	void beginFrame(const QRegion& region);
+	void beginStage();
+	void endStage(Stage stage);
+	void endFrame();
+
+	void setItemCounts(int visited, int drawn);
+	void setTileCounts(int hits, int misses);
+	void setSymbolCounts(int hits, int misses);
+
+	bool draw(QPainter* painter);
+	QRect refreshRect() const;
+
+private:
+	QStringList lines() const;
+	QString percentage(int hits, int misses) const;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/* DiagramPngWriter.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramPngWriter.h"
+#include <zlib.h>
+
+// Size of the compressed data written out in each IDAT chunk
+static const int DiagramPngWriterChunkSize = 256 * 1024;
+
+DiagramPngWriter::DiagramPngWriter(QIODevice* device)
+{
+	mDevice = device;
+	mCompressionLevel = 6;
+	mFilter = FilterAdaptive;
+
+	mStream = nullptr;
+	mRowsWritten = 0;
+}
+
+DiagramPngWriter::~DiagramPngWriter()
+{
+	if (mStream)
+	{
+		deflateEnd(mStream);
+		delete mStream;
+	}
+}
+
+//==================================================================================================
+
+void DiagramPngWriter::setCompressionLevel(int level)
+{
+	mCompressionLevel = qBound(0, level, 9);
+}
+
+void DiagramPngWriter::setFilter(Filter filter)
+{
+	mFilter = filter;
+}
+
+int DiagramPngWriter::compressionLevel() const
+{
+	return mCompressionLevel;
+}
+
+DiagramPngWriter::Filter DiagramPngWriter::filter() const
+{
+	return mFilter;
+}
+
+//==================================================================================================
+
+bool DiagramPngWriter::begin(const QSize& size)
+{
+	mSize = size;
+	mRowsWritten = 0;
+	mErrorMessage.clear();
+
+	if (size.width() <= 0 || size.height() <= 0)
+	{
+		setError("Invalid image size.");
+		return false;
+	}
+
+	mStream = new z_stream;
+	memset(mStream, 0, sizeof(z_stream));
+	if (deflateInit(mStream, mCompressionLevel) != Z_OK)
+	{
+		delete mStream;
+		mStream = nullptr;
+		setError("Unable to initialize the PNG compressor.");
+		return false;
+	}
+
+	mPreviousRow.fill(0, size.width() * 4);
+	mRow.resize(size.width() * 4);
+	mFilteredRows.reserve(16 * (size.width() * 4 + 1));
+	mOutput.reserve(DiagramPngWriterChunkSize);
+
+	static const char signature[8] = { '\x89', 'P', 'N', 'G', '\r', '\n', '\x1A', '\n' };
+	if (mDevice->write(signature, 8) != 8)
+	{
+		setError("Unable to write to the output file.");
+		return false;
+	}
+
+	// IHDR: width, height, 8 bits per sample, RGBA, deflate, adaptive filtering, no interlace
+	QByteArray header;
+	QDataStream headerStream(&header, QIODevice::WriteOnly);
+	headerStream << (quint32)size.width() << (quint32)size.height() << (quint8)8 << (quint8)6
+		<< (quint8)0 << (quint8)0 << (quint8)0;
+
+	return writeChunk("IHDR", header);
+}
+
+bool DiagramPngWriter::writeRows(const QImage& image)
+{
+	if (!mStream || !mErrorMessage.isEmpty()) return false;
+
+	QImage rows = (image.format() == QImage::Format_ARGB32) ? image : image.convertToFormat(QImage::Format_ARGB32);
+	int rowCount = qMin(rows.height(), mSize.height() - mRowsWritten);
+	int width = mSize.width();
+
+	for(int y = 0; y < rowCount; y++)
+	{
+		const QRgb* pixels = reinterpret_cast<const QRgb*>(rows.constScanLine(y));
+		uchar* row = reinterpret_cast<uchar*>(mRow.data());
+
+		for(int x = 0; x < width; x++)
+		{
+			QRgb pixel = (x < rows.width()) ? pixels[x] : 0;
+			row[4 * x] = qRed(pixel);
+			row[4 * x + 1] = qGreen(pixel);
+			row[4 * x + 2] = qBlue(pixel);
+			row[4 * x + 3] = qAlpha(pixel);
+		}
+
+		int offset = mFilteredRows.size();
+		mFilteredRows.resize(offset + 1 + mRow.size());
+		uchar* output = reinterpret_cast<uchar*>(mFilteredRows.data()) + offset;
+
+		if (mFilter == FilterAdaptive)
+		{
+			// Pick the filter with the smallest sum of absolute differences, as libpng does
+			Filter bestFilter = FilterNone;
+			quint64 bestSum = std::numeric_limits<quint64>::max();
+
+			for(int filter = FilterNone; filter <= FilterPaeth; filter++)
+			{
+				quint64 sum = 0;
+
+				filterRow((Filter)filter, output);
+				for(int i = 1; i <= mRow.size(); i++) sum += qAbs((int)(signed char)output[i]);
+
+				if (sum < bestSum)
+				{
+					bestSum = sum;
+					bestFilter = (Filter)filter;
+				}
+			}
+
+			filterRow(bestFilter, output);
+		}
+		else filterRow(mFilter, output);
+
+		mPreviousRow.swap(mRow);
+		mRowsWritten++;
+
+		if (mFilteredRows.size() >= mFilteredRows.capacity() - mRow.size() - 1 && !deflateRows(false))
+			return false;
+	}
+
+	return deflateRows(false);
+}
+
+bool DiagramPngWriter::finish()
+{
+	if (!mStream || !mErrorMessage.isEmpty()) return false;
+
+	// Rows that were never added are written as transparent
+	if (mRowsWritten < mSize.height())
+	{
+		QImage blankRows(mSize.width(), qMin(mSize.height() - mRowsWritten, 256), QImage::Format_ARGB32);
+		blankRows.fill(Qt::transparent);
+		while (mRowsWritten < mSize.height() && writeRows(blankRows)) { }
+	}
+
+	bool ok = deflateRows(true) && writeChunk("IEND", QByteArray());
+
+	deflateEnd(mStream);
+	delete mStream;
+	mStream = nullptr;
+
+	return ok;
+}
+
+//==================================================================================================
+
+QString DiagramPngWriter::errorMessage() const
+{
+	return mErrorMessage;
+}
+
+//==================================================================================================
+
+void DiagramPngWriter::filterRow(Filter filter, uchar* output) const
+{
+	const uchar* row = reinterpret_cast<const uchar*>(mRow.constData());
+	const uchar* previousRow = reinterpret_cast<const uchar*>(mPreviousRow.constData());
+	int length = mRow.size();
+
+	output[0] = (uchar)(filter - FilterNone);
+	output++;
+
+	switch (filter)
+	{
+	case FilterSub:
+		for(int i = 0; i < length; i++)
+			output[i] = row[i] - ((i >= 4) ? row[i - 4] : 0);
+		break;
+	case FilterUp:
+		for(int i = 0; i < length; i++)
+			output[i] = row[i] - previousRow[i];
+		break;
+	case FilterAverage:
+		for(int i = 0; i < length; i++)
+			output[i] = row[i] - (((i >= 4) ? row[i - 4] : 0) + previousRow[i]) / 2;
+		break;
+	case FilterPaeth:
+		for(int i = 0; i < length; i++)
+		{
+			int a = (i >= 4) ? row[i - 4] : 0;
+			int b = previousRow[i];
+			int c = (i >= 4) ? previousRow[i - 4] : 0;
+			int p = a + b - c;
+			int pa = qAbs(p - a), pb = qAbs(p - b), pc = qAbs(p - c);
+
+			output[i] = row[i] - ((pa <= pb && pa <= pc) ? a : ((pb <= pc) ? b : c));
+		}
+		break;
+	default:
+		memcpy(output, row, length);
+		break;
+	}
+}
+
+bool DiagramPngWriter::deflateRows(bool finish)
+{
+	mStream->next_in = reinterpret_cast<Bytef*>(mFilteredRows.data());
+	mStream->avail_in = mFilteredRows.size();
+
+	int result = Z_OK;
+	do
+	{
+		int offset = mOutput.size();
+		mOutput.resize(DiagramPngWriterChunkSize);
+		mStream->next_out = reinterpret_cast<Bytef*>(mOutput.data()) + offset;
+		mStream->avail_out = DiagramPngWriterChunkSize - offset;
+
+		result = deflate(mStream, (finish) ? Z_FINISH : Z_NO_FLUSH);
+		if (result == Z_STREAM_ERROR)
+		{
+			setError("Error while compressing the PNG image data.");
+			return false;
+		}
+
+		mOutput.resize(DiagramPngWriterChunkSize - mStream->avail_out);
+
+		if (mOutput.size() == DiagramPngWriterChunkSize || (finish && result == Z_STREAM_END && !mOutput.isEmpty()))
+		{
+			if (!writeChunk("IDAT", mOutput)) return false;
+			mOutput.resize(0);
+		}
+	} while (mStream->avail_in > 0 || (finish && result != Z_STREAM_END));
+
+	mFilteredRows.resize(0);
+	return true;
+}
+
+bool DiagramPngWriter::writeChunk(const char* type, const QByteArray& data)
+{
+	QByteArray chunk;
+	QDataStream chunkStream(&chunk, QIODevice::WriteOnly);
+
+	chunkStream << (quint32)data.size();
+	chunkStream.writeRawData(type, 4);
+	chunkStream.writeRawData(data.constData(), data.size());
+
+	uLong crc = crc32(0L, Z_NULL, 0);
+	crc = crc32(crc, reinterpret_cast<const Bytef*>(chunk.constData()) + 4, data.size() + 4);
+	chunkStream << (quint32)crc;
+
+	if (mDevice->write(chunk) != chunk.size())
+	{
+		setError("Unable to write to the output file.");
+		return false;
+	}
+
+	return true;
+}
+
+void DiagramPngWriter::setError(const QString& message)
+{
+	if (mErrorMessage.isEmpty()) mErrorMessage = message;
+}
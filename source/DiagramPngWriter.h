@@ -0,0 +1,72 @@
+/* DiagramPngWriter.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMPNGWRITER_H
+#define DIAGRAMPNGWRITER_H
+
+#include <QtGui>
+
+typedef struct z_stream_s z_stream;
+
+// Streaming PNG encoder.  Rows are filtered and deflated as they are added, and the compressed
+// data is written out in IDAT chunks of bounded size, so only one row and the compressor's state
+// are held in memory regardless of the image size.  Images are written as 8-bit RGBA.
+class DiagramPngWriter
+{
+public:
+	enum Filter { FilterAdaptive, FilterNone, FilterSub, FilterUp, FilterAverage, FilterPaeth };
+
+private:
+	QIODevice* mDevice;
+	QSize mSize;
+	int mCompressionLevel;
+	Filter mFilter;
+
+	z_stream* mStream;
+	QByteArray mPreviousRow;
+	QByteArray mRow;
+	QByteArray mFilteredRows;
+	QByteArray mOutput;
+	int mRowsWritten;
+	QString mErrorMessage;
+
+public:
+	DiagramPngWriter(QIODevice* device);
+	~DiagramPngWriter();
+
+	void setCompressionLevel(int level);
+	void setFilter(Filter filter);
+	int compressionLevel() const;
+	Filter filter() const;
+
+	bool begin(const QSize& size);
+	bool writeRows(const QImage& image);
+	bool finish();
+
+	QString errorMessage() const;
+
+private:
+	void filterRow(Filter filter, uchar* output) const;
+	bool deflateRows(bool finish);
+	bool writeChunk(const char* type, const QByteArray& data);
+	void setError(const QString& message);
+};
+
+#endif
@@ -19,6 +19,8 @@
  */
 
 #include "DiagramReader.h"
+#include "DiagramPathScanner.h"
+#include <QtConcurrent>
 
 DiagramReader::DiagramReader(QIODevice* device) : QXmlStreamReader(device) { }
 
@@ -58,16 +60,16 @@ void DiagramReader::read(DiagramWidget* diagram)
 							scene->setSceneRect(sceneRect);
 
 							if (attr.hasAttribute("background-color"))
-								scene->setBackgroundBrush(colorFromString(attr.value("background-color").toString()));
+								scene->setBackgroundBrush(colorFromString(attr.value("background-color")));
 						}
 
 						if (attr.hasAttribute("grid"))
 							diagram->setGrid(attr.value("grid").toDouble());
 
 						if (attr.hasAttribute("grid-color"))
-							diagram->setGridBrush(colorFromString(attr.value("grid-color").toString()));
+							diagram->setGridBrush(colorFromString(attr.value("grid-color")));
 						if (attr.hasAttribute("grid-style"))
-							diagram->setGridStyle(gridStyleFromString(attr.value("grid-style").toString()));
+							diagram->setGridStyle(gridStyleFromString(attr.value("grid-style")));
 						if (attr.hasAttribute("grid-spacing-major"))
 							diagram->setGridSpacing(attr.value("grid-spacing-major").toInt(), diagram->gridSpacingMinor());
 						if (attr.hasAttribute("grid-spacing-minor"))
@@ -79,8 +81,7 @@ void DiagramReader::read(DiagramWidget* diagram)
 							if (name() == "items")
 							{
 								items = readItemElements();
-								for(auto itemIter = items.begin(); scene && itemIter != items.end(); itemIter++)
-									scene->addItem(*itemIter);
+								diagram->addSceneItems(items);
 							}
 							else skipCurrentElement();
 						}
@@ -111,70 +112,430 @@ void DiagramReader::readItems(QList<DrawingItem*>& items)
 	}
 }
 
+DrawingItem* DiagramReader::readItem()
+{
+	DrawingItem* item = nullptr;
+
+	if (readNextStartElement())
+	{
+		if (isItemElement(name()))
+		{
+			QList<ItemData> dataList;
+			dataList.append(readItemData());
+
+			QList<DrawingItem*> items = createItems(parseItemBatch(dataList));
+			if (!items.isEmpty()) item = items.first();
+		}
+		else skipCurrentElement();
+	}
+
+	return item;
+}
+
 //==================================================================================================
 
 QList<DrawingItem*> DiagramReader::readItemElements()
 {
 	QList<DrawingItem*> items;
+	QList< QFuture< QList<ItemData> > > parsedBatches;
+	QList<ItemData> batch;
+	const int batchSize = 256;
+	const int maxPendingBatches = 2 * qMax(QThreadPool::globalInstance()->maxThreadCount(), 1);
 
-	DrawingItem* newItem = nullptr;
-	QString itemName;
-
+	// Tokenize the item elements on this thread and hand full batches off to the thread pool to
+	// convert their attributes into numbers, points, paths and styles
 	while (readNextStartElement())
 	{
-		newItem = nullptr;
-		itemName = name().toString();
-
-		if (itemName == "line") newItem = readLineItem();
-		else if (itemName == "arc") newItem = readArcItem();
-		else if (itemName == "polyline") newItem = readPolylineItem();
-		else if (itemName == "curve") newItem = readCurveItem();
-		else if (itemName == "rect") newItem = readRectItem();
-		else if (itemName == "ellipse") newItem = readEllipseItem();
-		else if (itemName == "polygon") newItem = readPolygonItem();
-		else if (itemName == "text") newItem = readTextItem();
-		else if (itemName == "text-rect") newItem = readTextRectItem();
-		else if (itemName == "text-ellipse") newItem = readTextEllipseItem();
-		else if (itemName == "text-polygon") newItem = readTextPolygonItem();
-		else if (itemName == "path") newItem = readPathItem();
-		else if (itemName == "group") newItem = readItemGroup();
+		if (isItemElement(name())) batch.append(readItemData());
 		else skipCurrentElement();
 
-		if (newItem) items.append(newItem);
+		if (batch.size() >= batchSize)
+		{
+			parsedBatches.append(QtConcurrent::run(this, &DiagramReader::parseItemBatch, batch));
+			batch.clear();
+
+			// Create the items of the batches that are already parsed, in document order, so their
+			// data is released while the rest of the document is still being read.  Waiting on the
+			// oldest batch once too many are pending keeps the tokenizer from running far ahead.
+			while (!parsedBatches.isEmpty() &&
+				(parsedBatches.first().isFinished() || parsedBatches.size() > maxPendingBatches))
+			{
+				items.append(createItems(parsedBatches.takeFirst().result()));
+			}
+		}
 	}
 
-	// Connect items together
-	QList<DrawingItemPoint*> itemPoints, otherItemPoints;
-	qreal distance, threshold = 0.01;
+	// Parse the last partial batch here while the pool finishes, then create the remaining items
+	batch = parseItemBatch(batch);
+
+	while (!parsedBatches.isEmpty())
+		items.append(createItems(parsedBatches.takeFirst().result()));
+	items.append(createItems(batch));
+
+	connectItems(items);
+
+	return items;
+}
+
+//==================================================================================================
+
+void DiagramReader::connectItems(const QList<DrawingItem*>& items, int firstNewItem)
+{
+	// Map each connectable point to scene coordinates once and bucket it into a uniform grid.
+	// The cells are twice the connection threshold, so any pair of points within the threshold
+	// is guaranteed to land in the same or an adjacent cell.
+	struct ConnectionPoint
+	{
+		int itemIndex;
+		DrawingItemPoint* point;
+		QPointF scenePos;
+	};
+
+	QVector<ConnectionPoint> connectionPoints;
+	QHash< QPair<qint64,qint64>, QVector<int> > grid;
+	QList<DrawingItemPoint*> itemPoints;
+	qreal distance, threshold = 0.01, cellSize = 2 * threshold;
 	QPointF vec;
-	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	int itemIndex = 0;
+
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++, itemIndex++)
 	{
-		for(auto otherItemIter = itemIter + 1; otherItemIter != items.end(); otherItemIter++)
+		itemPoints = (*itemIter)->points();
+
+		for(auto itemPointIter = itemPoints.begin(); itemPointIter != itemPoints.end(); itemPointIter++)
 		{
-			itemPoints = (*itemIter)->points();
-			otherItemPoints = (*otherItemIter)->points();
+			if ((*itemPointIter)->flags() & DrawingItemPoint::Connection)
+			{
+				ConnectionPoint connectionPoint;
+				connectionPoint.itemIndex = itemIndex;
+				connectionPoint.point = *itemPointIter;
+				connectionPoint.scenePos = (*itemIter)->mapToScene((*itemPointIter)->position());
+
+				grid[qMakePair((qint64)qFloor(connectionPoint.scenePos.x() / cellSize),
+					(qint64)qFloor(connectionPoint.scenePos.y() / cellSize))].append(connectionPoints.size());
+				connectionPoints.append(connectionPoint);
+			}
+		}
+	}
+
+	// Visit the points in item order and connect each one to nearby points of later items.  Sorting
+	// the candidates by index keeps the order of each point's connections identical to a full
+	// pairwise comparison.  Pairs where both items come before firstNewItem are assumed to be
+	// connected already.
+	QVector<int> candidates;
+	qint64 cellX, cellY;
 
-			for(auto itemPointIter = itemPoints.begin(); itemPointIter != itemPoints.end(); itemPointIter++)
+	for(int i = 0; i < connectionPoints.size(); i++)
+	{
+		const ConnectionPoint& connectionPoint = connectionPoints[i];
+		cellX = qFloor(connectionPoint.scenePos.x() / cellSize);
+		cellY = qFloor(connectionPoint.scenePos.y() / cellSize);
+
+		candidates.clear();
+		for(qint64 x = cellX - 1; x <= cellX + 1; x++)
+		{
+			for(qint64 y = cellY - 1; y <= cellY + 1; y++)
 			{
-				for(auto otherItemPointIter = otherItemPoints.begin();
-					otherItemPointIter != otherItemPoints.end(); otherItemPointIter++)
+				auto cellIter = grid.constFind(qMakePair(x, y));
+				if (cellIter == grid.constEnd()) continue;
+
+				for(auto indexIter = cellIter->begin(); indexIter != cellIter->end(); indexIter++)
 				{
-					if (((*itemPointIter)->flags() & DrawingItemPoint::Connection) && ((*otherItemPointIter)->flags() & DrawingItemPoint::Connection) &&
-						(((*itemPointIter)->flags() & DrawingItemPoint::Free) || ((*otherItemPointIter)->flags() & DrawingItemPoint::Free)))
+					if (connectionPoints[*indexIter].itemIndex > connectionPoint.itemIndex &&
+						connectionPoints[*indexIter].itemIndex >= firstNewItem)
 					{
-						vec = (*itemIter)->mapToScene((*itemPointIter)->position()) -
-							(*otherItemIter)->mapToScene((*otherItemPointIter)->position());
-						distance = qSqrt(vec.x() * vec.x() + vec.y() * vec.y());
-
-						if (distance <= threshold)
-						{
-							(*itemPointIter)->addConnection(*otherItemPointIter);
-							(*otherItemPointIter)->addConnection(*itemPointIter);
-						}
+						candidates.append(*indexIter);
 					}
 				}
 			}
 		}
+		std::sort(candidates.begin(), candidates.end());
+
+		for(auto candidateIter = candidates.begin(); candidateIter != candidates.end(); candidateIter++)
+		{
+			const ConnectionPoint& otherConnectionPoint = connectionPoints[*candidateIter];
+
+			if ((connectionPoint.point->flags() & DrawingItemPoint::Free) ||
+				(otherConnectionPoint.point->flags() & DrawingItemPoint::Free))
+			{
+				vec = connectionPoint.scenePos - otherConnectionPoint.scenePos;
+				distance = qSqrt(vec.x() * vec.x() + vec.y() * vec.y());
+
+				if (distance <= threshold)
+				{
+					connectionPoint.point->addConnection(otherConnectionPoint.point);
+					otherConnectionPoint.point->addConnection(connectionPoint.point);
+				}
+			}
+		}
+	}
+}
+
+//==================================================================================================
+
+bool DiagramReader::isItemElement(const QStringRef& elementName) const
+{
+	return (elementName == "line" || elementName == "arc" || elementName == "polyline" ||
+		elementName == "curve" || elementName == "rect" || elementName == "ellipse" ||
+		elementName == "polygon" || elementName == "text" || elementName == "text-rect" ||
+		elementName == "text-ellipse" || elementName == "text-polygon" || elementName == "path" ||
+		elementName == "group");
+}
+
+DiagramReader::ItemData DiagramReader::readItemData()
+{
+	ItemData data;
+	QXmlStreamAttributes attr = attributes();
+
+	// Keep the known attribute values back to back in a single string rather than one string
+	// per name and value
+	data.type = name().toString();
+	data.attributes.reserve(attr.size());
+	for(auto attrIter = attr.begin(); attrIter != attr.end(); attrIter++)
+	{
+		int attributeName = attributeNameFromString(attrIter->name());
+		if (attributeName >= 0)
+		{
+			ItemAttribute attribute;
+			attribute.name = attributeName;
+			attribute.start = data.attributeText.size();
+			attribute.length = attrIter->value().size();
+			data.attributeText.append(attrIter->value());
+			data.attributes.append(attribute);
+		}
+	}
+
+	if (data.type == "group")
+	{
+		while (readNextStartElement())
+		{
+			if (isItemElement(name())) data.children.append(readItemData());
+			else skipCurrentElement();
+		}
+	}
+	else if (data.type == "text" || data.type == "text-rect" || data.type == "text-ellipse" ||
+		data.type == "text-polygon")
+	{
+		if (readNext() == QXmlStreamReader::Characters)
+		{
+			data.caption = text().toString();
+			data.hasCaption = true;
+			skipCurrentElement();
+		}
+	}
+	else skipCurrentElement();
+
+	return data;
+}
+
+int DiagramReader::attributeNameFromString(const QStringRef& str) const
+{
+	static const char* attributeNames[NumberOfAttributes] = { "x1", "y1", "x2", "y2", "cx1", "cy1",
+		"cx2", "cy2", "left", "top", "width", "height", "rx", "ry", "view-left", "view-top", "view-width",
+		"view-height", "name", "transform", "points", "glue-points", "d", "stroke-style", "stroke-width",
+		"stroke-color", "stroke-opacity", "fill-color", "fill-opacity", "font-name", "font-size", "font-bold",
+		"font-italic", "font-underline", "font-strike-through", "text-alignment-horizontal",
+		"text-alignment-vertical", "text-color", "text-opacity", "arrow-start-style", "arrow-start-size",
+		"arrow-end-style", "arrow-end-size" };
+
+	for(int i = 0; i < NumberOfAttributes; i++)
+	{
+		if (str == QLatin1String(attributeNames[i])) return i;
+	}
+
+	return -1;
+}
+
+QStringRef DiagramReader::attributeValue(const ItemData& data, AttributeName name) const
+{
+	for(auto attributeIter = data.attributes.begin(); attributeIter != data.attributes.end(); attributeIter++)
+	{
+		if (attributeIter->name == name)
+			return QStringRef(&data.attributeText, attributeIter->start, attributeIter->length);
+	}
+
+	return QStringRef();
+}
+
+//==================================================================================================
+
+QList<DiagramReader::ItemData> DiagramReader::parseItemBatch(QList<ItemData> batch) const
+{
+	for(auto dataIter = batch.begin(); dataIter != batch.end(); dataIter++)
+		parseItemData(*dataIter);
+
+	return batch;
+}
+
+void DiagramReader::parseItemData(ItemData& data) const
+{
+	QStringRef value;
+
+	for(auto attributeIter = data.attributes.begin(); attributeIter != data.attributes.end(); attributeIter++)
+	{
+		if (attributeIter->name < NumberOfNumberAttributes)
+		{
+			data.numbers[attributeIter->name] =
+				QStringRef(&data.attributeText, attributeIter->start, attributeIter->length).toDouble();
+			data.numberFlags |= (1u << attributeIter->name);
+		}
+	}
+
+	value = attributeValue(data, NameAttribute);
+	if (!value.isNull()) data.name = value.toString();
+
+	value = attributeValue(data, TransformAttribute);
+	if (!value.isNull()) transformFromString(value.toString(), data);
+
+	value = attributeValue(data, PointsAttribute);
+	if (value.isNull()) value = attributeValue(data, GluePointsAttribute);
+	if (!value.isNull())
+	{
+		data.points = pointsFromString(value);
+		data.hasPoints = true;
+	}
+
+	value = attributeValue(data, PathAttribute);
+	if (!value.isNull())
+	{
+		data.path = pathFromString(value);
+		data.hasPath = true;
+	}
+
+	data.style = parseItemStyle(data);
+
+	// The attribute text is no longer needed once everything has been converted
+	data.attributeText.clear();
+	data.attributes.clear();
+
+	for(auto childIter = data.children.begin(); childIter != data.children.end(); childIter++)
+		parseItemData(*childIter);
+}
+
+QHash<DrawingItemStyle::Property,QVariant> DiagramReader::parseItemStyle(const ItemData& data) const
+{
+	QHash<DrawingItemStyle::Property,QVariant> style;
+	QStringRef value;
+
+	// Pen
+	value = attributeValue(data, StrokeStyleAttribute);
+	Qt::PenStyle penStyle = (!value.isNull()) ? penStyleFromString(value) : Qt::SolidLine;
+	style.insert(DrawingItemStyle::PenStyle, (uint)penStyle);
+
+	value = attributeValue(data, StrokeWidthAttribute);
+	qreal penWidth = (!value.isNull()) ? value.toDouble() : 1.0;
+	style.insert(DrawingItemStyle::PenWidth, penWidth);
+
+	value = attributeValue(data, StrokeColorAttribute);
+	QColor penColor = (!value.isNull()) ? colorFromString(value) : QColor(0, 0, 0);
+	style.insert(DrawingItemStyle::PenColor, penColor);
+
+	value = attributeValue(data, StrokeOpacityAttribute);
+	qreal penOpacity = (!value.isNull()) ? value.toDouble() : 1.0;
+	style.insert(DrawingItemStyle::PenOpacity, penOpacity);
+
+	// Brush
+	value = attributeValue(data, FillColorAttribute);
+	QColor brushColor = (!value.isNull()) ? colorFromString(value) : QColor(255, 255, 255);
+	style.insert(DrawingItemStyle::BrushColor, brushColor);
+
+	value = attributeValue(data, FillOpacityAttribute);
+	qreal brushOpacity = (!value.isNull()) ? value.toDouble() : 1.0;
+	style.insert(DrawingItemStyle::BrushOpacity, brushOpacity);
+
+	// Font
+	value = attributeValue(data, FontNameAttribute);
+	QString fontName = (!value.isNull()) ? value.toString() : QString("Arial");
+	style.insert(DrawingItemStyle::FontName, fontName);
+
+	value = attributeValue(data, FontSizeAttribute);
+	qreal fontSize = (!value.isNull()) ? value.toDouble() : 0.0;
+	style.insert(DrawingItemStyle::FontSize, fontSize);
+
+	value = attributeValue(data, FontBoldAttribute);
+	bool fontBold = (!value.isNull()) ?
+		(value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) : false;
+	style.insert(DrawingItemStyle::FontBold, fontBold);
+
+	value = attributeValue(data, FontItalicAttribute);
+	bool fontItalic = (!value.isNull()) ?
+		(value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) : false;
+	style.insert(DrawingItemStyle::FontItalic, fontItalic);
+
+	value = attributeValue(data, FontUnderlineAttribute);
+	bool fontUnderline = (!value.isNull()) ?
+		(value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) : false;
+	style.insert(DrawingItemStyle::FontUnderline, fontUnderline);
+
+	value = attributeValue(data, FontStrikeThroughAttribute);
+	bool fontStrikeThrough = (!value.isNull()) ?
+		(value.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0) : false;
+	style.insert(DrawingItemStyle::FontStrikeThrough, fontStrikeThrough);
+
+	value = attributeValue(data, TextAlignmentHorizontalAttribute);
+	Qt::Alignment horizontalAlign = (!value.isNull()) ? alignmentFromString(value) : Qt::AlignHCenter;
+	style.insert(DrawingItemStyle::TextHorizontalAlignment, (uint)horizontalAlign);
+
+	value = attributeValue(data, TextAlignmentVerticalAttribute);
+	Qt::Alignment verticalAlign = (!value.isNull()) ? alignmentFromString(value) : Qt::AlignVCenter;
+	style.insert(DrawingItemStyle::TextVerticalAlignment, (uint)verticalAlign);
+
+	value = attributeValue(data, TextColorAttribute);
+	QColor textColor = (!value.isNull()) ? colorFromString(value) : QColor(0, 0, 0);
+	style.insert(DrawingItemStyle::TextColor, textColor);
+
+	value = attributeValue(data, TextOpacityAttribute);
+	qreal textOpacity = (!value.isNull()) ? value.toDouble() : 1.0;
+	style.insert(DrawingItemStyle::TextOpacity, textOpacity);
+
+	// Arrows
+	value = attributeValue(data, ArrowStartStyleAttribute);
+	DrawingItemStyle::ArrowStyle startArrow = (!value.isNull()) ?
+		arrowStyleFromString(value) : DrawingItemStyle::ArrowNone;
+	style.insert(DrawingItemStyle::StartArrowStyle, (uint)startArrow);
+
+	value = attributeValue(data, ArrowStartSizeAttribute);
+	qreal startArrowSize = (!value.isNull()) ? value.toDouble() : 0.0;
+	style.insert(DrawingItemStyle::StartArrowSize, startArrowSize);
+
+	value = attributeValue(data, ArrowEndStyleAttribute);
+	DrawingItemStyle::ArrowStyle endArrow = (!value.isNull()) ?
+		arrowStyleFromString(value) : DrawingItemStyle::ArrowNone;
+	style.insert(DrawingItemStyle::EndArrowStyle, (uint)endArrow);
+
+	value = attributeValue(data, ArrowEndSizeAttribute);
+	qreal endArrowSize = (!value.isNull()) ? value.toDouble() : 0.0;
+	style.insert(DrawingItemStyle::EndArrowSize, endArrowSize);
+
+	return style;
+}
+
+//==================================================================================================
+
+QList<DrawingItem*> DiagramReader::createItems(const QList<ItemData>& dataList)
+{
+	QList<DrawingItem*> items;
+	DrawingItem* newItem = nullptr;
+
+	for(auto dataIter = dataList.begin(); dataIter != dataList.end(); dataIter++)
+	{
+		newItem = nullptr;
+
+		if (dataIter->type == "line") newItem = createLineItem(*dataIter);
+		else if (dataIter->type == "arc") newItem = createArcItem(*dataIter);
+		else if (dataIter->type == "polyline") newItem = createPolylineItem(*dataIter);
+		else if (dataIter->type == "curve") newItem = createCurveItem(*dataIter);
+		else if (dataIter->type == "rect") newItem = createRectItem(*dataIter);
+		else if (dataIter->type == "ellipse") newItem = createEllipseItem(*dataIter);
+		else if (dataIter->type == "polygon") newItem = createPolygonItem(*dataIter);
+		else if (dataIter->type == "text") newItem = createTextItem(*dataIter);
+		else if (dataIter->type == "text-rect") newItem = createTextRectItem(*dataIter);
+		else if (dataIter->type == "text-ellipse") newItem = createTextEllipseItem(*dataIter);
+		else if (dataIter->type == "text-polygon") newItem = createTextPolygonItem(*dataIter);
+		else if (dataIter->type == "path") newItem = createPathItem(*dataIter);
+		else if (dataIter->type == "group") newItem = createItemGroup(*dataIter);
+
+		if (newItem) items.append(newItem);
 	}
 
 	return items;
@@ -182,443 +543,274 @@ QList<DrawingItem*> DiagramReader::readItemElements()
 
 //==================================================================================================
 
-DrawingLineItem* DiagramReader::readLineItem()
+DrawingLineItem* DiagramReader::createLineItem(const ItemData& data)
 {
 	DrawingLineItem* item = new DrawingLineItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QLineF line = item->line();
 	QPointF p1 = line.p1();
 	QPointF p2 = line.p2();
-	if (attr.hasAttribute("x1")) p1.setX(attr.value("x1").toDouble());
-	if (attr.hasAttribute("y1")) p1.setY(attr.value("y1").toDouble());
-	if (attr.hasAttribute("x2")) p2.setX(attr.value("x2").toDouble());
-	if (attr.hasAttribute("y2")) p2.setY(attr.value("y2").toDouble());
+	if (data.hasNumber(X1Attribute)) p1.setX(data.numbers[X1Attribute]);
+	if (data.hasNumber(Y1Attribute)) p1.setY(data.numbers[Y1Attribute]);
+	if (data.hasNumber(X2Attribute)) p2.setX(data.numbers[X2Attribute]);
+	if (data.hasNumber(Y2Attribute)) p2.setY(data.numbers[Y2Attribute]);
 	item->setLine(QLineF(p1, p2));
 
-	readItemStyle(item->style());
-
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingArcItem* DiagramReader::readArcItem()
+DrawingArcItem* DiagramReader::createArcItem(const ItemData& data)
 {
 	DrawingArcItem* item = new DrawingArcItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QLineF line = item->arc();
 	QPointF p1 = line.p1();
 	QPointF p2 = line.p2();
-	if (attr.hasAttribute("x1")) p1.setX(attr.value("x1").toDouble());
-	if (attr.hasAttribute("y1")) p1.setY(attr.value("y1").toDouble());
-	if (attr.hasAttribute("x2")) p2.setX(attr.value("x2").toDouble());
-	if (attr.hasAttribute("y2")) p2.setY(attr.value("y2").toDouble());
+	if (data.hasNumber(X1Attribute)) p1.setX(data.numbers[X1Attribute]);
+	if (data.hasNumber(Y1Attribute)) p1.setY(data.numbers[Y1Attribute]);
+	if (data.hasNumber(X2Attribute)) p2.setX(data.numbers[X2Attribute]);
+	if (data.hasNumber(Y2Attribute)) p2.setY(data.numbers[Y2Attribute]);
 	item->setArc(QLineF(p1, p2));
 
-	readItemStyle(item->style());
-
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingPolylineItem* DiagramReader::readPolylineItem()
+DrawingPolylineItem* DiagramReader::createPolylineItem(const ItemData& data)
 {
 	DrawingPolylineItem* item = new DrawingPolylineItem();
-	QXmlStreamAttributes attr = attributes();
-
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
 
-	if (attr.hasAttribute("points"))
-		item->setPolyline(pointsFromString(attr.value("points").toString()));
+	applyItemTransform(data, item);
 
-	readItemStyle(item->style());
+	if (data.hasPoints) item->setPolyline(data.points);
 
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingCurveItem* DiagramReader::readCurveItem()
+DrawingCurveItem* DiagramReader::createCurveItem(const ItemData& data)
 {
 	DrawingCurveItem* item = new DrawingCurveItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QPointF p1 = item->curveStartPos(), p2 = item->curveEndPos();
 	QPointF cp1 = item->curveStartControlPos(), cp2 = item->curveEndControlPos();
-	if (attr.hasAttribute("x1")) p1.setX(attr.value("x1").toDouble());
-	if (attr.hasAttribute("y1")) p1.setY(attr.value("y1").toDouble());
-	if (attr.hasAttribute("cx1")) cp1.setX(attr.value("cx1").toDouble());
-	if (attr.hasAttribute("cy1")) cp1.setY(attr.value("cy1").toDouble());
-	if (attr.hasAttribute("cx2")) cp2.setX(attr.value("cx2").toDouble());
-	if (attr.hasAttribute("cy2")) cp2.setY(attr.value("cy2").toDouble());
-	if (attr.hasAttribute("x2")) p2.setX(attr.value("x2").toDouble());
-	if (attr.hasAttribute("y2")) p2.setY(attr.value("y2").toDouble());
+	if (data.hasNumber(X1Attribute)) p1.setX(data.numbers[X1Attribute]);
+	if (data.hasNumber(Y1Attribute)) p1.setY(data.numbers[Y1Attribute]);
+	if (data.hasNumber(Cx1Attribute)) cp1.setX(data.numbers[Cx1Attribute]);
+	if (data.hasNumber(Cy1Attribute)) cp1.setY(data.numbers[Cy1Attribute]);
+	if (data.hasNumber(Cx2Attribute)) cp2.setX(data.numbers[Cx2Attribute]);
+	if (data.hasNumber(Cy2Attribute)) cp2.setY(data.numbers[Cy2Attribute]);
+	if (data.hasNumber(X2Attribute)) p2.setX(data.numbers[X2Attribute]);
+	if (data.hasNumber(Y2Attribute)) p2.setY(data.numbers[Y2Attribute]);
 	item->setCurve(p1, cp1, cp2, p2);
 
-	readItemStyle(item->style());
-
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingRectItem* DiagramReader::readRectItem()
+DrawingRectItem* DiagramReader::createRectItem(const ItemData& data)
 {
 	DrawingRectItem* item = new DrawingRectItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QRectF rect = item->rect();
-	if (attr.hasAttribute("left")) rect.setLeft(attr.value("left").toDouble());
-	if (attr.hasAttribute("top")) rect.setTop(attr.value("top").toDouble());
-	if (attr.hasAttribute("width")) rect.setWidth(attr.value("width").toDouble());
-	if (attr.hasAttribute("height")) rect.setHeight(attr.value("height").toDouble());
+	if (data.hasNumber(LeftAttribute)) rect.setLeft(data.numbers[LeftAttribute]);
+	if (data.hasNumber(TopAttribute)) rect.setTop(data.numbers[TopAttribute]);
+	if (data.hasNumber(WidthAttribute)) rect.setWidth(data.numbers[WidthAttribute]);
+	if (data.hasNumber(HeightAttribute)) rect.setHeight(data.numbers[HeightAttribute]);
 	item->setRect(rect);
 
-	if (attr.hasAttribute("rx")) item->setCornerRadii(attr.value("rx").toDouble(), item->cornerRadiusY());
-	if (attr.hasAttribute("ry")) item->setCornerRadii(item->cornerRadiusX(), attr.value("ry").toDouble());
-
-	readItemStyle(item->style());
+	if (data.hasNumber(RxAttribute)) item->setCornerRadii(data.numbers[RxAttribute], item->cornerRadiusY());
+	if (data.hasNumber(RyAttribute)) item->setCornerRadii(item->cornerRadiusX(), data.numbers[RyAttribute]);
 
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingEllipseItem* DiagramReader::readEllipseItem()
+DrawingEllipseItem* DiagramReader::createEllipseItem(const ItemData& data)
 {
 	DrawingEllipseItem* item = new DrawingEllipseItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QRectF rect = item->ellipse();
-	if (attr.hasAttribute("left")) rect.setLeft(attr.value("left").toDouble());
-	if (attr.hasAttribute("top")) rect.setTop(attr.value("top").toDouble());
-	if (attr.hasAttribute("width")) rect.setWidth(attr.value("width").toDouble());
-	if (attr.hasAttribute("height")) rect.setHeight(attr.value("height").toDouble());
+	if (data.hasNumber(LeftAttribute)) rect.setLeft(data.numbers[LeftAttribute]);
+	if (data.hasNumber(TopAttribute)) rect.setTop(data.numbers[TopAttribute]);
+	if (data.hasNumber(WidthAttribute)) rect.setWidth(data.numbers[WidthAttribute]);
+	if (data.hasNumber(HeightAttribute)) rect.setHeight(data.numbers[HeightAttribute]);
 	item->setEllipse(rect);
 
-	readItemStyle(item->style());
-
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingPolygonItem* DiagramReader::readPolygonItem()
+DrawingPolygonItem* DiagramReader::createPolygonItem(const ItemData& data)
 {
 	DrawingPolygonItem* item = new DrawingPolygonItem();
-	QXmlStreamAttributes attr = attributes();
-
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
 
-	if (attr.hasAttribute("points"))
-		item->setPolygon(pointsFromString(attr.value("points").toString()));
+	applyItemTransform(data, item);
 
-	readItemStyle(item->style());
+	if (data.hasPoints) item->setPolygon(data.points);
 
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingTextItem* DiagramReader::readTextItem()
+DrawingTextItem* DiagramReader::createTextItem(const ItemData& data)
 {
 	DrawingTextItem* item = new DrawingTextItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
-	readItemStyle(item->style());
+	applyItemStyle(data, item->style());
 
-	if (readNext() == QXmlStreamReader::Characters)
-	{
-		item->setCaption(text().toString());
-		skipCurrentElement();
-	}
+	if (data.hasCaption) item->setCaption(data.caption);
 
 	return item;
 }
 
-DrawingTextRectItem* DiagramReader::readTextRectItem()
+DrawingTextRectItem* DiagramReader::createTextRectItem(const ItemData& data)
 {
 	DrawingTextRectItem* item = new DrawingTextRectItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QRectF rect = item->rect();
-	if (attr.hasAttribute("left")) rect.setLeft(attr.value("left").toDouble());
-	if (attr.hasAttribute("top")) rect.setTop(attr.value("top").toDouble());
-	if (attr.hasAttribute("width")) rect.setWidth(attr.value("width").toDouble());
-	if (attr.hasAttribute("height")) rect.setHeight(attr.value("height").toDouble());
+	if (data.hasNumber(LeftAttribute)) rect.setLeft(data.numbers[LeftAttribute]);
+	if (data.hasNumber(TopAttribute)) rect.setTop(data.numbers[TopAttribute]);
+	if (data.hasNumber(WidthAttribute)) rect.setWidth(data.numbers[WidthAttribute]);
+	if (data.hasNumber(HeightAttribute)) rect.setHeight(data.numbers[HeightAttribute]);
 	item->setRect(rect);
 
-	if (attr.hasAttribute("rx")) item->setCornerRadii(attr.value("rx").toDouble(), item->cornerRadiusY());
-	if (attr.hasAttribute("ry")) item->setCornerRadii(item->cornerRadiusX(), attr.value("ry").toDouble());
+	if (data.hasNumber(RxAttribute)) item->setCornerRadii(data.numbers[RxAttribute], item->cornerRadiusY());
+	if (data.hasNumber(RyAttribute)) item->setCornerRadii(item->cornerRadiusX(), data.numbers[RyAttribute]);
 
-	readItemStyle(item->style());
+	applyItemStyle(data, item->style());
 
-	if (readNext() == QXmlStreamReader::Characters)
-	{
-		item->setCaption(text().toString());
-		skipCurrentElement();
-	}
+	if (data.hasCaption) item->setCaption(data.caption);
 
 	return item;
 }
 
-DrawingTextEllipseItem* DiagramReader::readTextEllipseItem()
+DrawingTextEllipseItem* DiagramReader::createTextEllipseItem(const ItemData& data)
 {
 	DrawingTextEllipseItem* item = new DrawingTextEllipseItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QRectF rect = item->ellipse();
-	if (attr.hasAttribute("left")) rect.setLeft(attr.value("left").toDouble());
-	if (attr.hasAttribute("top")) rect.setTop(attr.value("top").toDouble());
-	if (attr.hasAttribute("width")) rect.setWidth(attr.value("width").toDouble());
-	if (attr.hasAttribute("height")) rect.setHeight(attr.value("height").toDouble());
+	if (data.hasNumber(LeftAttribute)) rect.setLeft(data.numbers[LeftAttribute]);
+	if (data.hasNumber(TopAttribute)) rect.setTop(data.numbers[TopAttribute]);
+	if (data.hasNumber(WidthAttribute)) rect.setWidth(data.numbers[WidthAttribute]);
+	if (data.hasNumber(HeightAttribute)) rect.setHeight(data.numbers[HeightAttribute]);
 	item->setEllipse(rect);
 
-	readItemStyle(item->style());
+	applyItemStyle(data, item->style());
 
-	if (readNext() == QXmlStreamReader::Characters)
-	{
-		item->setCaption(text().toString());
-		skipCurrentElement();
-	}
+	if (data.hasCaption) item->setCaption(data.caption);
 
 	return item;
 }
 
-DrawingTextPolygonItem* DiagramReader::readTextPolygonItem()
+DrawingTextPolygonItem* DiagramReader::createTextPolygonItem(const ItemData& data)
 {
 	DrawingTextPolygonItem* item = new DrawingTextPolygonItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
-	if (attr.hasAttribute("points"))
-		item->setPolygon(pointsFromString(attr.value("points").toString()));
+	if (data.hasPoints) item->setPolygon(data.points);
 
-	readItemStyle(item->style());
+	applyItemStyle(data, item->style());
 
-	if (readNext() == QXmlStreamReader::Characters)
-	{
-		item->setCaption(text().toString());
-		skipCurrentElement();
-	}
+	if (data.hasCaption) item->setCaption(data.caption);
 
 	return item;
 }
 
-DrawingPathItem* DiagramReader::readPathItem()
+DrawingPathItem* DiagramReader::createPathItem(const ItemData& data)
 {
 	DrawingPathItem* item = new DrawingPathItem();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("name")) item->setName(attr.value("name").toString());
+	if (!data.name.isNull()) item->setName(data.name);
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
 	QRectF pathRect = item->pathRect();
-	if (attr.hasAttribute("view-left")) pathRect.setLeft(attr.value("view-left").toDouble());
-	if (attr.hasAttribute("view-top")) pathRect.setTop(attr.value("view-top").toDouble());
-	if (attr.hasAttribute("view-width")) pathRect.setWidth(attr.value("view-width").toDouble());
-	if (attr.hasAttribute("view-height")) pathRect.setHeight(attr.value("view-height").toDouble());
+	if (data.hasNumber(ViewLeftAttribute)) pathRect.setLeft(data.numbers[ViewLeftAttribute]);
+	if (data.hasNumber(ViewTopAttribute)) pathRect.setTop(data.numbers[ViewTopAttribute]);
+	if (data.hasNumber(ViewWidthAttribute)) pathRect.setWidth(data.numbers[ViewWidthAttribute]);
+	if (data.hasNumber(ViewHeightAttribute)) pathRect.setHeight(data.numbers[ViewHeightAttribute]);
 	item->setPath(item->path(), pathRect);
 
-	if (attr.hasAttribute("d"))
-		item->setPath(pathFromString(attr.value("d").toString()), pathRect);
+	if (data.hasPath) item->setPath(data.path, pathRect);
 
 	QRectF rect = item->rect();
-	if (attr.hasAttribute("left")) rect.setLeft(attr.value("left").toDouble());
-	if (attr.hasAttribute("top")) rect.setTop(attr.value("top").toDouble());
-	if (attr.hasAttribute("width")) rect.setWidth(attr.value("width").toDouble());
-	if (attr.hasAttribute("height")) rect.setHeight(attr.value("height").toDouble());
+	if (data.hasNumber(LeftAttribute)) rect.setLeft(data.numbers[LeftAttribute]);
+	if (data.hasNumber(TopAttribute)) rect.setTop(data.numbers[TopAttribute]);
+	if (data.hasNumber(WidthAttribute)) rect.setWidth(data.numbers[WidthAttribute]);
+	if (data.hasNumber(HeightAttribute)) rect.setHeight(data.numbers[HeightAttribute]);
 	item->setRect(rect);
 
-	if (attr.hasAttribute("glue-points"))
-		item->addConnectionPoints(pointsFromString(attr.value("glue-points").toString()));
-
-	readItemStyle(item->style());
+	if (data.hasPoints) item->addConnectionPoints(data.points);
 
-	skipCurrentElement();
+	applyItemStyle(data, item->style());
 
 	return item;
 }
 
-DrawingItemGroup* DiagramReader::readItemGroup()
+DrawingItemGroup* DiagramReader::createItemGroup(const ItemData& data)
 {
 	DrawingItemGroup* item = new DrawingItemGroup();
-	QXmlStreamAttributes attr = attributes();
 
-	if (attr.hasAttribute("transform")) transformFromString(attr.value("transform").toString(), item);
+	applyItemTransform(data, item);
 
-	item->setItems(readItemElements());
+	QList<DrawingItem*> items = createItems(data.children);
+	connectItems(items);
+	item->setItems(items);
 
 	return item;
 }
 
 //==================================================================================================
 
-void DiagramReader::readItemStyle(DrawingItemStyle* style)
+void DiagramReader::applyItemTransform(const ItemData& data, DrawingItem* item)
 {
-	QXmlStreamAttributes attr = attributes();
-
-	// Pen
-	if (style->hasValue(DrawingItemStyle::PenStyle))
-	{
-		Qt::PenStyle penStyle = (attr.hasAttribute("stroke-style")) ?
-			penStyleFromString(attr.value("stroke-style").toString()) :	Qt::SolidLine;
-		style->setValue(DrawingItemStyle::PenStyle, (uint)penStyle);
-	}
-
-	if (style->hasValue(DrawingItemStyle::PenWidth))
-	{
-		qreal penWidth = (attr.hasAttribute("stroke-width")) ? attr.value("stroke-width").toDouble() : 1.0;
-		style->setValue(DrawingItemStyle::PenWidth, penWidth);
-	}
-
-	if (style->hasValue(DrawingItemStyle::PenColor))
-	{
-		QColor color = (attr.hasAttribute("stroke-color")) ?
-			colorFromString(attr.value("stroke-color").toString()) : QColor(0, 0, 0);
-		style->setValue(DrawingItemStyle::PenColor, color);
-	}
-
-	if (style->hasValue(DrawingItemStyle::PenOpacity))
+	if (data.hasPosition)
 	{
-		qreal opacity = (attr.hasAttribute("stroke-opacity")) ?	attr.value("stroke-opacity").toDouble() : 1.0;
-		style->setValue(DrawingItemStyle::PenOpacity, opacity);
+		item->setX(data.position.x());
+		item->setY(data.position.y());
 	}
 
-	// Brush
-	if (style->hasValue(DrawingItemStyle::BrushColor))
-	{
-		QColor color = (attr.hasAttribute("fill-color")) ?
-			colorFromString(attr.value("fill-color").toString()) : QColor(255, 255, 255);
-		style->setValue(DrawingItemStyle::BrushColor, color);
-	}
-
-	if (style->hasValue(DrawingItemStyle::BrushOpacity))
-	{
-		qreal opacity = (attr.hasAttribute("fill-opacity")) ? attr.value("fill-opacity").toDouble() : 1.0;
-		style->setValue(DrawingItemStyle::BrushOpacity, opacity);
-	}
-
-	// Font
-	if (style->hasValue(DrawingItemStyle::FontName))
-	{
-		QString name = (attr.hasAttribute("font-name")) ? attr.value("font-name").toString() : "Arial";
-		style->setValue(DrawingItemStyle::FontName, name);
-	}
-
-	if (style->hasValue(DrawingItemStyle::FontSize))
-	{
-		qreal size = (attr.hasAttribute("font-size")) ? attr.value("font-size").toDouble() : 0.0;
-		style->setValue(DrawingItemStyle::FontSize, size);
-	}
-
-	if (style->hasValue(DrawingItemStyle::FontBold))
-	{
-		bool fontStyle = (attr.hasAttribute("font-bold")) ?
-			(attr.value("font-bold").toString().toLower() == "true") : false;
-		style->setValue(DrawingItemStyle::FontBold, fontStyle);
-	}
-
-	if (style->hasValue(DrawingItemStyle::FontItalic))
-	{
-		bool fontStyle = (attr.hasAttribute("font-italic")) ?
-			(attr.value("font-italic").toString().toLower() == "true") : false;
-		style->setValue(DrawingItemStyle::FontItalic, fontStyle);
-	}
-
-	if (style->hasValue(DrawingItemStyle::FontUnderline))
-	{
-		bool fontStyle = (attr.hasAttribute("font-underline")) ?
-			(attr.value("font-underline").toString().toLower() == "true") : false;
-		style->setValue(DrawingItemStyle::FontUnderline, fontStyle);
-	}
-
-	if (style->hasValue(DrawingItemStyle::FontStrikeThrough))
-	{
-		bool fontStyle = (attr.hasAttribute("font-strike-through")) ?
-			(attr.value("font-strike-through").toString().toLower() == "true") : false;
-		style->setValue(DrawingItemStyle::FontStrikeThrough, fontStyle);
-	}
-
-	if (style->hasValue(DrawingItemStyle::TextHorizontalAlignment))
-	{
-		Qt::Alignment textAlign = (attr.hasAttribute("text-alignment-horizontal")) ?
-			alignmentFromString(attr.value("text-alignment-horizontal").toString()) : Qt::AlignHCenter;
-		style->setValue(DrawingItemStyle::TextHorizontalAlignment, (uint)textAlign);
-	}
-
-	if (style->hasValue(DrawingItemStyle::TextVerticalAlignment))
-	{
-		Qt::Alignment textAlign = (attr.hasAttribute("text-alignment-vertical")) ?
-			alignmentFromString(attr.value("text-alignment-vertical").toString()) : Qt::AlignVCenter;
-		style->setValue(DrawingItemStyle::TextVerticalAlignment, (uint)textAlign);
-	}
-
-	if (style->hasValue(DrawingItemStyle::TextColor))
-	{
-		QColor color = (attr.hasAttribute("text-color")) ?
-			colorFromString(attr.value("text-color").toString()) : QColor(0, 0, 0);
-		style->setValue(DrawingItemStyle::TextColor, color);
-	}
-
-	if (style->hasValue(DrawingItemStyle::TextOpacity))
-	{
-		qreal opacity = (attr.hasAttribute("text-opacity")) ? attr.value("text-opacity").toDouble() : 1.0;
-		style->setValue(DrawingItemStyle::TextOpacity, opacity);
-	}
-
-	// Arrows
-	if (style->hasValue(DrawingItemStyle::StartArrowStyle))
-	{
-		DrawingItemStyle::ArrowStyle arrow = (attr.hasAttribute("arrow-start-style")) ?
-			arrowStyleFromString(attr.value("arrow-start-style").toString()) : DrawingItemStyle::ArrowNone;
-		style->setValue(DrawingItemStyle::StartArrowStyle, (uint)arrow);
-	}
-
-	if (style->hasValue(DrawingItemStyle::StartArrowSize))
-	{
-		qreal size = (attr.hasAttribute("arrow-start-size")) ? attr.value("arrow-start-size").toDouble() : 0.0;
-		style->setValue(DrawingItemStyle::StartArrowSize, size);
-	}
-
-	if (style->hasValue(DrawingItemStyle::EndArrowStyle))
-	{
-		DrawingItemStyle::ArrowStyle arrow = (attr.hasAttribute("arrow-end-style")) ?
-			arrowStyleFromString(attr.value("arrow-end-style").toString()) : DrawingItemStyle::ArrowNone;
-		style->setValue(DrawingItemStyle::EndArrowStyle, (uint)arrow);
-	}
+	for(auto transformIter = data.transforms.begin(); transformIter != data.transforms.end(); transformIter++)
+		item->setTransform(*transformIter, true);
+}
 
-	if (style->hasValue(DrawingItemStyle::EndArrowSize))
+void DiagramReader::applyItemStyle(const ItemData& data, DrawingItemStyle* style)
+{
+	for(auto styleIter = data.style.begin(); styleIter != data.style.end(); styleIter++)
 	{
-		qreal size = (attr.hasAttribute("arrow-end-size")) ? attr.value("arrow-end-size").toDouble() : 0.0;
-		style->setValue(DrawingItemStyle::EndArrowSize, size);
+		if (style->hasValue(styleIter.key())) style->setValue(styleIter.key(), styleIter.value());
 	}
 }
 
 //==================================================================================================
 
-Qt::Alignment DiagramReader::alignmentFromString(const QString& str) const
+Qt::Alignment DiagramReader::alignmentFromString(const QStringRef& str) const
 {
 	Qt::Alignment align;
 
@@ -632,7 +824,7 @@ Qt::Alignment DiagramReader::alignmentFromString(const QString& str) const
 	return align;
 }
 
-DrawingItemStyle::ArrowStyle DiagramReader::arrowStyleFromString(const QString& str) const
+DrawingItemStyle::ArrowStyle DiagramReader::arrowStyleFromString(const QStringRef& str) const
 {
 	DrawingItemStyle::ArrowStyle style = DrawingItemStyle::ArrowNone;
 
@@ -653,7 +845,7 @@ DrawingItemStyle::ArrowStyle DiagramReader::arrowStyleFromString(const QString&
 	return style;
 }
 
-QColor DiagramReader::colorFromString(const QString& str) const
+QColor DiagramReader::colorFromString(const QStringRef& str) const
 {
 	QColor color;
 
@@ -664,7 +856,7 @@ QColor DiagramReader::colorFromString(const QString& str) const
 	return color;
 }
 
-DiagramWidget::GridRenderStyle DiagramReader::gridStyleFromString(const QString& str) const
+DiagramWidget::GridRenderStyle DiagramReader::gridStyleFromString(const QStringRef& str) const
 {
 	DiagramWidget::GridRenderStyle style = DiagramWidget::GridNone;
 
@@ -675,44 +867,13 @@ DiagramWidget::GridRenderStyle DiagramReader::gridStyleFromString(const QString&
 	return style;
 }
 
-QPainterPath DiagramReader::pathFromString(const QString& str) const
+QPainterPath DiagramReader::pathFromString(const QStringRef& str) const
 {
-	QPainterPath path;
-
-	QStringList tokenList = str.split(" ", QString::SkipEmptyParts);
-	qreal x, y, x1, y1, x2, y2;
-	bool xOk = false, yOk = false, x1Ok = false, x2Ok = false, y1Ok = false, y2Ok = false;
-
-	for(int i = 0; i < tokenList.size(); i++)
-	{
-		if (tokenList[i] == "M" && i+2 < tokenList.size())
-		{
-			x = tokenList[i+1].toDouble(&xOk);
-			y = tokenList[i+2].toDouble(&yOk);
-			if (xOk && yOk) path.moveTo(x, y);
-		}
-		else if (tokenList[i] == "L" && i+2 < tokenList.size())
-		{
-			x = tokenList[i+1].toDouble(&xOk);
-			y = tokenList[i+2].toDouble(&yOk);
-			if (xOk && yOk) path.lineTo(x, y);
-		}
-		else if (tokenList[i] == "C" && i+6 < tokenList.size())
-		{
-			x1 = tokenList[i+1].toDouble(&x1Ok);
-			y1 = tokenList[i+2].toDouble(&y1Ok);
-			x2 = tokenList[i+3].toDouble(&x2Ok);
-			y2 = tokenList[i+4].toDouble(&y2Ok);
-			x = tokenList[i+5].toDouble(&xOk);
-			y = tokenList[i+6].toDouble(&yOk);
-			if (x1Ok && y1Ok && x2Ok && y2Ok && xOk && yOk) path.cubicTo(x1, y1, x2, y2, x, y);
-		}
-	}
-
-	return path;
+	DiagramPathScanner scanner(str);
+	return scanner.readPath();
 }
 
-Qt::PenStyle DiagramReader::penStyleFromString(const QString& str) const
+Qt::PenStyle DiagramReader::penStyleFromString(const QStringRef& str) const
 {
 	Qt::PenStyle style = Qt::SolidLine;
 
@@ -725,7 +886,7 @@ Qt::PenStyle DiagramReader::penStyleFromString(const QString& str) const
 	return style;
 }
 
-Qt::PenCapStyle DiagramReader::penCapStyleFromString(const QString& str) const
+Qt::PenCapStyle DiagramReader::penCapStyleFromString(const QStringRef& str) const
 {
 	Qt::PenCapStyle style = Qt::RoundCap;
 
@@ -735,7 +896,7 @@ Qt::PenCapStyle DiagramReader::penCapStyleFromString(const QString& str) const
 	return style;
 }
 
-Qt::PenJoinStyle DiagramReader::penJoinStyleFromString(const QString& str) const
+Qt::PenJoinStyle DiagramReader::penJoinStyleFromString(const QStringRef& str) const
 {
 	Qt::PenJoinStyle style = Qt::RoundJoin;
 
@@ -745,30 +906,13 @@ Qt::PenJoinStyle DiagramReader::penJoinStyleFromString(const QString& str) const
 	return style;
 }
 
-QPolygonF DiagramReader::pointsFromString(const QString& str) const
+QPolygonF DiagramReader::pointsFromString(const QStringRef& str) const
 {
-	QPolygonF points;
-
-	QStringList tokenList = str.split(" ");
-	QStringList coordList;
-	qreal x, y;
-	bool xOk = false, yOk = false;
-
-	for(int i = 0; i < tokenList.size(); i++)
-	{
-		coordList = tokenList[i].split(",");
-		if (coordList.size() == 2)
-		{
-			x = coordList[0].toDouble(&xOk);
-			y = coordList[1].toDouble(&yOk);
-			if (xOk && yOk) points.append(QPointF(x, y));
-		}
-	}
-
-	return points;
+	DiagramPathScanner scanner(str);
+	return scanner.readPoints();
 }
 
-void DiagramReader::transformFromString(const QString& str, DrawingItem* item)
+void DiagramReader::transformFromString(const QString& str, ItemData& data) const
 {
 	QStringList tokens = str.split(QRegExp("\\s+"));
 	for(auto tokenIter = tokens.begin(); tokenIter != tokens.end(); tokenIter++)
@@ -780,8 +924,8 @@ void DiagramReader::transformFromString(const QString& str, DrawingItem* item)
 
 			if (coords.size() == 2)
 			{
-				item->setX(coords.first().toDouble());
-				item->setY(coords.last().toDouble());
+				data.position = QPointF(coords.first().toDouble(), coords.last().toDouble());
+				data.hasPosition = true;
 			}
 		}
 		else if (tokenIter->startsWith("rotate("))
@@ -791,7 +935,7 @@ void DiagramReader::transformFromString(const QString& str, DrawingItem* item)
 
 			QTransform transform;
 			transform.rotate(angle.toDouble());
-			item->setTransform(transform, true);
+			data.transforms.append(transform);
 		}
 		else if (tokenIter->startsWith("scale("))
 		{
@@ -801,7 +945,7 @@ void DiagramReader::transformFromString(const QString& str, DrawingItem* item)
 			{
 				QTransform transform;
 				transform.scale(coords.first().toDouble(), coords.last().toDouble());
-				item->setTransform(transform, true);
+				data.transforms.append(transform);
 			}
 		}
 	}
@@ -32,36 +32,96 @@ public:
 
 	void read(DiagramWidget* diagram);
 	void readItems(QList<DrawingItem*>& items);
+	DrawingItem* readItem();
+
+	static void connectItems(const QList<DrawingItem*>& items, int firstNewItem = 0);
 
 private:
+	// Attributes the reader understands.  The numeric attributes come first so that their values
+	// can be stored in a fixed array indexed by name.
+	enum AttributeName { X1Attribute, Y1Attribute, X2Attribute, Y2Attribute, Cx1Attribute, Cy1Attribute,
+		Cx2Attribute, Cy2Attribute, LeftAttribute, TopAttribute, WidthAttribute, HeightAttribute,
+		RxAttribute, RyAttribute, ViewLeftAttribute, ViewTopAttribute, ViewWidthAttribute, ViewHeightAttribute,
+		NameAttribute, TransformAttribute, PointsAttribute, GluePointsAttribute, PathAttribute,
+		StrokeStyleAttribute, StrokeWidthAttribute, StrokeColorAttribute, StrokeOpacityAttribute,
+		FillColorAttribute, FillOpacityAttribute, FontNameAttribute, FontSizeAttribute, FontBoldAttribute,
+		FontItalicAttribute, FontUnderlineAttribute, FontStrikeThroughAttribute,
+		TextAlignmentHorizontalAttribute, TextAlignmentVerticalAttribute, TextColorAttribute,
+		TextOpacityAttribute, ArrowStartStyleAttribute, ArrowStartSizeAttribute, ArrowEndStyleAttribute,
+		ArrowEndSizeAttribute, NumberOfAttributes };
+	static const int NumberOfNumberAttributes = ViewHeightAttribute + 1;
+
+	// An attribute value stored as a span of the item's attributeText
+	struct ItemAttribute
+	{
+		quint8 name;
+		int start;
+		int length;
+	};
+
+	struct ItemData
+	{
+		QString type;
+		QString attributeText;
+		QVector<ItemAttribute> attributes;
+		QList<ItemData> children;
+
+		QString name;
+		bool hasPosition = false;
+		QPointF position;
+		QList<QTransform> transforms;
+		quint32 numberFlags = 0;
+		qreal numbers[NumberOfNumberAttributes];
+		bool hasPoints = false;
+		QPolygonF points;
+		bool hasPath = false;
+		QPainterPath path;
+		bool hasCaption = false;
+		QString caption;
+		QHash<DrawingItemStyle::Property,QVariant> style;
+
+		bool hasNumber(AttributeName name) const { return (numberFlags & (1u << name)); }
+	};
+
 	QList<DrawingItem*> readItemElements();
 
-	DrawingLineItem* readLineItem();
-	DrawingArcItem* readArcItem();
-	DrawingPolylineItem* readPolylineItem();
-	DrawingCurveItem* readCurveItem();
-	DrawingRectItem* readRectItem();
-	DrawingEllipseItem* readEllipseItem();
-	DrawingPolygonItem* readPolygonItem();
-	DrawingTextItem* readTextItem();
-	DrawingTextRectItem* readTextRectItem();
-	DrawingTextEllipseItem* readTextEllipseItem();
-	DrawingTextPolygonItem* readTextPolygonItem();
-	DrawingPathItem* readPathItem();
-	DrawingItemGroup* readItemGroup();
-
-	void readItemStyle(DrawingItemStyle* style);
-
-	Qt::Alignment alignmentFromString(const QString& str) const;
-	DrawingItemStyle::ArrowStyle arrowStyleFromString(const QString& str) const;
-	QColor colorFromString(const QString& str) const;
-	DiagramWidget::GridRenderStyle gridStyleFromString(const QString& str) const;
-	QPainterPath pathFromString(const QString& str) const;
-	Qt::PenStyle penStyleFromString(const QString& str) const;
-	Qt::PenCapStyle penCapStyleFromString(const QString& str) const;
-	Qt::PenJoinStyle penJoinStyleFromString(const QString& str) const;
-	QPolygonF pointsFromString(const QString& str) const;
-	void transformFromString(const QString& str, DrawingItem* item);
+	bool isItemElement(const QStringRef& elementName) const;
+	ItemData readItemData();
+	int attributeNameFromString(const QStringRef& str) const;
+	QStringRef attributeValue(const ItemData& data, AttributeName name) const;
+
+	QList<ItemData> parseItemBatch(QList<ItemData> batch) const;
+	void parseItemData(ItemData& data) const;
+	QHash<DrawingItemStyle::Property,QVariant> parseItemStyle(const ItemData& data) const;
+
+	QList<DrawingItem*> createItems(const QList<ItemData>& dataList);
+	DrawingLineItem* createLineItem(const ItemData& data);
+	DrawingArcItem* createArcItem(const ItemData& data);
+	DrawingPolylineItem* createPolylineItem(const ItemData& data);
+	DrawingCurveItem* createCurveItem(const ItemData& data);
+	DrawingRectItem* createRectItem(const ItemData& data);
+	DrawingEllipseItem* createEllipseItem(const ItemData& data);
+	DrawingPolygonItem* createPolygonItem(const ItemData& data);
+	DrawingTextItem* createTextItem(const ItemData& data);
+	DrawingTextRectItem* createTextRectItem(const ItemData& data);
+	DrawingTextEllipseItem* createTextEllipseItem(const ItemData& data);
+	DrawingTextPolygonItem* createTextPolygonItem(const ItemData& data);
+	DrawingPathItem* createPathItem(const ItemData& data);
+	DrawingItemGroup* createItemGroup(const ItemData& data);
+
+	void applyItemTransform(const ItemData& data, DrawingItem* item);
+	void applyItemStyle(const ItemData& data, DrawingItemStyle* style);
+
+	Qt::Alignment alignmentFromString(const QStringRef& str) const;
+	DrawingItemStyle::ArrowStyle arrowStyleFromString(const QStringRef& str) const;
+	QColor colorFromString(const QStringRef& str) const;
+	DiagramWidget::GridRenderStyle gridStyleFromString(const QStringRef& str) const;
+	QPainterPath pathFromString(const QStringRef& str) const;
+	Qt::PenStyle penStyleFromString(const QStringRef& str) const;
+	Qt::PenCapStyle penCapStyleFromString(const QStringRef& str) const;
+	Qt::PenJoinStyle penJoinStyleFromString(const QStringRef& str) const;
+	QPolygonF pointsFromString(const QStringRef& str) const;
+	void transformFromString(const QString& str, ItemData& data) const;
 };
 
 #endif
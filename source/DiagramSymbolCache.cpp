@@ -0,0 +1,224 @@
+/* DiagramSymbolCache.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramSymbolCache.h"
+
+// Symbols larger than this on screen are cheaper to draw than to keep as sprites
+static const int DiagramSymbolCacheMaxSpriteSize = 512;
+
+DiagramSymbolCache::DiagramSymbolCache(int maximumSizeKB) : mSprites(maximumSizeKB)
+{
+	mNextSymbolId = 0;
+	mHits = 0;
+	mMisses = 0;
+}
+
+DiagramSymbolCache::~DiagramSymbolCache() { }
+
+//==================================================================================================
+
+DiagramSymbolCache::Symbol DiagramSymbolCache::symbol(DrawingPathItem* item)
+{
+	auto symbolIter = mItemSymbols.find(item);
+
+	if (symbolIter == mItemSymbols.end())
+	{
+		Symbol symbol;
+
+		symbol.id = symbolId(item);
+		symbol.boundingRect = item->boundingRect();
+
+		QPainter picturePainter(&symbol.picture);
+		item->render(&picturePainter);
+		picturePainter.end();
+
+		symbolIter = mItemSymbols.insert(item, symbol);
+	}
+
+	return symbolIter.value();
+}
+
+void DiagramSymbolCache::invalidateItem(DrawingItem* item)
+{
+	auto symbolIter = mItemSymbols.find(item);
+
+	if (symbolIter != mItemSymbols.end())
+	{
+		releaseSymbolId(symbolIter->id);
+		mItemSymbols.erase(symbolIter);
+	}
+}
+
+void DiagramSymbolCache::invalidateAllItems()
+{
+	mItemSymbols.clear();
+	mSymbolIds.clear();
+	mSymbolIdentities.clear();
+}
+
+//==================================================================================================
+
+void DiagramSymbolCache::drawSymbol(QPainter* painter, const Symbol& symbol)
+{
+	QTransform deviceTransform = painter->deviceTransform();
+	QTransform linearTransform(deviceTransform.m11(), deviceTransform.m12(),
+		deviceTransform.m21(), deviceTransform.m22(), 0, 0);
+	QRectF spriteRect = linearTransform.mapRect(symbol.boundingRect).adjusted(-1, -1, 1, 1);
+	quint64 key = 0;
+
+	if (spriteRect.width() > DiagramSymbolCacheMaxSpriteSize || spriteRect.height() > DiagramSymbolCacheMaxSpriteSize ||
+		!spriteKey(symbol.id, linearTransform, key))
+	{
+		painter->drawPicture(QPointF(0, 0), symbol.picture);
+		return;
+	}
+
+	QImage sprite;
+	QPoint spriteOffset(qFloor(spriteRect.left()), qFloor(spriteRect.top()));
+
+	mMutex.lock();
+	QImage* cachedSprite = mSprites.object(key);
+	if (cachedSprite)
+	{
+		sprite = *cachedSprite;
+		mHits++;
+	}
+	else mMisses++;
+	mMutex.unlock();
+
+	if (sprite.isNull())
+	{
+		sprite = QImage(qCeil(spriteRect.right()) - spriteOffset.x(), qCeil(spriteRect.bottom()) - spriteOffset.y(),
+			QImage::Format_ARGB32_Premultiplied);
+		sprite.fill(Qt::transparent);
+
+		QPainter spritePainter(&sprite);
+		spritePainter.setRenderHints(painter->renderHints());
+		spritePainter.setTransform(linearTransform * QTransform::fromTranslate(-spriteOffset.x(), -spriteOffset.y()));
+		spritePainter.drawPicture(QPointF(0, 0), symbol.picture);
+		spritePainter.end();
+
+		mMutex.lock();
+		mSprites.insert(key, new QImage(sprite), qMax(1, sprite.byteCount() / 1024));
+		mMutex.unlock();
+	}
+
+	// The sprite is drawn at the nearest whole device pixel
+	qreal devicePixelRatio = painter->device()->devicePixelRatioF();
+	QPointF devicePos(deviceTransform.dx() + spriteOffset.x(), deviceTransform.dy() + spriteOffset.y());
+
+	painter->save();
+	painter->setTransform(QTransform::fromScale(1 / devicePixelRatio, 1 / devicePixelRatio));
+	painter->drawImage(QPoint(qRound(devicePos.x()), qRound(devicePos.y())), sprite);
+	painter->restore();
+}
+
+void DiagramSymbolCache::clear()
+{
+	// Only the sprites; the captured symbols stay valid until their items change
+	mMutex.lock();
+	mSprites.clear();
+	mMutex.unlock();
+}
+
+void DiagramSymbolCache::takeStatistics(int& hits, int& misses)
+{
+	mMutex.lock();
+	hits = mHits;
+	misses = mMisses;
+	mHits = 0;
+	mMisses = 0;
+	mMutex.unlock();
+}
+
+//==================================================================================================
+
+quint32 DiagramSymbolCache::symbolId(DrawingPathItem* item)
+{
+	QByteArray identity;
+	QDataStream stream(&identity, QIODevice::WriteOnly);
+	DrawingItemStyle* style = item->style();
+
+	stream << item->path() << item->pathRect() << item->rect();
+
+	for(int i = 0; i < DrawingItemStyle::NumberOfProperties; i++)
+	{
+		DrawingItemStyle::Property property = (DrawingItemStyle::Property)i;
+		stream << (style->hasValue(property) ? style->value(property) : DrawingItemStyle::defaultValue(property));
+	}
+
+	auto idIter = mSymbolIds.find(identity);
+	if (idIter == mSymbolIds.end())
+	{
+		SymbolIdentity symbolIdentity;
+		symbolIdentity.identity = identity;
+		symbolIdentity.references = 0;
+
+		idIter = mSymbolIds.insert(identity, mNextSymbolId++);
+		mSymbolIdentities.insert(idIter.value(), symbolIdentity);
+	}
+
+	mSymbolIdentities[idIter.value()].references++;
+
+	return idIter.value();
+}
+
+void DiagramSymbolCache::releaseSymbolId(quint32 id)
+{
+	// The id's sprites are left to age out of the sprite cache
+	auto identityIter = mSymbolIdentities.find(id);
+
+	if (identityIter != mSymbolIdentities.end() && --identityIter->references <= 0)
+	{
+		mSymbolIds.remove(identityIter->identity);
+		mSymbolIdentities.erase(identityIter);
+	}
+}
+
+bool DiagramSymbolCache::spriteKey(quint32 id, const QTransform& linearTransform, quint64& key) const
+{
+	const qreal epsilon = 1E-6;
+	qreal a, b;
+	quint64 orientation = 0;
+
+	// Only the eight axis-aligned orientations with a uniform scale can share a sprite
+	if (qAbs(linearTransform.m12()) < epsilon && qAbs(linearTransform.m21()) < epsilon)
+	{
+		a = linearTransform.m11();
+		b = linearTransform.m22();
+	}
+	else if (qAbs(linearTransform.m11()) < epsilon && qAbs(linearTransform.m22()) < epsilon)
+	{
+		a = linearTransform.m12();
+		b = linearTransform.m21();
+		orientation |= 4;
+	}
+	else return false;
+
+	if (qAbs(qAbs(a) - qAbs(b)) > epsilon * qAbs(a) || qAbs(a) < epsilon) return false;
+
+	if (a < 0) orientation |= 2;
+	if (b < 0) orientation |= 1;
+
+	qint64 zoomBucket = qRound(std::log2(qAbs(a)) * 1024);
+
+	key = ((quint64)id << 32) | (orientation << 24) | ((quint64)zoomBucket & 0xFFFFFF);
+	return true;
+}
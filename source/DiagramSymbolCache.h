@@ -0,0 +1,83 @@
+/* DiagramSymbolCache.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMSYMBOLCACHE_H
+#define DIAGRAMSYMBOLCACHE_H
+
+#include <Drawing.h>
+
+// Shared raster cache for path items.  Each distinct symbol is rendered to a sprite once and
+// blitted for every instance.  A sprite is keyed by the symbol's identity (an id shared by all
+// items with the same path and style), its orientation (one of the eight 90 degree rotations and
+// flips) and its zoom level in buckets of 1/1024 of an octave.  Items at other angles are drawn
+// directly.
+//
+// Symbols are captured from their items on the GUI thread and kept until the item is invalidated,
+// so the path and style are only serialized once per change.  An id is dropped once no captured
+// symbol uses it any more and is never handed out again, so stale sprites are never matched.  The tile workers only draw the
+// captured symbols and never read the items themselves.  All access to the sprites is serialized;
+// sprites are rendered outside of the lock.  Exports draw path items directly and never go
+// through this cache.
+class DiagramSymbolCache
+{
+public:
+	struct Symbol
+	{
+		quint32 id;
+		QPicture picture;
+		QRectF boundingRect;
+	};
+
+private:
+	struct SymbolIdentity
+	{
+		QByteArray identity;
+		int references;
+	};
+
+	QHash<DrawingItem*,Symbol> mItemSymbols;
+	QHash<QByteArray,quint32> mSymbolIds;
+	QHash<quint32,SymbolIdentity> mSymbolIdentities;
+	quint32 mNextSymbolId;
+
+	QCache<quint64,QImage> mSprites;
+	QMutex mMutex;
+	int mHits, mMisses;
+
+public:
+	DiagramSymbolCache(int maximumSizeKB = 32768);
+	~DiagramSymbolCache();
+
+	Symbol symbol(DrawingPathItem* item);
+	void invalidateItem(DrawingItem* item);
+	void invalidateAllItems();
+
+	void drawSymbol(QPainter* painter, const Symbol& symbol);
+	void clear();
+
+	void takeStatistics(int& hits, int& misses);
+
+private:
+	quint32 symbolId(DrawingPathItem* item);
+	void releaseSymbolId(quint32 id);
+	bool spriteKey(quint32 id, const QTransform& linearTransform, quint64& key) const;
+};
+
+#endif
@@ -0,0 +1,833 @@
+/* DiagramTileCache.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramTileCache.h"
+#include "DiagramItemPlacement.h"
+#include <QtConcurrent>
+
+// Above this many added or removed items it is cheaper to redraw every tile
+static const int DiagramTileCacheMaxItemInvalidations = 1000;
+
+// Interval at which the view checks for finished tiles while jobs are in flight
+static const int DiagramTileCachePollInterval = 15;
+
+// Time a tile job may run before it yields, in milliseconds
+static const int DiagramTileCacheFrameBudget = 12;
+
+// Time the view may spend preparing new tiles and recording their item snapshots per frame, in
+// milliseconds.  At least one item snapshot is recorded per frame.
+static const int DiagramTileCacheSchedulingBudget = 6;
+
+// Items at least this large in device pixels are drawn in a new tile's coarse pass
+static const qreal DiagramTileCacheCoarseItemSize = 32;
+
+DiagramTileCache::DiagramTileCache(DiagramWidget* widget, int tileSize)
+{
+	// The default tile size is a multiple of the dotted grid pen's pattern length, so dotted grid
+	// lines continue seamlessly from one tile to the next
+	mWidget = widget;
+	mTileSize = tileSize;
+
+	mScale = 0;
+	mDevicePixelRatio = 0;
+	mPreviousScale = 0;
+
+	mItemListDirty = true;
+	mQueryStamp = 0;
+	mCellSize = 1;
+	mGridColumns = mGridRows = 0;
+
+	mStatistics.tileHits = mStatistics.tileMisses = 0;
+	mStatistics.itemsVisited = mStatistics.itemsDrawn = 0;
+	mStatistics.symbolHits = mStatistics.symbolMisses = 0;
+}
+
+DiagramTileCache::~DiagramTileCache()
+{
+	waitForJobs();
+}
+
+//==================================================================================================
+
+void DiagramTileCache::draw(QPainter* painter, const QRectF& visibleRect)
+{
+	qreal devicePixelRatio = mWidget->devicePixelRatio();
+	qreal scale = mWidget->scale() * devicePixelRatio;
+	QPointF offset(-visibleRect.left() * scale, -visibleRect.top() * scale);
+	QPointF phaseDelta = offset - mPhase;
+
+	mFrameTimer.start();
+
+	mStatistics.tileHits = mStatistics.tileMisses = 0;
+	mStatistics.itemsVisited = mStatistics.itemsDrawn = 0;
+
+	collectJobs();
+	mSymbolCache.takeStatistics(mStatistics.symbolHits, mStatistics.symbolMisses);
+
+	// Tiles stay valid as long as the view only moves by whole device pixels.  Otherwise the
+	// current tiles are kept as placeholders until the new ones are ready.
+	if (scale != mScale || devicePixelRatio != mDevicePixelRatio ||
+		qAbs(phaseDelta.x() - qRound(phaseDelta.x())) > 1E-3 || qAbs(phaseDelta.y() - qRound(phaseDelta.y())) > 1E-3)
+	{
+		if (!mTiles.isEmpty())
+		{
+			mPreviousTiles = mTiles;
+			mPreviousScale = mScale;
+			mPreviousPhase = mPhase;
+		}
+
+		cancelJobs();
+
+		mTiles.clear();
+		mDirtyTiles.clear();
+		mJobs.clear();
+		mPartialTiles.clear();
+		mPendingTiles.clear();
+
+		mScale = scale;
+		mDevicePixelRatio = devicePixelRatio;
+		mPhase = QPointF(offset.x() - qFloor(offset.x()), offset.y() - qFloor(offset.y()));
+		phaseDelta = offset - mPhase;
+	}
+
+	syncItems();
+
+	QPoint origin(qRound(phaseDelta.x()), qRound(phaseDelta.y()));
+	QSize deviceSize = mWidget->viewport()->size() * devicePixelRatio;
+	QRect range = tileRange(QRectF(-origin, deviceSize));
+	bool complete = true;
+	bool prepared = false;
+
+	for(int row = range.top(); row <= range.bottom(); row++)
+	{
+		for(int column = range.left(); column <= range.right(); column++)
+		{
+			quint64 key = tileKey(column, row);
+
+			if (!mTiles.contains(key) || mDirtyTiles.contains(key))
+			{
+				// Interrupted tiles are cheap to resume; new ones are only prepared while the frame
+				// has time left and are started once all of their snapshots are recorded
+				if (!mJobs.contains(key))
+				{
+					if (mPartialTiles.contains(key)) scheduleTile(column, row);
+					else if (!prepared || mFrameTimer.elapsed() < DiagramTileCacheSchedulingBudget)
+					{
+						auto pendingIter = mPendingTiles.find(key);
+						if (pendingIter == mPendingTiles.end())
+							pendingIter = mPendingTiles.insert(key, createTileRequest(column, row));
+
+						bool ready = prepareTileRequest(pendingIter.value(), !prepared);
+						prepared = true;
+						if (ready) scheduleTile(column, row);
+					}
+				}
+				mStatistics.tileMisses++;
+				complete = false;
+			}
+			else mStatistics.tileHits++;
+		}
+	}
+
+	painter->save();
+	painter->resetTransform();
+
+	if (!complete)
+	{
+		painter->fillRect(QRectF(QPointF(0, 0), QSizeF(deviceSize) / devicePixelRatio), mWidget->scene()->backgroundBrush());
+		drawPreviousTiles(painter, origin, deviceSize);
+	}
+
+	for(int row = range.top(); row <= range.bottom(); row++)
+	{
+		for(int column = range.left(); column <= range.right(); column++)
+		{
+			auto tileIter = mTiles.find(tileKey(column, row));
+
+			if (tileIter != mTiles.end())
+			{
+				painter->drawImage(QPointF(column * mTileSize + origin.x(), row * mTileSize + origin.y()) / devicePixelRatio,
+					tileIter.value());
+			}
+		}
+	}
+
+	painter->restore();
+
+	if (complete) mPreviousTiles.clear();
+
+	// Keep a ring of tiles around the view for panning, but do not let the cache grow unbounded
+	if (mTiles.size() > 2 * (range.width() + 2) * (range.height() + 2))
+		removeTiles(range.adjusted(-1, -1, 1, 1));
+
+	if (!mJobs.isEmpty() || !complete)
+		QTimer::singleShot(DiagramTileCachePollInterval, mWidget->viewport(), SLOT(update()));
+}
+
+//==================================================================================================
+
+void DiagramTileCache::invalidate(const QRectF& rect)
+{
+	if ((!mTiles.isEmpty() || !mJobs.isEmpty() || !mPartialTiles.isEmpty() || !mPendingTiles.isEmpty()) &&
+		rect.isValid())
+	{
+		// Pad for antialiasing and cosmetic pens that extend past the item's bounding rect
+		QRectF deviceRect(rect.left() * mScale + mPhase.x(), rect.top() * mScale + mPhase.y(),
+			rect.width() * mScale, rect.height() * mScale);
+		QRect range = tileRange(deviceRect.adjusted(-4 * mDevicePixelRatio, -4 * mDevicePixelRatio,
+			4 * mDevicePixelRatio, 4 * mDevicePixelRatio));
+
+		if ((qint64)range.width() * range.height() > mTiles.size() + mJobs.size() + mPartialTiles.size() +
+			mPendingTiles.size())
+		{
+			QList<quint64> keys = mTiles.keys() + mJobs.keys() + mPartialTiles.keys() + mPendingTiles.keys();
+
+			for(auto keyIter = keys.begin(); keyIter != keys.end(); keyIter++)
+			{
+				if (range.contains(tilePosition(*keyIter))) invalidateTile(*keyIter);
+			}
+		}
+		else
+		{
+			for(int row = range.top(); row <= range.bottom(); row++)
+			{
+				for(int column = range.left(); column <= range.right(); column++)
+					invalidateTile(tileKey(column, row));
+			}
+		}
+	}
+}
+
+void DiagramTileCache::invalidateItems(const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		QRectF rect = itemRect(*itemIter);
+		int index = mItemIndices.value(*itemIter, -1);
+
+		// Both the area the item used to cover and the one it covers now need to be redrawn.  Items
+		// the cache does not know yet are either new to the scene, which syncItems picks up, or
+		// placement previews that are drawn in the overlay.
+		mSnapshots.remove(*itemIter);
+		mSymbolCache.invalidateItem(*itemIter);
+
+		if (index >= 0)
+		{
+			invalidate(mItems[index].rect);
+			removeFromGrid(index);
+			mItems[index].rect = rect;
+			addToGrid(index);
+			invalidate(rect);
+		}
+	}
+}
+
+void DiagramTileCache::invalidateItemList()
+{
+	mItemListDirty = true;
+}
+
+void DiagramTileCache::removeItems(const QList<DrawingItem*>& items)
+{
+	// The items are dropped right away rather than on the next sync since they are about to be
+	// deleted.  Their slots stay in the list with no item until then.
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		int index = mItemIndices.value(*itemIter, -1);
+
+		mSnapshots.remove(*itemIter);
+		mSymbolCache.invalidateItem(*itemIter);
+
+		if (index >= 0)
+		{
+			invalidate(mItems[index].rect);
+			removeFromGrid(index);
+			mItems[index].item = nullptr;
+			mItemIndices.remove(*itemIter);
+		}
+	}
+
+	mItemListDirty = true;
+}
+
+void DiagramTileCache::clearItems()
+{
+	// Forgets every item, for when the scene's items have all been deleted at once
+	mItems.clear();
+	mItemIndices.clear();
+	mGrid.clear();
+	mLargeItems.clear();
+	mSymbolCache.invalidateAllItems();
+	mItemListDirty = true;
+
+	clear();
+}
+
+void DiagramTileCache::clear()
+{
+	// Existing tiles are still shown until their replacements are ready
+	mSnapshots.clear();
+
+	QList<quint64> keys = mTiles.keys() + mJobs.keys() + mPartialTiles.keys() + mPendingTiles.keys();
+
+	for(auto keyIter = keys.begin(); keyIter != keys.end(); keyIter++)
+		invalidateTile(*keyIter);
+}
+
+//==================================================================================================
+
+DiagramTileCache::Statistics DiagramTileCache::statistics() const
+{
+	return mStatistics;
+}
+
+void DiagramTileCache::cancelJobs()
+{
+	// Running jobs stop after their current item and queued ones return without drawing.  Both keep
+	// their progress and are picked up again when their tile is next scheduled.
+	mGeneration.ref();
+}
+
+void DiagramTileCache::waitForJobs()
+{
+	cancelJobs();
+
+	for(auto jobIter = mRunningJobs.begin(); jobIter != mRunningJobs.end(); jobIter++)
+		jobIter->waitForFinished();
+}
+
+//==================================================================================================
+
+void DiagramTileCache::syncItems()
+{
+	if (!mItemListDirty) return;
+
+	DrawingScene* scene = mWidget->scene();
+	QList<DrawingItem*> items = (scene) ? scene->items() : QList<DrawingItem*>();
+	bool changed = (items.size() != mItems.size());
+
+	mItemListDirty = false;
+
+	for(int i = 0; !changed && i < items.size(); i++)
+		changed = (items[i] != mItems[i].item);
+
+	if (changed)
+	{
+		// Find what was added, removed or reordered by comparing against the last known item list
+		QVector<ItemEntry> newItems(items.size());
+		QHash<DrawingItem*,int> newItemIndices;
+		QList<QRectF> changedRects;
+		bool reordered = (items.size() == mItems.size());
+
+		newItemIndices.reserve(items.size());
+
+		for(int i = 0; i < items.size(); i++)
+		{
+			int oldIndex = mItemIndices.value(items[i], -1);
+
+			newItems[i].item = items[i];
+			newItems[i].queryStamp = 0;
+
+			if (oldIndex >= 0)
+			{
+				newItems[i].rect = mItems[oldIndex].rect;
+				if (reordered && oldIndex != i) changedRects.append(newItems[i].rect);
+			}
+			else
+			{
+				newItems[i].rect = itemRect(items[i]);
+				changedRects.append(newItems[i].rect);
+				mSnapshots.remove(items[i]);
+				mSymbolCache.invalidateItem(items[i]);
+			}
+
+			newItemIndices.insert(items[i], i);
+		}
+
+		for(auto itemIter = mItems.begin(); itemIter != mItems.end(); itemIter++)
+		{
+			if (itemIter->item && !newItemIndices.contains(itemIter->item))
+			{
+				changedRects.append(itemIter->rect);
+				mSnapshots.remove(itemIter->item);
+				mSymbolCache.invalidateItem(itemIter->item);
+			}
+		}
+
+		if (mItems.isEmpty() || changedRects.size() > DiagramTileCacheMaxItemInvalidations)
+			clear();
+		else
+		{
+			for(auto rectIter = changedRects.begin(); rectIter != changedRects.end(); rectIter++)
+				invalidate(*rectIter);
+		}
+
+		mItems.swap(newItems);
+		mItemIndices.swap(newItemIndices);
+		indexItems();
+	}
+}
+
+void DiagramTileCache::collectJobs()
+{
+	for(auto jobIter = mJobs.begin(); jobIter != mJobs.end(); )
+	{
+		if (jobIter->future.isFinished())
+		{
+			// A tile invalidated while its job was running stays dirty and is scheduled again
+			if (!jobIter->stale)
+			{
+				TileRequest progress = jobIter->future.result();
+
+				mStatistics.itemsVisited += progress.itemsVisited;
+				mStatistics.itemsDrawn += progress.itemsDrawn;
+
+				if (progress.abandoned || progress.nextItem < progress.items.size())
+				{
+					// Interrupted; continued from here the next time the tile is scheduled
+					mPartialTiles.insert(jobIter.key(), progress);
+					if (mTiles.contains(jobIter.key())) mDirtyTiles.insert(jobIter.key());
+				}
+				else if (progress.pass == CoarsePass)
+				{
+					// Show the large items while the detail pass runs
+					mTiles.insert(jobIter.key(), progress.image);
+					mDirtyTiles.insert(jobIter.key());
+
+					progress.pass = DetailPass;
+					progress.nextItem = 0;
+					progress.image = QImage();
+					mPartialTiles.insert(jobIter.key(), progress);
+				}
+				else
+				{
+					mTiles.insert(jobIter.key(), progress.image);
+					mDirtyTiles.remove(jobIter.key());
+				}
+			}
+
+			jobIter = mJobs.erase(jobIter);
+		}
+		else jobIter++;
+	}
+
+	for(auto jobIter = mRunningJobs.begin(); jobIter != mRunningJobs.end(); )
+	{
+		if (jobIter->isFinished()) jobIter = mRunningJobs.erase(jobIter);
+		else jobIter++;
+	}
+}
+
+void DiagramTileCache::scheduleTile(int column, int row)
+{
+	quint64 key = tileKey(column, row);
+	TileRequest request;
+	TileJob job;
+
+	auto partialIter = mPartialTiles.find(key);
+	if (partialIter != mPartialTiles.end())
+	{
+		request = partialIter.value();
+		mPartialTiles.erase(partialIter);
+	}
+	else
+	{
+		request = mPendingTiles.take(key);
+		request.pass = (mTiles.contains(key)) ? DetailPass : CoarsePass;
+	}
+
+	request.generation = mGeneration.load();
+	request.currentGeneration = &mGeneration;
+	request.abandoned = false;
+
+	job.future = QtConcurrent::run(&DiagramTileCache::renderTile, request);
+	job.stale = false;
+
+	mJobs.insert(key, job);
+	mRunningJobs.append(job.future);
+}
+
+DiagramTileCache::TileRequest DiagramTileCache::createTileRequest(int column, int row)
+{
+	TileRequest request;
+
+	request.column = column;
+	request.row = row;
+	request.tileSize = mTileSize;
+	request.scale = mScale;
+	request.devicePixelRatio = mDevicePixelRatio;
+	request.phase = mPhase;
+	request.symbolCache = &mSymbolCache;
+
+	QRectF sceneRect(QPointF((column * mTileSize - mPhase.x()) / mScale, (row * mTileSize - mPhase.y()) / mScale),
+		QSizeF(mTileSize / mScale, mTileSize / mScale));
+
+	// The background and grid are recorded with the tile's own device transform, since the grid
+	// is thinned out based on it
+	QTransform deviceTransform(mScale, 0, 0, mScale, mPhase.x() - column * mTileSize, mPhase.y() - row * mTileSize);
+	QPainter backgroundPainter(&request.background);
+	backgroundPainter.setTransform(deviceTransform * QTransform::fromScale(1 / mDevicePixelRatio, 1 / mDevicePixelRatio));
+	backgroundPainter.setClipRect(sceneRect);
+	mWidget->drawBackground(&backgroundPainter);
+	backgroundPainter.end();
+
+	// The job only gets snapshots of the items it covers, so it never reads the scene.  They are
+	// recorded by prepareTileRequest().
+	if (!mGrid.isEmpty())
+	{
+		QVector<int> candidates = mLargeItems;
+		QRect cells = cellRange(sceneRect);
+
+		for(int row = cells.top(); row <= cells.bottom(); row++)
+		{
+			for(int column = cells.left(); column <= cells.right(); column++)
+				candidates += mGrid[row * mGridColumns + column];
+		}
+
+		// An item can be in several of the cells; the stamp makes sure it is only added once.  The
+		// items are drawn in z-order, which is the order of their indices.
+		mQueryStamp++;
+		std::sort(candidates.begin(), candidates.end());
+
+		for(auto indexIter = candidates.begin(); indexIter != candidates.end(); indexIter++)
+		{
+			ItemEntry& entry = mItems[*indexIter];
+
+			if (entry.queryStamp != mQueryStamp)
+			{
+				entry.queryStamp = mQueryStamp;
+				if (entry.item->isVisible() && entry.rect.intersects(sceneRect))
+					request.pendingItems.append(entry.item);
+			}
+		}
+	}
+
+	request.items.reserve(request.pendingItems.size());
+	request.nextPendingItem = 0;
+	request.pass = DetailPass;
+	request.nextItem = 0;
+	request.itemsVisited = 0;
+	request.itemsDrawn = 0;
+	request.generation = 0;
+	request.currentGeneration = nullptr;
+	request.abandoned = false;
+
+	return request;
+}
+
+bool DiagramTileCache::prepareTileRequest(TileRequest& request, bool force)
+{
+	// Records the snapshots the tile still needs, in z-order, until the frame's scheduling budget
+	// is used up.  Items removed or changed since the request was created invalidated its tile, so
+	// the pending items are all still in the cache.
+	DiagramLevelOfDetail levelOfDetail = mWidget->levelOfDetail();
+
+	while (request.nextPendingItem < request.pendingItems.size() &&
+		(force || mFrameTimer.elapsed() < DiagramTileCacheSchedulingBudget))
+	{
+		const ItemEntry& entry = mItems[mItemIndices.value(request.pendingItems.at(request.nextPendingItem))];
+		int detailLevel = levelOfDetail.detailLevel(entry.item, entry.rect, mScale);
+		auto snapshotIter = mSnapshots.find(entry.item);
+
+		if (snapshotIter == mSnapshots.end() || snapshotIter->detailLevel != detailLevel ||
+			(detailLevel < 0 && snapshotIter->scale != mScale))
+		{
+			snapshotIter = mSnapshots.insert(entry.item, createSnapshot(entry, levelOfDetail, detailLevel));
+			force = false;
+		}
+
+		request.items.append(snapshotIter.value());
+		request.nextPendingItem++;
+	}
+
+	if (request.nextPendingItem < request.pendingItems.size()) return false;
+
+	request.pendingItems.clear();
+	return true;
+}
+
+DiagramTileCache::ItemSnapshot DiagramTileCache::createSnapshot(const ItemEntry& entry,
+	const DiagramLevelOfDetail& levelOfDetail, int detailLevel)
+{
+	ItemSnapshot snapshot;
+
+	snapshot.rect = entry.rect;
+	snapshot.scale = mScale;
+	snapshot.detailLevel = detailLevel;
+	snapshot.isSymbol = levelOfDetail.isSymbol(entry.item, entry.rect, mScale);
+
+	if (snapshot.isSymbol)
+	{
+		snapshot.symbolTransform = diagramItemTransform(entry.item);
+		snapshot.symbol = mSymbolCache.symbol(static_cast<DrawingPathItem*>(entry.item));
+	}
+	else
+	{
+		// Recorded in scene coordinates; the level of detail only depends on the zoom level
+		QPainter picturePainter(&snapshot.picture);
+		levelOfDetail.renderItem(&picturePainter, entry.item, entry.rect, mScale);
+		picturePainter.end();
+	}
+
+	return snapshot;
+}
+
+void DiagramTileCache::invalidateTile(quint64 key)
+{
+	if (mTiles.contains(key)) mDirtyTiles.insert(key);
+	mPartialTiles.remove(key);
+	mPendingTiles.remove(key);
+
+	auto jobIter = mJobs.find(key);
+	if (jobIter != mJobs.end()) jobIter->stale = true;
+}
+
+void DiagramTileCache::drawPreviousTiles(QPainter* painter, const QPoint& origin, const QSize& deviceSize)
+{
+	if (!mPreviousTiles.isEmpty() && mPreviousScale > 0)
+	{
+		qreal scaleFactor = mScale / mPreviousScale;
+		QRectF viewRect(QPointF(0, 0), QSizeF(deviceSize));
+
+		painter->save();
+		painter->setRenderHint(QPainter::SmoothPixmapTransform, !mWidget->isInteracting());
+
+		for(auto tileIter = mPreviousTiles.begin(); tileIter != mPreviousTiles.end(); tileIter++)
+		{
+			QPoint tile = tilePosition(tileIter.key());
+			QRectF targetRect(((tile.x() * mTileSize - mPreviousPhase.x()) * scaleFactor + mPhase.x() + origin.x()),
+				((tile.y() * mTileSize - mPreviousPhase.y()) * scaleFactor + mPhase.y() + origin.y()),
+				mTileSize * scaleFactor, mTileSize * scaleFactor);
+
+			if (targetRect.intersects(viewRect))
+			{
+				painter->drawImage(QRectF(targetRect.topLeft() / mDevicePixelRatio, targetRect.size() / mDevicePixelRatio),
+					tileIter.value());
+			}
+		}
+
+		painter->restore();
+	}
+}
+
+void DiagramTileCache::removeTiles(const QRect& keepRange)
+{
+	for(auto tileIter = mTiles.begin(); tileIter != mTiles.end(); )
+	{
+		if (!keepRange.contains(tilePosition(tileIter.key())))
+		{
+			mDirtyTiles.remove(tileIter.key());
+			mPartialTiles.remove(tileIter.key());
+			tileIter = mTiles.erase(tileIter);
+		}
+		else tileIter++;
+	}
+
+	for(auto pendingIter = mPendingTiles.begin(); pendingIter != mPendingTiles.end(); )
+	{
+		if (!keepRange.contains(tilePosition(pendingIter.key()))) pendingIter = mPendingTiles.erase(pendingIter);
+		else pendingIter++;
+	}
+}
+
+//==================================================================================================
+
+void DiagramTileCache::indexItems()
+{
+	// Bucket the item rects into a uniform scene grid sized for a few items per cell.  Items that
+	// would cover many cells are kept in a separate list that every tile checks.  Items moved
+	// outside the grid later are clamped into its edge cells, so the grid stays correct until the
+	// item list changes and it is rebuilt.
+	mGrid.clear();
+	mLargeItems.clear();
+
+	if (!mItems.isEmpty())
+	{
+		mGridRect = mItems.first().rect;
+		for(auto itemIter = mItems.begin(); itemIter != mItems.end(); itemIter++)
+		{
+			mGridRect.setCoords(qMin(mGridRect.left(), itemIter->rect.left()),
+				qMin(mGridRect.top(), itemIter->rect.top()),
+				qMax(mGridRect.right(), itemIter->rect.right()),
+				qMax(mGridRect.bottom(), itemIter->rect.bottom()));
+		}
+
+		int cellsPerSide = qBound(1, (int)qSqrt(mItems.size() / 4.0), 1024);
+		mCellSize = qMax(mGridRect.width(), mGridRect.height()) / cellsPerSide;
+		if (mCellSize <= 0) mCellSize = 1;
+
+		mGridColumns = qFloor(mGridRect.width() / mCellSize) + 1;
+		mGridRows = qFloor(mGridRect.height() / mCellSize) + 1;
+		mGrid.resize(mGridColumns * mGridRows);
+
+		for(int i = 0; i < mItems.size(); i++) addToGrid(i);
+	}
+}
+
+void DiagramTileCache::addToGrid(int index)
+{
+	const int maxCellsPerItem = 16;
+
+	if (!mGrid.isEmpty())
+	{
+		QRect cells = cellRange(mItems[index].rect);
+
+		if (cells.width() * cells.height() > maxCellsPerItem) mLargeItems.append(index);
+		else
+		{
+			for(int row = cells.top(); row <= cells.bottom(); row++)
+			{
+				for(int column = cells.left(); column <= cells.right(); column++)
+					mGrid[row * mGridColumns + column].append(index);
+			}
+		}
+	}
+}
+
+void DiagramTileCache::removeFromGrid(int index)
+{
+	if (!mGrid.isEmpty())
+	{
+		// Looks in the same cells that addToGrid used, so must be called before the rect changes
+		mLargeItems.removeOne(index);
+
+		QRect cells = cellRange(mItems[index].rect);
+		for(int row = cells.top(); row <= cells.bottom(); row++)
+		{
+			for(int column = cells.left(); column <= cells.right(); column++)
+				mGrid[row * mGridColumns + column].removeOne(index);
+		}
+	}
+}
+
+QRect DiagramTileCache::cellRange(const QRectF& rect) const
+{
+	int left = qBound(0, qFloor((rect.left() - mGridRect.left()) / mCellSize), mGridColumns - 1);
+	int top = qBound(0, qFloor((rect.top() - mGridRect.top()) / mCellSize), mGridRows - 1);
+	int right = qBound(0, qFloor((rect.right() - mGridRect.left()) / mCellSize), mGridColumns - 1);
+	int bottom = qBound(0, qFloor((rect.bottom() - mGridRect.top()) / mCellSize), mGridRows - 1);
+
+	return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+//==================================================================================================
+
+QRect DiagramTileCache::tileRange(const QRectF& deviceRect) const
+{
+	int left = qFloor(deviceRect.left() / mTileSize);
+	int top = qFloor(deviceRect.top() / mTileSize);
+	int right = qFloor((deviceRect.right() - 1) / mTileSize);
+	int bottom = qFloor((deviceRect.bottom() - 1) / mTileSize);
+
+	return QRect(QPoint(left, top), QPoint(qMax(left, right), qMax(top, bottom)));
+}
+
+QRectF DiagramTileCache::itemRect(DrawingItem* item) const
+{
+	return item->mapToScene(item->boundingRect()).boundingRect();
+}
+
+quint64 DiagramTileCache::tileKey(int column, int row) const
+{
+	return ((quint64)(quint32)column << 32) | (quint32)row;
+}
+
+QPoint DiagramTileCache::tilePosition(quint64 key) const
+{
+	return QPoint((qint32)(key >> 32), (qint32)(key & 0xFFFFFFFF));
+}
+
+//==================================================================================================
+
+DiagramTileCache::TileRequest DiagramTileCache::renderTile(const TileRequest& request)
+{
+	TileRequest progress = request;
+	QElapsedTimer timer;
+	bool newTile = progress.image.isNull();
+
+	progress.itemsVisited = 0;
+	progress.itemsDrawn = 0;
+
+	// Cancelled while still queued
+	if (request.currentGeneration->load() != request.generation)
+	{
+		progress.abandoned = true;
+		return progress;
+	}
+
+	timer.start();
+
+	if (newTile)
+	{
+		progress.image = QImage(request.tileSize, request.tileSize, QImage::Format_ARGB32_Premultiplied);
+		progress.image.setDevicePixelRatio(request.devicePixelRatio);
+		progress.image.fill(Qt::transparent);
+	}
+
+	// Scene to device pixel transform, shifted so that this tile starts at the image origin
+	QTransform deviceTransform(request.scale, 0, 0, request.scale,
+		request.phase.x() - request.column * request.tileSize, request.phase.y() - request.row * request.tileSize);
+	QRectF sceneRect = deviceTransform.inverted().mapRect(QRectF(0, 0, request.tileSize, request.tileSize));
+
+	QPainter painter(&progress.image);
+	painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+	painter.setTransform(deviceTransform * QTransform::fromScale(1 / request.devicePixelRatio, 1 / request.devicePixelRatio));
+	painter.setClipRect(sceneRect);
+
+	if (newTile)
+	{
+		// The background was recorded with the full device transform
+		painter.save();
+		painter.resetTransform();
+		painter.drawPicture(QPointF(0, 0), request.background);
+		painter.restore();
+	}
+
+	// Items stay in z-order; the coarse pass only skips the small ones.  At least one item is drawn
+	// per job so that every job makes progress.
+	while (progress.nextItem < progress.items.size())
+	{
+		const ItemSnapshot& snapshot = progress.items.at(progress.nextItem);
+		progress.nextItem++;
+		progress.itemsVisited++;
+
+		if (progress.pass == DetailPass ||
+			qMax(snapshot.rect.width(), snapshot.rect.height()) * request.scale >= DiagramTileCacheCoarseItemSize)
+		{
+			if (snapshot.isSymbol)
+			{
+				painter.save();
+				painter.setTransform(snapshot.symbolTransform, true);
+				request.symbolCache->drawSymbol(&painter, snapshot.symbol);
+				painter.restore();
+			}
+			else painter.drawPicture(QPointF(0, 0), snapshot.picture);
+
+			progress.itemsDrawn++;
+		}
+
+		if (timer.elapsed() >= DiagramTileCacheFrameBudget || request.currentGeneration->load() != request.generation)
+			break;
+	}
+
+	painter.end();
+
+	return progress;
+}
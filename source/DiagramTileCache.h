@@ -0,0 +1,190 @@
+/* DiagramTileCache.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMTILECACHE_H
+#define DIAGRAMTILECACHE_H
+
+#include <DiagramWidget.h>
+#include "DiagramSymbolCache.h"
+
+// Retained raster cache for the diagram view.  The background, grid and items are rendered into
+// fixed-size tiles in device pixels, anchored to the scene so that panning by whole pixels reuses
+// them and only newly exposed tiles are rasterized.  The cache is tied to one zoom level; tiles
+// are redrawn only where changed items were or are now.
+//
+// Tiles are rasterized on the global thread pool, each job with its own QPainter.  Jobs never read
+// the scene or its items: the tile's background and grid and every item it covers are recorded on
+// the GUI thread into pictures (or, for path symbols, into DiagramSymbolCache symbols) and only
+// those are replayed by the job.  Snapshots are recorded a few at a time within each frame's
+// scheduling budget, and a tile's job is only started once all of its items have one.  They are
+// dropped whenever their item is invalidated, added or removed, and are reused at other zoom
+// levels as long as the item's level of detail stays the same.  Until a tile is ready the view
+// shows its previous contents, or the tiles of the previous zoom level scaled to fit.
+//
+// The cache's copy of the scene's item list is only compared against the scene after the widget
+// reports that items were added, removed or reordered.  Items that are about to be deleted must be
+// removed from the cache first, so that a new item at the same address is not mistaken for them.
+//
+// Each job runs for at most one frame budget and is then picked up again on the next frame from
+// where it stopped.  A new tile is first drawn with only its large items, which is shown while
+// the full detail pass is in progress.  Jobs belong to a generation that is advanced on zoom and
+// on user input; jobs of an older generation stop after their current item, or do not start at
+// all if they are still queued, and are continued on a later frame.  Each frame only prepares as
+// many new tiles as fit in the scheduling budget.
+class DiagramTileCache
+{
+private:
+	enum RenderPass { CoarsePass, DetailPass };
+
+	struct ItemEntry
+	{
+		DrawingItem* item;
+		QRectF rect;
+		quint32 queryStamp;
+	};
+
+	struct ItemSnapshot
+	{
+		QRectF rect;
+		QPicture picture;
+		bool isSymbol;
+		QTransform symbolTransform;
+		DiagramSymbolCache::Symbol symbol;
+		int detailLevel;
+		qreal scale;
+	};
+
+	struct TileRequest
+	{
+		int column, row;
+		int tileSize;
+		qreal scale;
+		qreal devicePixelRatio;
+		QPointF phase;
+		DiagramSymbolCache* symbolCache;
+		QPicture background;
+		QVector<ItemSnapshot> items;
+		QVector<DrawingItem*> pendingItems;
+		int nextPendingItem;
+
+		RenderPass pass;
+		int nextItem;
+		int itemsVisited, itemsDrawn;
+		QImage image;
+		int generation;
+		const QAtomicInt* currentGeneration;
+		bool abandoned;
+	};
+
+	struct TileJob
+	{
+		QFuture<TileRequest> future;
+		bool stale;
+	};
+
+	DiagramWidget* mWidget;
+	int mTileSize;
+
+	QHash<quint64,QImage> mTiles;
+	QSet<quint64> mDirtyTiles;
+	qreal mScale;
+	qreal mDevicePixelRatio;
+	QPointF mPhase;
+
+	QHash<quint64,QImage> mPreviousTiles;
+	qreal mPreviousScale;
+	QPointF mPreviousPhase;
+
+	QHash<quint64,TileJob> mJobs;
+	QHash<quint64,TileRequest> mPartialTiles;
+	QHash<quint64,TileRequest> mPendingTiles;
+	QElapsedTimer mFrameTimer;
+	QList< QFuture<TileRequest> > mRunningJobs;
+	QAtomicInt mGeneration;
+
+	QVector<ItemEntry> mItems;
+	QHash<DrawingItem*,int> mItemIndices;
+	bool mItemListDirty;
+	quint32 mQueryStamp;
+
+	QRectF mGridRect;
+	qreal mCellSize;
+	int mGridColumns, mGridRows;
+	QVector< QVector<int> > mGrid;
+	QVector<int> mLargeItems;
+
+	QHash<DrawingItem*,ItemSnapshot> mSnapshots;
+
+	DiagramSymbolCache mSymbolCache;
+
+public:
+	struct Statistics
+	{
+		int tileHits, tileMisses;
+		int itemsVisited, itemsDrawn;
+		int symbolHits, symbolMisses;
+	};
+
+private:
+	Statistics mStatistics;
+
+public:
+	DiagramTileCache(DiagramWidget* widget, int tileSize = 240);
+	~DiagramTileCache();
+
+	void draw(QPainter* painter, const QRectF& visibleRect);
+
+	void invalidate(const QRectF& rect);
+	void invalidateItems(const QList<DrawingItem*>& items);
+	void invalidateItemList();
+	void removeItems(const QList<DrawingItem*>& items);
+	void clearItems();
+	void clear();
+
+	void cancelJobs();
+	void waitForJobs();
+
+	Statistics statistics() const;
+
+private:
+	void syncItems();
+	void collectJobs();
+	void scheduleTile(int column, int row);
+	TileRequest createTileRequest(int column, int row);
+	bool prepareTileRequest(TileRequest& request, bool force);
+	ItemSnapshot createSnapshot(const ItemEntry& entry, const DiagramLevelOfDetail& levelOfDetail, int detailLevel);
+	void invalidateTile(quint64 key);
+	void drawPreviousTiles(QPainter* painter, const QPoint& origin, const QSize& deviceSize);
+	void removeTiles(const QRect& keepRange);
+
+	void indexItems();
+	void addToGrid(int index);
+	void removeFromGrid(int index);
+	QRect cellRange(const QRectF& rect) const;
+
+	QRect tileRange(const QRectF& deviceRect) const;
+	QRectF itemRect(DrawingItem* item) const;
+	quint64 tileKey(int column, int row) const;
+	QPoint tilePosition(quint64 key) const;
+
+	static TileRequest renderTile(const TileRequest& request);
+};
+
+#endif
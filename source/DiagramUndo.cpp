@@ -19,6 +19,7 @@
  */
 
 #include "DiagramUndo.h"
+#include "DiagramItemType.h"
 
 DiagramSetItemsStyleCommand::DiagramSetItemsStyleCommand(DiagramWidget* diagram,
 	const QList<DrawingItem*>& items, const QHash<DrawingItemStyle::Property,QVariant>& properties)
@@ -75,18 +76,18 @@ DiagramSetItemCornerRadiusCommand::DiagramSetItemCornerRadiusCommand(DiagramWidg
 	mOriginalCornerRadiusX = 0;
 	mOriginalCornerRadiusY = 0;
 
-	DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(item);
-	DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
-
-	if (rectItem)
-	{
-		mOriginalCornerRadiusX = rectItem->cornerRadiusX();
-		mOriginalCornerRadiusY = rectItem->cornerRadiusY();
-	}
-	if (textRectItem)
+	switch (diagramItemType(item))
 	{
-		mOriginalCornerRadiusX = textRectItem->cornerRadiusX();
-		mOriginalCornerRadiusY = textRectItem->cornerRadiusY();
+	case DiagramRectItemType:
+		mOriginalCornerRadiusX = static_cast<DrawingRectItem*>(item)->cornerRadiusX();
+		mOriginalCornerRadiusY = static_cast<DrawingRectItem*>(item)->cornerRadiusY();
+		break;
+	case DiagramTextRectItemType:
+		mOriginalCornerRadiusX = static_cast<DrawingTextRectItem*>(item)->cornerRadiusX();
+		mOriginalCornerRadiusY = static_cast<DrawingTextRectItem*>(item)->cornerRadiusY();
+		break;
+	default:
+		break;
 	}
 }
 
@@ -118,15 +119,14 @@ DiagramSetItemCaptionCommand::DiagramSetItemCaptionCommand(DiagramWidget* diagra
 	mItem = item;
 	mCaption = caption;
 
-	DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(item);
-	DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
-	DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(item);
-	DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(item);
-
-	if (textItem) mOriginalCaption = textItem->caption();
-	if (textRectItem) mOriginalCaption = textRectItem->caption();
-	if (textEllipseItem) mOriginalCaption = textEllipseItem->caption();
-	if (textPolygonItem) mOriginalCaption = textPolygonItem->caption();
+	switch (diagramItemType(item))
+	{
+	case DiagramTextItemType: mOriginalCaption = static_cast<DrawingTextItem*>(item)->caption(); break;
+	case DiagramTextRectItemType: mOriginalCaption = static_cast<DrawingTextRectItem*>(item)->caption(); break;
+	case DiagramTextEllipseItemType: mOriginalCaption = static_cast<DrawingTextEllipseItem*>(item)->caption(); break;
+	case DiagramTextPolygonItemType: mOriginalCaption = static_cast<DrawingTextPolygonItem*>(item)->caption(); break;
+	default: break;
+	}
 }
 
 DiagramSetItemCaptionCommand::~DiagramSetItemCaptionCommand() { }
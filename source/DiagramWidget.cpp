@@ -19,9 +19,15 @@
  */
 
 #include "DiagramWidget.h"
+#include "DiagramGridRenderer.h"
 #include "DiagramUndo.h"
 #include "DiagramReader.h"
 #include "DiagramWriter.h"
+#include "DiagramItemIndex.h"
+#include "DiagramItemPlacement.h"
+#include "DiagramItemType.h"
+#include "DiagramPerformanceHud.h"
+#include "DiagramTileCache.h"
 
 DiagramWidget::DiagramWidget() : DrawingView()
 {
@@ -31,32 +37,84 @@ DiagramWidget::DiagramWidget() : DrawingView()
 	mGridBrush = QColor(0, 128, 128);
 	mGridSpacingMajor = 8;
 	mGridSpacingMinor = 2;
+	mGridRenderer = new DiagramGridRenderer(this);
+	mTileCache = new DiagramTileCache(this);
+
+	mInteractiveQualityEnabled = true;
+	mInteracting = false;
+	mInteractionTimer.setSingleShot(true);
+	mInteractionTimer.setInterval(150);
+
+	mPerformanceHud = new DiagramPerformanceHud();
 
 	mConsecutivePastes = 0;
+	mItemsChangedDuringPress = false;
+	mDrawPlaceItemsInOverlay = false;
+
+	mItemIndex = nullptr;
+	mMaxLoadedItems = 50000;
 
 	addActions();
 	createContextMenu();
 	connect(this, SIGNAL(selectionChanged(const QList<DrawingItem*>&)), this, SLOT(updateActionsFromSelection()));
+	connect(this, SIGNAL(selectionChanged(const QList<DrawingItem*>&)), this, SLOT(pinItems(const QList<DrawingItem*>&)));
+	connect(horizontalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(loadVisibleItems()));
+	connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(loadVisibleItems()));
+	connect(this, SIGNAL(scaleChanged(qreal)), this, SLOT(loadVisibleItems()));
+
+	connect(this, SIGNAL(itemsPositionChanged(const QList<DrawingItem*>&)), this, SLOT(invalidateItems(const QList<DrawingItem*>&)));
+	connect(this, SIGNAL(itemsTransformChanged(const QList<DrawingItem*>&)), this, SLOT(invalidateItems(const QList<DrawingItem*>&)));
+	connect(this, SIGNAL(itemsGeometryChanged(const QList<DrawingItem*>&)), this, SLOT(invalidateItems(const QList<DrawingItem*>&)));
+	connect(this, SIGNAL(itemsVisibilityChanged(const QList<DrawingItem*>&)), this, SLOT(invalidateItems(const QList<DrawingItem*>&)));
+	connect(this, SIGNAL(itemsStyleChanged(const QList<DrawingItem*>&)), this, SLOT(invalidateItems(const QList<DrawingItem*>&)));
+	connect(this, SIGNAL(itemCornerRadiusChanged(DrawingItem*)), this, SLOT(invalidateItem(DrawingItem*)));
+	connect(this, SIGNAL(itemCaptionChanged(DrawingItem*)), this, SLOT(invalidateItem(DrawingItem*)));
+
+	// Items added, removed or reordered; the tile cache compares its item list with the scene's
+	// only after one of these
+	connect(this, SIGNAL(numberOfItemsChanged(int)), this, SLOT(invalidateItemList()));
+	connect(actions()[UndoAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[RedoAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[BringForwardAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[SendBackwardAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[BringToFrontAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[SendToBackAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[GroupAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+	connect(actions()[UngroupAction], SIGNAL(triggered()), this, SLOT(invalidateItemList()));
+
+	connect(horizontalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(beginInteraction()));
+	connect(verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(beginInteraction()));
+	connect(this, SIGNAL(scaleChanged(qreal)), this, SLOT(beginInteraction()));
+	connect(&mInteractionTimer, SIGNAL(timeout()), this, SLOT(endInteraction()));
 }
 
-DiagramWidget::~DiagramWidget() { }
+DiagramWidget::~DiagramWidget()
+{
+	delete mPerformanceHud;
+	delete mTileCache;
+	delete mGridRenderer;
+	delete mItemIndex;
+}
 
 //==================================================================================================
 
 void DiagramWidget::setGridStyle(GridRenderStyle style)
 {
 	mGridStyle = style;
+	mTileCache->clear();
 }
 
 void DiagramWidget::setGridBrush(const QBrush& brush)
 {
 	mGridBrush = brush;
+	mTileCache->clear();
 }
 
 void DiagramWidget::setGridSpacing(int majorSpacing, int minorSpacing)
 {
 	mGridSpacingMajor = majorSpacing;
 	mGridSpacingMinor = minorSpacing;
+	mTileCache->clear();
 }
 
 DiagramWidget::GridRenderStyle DiagramWidget::gridStyle() const
@@ -81,6 +139,51 @@ int DiagramWidget::gridSpacingMinor() const
 
 //==================================================================================================
 
+void DiagramWidget::setLevelOfDetail(const DiagramLevelOfDetail& levelOfDetail)
+{
+	mLevelOfDetail = levelOfDetail;
+	mTileCache->clear();
+}
+
+DiagramLevelOfDetail DiagramWidget::levelOfDetail() const
+{
+	return mLevelOfDetail;
+}
+
+//==================================================================================================
+
+void DiagramWidget::setInteractiveQualityEnabled(bool enabled)
+{
+	mInteractiveQualityEnabled = enabled;
+	if (!enabled) endInteraction();
+}
+
+bool DiagramWidget::isInteractiveQualityEnabled() const
+{
+	return mInteractiveQualityEnabled;
+}
+
+bool DiagramWidget::isInteracting() const
+{
+	return (mInteractiveQualityEnabled && mInteracting);
+}
+
+//==================================================================================================
+
+void DiagramWidget::setPerformanceHudVisible(bool visible)
+{
+	mPerformanceHud->setVisible(visible);
+	actions()[PerformanceHudAction]->setChecked(visible);
+	viewport()->update();
+}
+
+bool DiagramWidget::isPerformanceHudVisible() const
+{
+	return mPerformanceHud->isVisible();
+}
+
+//==================================================================================================
+
 void DiagramWidget::setProperties(const QHash<DiagramWidget::Property,QVariant>& properties)
 {
 	DrawingScene* scene = DiagramWidget::scene();
@@ -92,6 +195,8 @@ void DiagramWidget::setProperties(const QHash<DiagramWidget::Property,QVariant>&
 	if (properties.contains(GridColor)) setGridBrush(properties[GridColor].value<QColor>());
 	if (properties.contains(GridSpacingMajor)) setGridSpacing(properties[GridSpacingMajor].toInt(), mGridSpacingMinor);
 	if (properties.contains(GridSpacingMinor)) setGridSpacing(mGridSpacingMajor, properties[GridSpacingMinor].toInt());
+
+	mTileCache->clear();
 }
 
 QHash<DiagramWidget::Property,QVariant> DiagramWidget::properties() const
@@ -124,6 +229,8 @@ void DiagramWidget::renderExport(QPainter* painter)
 	DrawingScene* scene = DiagramWidget::scene();
 	if (scene)
 	{
+		loadAllItems();
+
 		painter->setBrush(scene->backgroundBrush());
 		painter->setPen(Qt::NoPen);
 		painter->drawRect(scene->sceneRect());
@@ -132,6 +239,66 @@ void DiagramWidget::renderExport(QPainter* painter)
 	}
 }
 
+void DiagramWidget::renderExport(QPainter* painter, const QList<DrawingItem*>& items)
+{
+	// Draws only the given items, which must already be loaded; safe to call from worker threads
+	DrawingScene* scene = DiagramWidget::scene();
+	if (scene)
+	{
+		painter->setBrush(scene->backgroundBrush());
+		painter->setPen(Qt::NoPen);
+		painter->drawRect(scene->sceneRect());
+
+		for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+			renderDiagramItem(painter, *itemIter);
+	}
+}
+
+//==================================================================================================
+
+void DiagramWidget::setItemIndex(DiagramItemIndex* index)
+{
+	if (mItemIndex != index)
+	{
+		delete mItemIndex;
+		mItemIndex = index;
+	}
+}
+
+DiagramItemIndex* DiagramWidget::itemIndex() const
+{
+	return mItemIndex;
+}
+
+void DiagramWidget::addSceneItems(const QList<DrawingItem*>& items)
+{
+	// Adds items read from a file straight to the scene, without undo.  The viewport does not
+	// repaint and the tile cache does not look at the scene's item list until all of them are in.
+	DrawingScene* scene = DiagramWidget::scene();
+
+	if (scene && !items.isEmpty())
+	{
+		bool updatesEnabled = viewport()->updatesEnabled();
+		viewport()->setUpdatesEnabled(false);
+
+		for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+			scene->addItem(*itemIter);
+
+		viewport()->setUpdatesEnabled(updatesEnabled);
+
+		mTileCache->invalidateItemList();
+		viewport()->update();
+	}
+}
+
+void DiagramWidget::clearItems()
+{
+	DrawingScene* scene = DiagramWidget::scene();
+
+	mTileCache->clearItems();
+	if (scene) scene->clearItems();
+}
+
 //==================================================================================================
 
 void DiagramWidget::cut()
@@ -189,6 +356,58 @@ void DiagramWidget::paste()
 	}
 }
 
+void DiagramWidget::selectAll()
+{
+	loadAllItems();
+	DrawingView::selectAll();
+}
+
+//==================================================================================================
+
+void DiagramWidget::loadVisibleItems()
+{
+	if (mItemIndex && mItemIndex->numberOfUnloadedItems() > 0)
+	{
+		// Load a margin around the visible area as well so that items with text or thick strokes
+		// extending past their geometry are in place before they scroll into view
+		QRectF visibleRect = DiagramWidget::visibleRect();
+		QRectF rect = visibleRect.adjusted(-visibleRect.width() / 2, -visibleRect.height() / 2,
+			visibleRect.width() / 2, visibleRect.height() / 2);
+
+		if (!mItemIndex->loadItems(scene(), rect).isEmpty())
+		{
+			mTileCache->invalidateItemList();
+			viewport()->update();
+		}
+
+		// Keep the memory use bounded while panning around a large drawing by unloading the items
+		// that have been far off-screen the longest
+		rect = visibleRect.adjusted(-visibleRect.width() * 2, -visibleRect.height() * 2,
+			visibleRect.width() * 2, visibleRect.height() * 2);
+
+		QList<DrawingItem*> unloadedItems = mItemIndex->unloadItems(scene(), rect, mMaxLoadedItems);
+		mTileCache->removeItems(unloadedItems);
+		qDeleteAll(unloadedItems);
+	}
+}
+
+void DiagramWidget::loadAllItems()
+{
+	if (mItemIndex && mItemIndex->numberOfUnloadedItems() > 0)
+	{
+		if (!mItemIndex->loadAllItems(scene()).isEmpty())
+		{
+			mTileCache->invalidateItemList();
+			viewport()->update();
+		}
+	}
+}
+
+void DiagramWidget::invalidateItemList()
+{
+	mTileCache->invalidateItemList();
+}
+
 //==================================================================================================
 
 void DiagramWidget::setSelectionStyleProperties(const QHash<DrawingItemStyle::Property,QVariant>& properties)
@@ -204,10 +423,8 @@ void DiagramWidget::setSelectionCornerRadius(qreal radiusX, qreal radiusY)
 	if (selectedItems.size() == 1)
 	{
 		DrawingItem* item = selectedItems.first();
-		DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(item);
-		DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
 
-		if (rectItem || textRectItem)
+		if (diagramItemHasCornerRadius(diagramItemType(item)))
 			pushUndoCommand(new DiagramSetItemCornerRadiusCommand(this, item, radiusX, radiusY));
 	}
 }
@@ -218,12 +435,8 @@ void DiagramWidget::setSelectionCaption(const QString& newCaption)
 	if (selectedItems.size() == 1)
 	{
 		DrawingItem* item = selectedItems.first();
-		DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(item);
-		DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
-		DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(item);
-		DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(item);
 
-		if (textItem || textRectItem || textEllipseItem || textPolygonItem)
+		if (diagramItemHasCaption(diagramItemType(item)))
 			pushUndoCommand(new DiagramSetItemCaptionCommand(this, item, newCaption));
 	}
 }
@@ -241,6 +454,8 @@ void DiagramWidget::setItemsStyle(const QHash< DrawingItem*, QHash<DrawingItemSt
 	QList<DrawingItem*> items = properties.keys();
 	QList<DrawingItemStyle::Property> styleProperties;
 
+	addDirtyItems(items);
+
 	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
 	{
 		styleProperties = properties[*itemIter].keys();
@@ -252,40 +467,48 @@ void DiagramWidget::setItemsStyle(const QHash< DrawingItem*, QHash<DrawingItemSt
 	}
 
 	emit itemsStyleChanged(items);
-	viewport()->update();
+	addDirtyItems(items);
 }
 
 void DiagramWidget::setItemCornerRadius(DrawingItem* item, qreal radiusX, qreal radiusY)
 {
-	DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(item);
-	DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
+	DiagramItemType type = diagramItemType(item);
 
-	if (rectItem || textRectItem)
+	if (diagramItemHasCornerRadius(type))
 	{
-		if (rectItem) rectItem->setCornerRadii(radiusX, radiusY);
-		if (textRectItem) textRectItem->setCornerRadii(radiusX, radiusY);
+		addDirtyRect(itemSceneRect(item));
+
+		switch (type)
+		{
+		case DiagramRectItemType: static_cast<DrawingRectItem*>(item)->setCornerRadii(radiusX, radiusY); break;
+		case DiagramTextRectItemType: static_cast<DrawingTextRectItem*>(item)->setCornerRadii(radiusX, radiusY); break;
+		default: break;
+		}
 
 		emit itemCornerRadiusChanged(item);
-		viewport()->update();
+		addDirtyRect(itemSceneRect(item));
 	}
 }
 
 void DiagramWidget::setItemCaption(DrawingItem* item, const QString& caption)
 {
-	DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(item);
-	DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(item);
-	DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(item);
-	DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(item);
+	DiagramItemType type = diagramItemType(item);
 
-	if (textItem || textRectItem || textEllipseItem || textPolygonItem)
+	if (diagramItemHasCaption(type))
 	{
-		if (textItem) textItem->setCaption(caption);
-		if (textRectItem) textRectItem->setCaption(caption);
-		if (textEllipseItem) textEllipseItem->setCaption(caption);
-		if (textPolygonItem) textPolygonItem->setCaption(caption);
+		addDirtyRect(itemSceneRect(item));
+
+		switch (type)
+		{
+		case DiagramTextItemType: static_cast<DrawingTextItem*>(item)->setCaption(caption); break;
+		case DiagramTextRectItemType: static_cast<DrawingTextRectItem*>(item)->setCaption(caption); break;
+		case DiagramTextEllipseItemType: static_cast<DrawingTextEllipseItem*>(item)->setCaption(caption); break;
+		case DiagramTextPolygonItemType: static_cast<DrawingTextPolygonItem*>(item)->setCaption(caption); break;
+		default: break;
+		}
 
 		emit itemCaptionChanged(item);
-		viewport()->update();
+		addDirtyRect(itemSceneRect(item));
 	}
 }
 
@@ -294,79 +517,153 @@ void DiagramWidget::setViewProperties(const QHash<DiagramWidget::Property,QVaria
 	setProperties(properties);
 	emit diagramPropertiesChanged(properties);
 	if (properties.contains(SceneRect)) zoomFit();
-	viewport()->update();
+
+	// Background and grid changes affect the whole view
+	addDirtyRect(visibleRect());
 }
 
 //==================================================================================================
 
-void DiagramWidget::drawBackground(QPainter* painter)
+void DiagramWidget::addDirtyRect(const QRectF& sceneRect)
+{
+	// Map to viewport pixels the same way paintEvent() does, with room for antialiasing and the
+	// selection handles drawn around the item
+	QRectF visibleRect = DiagramWidget::visibleRect();
+	QRectF deviceRect((sceneRect.topLeft() - visibleRect.topLeft()) * scale(), sceneRect.size() * scale());
+
+	// Coalesce all of the changes made in one pass through the event loop into one update
+	if (mDirtyRegion.isEmpty()) QMetaObject::invokeMethod(this, "updateDirtyRegion", Qt::QueuedConnection);
+	mDirtyRegion += deviceRect.toAlignedRect().adjusted(-8, -8, 8, 8) & viewport()->rect();
+}
+
+void DiagramWidget::addDirtyItems(const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+		addDirtyRect(itemSceneRect(*itemIter));
+}
+
+QRectF DiagramWidget::itemSceneRect(DrawingItem* item) const
+{
+	return item->mapToScene(item->boundingRect()).boundingRect();
+}
+
+int DiagramWidget::numberOfItemsInRect(const QRectF& sceneRect) const
 {
 	DrawingScene* scene = DiagramWidget::scene();
+	QList<DrawingItem*> items = (scene) ? scene->items() : QList<DrawingItem*>();
+	int count = 0;
 
-	if (scene)
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		if ((*itemIter)->isVisible() && itemSceneRect(*itemIter).intersects(sceneRect)) count++;
+	}
+
+	return count;
+}
+
+//==================================================================================================
+
+void DiagramWidget::paintEvent(QPaintEvent* event)
+{
+	DrawingScene* scene = DiagramWidget::scene();
+	bool refreshHud = false;
+
+	mPerformanceHud->beginFrame(event->region());
+
+	// The view is drawn as the cached items layer with the overlay (drawForeground) on top, so
+	// selection, hover, rubber band and placement preview changes never re-rasterize items.  Once a
+	// press starts moving items they change every frame, so those frames bypass the tile cache.
+	if (scene && (QApplication::mouseButtons() == Qt::NoButton || !mItemsChangedDuringPress))
 	{
-		QBrush backgroundBrush = scene->backgroundBrush();
-		qreal grid = DiagramWidget::grid();
 		QRectF visibleRect = DiagramWidget::visibleRect();
+		QPainter painter(viewport());
 
-		QPainter::RenderHints renderHints = painter->renderHints();
-		painter->setRenderHints(renderHints, false);
+		mPerformanceHud->beginStage();
+		mTileCache->draw(&painter, visibleRect);
+		mPerformanceHud->endStage(DiagramPerformanceHud::TilesStage);
 
-		// Draw background
-		painter->setBrush(backgroundBrush);
-		painter->setPen(Qt::NoPen);
-		painter->drawRect(visibleRect);
+		painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, !isInteracting());
+		painter.scale(scale(), scale());
+		painter.translate(-visibleRect.topLeft());
 
-		// Draw grid
-		QPen gridPen(mGridBrush, devicePixelRatio());
-		gridPen.setCosmetic(true);
+		mPerformanceHud->beginStage();
+		mDrawPlaceItemsInOverlay = true;
+		drawForeground(&painter);
+		mDrawPlaceItemsInOverlay = false;
+		mPerformanceHud->endStage(DiagramPerformanceHud::ForegroundStage);
 
-		if (mGridStyle != GridNone && grid >= 0)
+		mPerformanceHud->endFrame();
+
+		if (mPerformanceHud->isVisible())
 		{
-			painter->setPen(gridPen);
+			DiagramTileCache::Statistics statistics = mTileCache->statistics();
+			mPerformanceHud->setItemCounts(statistics.itemsVisited, statistics.itemsDrawn);
+			mPerformanceHud->setTileCounts(statistics.tileHits, statistics.tileMisses);
+			mPerformanceHud->setSymbolCounts(statistics.symbolHits, statistics.symbolMisses);
+			refreshHud = mPerformanceHud->draw(&painter);
+		}
+	}
+	else if (scene && isInteracting())
+	{
+		// Mid-drag frames are drawn without antialiasing; endInteraction() repaints at full
+		// quality once the view has been idle for a moment
+		QRectF visibleRect = DiagramWidget::visibleRect();
+		QPainter painter(viewport());
 
-			if (mGridStyle == GridDots && mGridSpacingMajor > 0)
-			{
-				qreal spacing = grid * mGridSpacingMajor;
-				for(qreal y = qCeil(visibleRect.top() / spacing) * spacing; y < visibleRect.bottom(); y += spacing)
-				{
-					for(qreal x = qCeil(visibleRect.left() / spacing) * spacing; x < visibleRect.right(); x += spacing)
-						painter->drawPoint(QPointF(x, y));
-				}
-			}
+		painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, false);
+		painter.setClipRegion(event->region());
+		painter.scale(scale(), scale());
+		painter.translate(-visibleRect.topLeft());
 
-			if (mGridStyle == GridGraphPaper && mGridSpacingMinor > 0)
-			{
-				gridPen.setStyle(Qt::DotLine);
-				painter->setPen(gridPen);
-
-				qreal spacing = grid * mGridSpacingMinor;
-				for(qreal y = qCeil(visibleRect.top() / spacing) * spacing; y < visibleRect.bottom(); y += spacing)
-					painter->drawLine(QPointF(visibleRect.left(), y), QPointF(visibleRect.right(), y));
-				for(qreal x = qCeil(visibleRect.left() / spacing) * spacing; x < visibleRect.right(); x += spacing)
-					painter->drawLine(QPointF(x, visibleRect.top()), QPointF(x, visibleRect.bottom()));
-			}
+		mPerformanceHud->beginStage();
+		drawBackground(&painter);
+		mPerformanceHud->endStage(DiagramPerformanceHud::BackgroundStage);
 
-			if ((mGridStyle == GridLines || mGridStyle == GridGraphPaper) && mGridSpacingMajor > 0)
-			{
-				gridPen.setStyle(Qt::SolidLine);
-				painter->setPen(gridPen);
-
-				qreal spacing = grid * mGridSpacingMajor;
-				for(qreal y = qCeil(visibleRect.top() / spacing) * spacing; y < visibleRect.bottom(); y += spacing)
-					painter->drawLine(QPointF(visibleRect.left(), y), QPointF(visibleRect.right(), y));
-				for(qreal x = qCeil(visibleRect.left() / spacing) * spacing; x < visibleRect.right(); x += spacing)
-					painter->drawLine(QPointF(x, visibleRect.top()), QPointF(x, visibleRect.bottom()));
-			}
+		mPerformanceHud->beginStage();
+		drawItems(&painter);
+		mPerformanceHud->endStage(DiagramPerformanceHud::ItemsStage);
+
+		mPerformanceHud->beginStage();
+		drawForeground(&painter);
+		mPerformanceHud->endStage(DiagramPerformanceHud::ForegroundStage);
+
+		mPerformanceHud->endFrame();
+
+		if (mPerformanceHud->isVisible())
+		{
+			mPerformanceHud->setItemCounts(scene->items().size(), numberOfItemsInRect(visibleRect));
+			refreshHud = mPerformanceHud->draw(&painter);
 		}
+	}
+	else
+	{
+		DrawingView::paintEvent(event);
+		mPerformanceHud->endFrame();
 
-		// Draw origin
-		painter->save();
-		painter->setBrush(Qt::transparent);
-		painter->setPen(gridPen);
-		painter->resetTransform();
-		painter->drawEllipse(mapFromScene(QPointF(0, 0)), 4, 4);
-		painter->restore();
+		if (mPerformanceHud->isVisible())
+		{
+			QPainter painter(viewport());
+			refreshHud = mPerformanceHud->draw(&painter);
+		}
+	}
+
+	if (refreshHud) viewport()->update(mPerformanceHud->refreshRect());
+}
+
+void DiagramWidget::drawBackground(QPainter* painter)
+{
+	DrawingScene* scene = DiagramWidget::scene();
+
+	if (scene)
+	{
+		QBrush backgroundBrush = scene->backgroundBrush();
+		QRectF visibleRect = (painter->hasClipping()) ? painter->clipBoundingRect() : DiagramWidget::visibleRect();
+
+		QPainter::RenderHints renderHints = painter->renderHints();
+		painter->setRenderHints(renderHints, false);
+
+		// Draw background and grid
+		mGridRenderer->draw(painter, visibleRect);
 
 		// Draw border
 		QPen borderPen((backgroundBrush == Qt::black) ? Qt::white : Qt::black, devicePixelRatio() * 2);
@@ -381,10 +678,44 @@ void DiagramWidget::drawBackground(QPainter* painter)
 	}
 }
 
+void DiagramWidget::drawForeground(QPainter* painter)
+{
+	// The origin marker belongs to the overlay so that the cached tiles only hold the background,
+	// grid and items
+	QPen gridPen(mGridBrush, devicePixelRatio());
+	gridPen.setCosmetic(true);
+
+	QPointF originPos = painter->transform().map(QPointF(0, 0));
+
+	painter->save();
+	painter->setBrush(Qt::transparent);
+	painter->setPen(gridPen);
+	painter->resetTransform();
+	painter->drawEllipse(originPos, 4, 4);
+	painter->restore();
+
+	// Items being placed are not in the scene, so the tile cache does not have them.  The direct
+	// drawing paths already draw them along with the scene's items.
+	if (mDrawPlaceItemsInOverlay && mode() == PlaceMode)
+	{
+		QList<DrawingItem*> items = placeItems();
+
+		for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+		{
+			if ((*itemIter)->isVisible()) renderDiagramItem(painter, *itemIter);
+		}
+	}
+
+	// Selection handles, the rubber band and hover feedback
+	DrawingView::drawForeground(painter);
+}
+
 //==================================================================================================
 
 void DiagramWidget::mousePressEvent(QMouseEvent* event)
 {
+	beginInteraction();
+	mItemsChangedDuringPress = false;
 	DrawingView::mousePressEvent(event);
 
 	mButtonDownScenePos = mapToScene(event->pos());
@@ -422,6 +753,7 @@ void DiagramWidget::mouseReleaseEvent(QMouseEvent* event)
 	else DrawingView::mouseReleaseEvent(event);
 
 	mConsecutivePastes = 0;
+	if (mInteracting) beginInteraction();
 }
 
 void DiagramWidget::mouseDoubleClickEvent(QMouseEvent* event)
@@ -431,6 +763,69 @@ void DiagramWidget::mouseDoubleClickEvent(QMouseEvent* event)
 	if (mouseDownItem()) emit propertiesTriggered();
 }
 
+void DiagramWidget::resizeEvent(QResizeEvent* event)
+{
+	DrawingView::resizeEvent(event);
+	loadVisibleItems();
+}
+
+//==================================================================================================
+
+void DiagramWidget::invalidateItems(const QList<DrawingItem*>& items)
+{
+	if (QApplication::mouseButtons() != Qt::NoButton) mItemsChangedDuringPress = true;
+	mTileCache->invalidateItems(items);
+	pinItems(items);
+}
+
+void DiagramWidget::invalidateItem(DrawingItem* item)
+{
+	if (QApplication::mouseButtons() != Qt::NoButton) mItemsChangedDuringPress = true;
+	mTileCache->invalidateItems(QList<DrawingItem*>() << item);
+	pinItems(QList<DrawingItem*>() << item);
+}
+
+void DiagramWidget::pinItems(const QList<DrawingItem*>& items)
+{
+	// Selected or changed items may be referenced by the undo stack, so they are never unloaded
+	if (mItemIndex) mItemIndex->pinItems(items);
+}
+
+void DiagramWidget::updateDirtyRegion()
+{
+	if (!mDirtyRegion.isEmpty())
+	{
+		viewport()->update(mDirtyRegion);
+		mDirtyRegion = QRegion();
+	}
+}
+
+void DiagramWidget::beginInteraction()
+{
+	// Presses, scrolling and zooming change what the view needs next, so tile jobs queued for the
+	// previous view give way to the ones the next frame schedules
+	mTileCache->cancelJobs();
+
+	if (mInteractiveQualityEnabled)
+	{
+		mInteracting = true;
+		mInteractionTimer.start();
+	}
+}
+
+void DiagramWidget::endInteraction()
+{
+	// The press is still going on; the release restarts the timer
+	if (mInteracting && QApplication::mouseButtons() != Qt::NoButton) return;
+
+	mInteractionTimer.stop();
+	if (mInteracting)
+	{
+		mInteracting = false;
+		viewport()->update();
+	}
+}
+
 //==================================================================================================
 
 void DiagramWidget::updateActionsFromSelection()
@@ -445,11 +840,10 @@ void DiagramWidget::updateActionsFromSelection()
 	if (selectedItems.size() == 1)
 	{
 		DrawingItem* item = selectedItems.first();
-		DrawingItemGroup* groupItem = dynamic_cast<DrawingItemGroup*>(item);
 
 		canInsertRemovePoints = ((item->flags() & DrawingItem::CanInsertPoints) ||
 			(item->flags() & DrawingItem::CanRemovePoints));
-		canUngroup = (groupItem);
+		canUngroup = (diagramItemType(item) == DiagramItemGroupType);
 	}
 
 	actions[InsertPointAction]->setEnabled(canInsertRemovePoints);
@@ -491,6 +885,10 @@ void DiagramWidget::addActions()
 	addAction("Zoom Fit", this, SLOT(zoomFit()), ":/icons/oxygen/zoom-fit-best.png", "/");
 
 	addAction("Properties...", this, SIGNAL(propertiesTriggered()), ":/icons/oxygen/games-config-board.png");
+
+	QAction* hudAction = addAction("Performance Overlay", nullptr, nullptr, "", "F12");
+	hudAction->setCheckable(true);
+	connect(hudAction, SIGNAL(toggled(bool)), this, SLOT(setPerformanceHudVisible(bool)));
 }
 
 void DiagramWidget::createContextMenu()
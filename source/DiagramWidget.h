@@ -22,11 +22,19 @@
 #define DIAGRAMWIDGET_H
 
 #include <Drawing.h>
+#include "DiagramLevelOfDetail.h"
+
+class DiagramGridRenderer;
+class DiagramItemIndex;
+class DiagramPerformanceHud;
+class DiagramTileCache;
 
 class DiagramWidget : public DrawingView
 {
 	Q_OBJECT
 
+	friend class DiagramTileCache;
+
 public:
 	enum GridRenderStyle { GridNone, GridDots, GridLines, GridGraphPaper };
 
@@ -37,12 +45,23 @@ public:
 		SelectAllAction, SelectNoneAction, RotateAction, RotateBackAction, FlipAction,
 		BringForwardAction, SendBackwardAction, BringToFrontAction, SendToBackAction,
 		InsertPointAction, RemovePointAction, GroupAction, UngroupAction,
-		ZoomInAction, ZoomOutAction, ZoomFitAction, PropertiesAction, NumberOfActions };
+		ZoomInAction, ZoomOutAction, ZoomFitAction, PropertiesAction, PerformanceHudAction, NumberOfActions };
 
 private:
 	GridRenderStyle mGridStyle;
 	QBrush mGridBrush;
 	int mGridSpacingMajor, mGridSpacingMinor;
+	DiagramGridRenderer* mGridRenderer;
+	DiagramTileCache* mTileCache;
+	DiagramLevelOfDetail mLevelOfDetail;
+
+	bool mInteractiveQualityEnabled;
+	bool mInteracting;
+	QTimer mInteractionTimer;
+
+	QRegion mDirtyRegion;
+
+	DiagramPerformanceHud* mPerformanceHud;
 
 	QMenu mSingleItemContextMenu;
 	QMenu mSinglePolyItemContextMenu;
@@ -51,6 +70,11 @@ private:
 
 	QPointF mButtonDownScenePos;
 	int mConsecutivePastes;
+	bool mItemsChangedDuringPress;
+	bool mDrawPlaceItemsInOverlay;
+
+	DiagramItemIndex* mItemIndex;
+	int mMaxLoadedItems;
 
 public:
 	DiagramWidget();
@@ -64,16 +88,37 @@ public:
 	int gridSpacingMajor() const;
 	int gridSpacingMinor() const;
 
+	void setLevelOfDetail(const DiagramLevelOfDetail& levelOfDetail);
+	DiagramLevelOfDetail levelOfDetail() const;
+
+	void setInteractiveQualityEnabled(bool enabled);
+	bool isInteractiveQualityEnabled() const;
+	bool isInteracting() const;
+
+	bool isPerformanceHudVisible() const;
+
 	void setProperties(const QHash<DiagramWidget::Property,QVariant>& properties);
 	QHash<DiagramWidget::Property,QVariant> properties() const;
 
 	void render(QPainter* painter);
 	void renderExport(QPainter* painter);
+	void renderExport(QPainter* painter, const QList<DrawingItem*>& items);
+
+	void setItemIndex(DiagramItemIndex* index);
+	DiagramItemIndex* itemIndex() const;
+
+	void addSceneItems(const QList<DrawingItem*>& items);
+	void clearItems();
 
 public slots:
 	void cut();
 	void copy();
 	void paste();
+	void selectAll();
+
+	void loadVisibleItems();
+	void loadAllItems();
+	void invalidateItemList();
 
 	void setSelectionStyleProperties(const QHash<DrawingItemStyle::Property,QVariant>& properties);
 	void setSelectionCornerRadius(qreal radiusX, qreal radiusY);
@@ -85,6 +130,8 @@ public slots:
 	void setItemCaption(DrawingItem* item, const QString& caption);
 	void setViewProperties(const QHash<DiagramWidget::Property,QVariant>& properties);
 
+	void setPerformanceHudVisible(bool visible);
+
 signals:
 	void propertiesTriggered();
 
@@ -94,16 +141,31 @@ signals:
 	void diagramPropertiesChanged(const QHash<DiagramWidget::Property,QVariant>& properties);
 
 protected:
+	void paintEvent(QPaintEvent* event);
 	void drawBackground(QPainter* painter);
+	void drawForeground(QPainter* painter);
 
 	void mousePressEvent(QMouseEvent* event);
 	void mouseReleaseEvent(QMouseEvent* event);
 	void mouseDoubleClickEvent(QMouseEvent* event);
 
+	void resizeEvent(QResizeEvent* event);
+
 private slots:
 	void updateActionsFromSelection();
+	void invalidateItems(const QList<DrawingItem*>& items);
+	void invalidateItem(DrawingItem* item);
+	void pinItems(const QList<DrawingItem*>& items);
+	void beginInteraction();
+	void endInteraction();
+	void updateDirtyRegion();
 
 private:
+	void addDirtyRect(const QRectF& sceneRect);
+	void addDirtyItems(const QList<DrawingItem*>& items);
+	QRectF itemSceneRect(DrawingItem* item) const;
+	int numberOfItemsInRect(const QRectF& sceneRect) const;
+
 	void addActions();
 	void createContextMenu();
 	QAction* addAction(const QString& text, QObject* slotObj, const char* slotFunction,
@@ -19,6 +19,7 @@
  */
 
 #include "DiagramWriter.h"
+#include "DiagramItemType.h"
 
 DiagramWriter::DiagramWriter(QIODevice* device) : QXmlStreamWriter(device)
 {
@@ -50,15 +51,15 @@ void DiagramWriter::write(DiagramWidget* diagram)
 		if (scene)
 		{
 			QRectF sceneRect = scene->sceneRect();
-			writeAttribute("view-left", QString::number(sceneRect.left()));
-			writeAttribute("view-top", QString::number(sceneRect.top()));
-			writeAttribute("view-width", QString::number(sceneRect.width()));
-			writeAttribute("view-height", QString::number(sceneRect.height()));
+			writeAttribute("view-left", numberToString(sceneRect.left()));
+			writeAttribute("view-top", numberToString(sceneRect.top()));
+			writeAttribute("view-width", numberToString(sceneRect.width()));
+			writeAttribute("view-height", numberToString(sceneRect.height()));
 
 			writeAttribute("background-color", colorToString(scene->backgroundBrush().color()));
 		}
 
-		writeAttribute("grid", QString::number(diagram->grid()));
+		writeAttribute("grid", numberToString(diagram->grid()));
 
 		writeAttribute("grid-color", colorToString(diagram->gridBrush().color()));
 		writeAttribute("grid-style", gridStyleToString(diagram->gridStyle()));
@@ -98,33 +99,23 @@ void DiagramWriter::writeItemElements(const QList<DrawingItem*>& items)
 {
 	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
 	{
-		DrawingLineItem* lineItem = dynamic_cast<DrawingLineItem*>(*itemIter);
-		DrawingArcItem* arcItem = dynamic_cast<DrawingArcItem*>(*itemIter);
-		DrawingPolylineItem* polylineItem = dynamic_cast<DrawingPolylineItem*>(*itemIter);
-		DrawingCurveItem* curveItem = dynamic_cast<DrawingCurveItem*>(*itemIter);
-		DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(*itemIter);
-		DrawingEllipseItem* ellipseItem = dynamic_cast<DrawingEllipseItem*>(*itemIter);
-		DrawingPolygonItem* polygonItem = dynamic_cast<DrawingPolygonItem*>(*itemIter);
-		DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(*itemIter);
-		DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(*itemIter);
-		DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(*itemIter);
-		DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(*itemIter);
-		DrawingPathItem* pathItem = dynamic_cast<DrawingPathItem*>(*itemIter);
-		DrawingItemGroup* groupItem = dynamic_cast<DrawingItemGroup*>(*itemIter);
-
-		if (lineItem) writeLineItem(lineItem);
-		else if (arcItem) writeArcItem(arcItem);
-		else if (polylineItem) writePolylineItem(polylineItem);
-		else if (curveItem) writeCurveItem(curveItem);
-		else if (rectItem) writeRectItem(rectItem);
-		else if (ellipseItem) writeEllipseItem(ellipseItem);
-		else if (polygonItem) writePolygonItem(polygonItem);
-		else if (textItem) writeTextItem(textItem);
-		else if (textRectItem) writeTextRectItem(textRectItem);
-		else if (textEllipseItem) writeTextEllipseItem(textEllipseItem);
-		else if (textPolygonItem) writeTextPolygonItem(textPolygonItem);
-		else if (pathItem) writePathItem(pathItem);
-		else if (groupItem) writeItemGroup(groupItem);
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramLineItemType: writeLineItem(static_cast<DrawingLineItem*>(*itemIter)); break;
+		case DiagramArcItemType: writeArcItem(static_cast<DrawingArcItem*>(*itemIter)); break;
+		case DiagramPolylineItemType: writePolylineItem(static_cast<DrawingPolylineItem*>(*itemIter)); break;
+		case DiagramCurveItemType: writeCurveItem(static_cast<DrawingCurveItem*>(*itemIter)); break;
+		case DiagramRectItemType: writeRectItem(static_cast<DrawingRectItem*>(*itemIter)); break;
+		case DiagramEllipseItemType: writeEllipseItem(static_cast<DrawingEllipseItem*>(*itemIter)); break;
+		case DiagramPolygonItemType: writePolygonItem(static_cast<DrawingPolygonItem*>(*itemIter)); break;
+		case DiagramTextItemType: writeTextItem(static_cast<DrawingTextItem*>(*itemIter)); break;
+		case DiagramTextRectItemType: writeTextRectItem(static_cast<DrawingTextRectItem*>(*itemIter)); break;
+		case DiagramTextEllipseItemType: writeTextEllipseItem(static_cast<DrawingTextEllipseItem*>(*itemIter)); break;
+		case DiagramTextPolygonItemType: writeTextPolygonItem(static_cast<DrawingTextPolygonItem*>(*itemIter)); break;
+		case DiagramPathItemType: writePathItem(static_cast<DrawingPathItem*>(*itemIter)); break;
+		case DiagramItemGroupType: writeItemGroup(static_cast<DrawingItemGroup*>(*itemIter)); break;
+		default: break;
+		}
 	}
 }
 
@@ -137,10 +128,10 @@ void DiagramWriter::writeLineItem(DrawingLineItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QLineF line = item->line();
-	writeAttribute("x1", QString::number(line.x1()));
-	writeAttribute("y1", QString::number(line.y1()));
-	writeAttribute("x2", QString::number(line.x2()));
-	writeAttribute("y2", QString::number(line.y2()));
+	writeAttribute("x1", numberToString(line.x1()));
+	writeAttribute("y1", numberToString(line.y1()));
+	writeAttribute("x2", numberToString(line.x2()));
+	writeAttribute("y2", numberToString(line.y2()));
 
 	writeItemStyle(item->style());
 
@@ -154,10 +145,10 @@ void DiagramWriter::writeArcItem(DrawingArcItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QLineF line = item->arc();
-	writeAttribute("x1", QString::number(line.x1()));
-	writeAttribute("y1", QString::number(line.y1()));
-	writeAttribute("x2", QString::number(line.x2()));
-	writeAttribute("y2", QString::number(line.y2()));
+	writeAttribute("x1", numberToString(line.x1()));
+	writeAttribute("y1", numberToString(line.y1()));
+	writeAttribute("x2", numberToString(line.x2()));
+	writeAttribute("y2", numberToString(line.y2()));
 
 	writeItemStyle(item->style());
 
@@ -187,14 +178,14 @@ void DiagramWriter::writeCurveItem(DrawingCurveItem* item)
 
 	writeAttribute("transform", transformToString(item));
 
-	writeAttribute("x1", QString::number(item->curveStartPos().x()));
-	writeAttribute("y1", QString::number(item->curveStartPos().y()));
-	writeAttribute("cx1", QString::number(item->curveStartControlPos().x()));
-	writeAttribute("cy1", QString::number(item->curveStartControlPos().y()));
-	writeAttribute("cx2", QString::number(item->curveEndControlPos().x()));
-	writeAttribute("cy2", QString::number(item->curveEndControlPos().y()));
-	writeAttribute("x2", QString::number(item->curveEndPos().x()));
-	writeAttribute("y2", QString::number(item->curveEndPos().y()));
+	writeAttribute("x1", numberToString(item->curveStartPos().x()));
+	writeAttribute("y1", numberToString(item->curveStartPos().y()));
+	writeAttribute("cx1", numberToString(item->curveStartControlPos().x()));
+	writeAttribute("cy1", numberToString(item->curveStartControlPos().y()));
+	writeAttribute("cx2", numberToString(item->curveEndControlPos().x()));
+	writeAttribute("cy2", numberToString(item->curveEndControlPos().y()));
+	writeAttribute("x2", numberToString(item->curveEndPos().x()));
+	writeAttribute("y2", numberToString(item->curveEndPos().y()));
 
 	writeItemStyle(item->style());
 
@@ -208,13 +199,13 @@ void DiagramWriter::writeRectItem(DrawingRectItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QRectF rect = item->rect();
-	writeAttribute("left", QString::number(rect.left()));
-	writeAttribute("top", QString::number(rect.top()));
-	writeAttribute("width", QString::number(rect.width()));
-	writeAttribute("height", QString::number(rect.height()));
+	writeAttribute("left", numberToString(rect.left()));
+	writeAttribute("top", numberToString(rect.top()));
+	writeAttribute("width", numberToString(rect.width()));
+	writeAttribute("height", numberToString(rect.height()));
 
-	if (item->cornerRadiusX() != 0) writeAttribute("rx", QString::number(item->cornerRadiusX()));
-	if (item->cornerRadiusY() != 0) writeAttribute("ry", QString::number(item->cornerRadiusY()));
+	if (item->cornerRadiusX() != 0) writeAttribute("rx", numberToString(item->cornerRadiusX()));
+	if (item->cornerRadiusY() != 0) writeAttribute("ry", numberToString(item->cornerRadiusY()));
 
 	writeItemStyle(item->style());
 
@@ -228,10 +219,10 @@ void DiagramWriter::writeEllipseItem(DrawingEllipseItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QRectF rect = item->ellipse();
-	writeAttribute("left", QString::number(rect.left()));
-	writeAttribute("top", QString::number(rect.top()));
-	writeAttribute("width", QString::number(rect.width()));
-	writeAttribute("height", QString::number(rect.height()));
+	writeAttribute("left", numberToString(rect.left()));
+	writeAttribute("top", numberToString(rect.top()));
+	writeAttribute("width", numberToString(rect.width()));
+	writeAttribute("height", numberToString(rect.height()));
 
 	writeItemStyle(item->style());
 
@@ -275,13 +266,13 @@ void DiagramWriter::writeTextRectItem(DrawingTextRectItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QRectF rect = item->rect();
-	writeAttribute("left", QString::number(rect.left()));
-	writeAttribute("top", QString::number(rect.top()));
-	writeAttribute("width", QString::number(rect.width()));
-	writeAttribute("height", QString::number(rect.height()));
+	writeAttribute("left", numberToString(rect.left()));
+	writeAttribute("top", numberToString(rect.top()));
+	writeAttribute("width", numberToString(rect.width()));
+	writeAttribute("height", numberToString(rect.height()));
 
-	if (item->cornerRadiusX() != 0) writeAttribute("rx", QString::number(item->cornerRadiusX()));
-	if (item->cornerRadiusY() != 0) writeAttribute("ry", QString::number(item->cornerRadiusY()));
+	if (item->cornerRadiusX() != 0) writeAttribute("rx", numberToString(item->cornerRadiusX()));
+	if (item->cornerRadiusY() != 0) writeAttribute("ry", numberToString(item->cornerRadiusY()));
 
 	writeItemStyle(item->style());
 
@@ -297,10 +288,10 @@ void DiagramWriter::writeTextEllipseItem(DrawingTextEllipseItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QRectF rect = item->ellipse();
-	writeAttribute("left", QString::number(rect.left()));
-	writeAttribute("top", QString::number(rect.top()));
-	writeAttribute("width", QString::number(rect.width()));
-	writeAttribute("height", QString::number(rect.height()));
+	writeAttribute("left", numberToString(rect.left()));
+	writeAttribute("top", numberToString(rect.top()));
+	writeAttribute("width", numberToString(rect.width()));
+	writeAttribute("height", numberToString(rect.height()));
 
 	writeItemStyle(item->style());
 
@@ -337,22 +328,22 @@ void DiagramWriter::writePathItem(DrawingPathItem* item)
 	writeAttribute("transform", transformToString(item));
 
 	QRectF rect = item->rect();
-	writeAttribute("left", QString::number(rect.left()));
-	writeAttribute("top", QString::number(rect.top()));
-	writeAttribute("width", QString::number(rect.width()));
-	writeAttribute("height", QString::number(rect.height()));
+	writeAttribute("left", numberToString(rect.left()));
+	writeAttribute("top", numberToString(rect.top()));
+	writeAttribute("width", numberToString(rect.width()));
+	writeAttribute("height", numberToString(rect.height()));
 
 	writeItemStyle(item->style());
 
 	QRectF pathRect = item->pathRect();
-	writeAttribute("view-left", QString::number(pathRect.left()));
-	writeAttribute("view-top", QString::number(pathRect.top()));
-	writeAttribute("view-width", QString::number(pathRect.width()));
-	writeAttribute("view-height", QString::number(pathRect.height()));
+	writeAttribute("view-left", numberToString(pathRect.left()));
+	writeAttribute("view-top", numberToString(pathRect.top()));
+	writeAttribute("view-width", numberToString(pathRect.width()));
+	writeAttribute("view-height", numberToString(pathRect.height()));
 
 	writeAttribute("d", pathToString(item->path()));
 
-	QString glueStr = pointsToString(item->connectionPoints());
+	const QString& glueStr = pointsToString(item->connectionPoints());
 	if (!glueStr.isEmpty()) writeAttribute("glue-points", glueStr);
 
 	writeEndElement();
@@ -383,7 +374,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 		}
 
 		if (style->hasValue(DrawingItemStyle::PenWidth))
-			writeAttribute("stroke-width", QString::number(style->value(DrawingItemStyle::PenWidth).toReal()));
+			writeAttribute("stroke-width", numberToString(style->value(DrawingItemStyle::PenWidth).toReal()));
 
 		if (style->hasValue(DrawingItemStyle::PenColor))
 			writeAttribute("stroke-color", colorToString(style->value(DrawingItemStyle::PenColor).value<QColor>()));
@@ -391,7 +382,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 		if (style->hasValue(DrawingItemStyle::PenOpacity))
 		{
 			qreal opacity = style->value(DrawingItemStyle::PenOpacity).toReal();
-			if (opacity != 1.0) writeAttribute("stroke-opacity", QString::number(opacity));
+			if (opacity != 1.0) writeAttribute("stroke-opacity", numberToString(opacity));
 		}
 
 		// Brush
@@ -401,7 +392,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 		if (style->hasValue(DrawingItemStyle::BrushOpacity))
 		{
 			qreal opacity = style->value(DrawingItemStyle::BrushOpacity).toReal();
-			if (opacity != 1.0) writeAttribute("fill-opacity", QString::number(opacity));
+			if (opacity != 1.0) writeAttribute("fill-opacity", numberToString(opacity));
 		}
 
 		// Font
@@ -409,7 +400,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 			writeAttribute("font-name", style->value(DrawingItemStyle::FontName).toString());
 
 		if (style->hasValue(DrawingItemStyle::FontSize))
-			writeAttribute("font-size", QString::number(style->value(DrawingItemStyle::FontSize).toReal()));
+			writeAttribute("font-size", numberToString(style->value(DrawingItemStyle::FontSize).toReal()));
 
 		if (style->hasValue(DrawingItemStyle::FontBold))
 		{
@@ -453,7 +444,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 		if (style->hasValue(DrawingItemStyle::TextOpacity))
 		{
 			qreal opacity = style->value(DrawingItemStyle::TextOpacity).toReal();
-			if (opacity != 1.0) writeAttribute("text-opacity", QString::number(opacity));
+			if (opacity != 1.0) writeAttribute("text-opacity", numberToString(opacity));
 		}
 
 		// Arrows
@@ -465,7 +456,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 			if (arrow != DrawingItemStyle::ArrowNone)
 				writeAttribute("arrow-start-style", arrowStyleToString(arrow));
 			if (arrowSize != 0)
-				writeAttribute("arrow-start-size", QString::number(arrowSize));
+				writeAttribute("arrow-start-size", numberToString(arrowSize));
 		}
 
 		if (style->hasValue(DrawingItemStyle::EndArrowStyle) && style->hasValue(DrawingItemStyle::EndArrowSize))
@@ -476,7 +467,7 @@ void DiagramWriter::writeItemStyle(DrawingItemStyle* style)
 			if (arrow != DrawingItemStyle::ArrowNone)
 				writeAttribute("arrow-end-style", arrowStyleToString(arrow));
 			if (arrowSize != 0)
-				writeAttribute("arrow-end-size", QString::number(arrowSize));
+				writeAttribute("arrow-end-size", numberToString(arrowSize));
 		}
 	}
 }
@@ -551,32 +542,28 @@ QString DiagramWriter::gridStyleToString(DiagramWidget::GridRenderStyle gridStyl
 	return str;
 }
 
-QString DiagramWriter::pathToString(const QPainterPath& path) const
+const QString& DiagramWriter::pathToString(const QPainterPath& path)
 {
-	QString pathStr;
+	mBuffer.clear();
 
 	for(int i = 0; i < path.elementCount(); i++)
 	{
 		QPainterPath::Element element = path.elementAt(i);
 
+		if (i > 0) mBuffer.append(' ');
+
 		switch (element.type)
 		{
-		case QPainterPath::MoveToElement:
-			pathStr += "M " + QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
-		case QPainterPath::LineToElement:
-			pathStr += "L " + QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
-		case QPainterPath::CurveToElement:
-			pathStr += "C " + QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
-		case QPainterPath::CurveToDataElement:
-			pathStr += QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
+		case QPainterPath::MoveToElement: mBuffer.append("M "); break;
+		case QPainterPath::LineToElement: mBuffer.append("L "); break;
+		case QPainterPath::CurveToElement: mBuffer.append("C "); break;
+		default: break;
 		}
+
+		mBuffer.append(QPointF(element.x, element.y), ' ');
 	}
 
-	return pathStr.trimmed();
+	return mBuffer.string();
 }
 
 QString DiagramWriter::penStyleToString(Qt::PenStyle style) const
@@ -625,17 +612,25 @@ QString DiagramWriter::penJoinStyleToString(Qt::PenJoinStyle style) const
 	return str;
 }
 
-QString DiagramWriter::pointsToString(const QPolygonF& points) const
+const QString& DiagramWriter::numberToString(qreal value)
 {
-	QString pointsStr;
+	return mBuffer.number(value);
+}
+
+const QString& DiagramWriter::pointsToString(const QPolygonF& points)
+{
+	mBuffer.clear();
 
 	for(auto pointIter = points.begin(); pointIter != points.end(); pointIter++)
-		pointsStr += QString::number((*pointIter).x()) + "," + QString::number((*pointIter).y()) + " ";
+	{
+		if (pointIter != points.begin()) mBuffer.append(' ');
+		mBuffer.append(*pointIter, ',');
+	}
 
-	return pointsStr.trimmed();
+	return mBuffer.string();
 }
 
-QString DiagramWriter::transformToString(DrawingItem* item) const
+const QString& DiagramWriter::transformToString(DrawingItem* item)
 {
 	QPointF pos = item->position();
 	QTransform transform = item->transform();
@@ -646,8 +641,24 @@ QString DiagramWriter::transformToString(DrawingItem* item) const
 	qreal hScale = transform.m11();
 	qreal vScale = transform.m22();
 
-	QString str = "translate(" + QString::number(pos.x()) + "," + QString::number(pos.y()) + ")";
-	str += (rotation != 0) ? " rotate(" + QString::number(rotation) + ")" : "";
-	str += (hScale != 1.0 || vScale != 1.0) ? " scale(" + QString::number(hScale) + "," + QString::number(vScale) + ")" : "";
-	return str;
+	mBuffer.clear();
+	mBuffer.append("translate(");
+	mBuffer.append(pos, ',');
+	mBuffer.append(')');
+
+	if (rotation != 0)
+	{
+		mBuffer.append(" rotate(");
+		mBuffer.append(rotation);
+		mBuffer.append(')');
+	}
+
+	if (hScale != 1.0 || vScale != 1.0)
+	{
+		mBuffer.append(" scale(");
+		mBuffer.append(QPointF(hScale, vScale), ',');
+		mBuffer.append(')');
+	}
+
+	return mBuffer.string();
 }
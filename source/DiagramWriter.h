@@ -22,9 +22,13 @@
 #define DIAGRAMWRITER_H
 
 #include <DiagramWidget.h>
+#include "DiagramNumberFormat.h"
 
 class DiagramWriter : public QXmlStreamWriter
 {
+private:
+	DiagramNumberBuffer mBuffer;
+
 public:
 	DiagramWriter(QIODevice* device);
 	DiagramWriter(QString* string);
@@ -56,12 +60,13 @@ private:
 	QString arrowStyleToString(DrawingItemStyle::ArrowStyle style) const;
 	QString colorToString(const QColor& color) const;
 	QString gridStyleToString(DiagramWidget::GridRenderStyle gridStyle) const;
-	QString pathToString(const QPainterPath& path) const;
+	const QString& numberToString(qreal value);
+	const QString& pathToString(const QPainterPath& path);
 	QString penStyleToString(Qt::PenStyle style) const;
 	QString penCapStyleToString(Qt::PenCapStyle style) const;
 	QString penJoinStyleToString(Qt::PenJoinStyle style) const;
-	QString pointsToString(const QPolygonF& points) const;
-	QString transformToString(DrawingItem* item) const;
+	const QString& pointsToString(const QPolygonF& points);
+	const QString& transformToString(DrawingItem* item);
 };
 
 #endif
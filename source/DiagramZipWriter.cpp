@@ -0,0 +1,234 @@
+/* DiagramZipWriter.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "DiagramZipWriter.h"
+#include <QtConcurrent>
+#include <quazip.h>
+#include <zip.h>
+#include <zlib.h>
+
+DiagramZipWriter::DiagramZipWriter(QuaZip* zip, int chunkSize) : QIODevice()
+{
+	mZip = zip;
+	mChunkSize = chunkSize;
+	mMaxPendingChunks = 2 * qMax(QThreadPool::globalInstance()->maxThreadCount(), 1);
+	mDateTime = QDateTime(QDate(1980, 1, 1), QTime(0, 0, 0));
+
+	mSize = 0;
+	mCrc = 0;
+	mFileValid = false;
+}
+
+DiagramZipWriter::~DiagramZipWriter()
+{
+	for(auto chunkIter = mPendingChunks.begin(); chunkIter != mPendingChunks.end(); chunkIter++)
+		chunkIter->waitForFinished();
+}
+
+//==================================================================================================
+
+void DiagramZipWriter::setDateTime(const QDateTime& dateTime)
+{
+	mDateTime = dateTime;
+}
+
+QDateTime DiagramZipWriter::dateTime() const
+{
+	return mDateTime;
+}
+
+//==================================================================================================
+
+bool DiagramZipWriter::beginFile(const QString& path)
+{
+	if (isOpen()) endFile();
+
+	mPath = path;
+	mBuffer.clear();
+	mDictionary.clear();
+	mSize = 0;
+	mCrc = crc32(0L, Z_NULL, 0);
+
+	// The entry is opened in raw mode so that the deflated chunks can be written as they are; the
+	// CRC and uncompressed size are only needed when it is closed
+	zip_fileinfo info;
+
+	memset(&info, 0, sizeof(info));
+	info.tmz_date.tm_sec = mDateTime.time().second();
+	info.tmz_date.tm_min = mDateTime.time().minute();
+	info.tmz_date.tm_hour = mDateTime.time().hour();
+	info.tmz_date.tm_mday = mDateTime.date().day();
+	info.tmz_date.tm_mon = mDateTime.date().month() - 1;
+	info.tmz_date.tm_year = mDateTime.date().year();
+
+	QByteArray fileName = mZip->getFileNameCodec()->fromUnicode(path);
+
+	mFileValid = (zipOpenNewFileInZip2(mZip->getZipFile(), fileName.constData(), &info, nullptr, 0,
+		nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION, 1) == ZIP_OK);
+
+	if (mFileValid) open(QIODevice::WriteOnly);
+	else if (mErrorMessage.isEmpty()) mErrorMessage = "Error writing " + path + " in file: " + mZip->getZipName();
+
+	return mFileValid;
+}
+
+bool DiagramZipWriter::endFile()
+{
+	bool fileValid = false;
+
+	if (isOpen())
+	{
+		queueChunk(mBuffer.size(), true);
+
+		while (!mPendingChunks.isEmpty())
+			writeChunk(mPendingChunks.takeFirst().result());
+
+		fileValid = (zipCloseFileInZipRaw(mZip->getZipFile(), (uLong)mSize, (uLong)mCrc) == ZIP_OK);
+		fileValid = (fileValid && mFileValid);
+
+		if (!fileValid && mErrorMessage.isEmpty())
+			mErrorMessage = "Error writing " + mPath + " in file: " + mZip->getZipName();
+
+		mDictionary.clear();
+		close();
+	}
+
+	return fileValid;
+}
+
+bool DiagramZipWriter::addFile(const QString& path, const QByteArray& data)
+{
+	bool fileValid = beginFile(path);
+
+	if (fileValid)
+	{
+		write(data);
+		fileValid = endFile();
+	}
+
+	return fileValid;
+}
+
+bool DiagramZipWriter::finish()
+{
+	if (isOpen()) endFile();
+	return mErrorMessage.isEmpty();
+}
+
+//==================================================================================================
+
+QString DiagramZipWriter::errorMessage() const
+{
+	return mErrorMessage;
+}
+
+//==================================================================================================
+
+qint64 DiagramZipWriter::readData(char* data, qint64 maxSize)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(maxSize);
+	return -1;
+}
+
+qint64 DiagramZipWriter::writeData(const char* data, qint64 maxSize)
+{
+	mBuffer.append(data, (int)maxSize);
+
+	while (mBuffer.size() >= mChunkSize)
+		queueChunk(mChunkSize, false);
+
+	return maxSize;
+}
+
+//==================================================================================================
+
+void DiagramZipWriter::queueChunk(int length, bool last)
+{
+	// Each job gets its chunk and the 32 KB before it to use as the deflate dictionary
+	QByteArray input = mDictionary + mBuffer.left(length);
+	int start = mDictionary.size();
+
+	mDictionary = input.right(qMin(input.size(), 32768));
+	mBuffer.remove(0, length);
+
+	mPendingChunks.append(QtConcurrent::run(&DiagramZipWriter::deflateChunk, input, start, length, last));
+
+	// Write out the chunks that are done, oldest first, and wait on the oldest one if too many are
+	// still in flight
+	while (!mPendingChunks.isEmpty() &&
+		(mPendingChunks.first().isFinished() || mPendingChunks.size() > mMaxPendingChunks))
+	{
+		writeChunk(mPendingChunks.takeFirst().result());
+	}
+}
+
+void DiagramZipWriter::writeChunk(const Chunk& chunk)
+{
+	mCrc = crc32_combine(mCrc, chunk.crc, chunk.length);
+	mSize += chunk.length;
+
+	if (mFileValid)
+	{
+		mFileValid = (chunk.valid &&
+			zipWriteInFileInZip(mZip->getZipFile(), chunk.data.constData(), chunk.data.size()) == ZIP_OK);
+	}
+}
+
+//==================================================================================================
+
+DiagramZipWriter::Chunk DiagramZipWriter::deflateChunk(const QByteArray& data, int start, int length, bool last)
+{
+	Chunk chunk;
+	z_stream stream;
+	const Bytef* input = reinterpret_cast<const Bytef*>(data.constData()) + start;
+
+	chunk.crc = crc32(crc32(0L, Z_NULL, 0), input, length);
+	chunk.length = length;
+	chunk.valid = false;
+
+	memset(&stream, 0, sizeof(stream));
+
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK)
+	{
+		// Priming each chunk with the tail of the previous one keeps the compression ratio close to
+		// that of a single stream.  Every chunk but the last ends on a byte boundary after a sync
+		// flush, so the chunks can simply be concatenated.
+		int dictionaryLength = qMin(start, 32768);
+		if (dictionaryLength > 0) deflateSetDictionary(&stream, input - dictionaryLength, dictionaryLength);
+
+		chunk.data.resize((int)deflateBound(&stream, length) + 64);
+
+		stream.next_in = const_cast<Bytef*>(input);
+		stream.avail_in = length;
+		stream.next_out = reinterpret_cast<Bytef*>(chunk.data.data());
+		stream.avail_out = chunk.data.size();
+
+		int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+		if (last) chunk.valid = (result == Z_STREAM_END);
+		else chunk.valid = (result == Z_OK && stream.avail_in == 0 && stream.avail_out > 0);
+
+		chunk.data.resize((int)stream.total_out);
+		deflateEnd(&stream);
+	}
+
+	return chunk;
+}
@@ -0,0 +1,88 @@
+/* DiagramZipWriter.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef DIAGRAMZIPWRITER_H
+#define DIAGRAMZIPWRITER_H
+
+#include <QtCore>
+
+class QuaZip;
+
+// Writes package parts into a zip file as they are generated.  Between beginFile() and endFile()
+// the writer is an open QIODevice; the data written to it is split into fixed-size chunks that
+// are deflated on the global thread pool.  Finished chunks are appended to the zip entry in order
+// and released, and only a few chunks per thread can be in flight, so memory use does not grow
+// with the size of the part.  Each chunk is primed with the tail of the previous one and all but
+// the last end on a sync flush, so they concatenate into a single raw deflate stream that does
+// not depend on the number of threads or the order in which they finish.  Entries are stamped
+// with a fixed date, the start of the DOS epoch unless the caller sets another one, so that the
+// same document always gives the same file.
+class DiagramZipWriter : public QIODevice
+{
+private:
+	struct Chunk
+	{
+		QByteArray data;
+		quint32 crc;
+		int length;
+		bool valid;
+	};
+
+	QuaZip* mZip;
+	int mChunkSize;
+	int mMaxPendingChunks;
+	QDateTime mDateTime;
+
+	QString mPath;
+	QByteArray mBuffer;
+	QByteArray mDictionary;
+	QList< QFuture<Chunk> > mPendingChunks;
+	qint64 mSize;
+	quint32 mCrc;
+	bool mFileValid;
+
+	QString mErrorMessage;
+
+public:
+	DiagramZipWriter(QuaZip* zip, int chunkSize = 262144);
+	~DiagramZipWriter();
+
+	void setDateTime(const QDateTime& dateTime);
+	QDateTime dateTime() const;
+
+	bool beginFile(const QString& path);
+	bool endFile();
+	bool addFile(const QString& path, const QByteArray& data);
+	bool finish();
+
+	QString errorMessage() const;
+
+protected:
+	qint64 readData(char* data, qint64 maxSize);
+	qint64 writeData(const char* data, qint64 maxSize);
+
+private:
+	void queueChunk(int length, bool last);
+	void writeChunk(const Chunk& chunk);
+
+	static Chunk deflateChunk(const QByteArray& data, int start, int length, bool last);
+};
+
+#endif
@@ -25,6 +25,7 @@ ExportOptionsDialog::ExportOptionsDialog(const QRectF& sceneRect, const QSize& e
 {
 	QVBoxLayout* mainLayout = new QVBoxLayout();
 	mainLayout->addWidget(createSizeGroup());
+	mainLayout->addWidget(createPngGroup());
 	mainLayout->addWidget(new QWidget());
 	mainLayout->addWidget(createButtonBox());
 	setLayout(mainLayout);
@@ -85,6 +86,25 @@ bool ExportOptionsDialog::maintainAspectRatio() const
 
 //==================================================================================================
 
+void ExportOptionsDialog::showPngOptions(int compressionLevel, int filter)
+{
+	mCompressionLevelSpin->setValue(compressionLevel);
+	mFilterCombo->setCurrentIndex(filter);
+	mPngGroup->setVisible(true);
+}
+
+int ExportOptionsDialog::pngCompressionLevel() const
+{
+	return mCompressionLevelSpin->value();
+}
+
+int ExportOptionsDialog::pngFilter() const
+{
+	return mFilterCombo->currentIndex();
+}
+
+//==================================================================================================
+
 void ExportOptionsDialog::updateWidth()
 {
 	if (mMaintainAspectRatioCheck->isChecked())
@@ -145,6 +165,31 @@ QGroupBox* ExportOptionsDialog::createSizeGroup()
 	return sizeGroup;
 }
 
+QGroupBox* ExportOptionsDialog::createPngGroup()
+{
+	mPngGroup = new QGroupBox("PNG");
+
+	mCompressionLevelSpin = new QSpinBox();
+	mCompressionLevelSpin->setRange(0, 9);
+	mCompressionLevelSpin->setValue(6);
+
+	// Same order as DiagramPngWriter::Filter
+	mFilterCombo = new QComboBox();
+	mFilterCombo->addItems(QStringList() << "Adaptive" << "None" << "Sub" << "Up" << "Average" << "Paeth");
+
+	QFormLayout* pngLayout = new QFormLayout();
+	pngLayout->addRow("Compression: ", mCompressionLevelSpin);
+	pngLayout->addRow("Filter: ", mFilterCombo);
+	pngLayout->setRowWrapPolicy(QFormLayout::DontWrapRows);
+	pngLayout->setLabelAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+	pngLayout->setFieldGrowthPolicy(QFormLayout::AllNonFixedFieldsGrow);
+	pngLayout->itemAt(0, QFormLayout::LabelRole)->widget()->setMinimumWidth(100);
+	mPngGroup->setLayout(pngLayout);
+	mPngGroup->setVisible(false);
+
+	return mPngGroup;
+}
+
 QDialogButtonBox* ExportOptionsDialog::createButtonBox()
 {
 	QDialogButtonBox* buttonBox = new QDialogButtonBox(Qt::Horizontal);
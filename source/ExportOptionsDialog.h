@@ -32,6 +32,10 @@ private:
 	QLineEdit* mHeightEdit;
 	QCheckBox* mMaintainAspectRatioCheck;
 
+	QGroupBox* mPngGroup;
+	QSpinBox* mCompressionLevelSpin;
+	QComboBox* mFilterCombo;
+
 	QRectF mSceneRect;
 
 public:
@@ -42,12 +46,17 @@ public:
 	QSize exportSize() const;
 	bool maintainAspectRatio() const;
 
+	void showPngOptions(int compressionLevel, int filter);
+	int pngCompressionLevel() const;
+	int pngFilter() const;
+
 private slots:
 	void updateWidth();
 	void updateHeight();
 
 private:
 	QGroupBox* createSizeGroup();
+	QGroupBox* createPngGroup();
 	QDialogButtonBox* createButtonBox();
 };
 
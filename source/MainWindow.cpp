@@ -22,13 +22,21 @@
 #include "DynamicPropertiesWidget.h"
 #include "DiagramWriter.h"
 #include "DiagramReader.h"
+#include "DiagramBinaryWriter.h"
+#include "DiagramBinaryReader.h"
+#include "DiagramImageRenderer.h"
+#include "DiagramItemIndex.h"
+#include "DiagramPngWriter.h"
 #include "PreferencesDialog.h"
 #include "AboutDialog.h"
 #include "ExportOptionsDialog.h"
 #include "ElectricItems.h"
 #include "LogicItems.h"
 #include "OdgWriter.h"
+#include "PdfWriter.h"
+#include "SvgWriter.h"
 #include "VsdxWriter.h"
+#include <QtConcurrent>
 
 //#define RELEASE_BUILD
 #undef RELEASE_BUILD
@@ -37,14 +45,18 @@ MainWindow::MainWindow(const QString& filePath) : QMainWindow()
 {
 	mPromptCloseUnsaved = true;
 	mPromptOverwrite = true;
-	mFileFilter = "Jade Drawings (*.jdm);;All Files (*)";
+	mFileFilter = "Jade Drawings (*.jdm);;Jade Binary Drawings (*.jdmb);;All Files (*)";
 	mFileSuffix = "jdm";
+	mBinaryFileSuffix = "jdmb";
+	mLazyLoadFileSize = 32 * 1024 * 1024;
 	mNewDiagramCount = 0;
 #ifndef WIN32
 	mWorkingDir = QDir::home();
 #endif
 
 	mPrevMaintainAspectRatio = true;
+	mPrevPngCompressionLevel = 6;
+	mPrevPngFilter = DiagramPngWriter::FilterAdaptive;
 
 	QMainWindow::setWindowTitle("Jade");
 	setWindowIcon(QIcon(":/icons/jade/diagram.png"));
@@ -53,6 +65,7 @@ MainWindow::MainWindow(const QString& filePath) : QMainWindow()
 	loadSettings();
 
 	mDiagramWidget = new DiagramWidget();
+	mDiagramWidget->setLevelOfDetail(mLevelOfDetail);
 
 	mStackedWidget = new QStackedWidget();
 	mStackedWidget->addWidget(new QWidget());
@@ -80,17 +93,7 @@ MainWindow::~MainWindow()
 
 void MainWindow::loadSettings()
 {
-#ifdef RELEASE_BUILD
-#ifdef WIN32
-	QString configPath("config.ini");
-#else
-	QString configPath(QDir::home().absoluteFilePath(".jade/config.ini"));
-#endif
-#else
-	QString configPath("config.ini");
-#endif
-
-	QSettings settings(configPath, QSettings::IniFormat);
+	QSettings settings(configPath(), QSettings::IniFormat);
 
 	settings.beginGroup("Window");
 	restoreGeometry(settings.value("geometry", QVariant()).toByteArray());
@@ -112,31 +115,13 @@ void MainWindow::loadSettings()
 	mDiagramDefaultProperties[DiagramWidget::GridColor] = settings.value("gridColor", QVariant(QColor(0, 128, 128))).value<QColor>();
 	settings.endGroup();
 
-	settings.beginGroup("ItemDefaults");
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenStyle, settings.value("penStyle", (uint)(Qt::SolidLine)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenWidth, settings.value("penWidth", 12.0));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenColor, settings.value("penColor", QColor(0, 0, 0)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenOpacity, settings.value("penOpacity", 1.0));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenCapStyle, (uint)(Qt::RoundCap));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenJoinStyle, (uint)(Qt::RoundJoin));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::BrushStyle, (uint)(Qt::SolidPattern));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::BrushColor, settings.value("brushColor", QColor(255, 255, 255)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::BrushOpacity, settings.value("brushOpacity", 1.0));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontName, settings.value("fontName", "Arial"));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontSize, settings.value("fontSize", 100.0));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontBold, settings.value("fontBold", false));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontItalic, settings.value("fontItalic", false));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontUnderline, settings.value("fontUnderline", false));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontOverline, false);
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontStrikeThrough, settings.value("fontStrikeThrough", false));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextHorizontalAlignment, settings.value("textAlignHorizontal", (uint)(Qt::AlignHCenter)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextVerticalAlignment, settings.value("textAlignVertical", (uint)(Qt::AlignVCenter)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextColor, settings.value("textColor", QColor(0, 0, 0)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextOpacity, settings.value("textOpacity", 1.0));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::StartArrowStyle, settings.value("startArrowStyle", (uint)(DrawingItemStyle::ArrowNone)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::StartArrowSize, settings.value("startArrowSize", 100.0));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::EndArrowStyle, settings.value("endArrowStyle", (uint)(DrawingItemStyle::ArrowNone)));
-	DrawingItemStyle::setDefaultValue(DrawingItemStyle::EndArrowSize, settings.value("endArrowSize", 100.0));
+	loadItemDefaults(settings);
+
+	settings.beginGroup("LevelOfDetail");
+	mLevelOfDetail.setMinimumItemSize(settings.value("minimumItemSize", QVariant(3.0)).toReal());
+	mLevelOfDetail.setMinimumTextSize(settings.value("minimumTextSize", QVariant(5.0)).toReal());
+	mLevelOfDetail.setMinimumArrowSize(settings.value("minimumArrowSize", QVariant(4.0)).toReal());
+	mLevelOfDetail.setMinimumSymbolSize(settings.value("minimumSymbolSize", QVariant(16.0)).toReal());
 	settings.endGroup();
 
 	settings.beginGroup("Recent");
@@ -166,17 +151,7 @@ void MainWindow::loadSettings()
 
 void MainWindow::saveSettings()
 {
-#ifdef RELEASE_BUILD
-#ifdef WIN32
-	QString configPath("config.ini");
-#else
-	QString configPath(QDir::home().absoluteFilePath(".jade/config.ini"));
-#endif
-#else
-	QString configPath("config.ini");
-#endif
-
-	QSettings settings(configPath, QSettings::IniFormat);
+	QSettings settings(configPath(), QSettings::IniFormat);
 
 	settings.beginGroup("Window");
 	settings.setValue("geometry", saveGeometry());
@@ -221,6 +196,13 @@ void MainWindow::saveSettings()
 	settings.setValue("endArrowSize", DrawingItemStyle::defaultValue(DrawingItemStyle::EndArrowSize));
 	settings.endGroup();
 
+	settings.beginGroup("LevelOfDetail");
+	settings.setValue("minimumItemSize", mLevelOfDetail.minimumItemSize());
+	settings.setValue("minimumTextSize", mLevelOfDetail.minimumTextSize());
+	settings.setValue("minimumArrowSize", mLevelOfDetail.minimumArrowSize());
+	settings.setValue("minimumSymbolSize", mLevelOfDetail.minimumSymbolSize());
+	settings.endGroup();
+
 	settings.beginGroup("Recent");
 	settings.setValue("workingDir", mWorkingDir.absolutePath());
 	settings.endGroup();
@@ -237,6 +219,49 @@ void MainWindow::saveSettings()
 	settings.endGroup();
 }
 
+QString MainWindow::configPath()
+{
+#ifdef RELEASE_BUILD
+#ifdef WIN32
+	return QString("config.ini");
+#else
+	return QDir::home().absoluteFilePath(".jade/config.ini");
+#endif
+#else
+	return QString("config.ini");
+#endif
+}
+
+void MainWindow::loadItemDefaults(QSettings& settings)
+{
+	settings.beginGroup("ItemDefaults");
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenStyle, settings.value("penStyle", (uint)(Qt::SolidLine)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenWidth, settings.value("penWidth", 12.0));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenColor, settings.value("penColor", QColor(0, 0, 0)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenOpacity, settings.value("penOpacity", 1.0));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenCapStyle, (uint)(Qt::RoundCap));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::PenJoinStyle, (uint)(Qt::RoundJoin));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::BrushStyle, (uint)(Qt::SolidPattern));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::BrushColor, settings.value("brushColor", QColor(255, 255, 255)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::BrushOpacity, settings.value("brushOpacity", 1.0));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontName, settings.value("fontName", "Arial"));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontSize, settings.value("fontSize", 100.0));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontBold, settings.value("fontBold", false));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontItalic, settings.value("fontItalic", false));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontUnderline, settings.value("fontUnderline", false));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontOverline, false);
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::FontStrikeThrough, settings.value("fontStrikeThrough", false));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextHorizontalAlignment, settings.value("textAlignHorizontal", (uint)(Qt::AlignHCenter)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextVerticalAlignment, settings.value("textAlignVertical", (uint)(Qt::AlignVCenter)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextColor, settings.value("textColor", QColor(0, 0, 0)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::TextOpacity, settings.value("textOpacity", 1.0));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::StartArrowStyle, settings.value("startArrowStyle", (uint)(DrawingItemStyle::ArrowNone)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::StartArrowSize, settings.value("startArrowSize", 100.0));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::EndArrowStyle, settings.value("endArrowStyle", (uint)(DrawingItemStyle::ArrowNone)));
+	DrawingItemStyle::setDefaultValue(DrawingItemStyle::EndArrowSize, settings.value("endArrowSize", 100.0));
+	settings.endGroup();
+}
+
 //==================================================================================================
 
 bool MainWindow::newDiagram()
@@ -320,14 +345,20 @@ bool MainWindow::saveDiagramAs()
 		QString filePath = (mFilePath.startsWith("Untitled")) ? mWorkingDir.path() : mFilePath;
 		QFileDialog::Options options = (mPromptOverwrite) ? (QFileDialog::Options)0 : QFileDialog::DontConfirmOverwrite;
 
-		filePath = QFileDialog::getSaveFileName(this, "Save File", filePath, mFileFilter, nullptr, options);
+		QString selectedFilter;
+
+		filePath = QFileDialog::getSaveFileName(this, "Save File", filePath, mFileFilter, &selectedFilter, options);
 		if (!filePath.isEmpty())
 		{
 			QFileInfo fileInfo(filePath);
 			mWorkingDir = fileInfo.dir();
 
-			if (!filePath.endsWith("." + mFileSuffix, Qt::CaseInsensitive))
-				filePath += "." + mFileSuffix;
+			if (!filePath.endsWith("." + mFileSuffix, Qt::CaseInsensitive) &&
+				!filePath.endsWith("." + mBinaryFileSuffix, Qt::CaseInsensitive))
+			{
+				if (selectedFilter.contains("*." + mBinaryFileSuffix)) filePath += "." + mBinaryFileSuffix;
+				else filePath += "." + mFileSuffix;
+			}
 
 			diagramSaved = saveDiagramToFile(filePath);
 			if (!diagramSaved)
@@ -385,34 +416,74 @@ void MainWindow::exportPng()
 		QFileDialog::Options options = (mPromptOverwrite) ? (QFileDialog::Options)0 : QFileDialog::DontConfirmOverwrite;
 
 		if (filePath.startsWith("Untitled")) filePath = mWorkingDir.path();
-		else filePath = filePath.left(filePath.length() - mFileSuffix.length() - 1) + ".png";
+		else filePath = filePath.left(filePath.lastIndexOf(".")) + ".png";
 
 		filePath = QFileDialog::getSaveFileName(this, "Export PNG", filePath, "Portable Network Graphics (*.png);;All Files (*)", nullptr, options);
 		if (!filePath.isEmpty())
 		{
 			ExportOptionsDialog exportDialog(mDiagramWidget->scene()->sceneRect(), QSize(), mPrevMaintainAspectRatio, 0.2, this);
+			exportDialog.showPngOptions(mPrevPngCompressionLevel, mPrevPngFilter);
 
 			if (exportDialog.exec() == QDialog::Accepted)
 			{
 				if (!filePath.endsWith(".png", Qt::CaseInsensitive)) filePath += ".png";
 
-				QImage pngImage(exportDialog.exportSize(), QImage::Format_ARGB32);
-				QPainter painter;
 				QRectF visibleRect = mDiagramWidget->scene()->sceneRect();
+				QSize exportSize = exportDialog.exportSize();
+				QFile pngFile(filePath);
 
 				mDiagramWidget->clearSelection();
 
-				painter.begin(&pngImage);
-				painter.scale(pngImage.width() / visibleRect.width(), pngImage.height() / visibleRect.height());
-				painter.translate(-visibleRect.left(), -visibleRect.top());
-				painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
-				mDiagramWidget->renderExport(&painter);
-				painter.end();
-
-				pngImage.save(filePath, "PNG");
+				if (pngFile.open(QIODevice::WriteOnly))
+				{
+					DiagramImageRenderer renderer(mDiagramWidget, exportSize, visibleRect);
+					DiagramPngWriter pngWriter(&pngFile);
+
+					pngWriter.setCompressionLevel(exportDialog.pngCompressionLevel());
+					pngWriter.setFilter((DiagramPngWriter::Filter)exportDialog.pngFilter());
+
+					// Render on the thread pool and keep the GUI responsive.  The renderer has already
+					// recorded the items, and the modal progress dialog is shown right away so that the
+					// export cannot be started again while it runs.
+					QProgressDialog progressDialog("Exporting " + QFileInfo(filePath).fileName() + "...",
+						"Cancel", 0, exportSize.height(), this);
+					QFutureWatcher<bool> watcher;
+					QEventLoop eventLoop;
+					QTimer progressTimer;
+
+					progressDialog.setWindowModality(Qt::WindowModal);
+					progressDialog.setMinimumDuration(0);
+					progressDialog.show();
+					progressTimer.setSingleShot(true);
+					progressTimer.setInterval(100);
+
+					connect(&watcher, SIGNAL(finished()), &eventLoop, SLOT(quit()));
+					connect(&progressTimer, SIGNAL(timeout()), &eventLoop, SLOT(quit()));
+
+					watcher.setFuture(QtConcurrent::run(&renderer, &DiagramImageRenderer::writePng, &pngWriter, 1024));
+
+					while (!watcher.isFinished())
+					{
+						progressTimer.start();
+						eventLoop.exec();
+
+						progressDialog.setValue(renderer.rowsRendered());
+						if (progressDialog.wasCanceled()) renderer.cancel();
+					}
+
+					bool ok = watcher.result();
+					progressDialog.reset();
+					pngFile.close();
+
+					if (renderer.isCancelled()) pngFile.remove();
+					else if (!ok) QMessageBox::critical(this, "PNG Export Error", pngWriter.errorMessage());
+				}
+				else QMessageBox::critical(this, "PNG Export Error", "Unable to open " + filePath + " for writing.");
 
 				mPrevExportSize = exportDialog.exportSize();
 				mPrevMaintainAspectRatio = exportDialog.maintainAspectRatio();
+				mPrevPngCompressionLevel = exportDialog.pngCompressionLevel();
+				mPrevPngFilter = exportDialog.pngFilter();
 			}
 		}
 	}
@@ -426,7 +497,7 @@ void MainWindow::exportSvg()
 		QFileDialog::Options options = (mPromptOverwrite) ? (QFileDialog::Options)0 : QFileDialog::DontConfirmOverwrite;
 
 		if (filePath.startsWith("Untitled")) filePath = mWorkingDir.path();
-		else filePath = filePath.left(filePath.length() - mFileSuffix.length() - 1) + ".svg";
+		else filePath = filePath.left(filePath.lastIndexOf(".")) + ".svg";
 
 		filePath = QFileDialog::getSaveFileName(this, "Export SVG", filePath, "Scalable Vector Graphics (*.svg);;All Files (*)", nullptr, options);
 		if (!filePath.isEmpty())
@@ -437,22 +508,11 @@ void MainWindow::exportSvg()
 			{
 				if (!filePath.endsWith(".svg", Qt::CaseInsensitive)) filePath += ".svg";
 
-				QSvgGenerator svgImage;
-				QPainter painter;
-				QRectF visibleRect = mDiagramWidget->scene()->sceneRect();
-
 				mDiagramWidget->selectNone();
 
-				svgImage.setFileName(filePath);
-				svgImage.setSize(exportDialog.exportSize());
-				svgImage.setViewBox(QRect(QPoint(0, 0), exportDialog.exportSize()));
-
-				painter.begin(&svgImage);
-				painter.scale(svgImage.size().width() / visibleRect.width(), svgImage.size().height() / visibleRect.height());
-				painter.translate(-visibleRect.left(), -visibleRect.top());
-				painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing, true);
-				mDiagramWidget->renderExport(&painter);
-				painter.end();
+				SvgWriter writer;
+				if (!writer.write(mDiagramWidget, exportDialog.exportSize(), filePath))
+					QMessageBox::critical(this, "SVG Export Error", writer.errorMessage());
 
 				mPrevExportSize = exportDialog.exportSize();
 				mPrevMaintainAspectRatio = exportDialog.maintainAspectRatio();
@@ -469,7 +529,7 @@ void MainWindow::exportOdg()
 		QFileDialog::Options options = (mPromptOverwrite) ? (QFileDialog::Options)0 : QFileDialog::DontConfirmOverwrite;
 
 		if (filePath.startsWith("Untitled")) filePath = mWorkingDir.path();
-		else filePath = filePath.left(filePath.length() - mFileSuffix.length() - 1) + ".odg";
+		else filePath = filePath.left(filePath.lastIndexOf(".")) + ".odg";
 
 		filePath = QFileDialog::getSaveFileName(this, "Export to ODG", filePath, "Open Document Graphics (*.odg);;All Files (*)", nullptr, options);
 		if (!filePath.isEmpty())
@@ -477,6 +537,7 @@ void MainWindow::exportOdg()
 			if (!filePath.endsWith(".odg", Qt::CaseInsensitive)) filePath += ".odg";
 
 			mDiagramWidget->selectNone();
+			mDiagramWidget->loadAllItems();
 
 			OdgWriter writer;
 			if (!writer.write(mDiagramWidget, &mPrinter, filePath))
@@ -493,7 +554,7 @@ void MainWindow::exportVsdx()
 		QFileDialog::Options options = (mPromptOverwrite) ? (QFileDialog::Options)0 : QFileDialog::DontConfirmOverwrite;
 
 		if (filePath.startsWith("Untitled")) filePath = mWorkingDir.path();
-		else filePath = filePath.left(filePath.length() - mFileSuffix.length() - 1) + ".vsdx";
+		else filePath = filePath.left(filePath.lastIndexOf(".")) + ".vsdx";
 
 		filePath = QFileDialog::getSaveFileName(this, "Export to VSDX", filePath, "Visio Drawings (*.vsdx);;All Files (*)", nullptr, options);
 		if (!filePath.isEmpty())
@@ -501,6 +562,7 @@ void MainWindow::exportVsdx()
 			if (!filePath.endsWith(".vsdx", Qt::CaseInsensitive)) filePath += ".vsdx";
 
 			mDiagramWidget->selectNone();
+			mDiagramWidget->loadAllItems();
 
 			VsdxWriter writer;
 			if (!writer.write(mDiagramWidget, &mPrinter, filePath))
@@ -557,7 +619,7 @@ void MainWindow::printPdf()
 		QFileDialog::Options options = (mPromptOverwrite) ? (QFileDialog::Options)0 : QFileDialog::DontConfirmOverwrite;
 
 		if (filePath.startsWith("Untitled")) filePath = mWorkingDir.path();
-		else filePath = filePath.left(filePath.length() - mFileSuffix.length() - 1) + ".pdf";
+		else filePath = filePath.left(filePath.lastIndexOf(".")) + ".pdf";
 
 		filePath = QFileDialog::getSaveFileName(this, "Print to PDF", filePath, "Portable Document Format (*.pdf);;All Files (*)", nullptr, options);
 		if (!filePath.isEmpty())
@@ -566,9 +628,9 @@ void MainWindow::printPdf()
 
 			mDiagramWidget->clearSelection();
 
-			mPrinter.setOutputFileName(filePath);
-			printPages(&mPrinter);
-			mPrinter.setOutputFileName("");
+			PdfWriter writer;
+			if (!writer.write(mDiagramWidget, &mPrinter, filePath))
+				QMessageBox::critical(this, "PDF Export Error", writer.errorMessage());
 		}
 	}
 }
@@ -605,6 +667,7 @@ void MainWindow::showDiagram()
 	mPropertiesWidget->setDiagramProperties(mDiagramWidget->properties());
 
 	mDiagramWidget->zoomFit();
+	mDiagramWidget->loadVisibleItems();
 
 	setModifiedText(mDiagramWidget->isClean());
 	setNumberOfItemsText(mDiagramWidget->scene()->items().size());
@@ -856,15 +919,29 @@ bool MainWindow::isDiagramVisible() const
 
 bool MainWindow::saveDiagramToFile(const QString& filePath)
 {
+	// Release the memory-mapped source file before it can be overwritten
+	mDiagramWidget->loadAllItems();
+	mDiagramWidget->setItemIndex(nullptr);
+
 	QFile dataFile(filePath);
 
 	bool fileError = !dataFile.open(QIODevice::WriteOnly);
 	if (!fileError)
 	{
-		DiagramWriter writer(&dataFile);
-		writer.write(mDiagramWidget);
+		if (filePath.endsWith("." + mBinaryFileSuffix, Qt::CaseInsensitive))
+		{
+			DiagramBinaryWriter writer(&dataFile);
+			writer.write(mDiagramWidget);
+		}
+		else
+		{
+			DiagramWriter writer(&dataFile);
+			writer.write(mDiagramWidget);
+		}
 		dataFile.close();
 
+		// The readers add their items to the scene directly
+		mDiagramWidget->invalidateItemList();
 		mDiagramWidget->setClean();
 		mDiagramWidget->viewport()->update();
 
@@ -883,10 +960,34 @@ bool MainWindow::loadDiagramFromFile(const QString& filePath)
 	{
 		clearDiagram();
 
-		DiagramReader reader(&dataFile);
-		reader.read(mDiagramWidget);
+		if (filePath.endsWith("." + mBinaryFileSuffix, Qt::CaseInsensitive))
+		{
+			DiagramBinaryReader reader(&dataFile);
+			reader.read(mDiagramWidget);
+			fileError = (reader.status() != QDataStream::Ok);
+		}
+		else if (dataFile.size() >= mLazyLoadFileSize)
+		{
+			// Index large drawings and only load the items as they are needed
+			DiagramItemIndex* itemIndex = new DiagramItemIndex();
+
+			fileError = !itemIndex->open(filePath);
+			if (!fileError)
+			{
+				itemIndex->readPage(mDiagramWidget);
+				mDiagramWidget->setItemIndex(itemIndex);
+			}
+			else delete itemIndex;
+		}
+		else
+		{
+			DiagramReader reader(&dataFile);
+			reader.read(mDiagramWidget);
+		}
 		dataFile.close();
 
+		// The readers add their items to the scene directly
+		mDiagramWidget->invalidateItemList();
 		mDiagramWidget->setClean();
 		mDiagramWidget->viewport()->update();
 
@@ -899,7 +1000,8 @@ bool MainWindow::loadDiagramFromFile(const QString& filePath)
 void MainWindow::clearDiagram()
 {
 	mDiagramWidget->setDefaultMode();
-	mDiagramWidget->scene()->clearItems();
+	mDiagramWidget->setItemIndex(nullptr);
+	mDiagramWidget->clearItems();
 }
 
 //==================================================================================================
@@ -1089,6 +1191,8 @@ void MainWindow::createMenus()
 	menu->addAction(widgetActions[DiagramWidget::ZoomInAction]);
 	menu->addAction(widgetActions[DiagramWidget::ZoomOutAction]);
 	menu->addAction(widgetActions[DiagramWidget::ZoomFitAction]);
+	menu->addSeparator();
+	menu->addAction(widgetActions[DiagramWidget::PerformanceHudAction]);
 
 	menu = menuBar()->addMenu("About");
 	menu->addAction(actions[AboutAction]);
@@ -47,6 +47,7 @@ private:
 	QStackedWidget* mStackedWidget;
 	DiagramWidget* mDiagramWidget;
 	QHash<DiagramWidget::Property,QVariant> mDiagramDefaultProperties;
+	DiagramLevelOfDetail mLevelOfDetail;
 
 	QComboBox* mZoomCombo;
 
@@ -69,12 +70,16 @@ private:
 	QString mFilePath;
 	QString mFileFilter;
 	QString mFileSuffix;
+	QString mBinaryFileSuffix;
+	qint64 mLazyLoadFileSize;
 	int mNewDiagramCount;
 	QDir mWorkingDir;
 	QByteArray mWindowState;
 
 	QSize mPrevExportSize;
 	bool mPrevMaintainAspectRatio;
+	int mPrevPngCompressionLevel;
+	int mPrevPngFilter;
 
 	QPrinter mPrinter;
 
@@ -85,6 +90,9 @@ public:
 	void loadSettings();
 	void saveSettings();
 
+	static QString configPath();
+	static void loadItemDefaults(QSettings& settings);
+
 public slots:
 	bool newDiagram();
 	bool openDiagram();
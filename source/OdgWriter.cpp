@@ -19,9 +19,10 @@
  */
  
 #include "OdgWriter.h"
+#include "DiagramItemType.h"
+#include "DiagramZipWriter.h"
 #include <QtPrintSupport>
 #include <quazip.h>
-#include <quazipfile.h>
 
 OdgWriter::OdgWriter() 
 {
@@ -45,7 +46,7 @@ bool OdgWriter::write(DiagramWidget* diagram, QPrinter* printer, const QString&
 	analyzeDiagram();
 	analyzeItemStyles();
 	
-	writeOdg(writeContent(), writeStyles(), writeMeta(), writeSettings(), writeManifest());
+	writeOdg();
 
 	return mErrorMessage.isEmpty();
 }
@@ -146,28 +147,20 @@ void OdgWriter::analyzeItemStyles()
 void OdgWriter::findItemStyles(const QList<DrawingItem*>& items, QList<DrawingItemStyle*>& itemStyles)
 {
 	DrawingItemStyle* style;
-	DrawingItemGroup* groupItem;
-	
 	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
 	{
 		style = (*itemIter)->style();
 		if (!itemStyles.contains(style)) itemStyles.append(style);
 		
-		groupItem = dynamic_cast<DrawingItemGroup*>(*itemIter);
-		if (groupItem) findItemStyles(groupItem->items(), itemStyles);
+		if (diagramItemType(*itemIter) == DiagramItemGroupType)
+			findItemStyles(static_cast<DrawingItemGroup*>(*itemIter)->items(), itemStyles);
 	}
 }
 
 //==================================================================================================
 
-QString OdgWriter::writeContent()
+void OdgWriter::writeContent(QXmlStreamWriter& xml)
 {
-	QString contentStr;
-	
-	QXmlStreamWriter xml(&contentStr);
-	xml.setAutoFormatting(true);
-	xml.setAutoFormattingIndent(2);
-
 	xml.writeStartDocument();
 	xml.writeStartElement("office:document-content");
 	xml.writeAttribute("xmlns:draw", "urn:oasis:names:tc:opendocument:xmlns:drawing:1.0");
@@ -205,18 +198,10 @@ QString OdgWriter::writeContent()
 
 	xml.writeEndElement();
 	xml.writeEndDocument();
-	
-	return contentStr;
 }
 
-QString OdgWriter::writeStyles()
+void OdgWriter::writeStyles(QXmlStreamWriter& xml)
 {
-	QString stylesStr;
-	
-	QXmlStreamWriter xml(&stylesStr);
-	xml.setAutoFormatting(true);
-	xml.setAutoFormattingIndent(2);
-
 	xml.writeStartDocument();
 	xml.writeStartElement("office:document-styles");
 	xml.writeAttribute("xmlns:draw", "urn:oasis:names:tc:opendocument:xmlns:drawing:1.0");
@@ -247,18 +232,10 @@ QString OdgWriter::writeStyles()
 
 	xml.writeEndElement();
 	xml.writeEndDocument();
-	
-	return stylesStr;
 }
 
-QString OdgWriter::writeMeta()
+void OdgWriter::writeMeta(QXmlStreamWriter& xml)
 {
-	QString metaStr;
-	
-	QXmlStreamWriter xml(&metaStr);
-	xml.setAutoFormatting(true);
-	xml.setAutoFormattingIndent(2);
-
 	xml.writeStartDocument();
 	xml.writeStartElement("office:document-meta");
 	xml.writeAttribute("xmlns:office", "urn:oasis:names:tc:opendocument:xmlns:office:1.0");
@@ -268,18 +245,10 @@ QString OdgWriter::writeMeta()
 
 	xml.writeEndElement();
 	xml.writeEndDocument();
-	
-	return metaStr;
 }
 
-QString OdgWriter::writeSettings()
+void OdgWriter::writeSettings(QXmlStreamWriter& xml)
 {
-	QString settingsStr;
-	
-	QXmlStreamWriter xml(&settingsStr);
-	xml.setAutoFormatting(true);
-	xml.setAutoFormattingIndent(2);
-
 	xml.writeStartDocument();
 	xml.writeStartElement("office:document-settings");
 	xml.writeAttribute("xmlns:office", "urn:oasis:names:tc:opendocument:xmlns:office:1.0");
@@ -289,18 +258,10 @@ QString OdgWriter::writeSettings()
 
 	xml.writeEndElement();
 	xml.writeEndDocument();
-	
-	return settingsStr;
 }
 
-QString OdgWriter::writeManifest()
+void OdgWriter::writeManifest(QXmlStreamWriter& xml)
 {
-	QString manifestStr;
-	
-	QXmlStreamWriter xml(&manifestStr);
-	xml.setAutoFormatting(true);
-	xml.setAutoFormattingIndent(2);
-
 	xml.writeStartDocument();
 	xml.writeStartElement("manifest:manifest");
 	xml.writeAttribute("xmlns:manifest", "urn:oasis:names:tc:opendocument:xmlns:manifest:1.0");
@@ -334,41 +295,50 @@ QString OdgWriter::writeManifest()
 
 	xml.writeEndElement();
 	xml.writeEndDocument();
-	
-	return manifestStr;
 }
 
-void OdgWriter::writeOdg(const QString& contentStr, const QString& stylesStr, const QString& metaStr, 
-	const QString& settingsStr, const QString& manifestStr)
+void OdgWriter::writeOdg()
 {
 	QuaZip odgFile(mFilePath);
 
 	if (odgFile.open(QuaZip::mdCreate))
 	{
-		createFileInZip(&odgFile, "mimetype", "application/vnd.oasis.opendocument.graphics");
-		createFileInZip(&odgFile, "META-INF/manifest.xml", manifestStr);
-		createFileInZip(&odgFile, "content.xml", contentStr);
-		createFileInZip(&odgFile, "meta.xml", metaStr);
-		createFileInZip(&odgFile, "settings.xml", settingsStr);
-		createFileInZip(&odgFile, "styles.xml", stylesStr);
+		DiagramZipWriter zipWriter(&odgFile);
+
+		createFileInZip(zipWriter, "mimetype", "application/vnd.oasis.opendocument.graphics");
+		createXmlFileInZip(zipWriter, "META-INF/manifest.xml", &OdgWriter::writeManifest);
+		createXmlFileInZip(zipWriter, "content.xml", &OdgWriter::writeContent);
+		createXmlFileInZip(zipWriter, "meta.xml", &OdgWriter::writeMeta);
+		createXmlFileInZip(zipWriter, "settings.xml", &OdgWriter::writeSettings);
+		createXmlFileInZip(zipWriter, "styles.xml", &OdgWriter::writeStyles);
+
+		if (!zipWriter.finish() && mErrorMessage.isEmpty()) mErrorMessage = zipWriter.errorMessage();
 
 		odgFile.close();
 	}
 	else mErrorMessage = "Error creating file: " + mFilePath;
 }
 
-void OdgWriter::createFileInZip(QuaZip* zip, const QString& path, const QString& content)
+void OdgWriter::createFileInZip(DiagramZipWriter& zip, const QString& path, const QString& content)
 {
-	QuaZipFile outputFile(zip);
+	zip.addFile(path, content.toUtf8());
+}
 
-	if (outputFile.open(QIODevice::WriteOnly, QuaZipNewInfo(path)))
+void OdgWriter::createXmlFileInZip(DiagramZipWriter& zip, const QString& path, XmlPartWriter writeFunction)
+{
+	// The part is streamed straight into the zip entry and deflated in chunks as it is written
+	if (zip.beginFile(path))
 	{
-		QTextStream outputStream(&outputFile);
-		outputStream << content;
-		outputStream.flush();
-		outputFile.close();
+		QXmlStreamWriter xml(&zip);
+		xml.setAutoFormatting(true);
+		xml.setAutoFormattingIndent(2);
+
+		(this->*writeFunction)(xml);
+
+		if (!zip.endFile() || xml.hasError())
+			mErrorMessage = "Error writing " + path + " in file: " + mFilePath;
 	}
-	else mErrorMessage = "Error creating " + path + " in file: " + zip->getZipName();
+	else mErrorMessage = "Error writing " + path + " in file: " + mFilePath;
 }
 
 //==================================================================================================
@@ -735,33 +705,23 @@ void OdgWriter::writeItems(QXmlStreamWriter& xml, const QList<DrawingItem*>& ite
 {
 	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
 	{
-		DrawingLineItem* lineItem = dynamic_cast<DrawingLineItem*>(*itemIter);
-		DrawingArcItem* arcItem = dynamic_cast<DrawingArcItem*>(*itemIter);
-		DrawingPolylineItem* polylineItem = dynamic_cast<DrawingPolylineItem*>(*itemIter);
-		DrawingCurveItem* curveItem = dynamic_cast<DrawingCurveItem*>(*itemIter);
-		DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(*itemIter);
-		DrawingEllipseItem* ellipseItem = dynamic_cast<DrawingEllipseItem*>(*itemIter);
-		DrawingPolygonItem* polygonItem = dynamic_cast<DrawingPolygonItem*>(*itemIter);
-		DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(*itemIter);
-		DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(*itemIter);
-		DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(*itemIter);
-		DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(*itemIter);
-		DrawingPathItem* pathItem = dynamic_cast<DrawingPathItem*>(*itemIter);
-		DrawingItemGroup* groupItem = dynamic_cast<DrawingItemGroup*>(*itemIter);
-
-		if (lineItem) writeLineItem(xml, lineItem);
-		else if (arcItem) writeArcItem(xml, arcItem);
-		else if (polylineItem) writePolylineItem(xml, polylineItem);
-		else if (curveItem) writeCurveItem(xml, curveItem);
-		else if (rectItem) writeRectItem(xml, rectItem);
-		else if (ellipseItem) writeEllipseItem(xml, ellipseItem);
-		else if (polygonItem) writePolygonItem(xml, polygonItem);
-		else if (textItem) writeTextItem(xml, textItem);
-		else if (textRectItem) writeTextRectItem(xml, textRectItem);
-		else if (textEllipseItem) writeTextEllipseItem(xml, textEllipseItem);
-		else if (textPolygonItem) writeTextPolygonItem(xml, textPolygonItem);
-		else if (pathItem) writePathItem(xml, pathItem);
-		else if (groupItem) writeItemGroup(xml, groupItem);
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramLineItemType: writeLineItem(xml, static_cast<DrawingLineItem*>(*itemIter)); break;
+		case DiagramArcItemType: writeArcItem(xml, static_cast<DrawingArcItem*>(*itemIter)); break;
+		case DiagramPolylineItemType: writePolylineItem(xml, static_cast<DrawingPolylineItem*>(*itemIter)); break;
+		case DiagramCurveItemType: writeCurveItem(xml, static_cast<DrawingCurveItem*>(*itemIter)); break;
+		case DiagramRectItemType: writeRectItem(xml, static_cast<DrawingRectItem*>(*itemIter)); break;
+		case DiagramEllipseItemType: writeEllipseItem(xml, static_cast<DrawingEllipseItem*>(*itemIter)); break;
+		case DiagramPolygonItemType: writePolygonItem(xml, static_cast<DrawingPolygonItem*>(*itemIter)); break;
+		case DiagramTextItemType: writeTextItem(xml, static_cast<DrawingTextItem*>(*itemIter)); break;
+		case DiagramTextRectItemType: writeTextRectItem(xml, static_cast<DrawingTextRectItem*>(*itemIter)); break;
+		case DiagramTextEllipseItemType: writeTextEllipseItem(xml, static_cast<DrawingTextEllipseItem*>(*itemIter)); break;
+		case DiagramTextPolygonItemType: writeTextPolygonItem(xml, static_cast<DrawingTextPolygonItem*>(*itemIter)); break;
+		case DiagramPathItemType: writePathItem(xml, static_cast<DrawingPathItem*>(*itemIter)); break;
+		case DiagramItemGroupType: writeItemGroup(xml, static_cast<DrawingItemGroup*>(*itemIter)); break;
+		default: break;
+		}
 	}
 }
 
@@ -1162,7 +1122,7 @@ QString OdgWriter::arrowStyleName(DrawingItemStyle::ArrowStyle arrowStyle, qreal
 }
 
 QString OdgWriter::arrowStylePath(DrawingItemStyle::ArrowStyle arrowStyle, qreal arrowSize,
-	qreal penWidth, QRectF& viewBox) const
+	qreal penWidth, QRectF& viewBox)
 {
 	//const qreal sqrt2 = qSqrt(2);
 
@@ -1263,32 +1223,28 @@ QString OdgWriter::colorToHexString(const QColor& color) const
 	return str;
 }
 
-QString OdgWriter::pathToString(const QPainterPath& path) const
+const QString& OdgWriter::pathToString(const QPainterPath& path)
 {
-	QString pathStr;
+	mBuffer.clear();
 
 	for(int i = 0; i < path.elementCount(); i++)
 	{
 		QPainterPath::Element element = path.elementAt(i);
 
+		if (i > 0) mBuffer.append(' ');
+
 		switch (element.type)
 		{
-		case QPainterPath::MoveToElement:
-			pathStr += "M " + QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
-		case QPainterPath::LineToElement:
-			pathStr += "L " + QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
-		case QPainterPath::CurveToElement:
-			pathStr += "C " + QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
-		case QPainterPath::CurveToDataElement:
-			pathStr += QString::number(element.x) + " " + QString::number(element.y) + " ";
-			break;
+		case QPainterPath::MoveToElement: mBuffer.append("M "); break;
+		case QPainterPath::LineToElement: mBuffer.append("L "); break;
+		case QPainterPath::CurveToElement: mBuffer.append("C "); break;
+		default: break;
 		}
+
+		mBuffer.append(QPointF(element.x, element.y), ' ');
 	}
 
-	return pathStr.trimmed();
+	return mBuffer.string();
 }
 
 QString OdgWriter::penStyleToString(Qt::PenStyle style) const
@@ -1337,17 +1293,20 @@ QString OdgWriter::penJoinStyleToString(Qt::PenJoinStyle style) const
 	return str;
 }
 
-QString OdgWriter::pointsToString(const QPolygonF& points) const
+const QString& OdgWriter::pointsToString(const QPolygonF& points)
 {
-	QString pointsStr;
+	mBuffer.clear();
 
 	for(auto pointIter = points.begin(); pointIter != points.end(); pointIter++)
-		pointsStr += QString::number((*pointIter).x()) + "," + QString::number((*pointIter).y()) + " ";
+	{
+		if (pointIter != points.begin()) mBuffer.append(' ');
+		mBuffer.append(*pointIter, ',');
+	}
 
-	return pointsStr.trimmed();
+	return mBuffer.string();
 }
 
-QString OdgWriter::transformToString(DrawingItem* item) const
+const QString& OdgWriter::transformToString(DrawingItem* item)
 {
 	QPointF mappedPos = mDiagramTransform.map(item->position());
 	QTransform transform = item->transform();
@@ -1358,10 +1317,29 @@ QString OdgWriter::transformToString(DrawingItem* item) const
 	qreal hScale = transform.m11();
 	qreal vScale = transform.m22();
 
-	QString str;
-	str += (hScale != 1.0 || vScale != 1.0) ? "scale(" + QString::number(hScale) + "," + QString::number(vScale) + ") " : "";
-	str += (rotation != 0) ? "rotate(" + QString::number(rotation) + ") " : "";
-	str += "translate(" + QString::number(mappedPos.x()) + mDiagramUnits + "," +
-		QString::number(mappedPos.y()) + mDiagramUnits + ")";
-	return str;
+	mBuffer.clear();
+
+	if (hScale != 1.0 || vScale != 1.0)
+	{
+		mBuffer.append("scale(");
+		mBuffer.append(QPointF(hScale, vScale), ',');
+		mBuffer.append(") ");
+	}
+
+	if (rotation != 0)
+	{
+		mBuffer.append("rotate(");
+		mBuffer.append(rotation);
+		mBuffer.append(") ");
+	}
+
+	mBuffer.append("translate(");
+	mBuffer.append(mappedPos.x());
+	mBuffer.append(mDiagramUnits);
+	mBuffer.append(',');
+	mBuffer.append(mappedPos.y());
+	mBuffer.append(mDiagramUnits);
+	mBuffer.append(')');
+
+	return mBuffer.string();
 }
@@ -22,9 +22,10 @@
 #define ODGWRITER_H
 
 #include <DiagramWidget.h>
+#include "DiagramNumberFormat.h"
 
 class QPrinter;
-class QuaZip;
+class DiagramZipWriter;
 
 class OdgWriter
 {
@@ -52,6 +53,8 @@ private:
 	QStringList mFontDecls;
 	QList<Qt::PenStyle> mDashStyles;
 	QList<ArrowStyle> mArrowStyles;
+
+	DiagramNumberBuffer mBuffer;
 	
 public:
 	OdgWriter();
@@ -65,14 +68,16 @@ private:
 	void analyzeItemStyles();
 	void findItemStyles(const QList<DrawingItem*>& items, QList<DrawingItemStyle*>& itemStyles);
 	
-	QString writeContent();
-	QString writeStyles();
-	QString writeMeta();
-	QString writeSettings();
-	QString writeManifest();
-	void writeOdg(const QString& contentStr, const QString& stylesStr, const QString& metaStr, 
-		const QString& settingsStr, const QString& manifestStr);
-	void createFileInZip(QuaZip* zip, const QString& path, const QString& content);
+	typedef void (OdgWriter::*XmlPartWriter)(QXmlStreamWriter& xml);
+
+	void writeContent(QXmlStreamWriter& xml);
+	void writeStyles(QXmlStreamWriter& xml);
+	void writeMeta(QXmlStreamWriter& xml);
+	void writeSettings(QXmlStreamWriter& xml);
+	void writeManifest(QXmlStreamWriter& xml);
+	void writeOdg();
+	void createFileInZip(DiagramZipWriter& zip, const QString& path, const QString& content);
+	void createXmlFileInZip(DiagramZipWriter& zip, const QString& path, XmlPartWriter writeFunction);
 		
 private:
 	void writeDefaultPageStyle(QXmlStreamWriter& xml);
@@ -108,17 +113,17 @@ private:
 	void clearArrowStyles();
 	bool containsArrowStyle(DrawingItemStyle::ArrowStyle arrowStyle, qreal arrowSize, qreal penWidth) const;
 	QString arrowStyleName(DrawingItemStyle::ArrowStyle arrowStyle, qreal arrowSize, qreal penWidth) const;
-	QString arrowStylePath(DrawingItemStyle::ArrowStyle arrowStyle, qreal arrowSize, qreal penWidth, QRectF& viewBox) const;
+	QString arrowStylePath(DrawingItemStyle::ArrowStyle arrowStyle, qreal arrowSize, qreal penWidth, QRectF& viewBox);
 	bool arrowStyleCentered(DrawingItemStyle::ArrowStyle arrowStyle) const;
 
 	QString alignmentToString(Qt::Alignment align) const;
 	QString colorToHexString(const QColor& color) const;
-	QString pathToString(const QPainterPath& path) const;
+	const QString& pathToString(const QPainterPath& path);
 	QString penStyleToString(Qt::PenStyle style) const;
 	QString penCapStyleToString(Qt::PenCapStyle style) const;
 	QString penJoinStyleToString(Qt::PenJoinStyle style) const;
-	QString pointsToString(const QPolygonF& points) const;
-	QString transformToString(DrawingItem* item) const;
+	const QString& pointsToString(const QPolygonF& points);
+	const QString& transformToString(DrawingItem* item);
 };
 
 #endif
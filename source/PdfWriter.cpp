@@ -0,0 +1,1205 @@
+/* PdfWriter.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "PdfWriter.h"
+#include "DiagramExportStyle.h"
+#include "DiagramItemPlacement.h"
+#include "DiagramItemType.h"
+#include "DiagramNumberFormat.h"
+#include <QtPrintSupport>
+#include <zlib.h>
+
+// Page content is compressed and written out in blocks of this size
+static const int PdfWriterContentBlockSize = 64 * 1024;
+
+// Captions are laid out at this pixel size and glyph outlines are stored in its units
+static const int PdfWriterCaptionPixelSize = 100;
+
+// Character codes available in each Type 3 font
+static const int PdfWriterFontCodes = 256;
+
+PdfWriter::PdfWriter()
+{
+	mDiagram = nullptr;
+	mPrinter = nullptr;
+
+	mDevice = nullptr;
+	mPosition = 0;
+
+	mStream = nullptr;
+	mContentLength = 0;
+}
+
+PdfWriter::~PdfWriter()
+{
+	if (mStream)
+	{
+		deflateEnd(mStream);
+		delete mStream;
+	}
+}
+
+//==================================================================================================
+
+bool PdfWriter::write(DiagramWidget* diagram, QPrinter* printer, const QString& filePath)
+{
+	mFilePath = filePath;
+	mPrinter = printer;
+	mDiagram = diagram;
+
+	mErrorMessage.clear();
+
+	mForms.clear();
+	mFormIndex.clear();
+	mItemForms.clear();
+	mFonts.clear();
+	mFontIndex.clear();
+	mGlyphCodes.clear();
+	mGraphicsStates.clear();
+
+	mDiagram->loadAllItems();
+	analyzeDiagram();
+	analyzeItems(mDiagram->scene()->items());
+
+	QFile pdfFile(mFilePath);
+	if (pdfFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		mDevice = &pdfFile;
+		writePdf();
+		mDevice = nullptr;
+
+		pdfFile.close();
+	}
+	else mErrorMessage = "Error creating file: " + mFilePath;
+
+	return mErrorMessage.isEmpty();
+}
+
+QString PdfWriter::errorMessage() const
+{
+	return mErrorMessage;
+}
+
+//==================================================================================================
+
+void PdfWriter::analyzeDiagram()
+{
+	QPageLayout pageLayout = mPrinter->pageLayout();
+	QRectF paintRect = pageLayout.paintRect(QPageLayout::Point);
+
+	mPageSize = pageLayout.fullRect(QPageLayout::Point).size();
+	mVisibleRect = mDiagram->scene()->sceneRect();
+
+	qreal pageAspect = paintRect.width() / paintRect.height();
+	qreal scale = qMin(paintRect.width() / mVisibleRect.width(), paintRect.height() / mVisibleRect.height());
+
+	if (mVisibleRect.height() * pageAspect > mVisibleRect.width())
+	{
+		mVisibleRect.adjust(-(mVisibleRect.height() * pageAspect - mVisibleRect.width()) / 2, 0,
+			(mVisibleRect.height() * pageAspect - mVisibleRect.width()) / 2, 0);
+	}
+	else if (mVisibleRect.width() / pageAspect > mVisibleRect.height())
+	{
+		mVisibleRect.adjust(0, -(mVisibleRect.width() / pageAspect - mVisibleRect.height()) / 2,
+			0, (mVisibleRect.width() / pageAspect - mVisibleRect.height()) / 2);
+	}
+
+	// PDF user space has its origin at the bottom left of the page with y pointing up
+	mPageTransform = QTransform(scale, 0, 0, -scale, paintRect.left() - mVisibleRect.left() * scale,
+		mPageSize.height() - paintRect.top() + mVisibleRect.top() * scale);
+}
+
+void PdfWriter::analyzeItems(const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramPathItemType:
+			analyzePathItem(static_cast<DrawingPathItem*>(*itemIter));
+			break;
+		case DiagramItemGroupType:
+			analyzeItems(static_cast<DrawingItemGroup*>(*itemIter)->items());
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+void PdfWriter::analyzePathItem(DrawingPathItem* item)
+{
+	// Symbols are keyed on their geometry at their placed size, so the form's stroke widths stay
+	// in scene units; the position within the item is applied when the form is placed
+	QByteArray paintOperator = PdfWriter::paintOperator(item->style(), item->path().fillRule());
+	if (paintOperator == "n") return;
+
+	QRectF pathRect = item->pathRect();
+	QRectF rect = item->rect();
+	QByteArray key;
+	QDataStream keyStream(&key, QIODevice::WriteOnly);
+	keyStream << (quint8)DiagramPathItemType << item->path() << pathRect << rect.size() << paintOperator;
+
+	int index = mFormIndex.value(key, -1);
+	if (index < 0)
+	{
+		QTransform pathTransform;
+		pathTransform.scale((pathRect.width() != 0) ? rect.width() / pathRect.width() : 1.0,
+			(pathRect.height() != 0) ? rect.height() / pathRect.height() : 1.0);
+		pathTransform.translate(-pathRect.left(), -pathRect.top());
+
+		index = addForm(key, pathTransform.map(item->path()), paintOperator);
+	}
+
+	mForms[index].strokeMargin = qMax(mForms[index].strokeMargin, strokeMargin(item->style()));
+	mItemForms.insert(item, index);
+}
+
+int PdfWriter::addForm(const QByteArray& key, const QPainterPath& path, const QByteArray& paintOperator)
+{
+	Form form;
+	form.path = path;
+	form.paintOperator = paintOperator;
+	form.strokeMargin = 0;
+	form.objectNumber = 0;
+
+	mForms.append(form);
+	mFormIndex.insert(key, mForms.size() - 1);
+
+	return mForms.size() - 1;
+}
+
+//==================================================================================================
+
+void PdfWriter::writePdf()
+{
+	mPosition = 0;
+	mObjectOffsets.clear();
+	mObjectOffsets.append(0);
+
+	writeData("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+
+	int catalogObject = newObject();
+	int pagesObject = newObject();
+	int pageObject = newObject();
+	int resourcesObject = newObject();
+
+	writeForms();
+
+	// The page content is compressed as it is generated, so its length is written afterwards
+	int contentObject = newObject();
+	int lengthObject = newObject();
+
+	beginObject(contentObject);
+	writeData("<< /Length " + QByteArray::number(lengthObject) + " 0 R /Filter /FlateDecode >>\nstream\n");
+	writePageContent();
+	writeData("\nendstream\n");
+	endObject();
+
+	beginObject(lengthObject);
+	writeData(QByteArray::number(mContentLength) + "\n");
+	endObject();
+
+	// Glyphs are collected as the captions are written
+	writeFonts();
+	writeResources(resourcesObject);
+
+	QByteArray mediaBox;
+	appendNumber(mediaBox, mPageSize.width());
+	mediaBox += ' ';
+	appendNumber(mediaBox, mPageSize.height());
+
+	beginObject(pageObject);
+	writeData("<< /Type /Page /Parent " + QByteArray::number(pagesObject) + " 0 R /MediaBox [0 0 " + mediaBox +
+		"] /Resources " + QByteArray::number(resourcesObject) + " 0 R /Contents " + QByteArray::number(contentObject) + " 0 R >>\n");
+	endObject();
+
+	beginObject(pagesObject);
+	writeData("<< /Type /Pages /Kids [" + QByteArray::number(pageObject) + " 0 R] /Count 1 >>\n");
+	endObject();
+
+	beginObject(catalogObject);
+	writeData("<< /Type /Catalog /Pages " + QByteArray::number(pagesObject) + " 0 R >>\n");
+	endObject();
+
+	// Cross-reference table; each entry is exactly 20 bytes
+	qint64 xrefPosition = mPosition;
+	QByteArray xref = "xref\n0 " + QByteArray::number(mObjectOffsets.size()) + "\n0000000000 65535 f \n";
+	for(int i = 1; i < mObjectOffsets.size(); i++)
+		xref += QByteArray::number(mObjectOffsets[i]).rightJustified(10, '0') + " 00000 n \n";
+	writeData(xref);
+
+	writeData("trailer\n<< /Size " + QByteArray::number(mObjectOffsets.size()) + " /Root " +
+		QByteArray::number(catalogObject) + " 0 R >>\nstartxref\n" + QByteArray::number(xrefPosition) + "\n%%EOF\n");
+}
+
+void PdfWriter::writeForms()
+{
+	for(int i = 0; i < mForms.size() && mErrorMessage.isEmpty(); i++)
+	{
+		Form& form = mForms[i];
+		QRectF boundingRect = form.path.controlPointRect();
+		QByteArray content, dictionary;
+
+		// Hairlines and rounding in viewers still need a little room at the edges of the box
+		qreal margin = form.strokeMargin + qMax(boundingRect.width(), boundingRect.height()) / 100;
+		boundingRect.adjust(-margin, -margin, margin, margin);
+
+		appendPath(content, form.path);
+		content += form.paintOperator + "\n";
+
+		dictionary = "/Type /XObject /Subtype /Form /BBox [";
+		appendPoint(dictionary, boundingRect.topLeft());
+		dictionary += ' ';
+		appendPoint(dictionary, boundingRect.bottomRight());
+		dictionary += "]";
+
+		form.objectNumber = writeCompressedStream(dictionary, content);
+
+		// Only the object number is needed from here on
+		form.path = QPainterPath();
+	}
+}
+
+void PdfWriter::writeFonts()
+{
+	// Glyph procedures are in the layout's pixel units with y pointing up; the font matrix scales
+	// them to text space, where the font size applies
+	QTransform glyphTransform = QTransform::fromScale(1, -1);
+	QByteArray fontMatrix;
+	appendNumber(fontMatrix, 1.0 / PdfWriterCaptionPixelSize);
+	fontMatrix = fontMatrix + " 0 0 " + fontMatrix + " 0 0";
+
+	for(int i = 0; i < mFonts.size() && mErrorMessage.isEmpty(); i++)
+	{
+		Font& font = mFonts[i];
+		QVector<QPointF> advances = font.rawFont.advancesForGlyphIndexes(font.glyphIndexes);
+		QByteArray charProcs, widths, differences;
+		QList<QByteArray> bfChars;
+		QRectF fontRect;
+
+		for(int code = 0; code < font.glyphIndexes.size() && mErrorMessage.isEmpty(); code++)
+		{
+			QPainterPath path = glyphTransform.map(font.rawFont.pathForGlyph(font.glyphIndexes[code]));
+			QRectF glyphRect = path.controlPointRect();
+			QByteArray content, name = "/g" + QByteArray::number(code);
+
+			appendNumber(content, advances[code].x());
+			content += " 0 ";
+			appendPoint(content, glyphRect.topLeft());
+			content += ' ';
+			appendPoint(content, glyphRect.bottomRight());
+			content += " d1\n";
+			if (!path.isEmpty())
+			{
+				appendPath(content, path);
+				content += (path.fillRule() == Qt::OddEvenFill) ? "f*\n" : "f\n";
+			}
+
+			charProcs += " " + name + " " + QByteArray::number(writeCompressedStream(QByteArray(), content)) + " 0 R";
+			differences += " " + name;
+			widths += ' ';
+			appendNumber(widths, advances[code].x());
+			fontRect = fontRect.united(glyphRect);
+
+			const QString& characters = font.characters[code];
+			if (!characters.isEmpty())
+			{
+				QByteArray bfChar = "<";
+				appendHex(bfChar, code, 2);
+				bfChar += "> <";
+				for(int j = 0; j < characters.size(); j++) appendHex(bfChar, characters[j].unicode(), 4);
+				bfChar += ">\n";
+				bfChars.append(bfChar);
+			}
+		}
+
+		if (!mErrorMessage.isEmpty()) break;
+
+		// The ToUnicode map lets viewers extract the captions' text; each bfchar block holds at
+		// most 100 entries
+		QByteArray toUnicode = "/CIDInit /ProcSet findresource begin\n12 dict begin\nbegincmap\n"
+			"/CIDSystemInfo << /Registry (Adobe) /Ordering (UCS) /Supplement 0 >> def\n"
+			"/CMapName /Adobe-Identity-UCS def\n/CMapType 2 def\n"
+			"1 begincodespacerange\n<00> <FF>\nendcodespacerange\n";
+		for(int j = 0; j < bfChars.size(); j += 100)
+		{
+			int count = qMin(100, bfChars.size() - j);
+			toUnicode += QByteArray::number(count) + " beginbfchar\n";
+			for(int k = j; k < j + count; k++) toUnicode += bfChars[k];
+			toUnicode += "endbfchar\n";
+		}
+		toUnicode += "endcmap\nCMapName currentdict /CMapResource defineresource pop\nend\nend\n";
+
+		int toUnicodeObject = writeCompressedStream(QByteArray(), toUnicode);
+
+		QByteArray dictionary = "<< /Type /Font /Subtype /Type3 /FontBBox [";
+		appendPoint(dictionary, fontRect.topLeft());
+		dictionary += ' ';
+		appendPoint(dictionary, fontRect.bottomRight());
+		dictionary += "] /FontMatrix [" + fontMatrix + "]\n/CharProcs <<" + charProcs + " >>\n";
+		dictionary += "/Encoding << /Type /Encoding /Differences [0" + differences + "] >>\n";
+		dictionary += "/FirstChar 0 /LastChar " + QByteArray::number(font.glyphIndexes.size() - 1) + " /Widths [" + widths.mid(1) + "]\n";
+		dictionary += "/Resources << /ProcSet [/PDF] >> /ToUnicode " + QByteArray::number(toUnicodeObject) + " 0 R >>\n";
+
+		font.objectNumber = newObject();
+		beginObject(font.objectNumber);
+		writeData(dictionary);
+		endObject();
+
+		// Only the object number is needed from here on
+		font.rawFont = QRawFont();
+	}
+}
+
+void PdfWriter::writePageContent()
+{
+	if (!beginContent()) return;
+
+	writeTransform(mPageTransform);
+
+	QColor backgroundColor = mDiagram->scene()->backgroundBrush().color();
+	if (backgroundColor.alpha() > 0)
+	{
+		QRectF sceneRect = mDiagram->scene()->sceneRect();
+
+		mContent += "q\n";
+		writeGraphicsState(1.0, backgroundColor.alphaF());
+		appendColor(mContent, backgroundColor, "rg");
+		appendPoint(mContent, sceneRect.topLeft());
+		mContent += ' ';
+		appendPoint(mContent, QPointF(sceneRect.width(), sceneRect.height()));
+		mContent += " re f\nQ\n";
+	}
+
+	writeItems(mDiagram->scene()->items());
+
+	deflateContent(true);
+}
+
+void PdfWriter::writeResources(int resourcesObject)
+{
+	QByteArray resources = (mFonts.isEmpty()) ? "<< /ProcSet [/PDF]" : "<< /ProcSet [/PDF /Text]";
+
+	if (!mForms.isEmpty())
+	{
+		resources += "\n/XObject <<";
+		for(int i = 0; i < mForms.size(); i++)
+			resources += " /X" + QByteArray::number(i + 1) + " " + QByteArray::number(mForms[i].objectNumber) + " 0 R";
+		resources += " >>";
+	}
+
+	if (!mFonts.isEmpty())
+	{
+		resources += "\n/Font <<";
+		for(int i = 0; i < mFonts.size(); i++)
+			resources += " /F" + QByteArray::number(i + 1) + " " + QByteArray::number(mFonts[i].objectNumber) + " 0 R";
+		resources += " >>";
+	}
+
+	if (!mGraphicsStates.isEmpty())
+	{
+		resources += "\n/ExtGState <<";
+		for(int i = 0; i < mGraphicsStates.size(); i++)
+		{
+			resources += " /GS" + QByteArray::number(i + 1) + " << /CA ";
+			appendNumber(resources, mGraphicsStates[i].first);
+			resources += " /ca ";
+			appendNumber(resources, mGraphicsStates[i].second);
+			resources += " >>";
+		}
+		resources += " >>";
+	}
+
+	resources += " >>\n";
+
+	beginObject(resourcesObject);
+	writeData(resources);
+	endObject();
+}
+
+//==================================================================================================
+
+void PdfWriter::writeItems(const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end() && mErrorMessage.isEmpty(); itemIter++)
+	{
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramLineItemType: writeLineItem(static_cast<DrawingLineItem*>(*itemIter)); break;
+		case DiagramArcItemType: writeArcItem(static_cast<DrawingArcItem*>(*itemIter)); break;
+		case DiagramPolylineItemType: writePolylineItem(static_cast<DrawingPolylineItem*>(*itemIter)); break;
+		case DiagramCurveItemType: writeCurveItem(static_cast<DrawingCurveItem*>(*itemIter)); break;
+		case DiagramRectItemType: writeRectItem(static_cast<DrawingRectItem*>(*itemIter)); break;
+		case DiagramEllipseItemType: writeEllipseItem(static_cast<DrawingEllipseItem*>(*itemIter)); break;
+		case DiagramPolygonItemType: writePolygonItem(static_cast<DrawingPolygonItem*>(*itemIter)); break;
+		case DiagramTextItemType: writeTextItem(static_cast<DrawingTextItem*>(*itemIter)); break;
+		case DiagramTextRectItemType: writeTextRectItem(static_cast<DrawingTextRectItem*>(*itemIter)); break;
+		case DiagramTextEllipseItemType: writeTextEllipseItem(static_cast<DrawingTextEllipseItem*>(*itemIter)); break;
+		case DiagramTextPolygonItemType: writeTextPolygonItem(static_cast<DrawingTextPolygonItem*>(*itemIter)); break;
+		case DiagramPathItemType: writePathItem(static_cast<DrawingPathItem*>(*itemIter)); break;
+		case DiagramItemGroupType: writeItemGroup(static_cast<DrawingItemGroup*>(*itemIter)); break;
+		default: break;
+		}
+
+		if (mContent.size() >= PdfWriterContentBlockSize) deflateContent(false);
+	}
+}
+
+void PdfWriter::writeLineItem(DrawingLineItem* item)
+{
+	QPainterPath path;
+	path.moveTo(item->line().p1());
+	path.lineTo(item->line().p2());
+	writeShape(item, path, false);
+}
+
+void PdfWriter::writeArcItem(DrawingArcItem* item)
+{
+	writeShape(item, arcPath(item->arc()), false);
+}
+
+void PdfWriter::writePolylineItem(DrawingPolylineItem* item)
+{
+	QPainterPath path;
+	path.addPolygon(diagramItemPolygon(item->points()));
+	writeShape(item, path, false);
+}
+
+void PdfWriter::writeCurveItem(DrawingCurveItem* item)
+{
+	QPainterPath path;
+	path.moveTo(item->curveStartPos());
+	path.cubicTo(item->curveStartControlPos(), item->curveEndControlPos(), item->curveEndPos());
+	writeShape(item, path, false);
+}
+
+void PdfWriter::writeRectItem(DrawingRectItem* item)
+{
+	QPainterPath path;
+	if (item->cornerRadiusX() != 0 || item->cornerRadiusY() != 0)
+		path.addRoundedRect(item->rect(), item->cornerRadiusX(), item->cornerRadiusY());
+	else
+		path.addRect(item->rect());
+	writeShape(item, path, true);
+}
+
+void PdfWriter::writeEllipseItem(DrawingEllipseItem* item)
+{
+	QPainterPath path;
+	path.addEllipse(item->ellipse());
+	writeShape(item, path, true);
+}
+
+void PdfWriter::writePolygonItem(DrawingPolygonItem* item)
+{
+	QPainterPath path;
+	path.addPolygon(diagramItemPolygon(item->points()));
+	path.closeSubpath();
+	writeShape(item, path, true);
+}
+
+void PdfWriter::writeTextItem(DrawingTextItem* item)
+{
+	writeShape(item, QPainterPath(), true, item->caption(), QRectF());
+}
+
+void PdfWriter::writeTextRectItem(DrawingTextRectItem* item)
+{
+	QPainterPath path;
+	if (item->cornerRadiusX() != 0 || item->cornerRadiusY() != 0)
+		path.addRoundedRect(item->rect(), item->cornerRadiusX(), item->cornerRadiusY());
+	else
+		path.addRect(item->rect());
+	writeShape(item, path, true, item->caption(), item->rect());
+}
+
+void PdfWriter::writeTextEllipseItem(DrawingTextEllipseItem* item)
+{
+	QPainterPath path;
+	path.addEllipse(item->ellipse());
+	writeShape(item, path, true, item->caption(), item->ellipse());
+}
+
+void PdfWriter::writeTextPolygonItem(DrawingTextPolygonItem* item)
+{
+	QPolygonF polygon = diagramItemPolygon(item->points());
+	QPainterPath path;
+	path.addPolygon(polygon);
+	path.closeSubpath();
+	writeShape(item, path, true, item->caption(), polygon.boundingRect());
+}
+
+void PdfWriter::writePathItem(DrawingPathItem* item)
+{
+	int index = mItemForms.value(item, -1);
+	if (index < 0) return;
+
+	mContent += "q\n";
+	writeTransform(QTransform::fromTranslate(item->rect().left(), item->rect().top()) * diagramItemTransform(item));
+	writeStyle(item->style());
+	mContent += "/X" + QByteArray::number(index + 1) + " Do\nQ\n";
+}
+
+void PdfWriter::writeItemGroup(DrawingItemGroup* item)
+{
+	mContent += "q\n";
+	writeTransform(diagramItemTransform(item));
+	writeItems(item->items());
+	mContent += "Q\n";
+}
+
+//==================================================================================================
+
+void PdfWriter::writeShape(DrawingItem* item, const QPainterPath& path, bool closed, const QString& caption,
+	const QRectF& captionRect)
+{
+	bool hasCaption = !caption.isEmpty();
+	QByteArray paintOperator = PdfWriter::paintOperator(item->style(), path.fillRule());
+
+	mContent += "q\n";
+	writeTransform(diagramItemTransform(item));
+
+	if (!path.isEmpty())
+	{
+		// The shape's graphics state is kept apart from the caption's
+		if (hasCaption) mContent += "q\n";
+
+		writeStyle(item->style());
+		if (paintOperator != "n")
+		{
+			appendPath(mContent, path);
+			mContent += paintOperator + "\n";
+		}
+		if (!closed) writeArrows(item, path);
+
+		if (hasCaption) mContent += "Q\n";
+	}
+
+	if (hasCaption) writeCaption(item, caption, captionRect);
+
+	mContent += "Q\n";
+}
+
+void PdfWriter::writeArrows(DrawingItem* item, const QPainterPath& path)
+{
+	// Arrows point away from the shape along its direction at each end
+	int count = path.elementCount();
+	if (count < 2 || !hasPen(item->style())) return;
+
+	QPointF startPoint = path.elementAt(0), endPoint = path.elementAt(count - 1);
+	QPointF startDirection, endDirection;
+
+	for(int i = 1; i < count && startDirection.isNull(); i++)
+		startDirection = startPoint - QPointF(path.elementAt(i));
+	for(int i = count - 2; i >= 0 && endDirection.isNull(); i--)
+		endDirection = endPoint - QPointF(path.elementAt(i));
+
+	writeArrow(item->style(), true, startPoint, startDirection);
+	writeArrow(item->style(), false, endPoint, endDirection);
+}
+
+void PdfWriter::writeArrow(DrawingItemStyle* style, bool start, const QPointF& tip, const QPointF& direction)
+{
+	DrawingItemStyle::Property styleProperty = (start) ? DrawingItemStyle::StartArrowStyle : DrawingItemStyle::EndArrowStyle;
+	DrawingItemStyle::Property sizeProperty = (start) ? DrawingItemStyle::StartArrowSize : DrawingItemStyle::EndArrowSize;
+
+	if (!style->hasValue(styleProperty) || !style->hasValue(sizeProperty) || direction.isNull()) return;
+
+	DrawingItemStyle::ArrowStyle arrowStyle = (DrawingItemStyle::ArrowStyle)style->value(styleProperty).toUInt();
+	QPainterPath path = diagramArrowPath(arrowStyle, style->value(sizeProperty).toReal());
+	if (path.isEmpty()) return;
+
+	QTransform arrowTransform;
+	arrowTransform.translate(tip.x(), tip.y());
+	arrowTransform.rotateRadians(qAtan2(direction.y(), direction.x()));
+
+	QColor fillColor = diagramArrowFillColor(arrowStyle, diagramStyleValue(style, DrawingItemStyle::PenColor).value<QColor>(),
+		mDiagram->scene()->backgroundBrush().color());
+	QByteArray paintOperator = "S";
+
+	if (fillColor.isValid())
+	{
+		appendColor(mContent, fillColor, "rg");
+		paintOperator = "B";
+	}
+
+	mContent += "[] 0 d 0 j\n";
+	appendPath(mContent, arrowTransform.map(path));
+	mContent += paintOperator + "\n";
+}
+
+void PdfWriter::writeCaption(DrawingItem* item, const QString& caption, const QRectF& rect)
+{
+	// Lines are laid out at a fixed pixel size and aligned around the caption's anchor point
+	DrawingItemStyle* style = item->style();
+	QColor textColor = diagramStyleValue(style, DrawingItemStyle::TextColor).value<QColor>();
+	qreal fontSize = diagramStyleValue(style, DrawingItemStyle::FontSize).toReal();
+	qreal scale = fontSize / PdfWriterCaptionPixelSize;
+	QPointF anchor = captionAnchor(style, rect);
+
+	QFont font(diagramStyleValue(style, DrawingItemStyle::FontName).toString());
+	font.setPixelSize(PdfWriterCaptionPixelSize);
+	font.setBold(diagramStyleValue(style, DrawingItemStyle::FontBold).toBool());
+	font.setItalic(diagramStyleValue(style, DrawingItemStyle::FontItalic).toBool());
+	bool underline = diagramStyleValue(style, DrawingItemStyle::FontUnderline).toBool();
+	bool strikeOut = diagramStyleValue(style, DrawingItemStyle::FontStrikeThrough).toBool();
+
+	QFontMetricsF fontMetrics(font);
+	QStringList lines = caption.split("\n");
+	Qt::Alignment horizontalAlign = (Qt::Alignment)diagramStyleValue(style, DrawingItemStyle::TextHorizontalAlignment).toUInt();
+	Qt::Alignment verticalAlign = (Qt::Alignment)diagramStyleValue(style, DrawingItemStyle::TextVerticalAlignment).toUInt();
+	qreal height = (lines.size() - 1) * fontMetrics.lineSpacing() + fontMetrics.height();
+	qreal top = -height / 2;
+	QByteArray decorations;
+	int currentFont = -1;
+
+	if (verticalAlign & Qt::AlignTop) top = 0;
+	else if (verticalAlign & Qt::AlignBottom) top = -height;
+
+	appendColor(mContent, textColor, "rg");
+	if (textColor.alpha() < 255) writeGraphicsState(1.0, textColor.alphaF());
+
+	mContent += "BT\n";
+
+	for(int i = 0; i < lines.size(); i++)
+	{
+		if (lines[i].isEmpty()) continue;
+
+		qreal width = fontMetrics.width(lines[i]);
+		qreal left = -width / 2;
+
+		if (horizontalAlign & Qt::AlignLeft) left = 0;
+		else if (horizontalAlign & Qt::AlignRight) left = -width;
+
+		QTextLayout textLayout(lines[i], font);
+		textLayout.beginLayout();
+		textLayout.createLine();
+		textLayout.endLayout();
+
+		// Glyph positions are relative to the top left of the line
+		QPointF origin = anchor + QPointF(left, top + i * fontMetrics.lineSpacing()) * scale;
+		QList<QGlyphRun> glyphRuns = textLayout.glyphRuns();
+		for(auto glyphRunIter = glyphRuns.begin(); glyphRunIter != glyphRuns.end(); glyphRunIter++)
+			writeGlyphs(*glyphRunIter, lines[i], origin, fontSize, currentFont);
+
+		// Underline and strike out are drawn as rectangles once the text is done
+		qreal baseline = top + fontMetrics.ascent() + i * fontMetrics.lineSpacing();
+		if (underline)
+		{
+			appendPoint(decorations, anchor + QPointF(left, baseline + fontMetrics.underlinePos() - fontMetrics.lineWidth() / 2) * scale);
+			decorations += ' ';
+			appendPoint(decorations, QPointF(width, fontMetrics.lineWidth()) * scale);
+			decorations += " re\n";
+		}
+		if (strikeOut)
+		{
+			appendPoint(decorations, anchor + QPointF(left, baseline - fontMetrics.strikeOutPos() - fontMetrics.lineWidth() / 2) * scale);
+			decorations += ' ';
+			appendPoint(decorations, QPointF(width, fontMetrics.lineWidth()) * scale);
+			decorations += " re\n";
+		}
+	}
+
+	mContent += "ET\n";
+
+	if (!decorations.isEmpty()) mContent += decorations + "f\n";
+}
+
+void PdfWriter::writeGlyphs(const QGlyphRun& glyphRun, const QString& text, const QPointF& origin, qreal fontSize,
+	int& currentFont)
+{
+	// Glyphs are shown with TJ, and where the layout places a glyph away from the end of the
+	// previous one the difference is written as an adjustment in thousandths of an em
+	QRawFont rawFont = glyphRun.rawFont();
+	QString fontKey = rawFont.familyName() + "\n" + rawFont.styleName();
+	QVector<quint32> glyphIndexes = glyphRun.glyphIndexes();
+	QVector<QPointF> positions = glyphRun.positions();
+	QVector<QPointF> advances = rawFont.advancesForGlyphIndexes(glyphIndexes);
+	qreal scale = fontSize / PdfWriterCaptionPixelSize;
+	bool started = false;
+	QPointF nextPosition;
+
+	for(int i = 0; i < glyphIndexes.size(); i++)
+	{
+		int fontCode = glyphCode(rawFont, fontKey, glyphIndexes[i], text);
+		int fontIndex = fontCode / PdfWriterFontCodes, code = fontCode % PdfWriterFontCodes;
+
+		if (!started || fontIndex != currentFont || positions[i].y() != nextPosition.y())
+		{
+			if (started) mContent += ">] TJ\n";
+
+			if (fontIndex != currentFont)
+			{
+				mContent += "/F" + QByteArray::number(fontIndex + 1) + ' ';
+				appendNumber(mContent, fontSize);
+				mContent += " Tf\n";
+				currentFont = fontIndex;
+			}
+
+			// The text matrix flips y back so that glyphs are upright in the scene's y-down space
+			mContent += "1 0 0 -1 ";
+			appendPoint(mContent, origin + positions[i] * scale);
+			mContent += " Tm\n[<";
+			started = true;
+		}
+		else if (qAbs(positions[i].x() - nextPosition.x()) > 0.001)
+		{
+			mContent += "> ";
+			appendNumber(mContent, -(positions[i].x() - nextPosition.x()) * 1000 / PdfWriterCaptionPixelSize);
+			mContent += " <";
+		}
+
+		appendHex(mContent, code, 2);
+		nextPosition = QPointF(positions[i].x() + advances[i].x(), positions[i].y());
+	}
+
+	if (started) mContent += ">] TJ\n";
+}
+
+void PdfWriter::writeStyle(DrawingItemStyle* style)
+{
+	qreal strokeOpacity = 1.0, fillOpacity = 1.0;
+
+	if (hasPen(style))
+	{
+		QColor penColor = diagramStyleValue(style, DrawingItemStyle::PenColor).value<QColor>();
+		Qt::PenStyle penStyle = (Qt::PenStyle)diagramStyleValue(style, DrawingItemStyle::PenStyle).toUInt();
+		qreal penWidth = diagramStyleValue(style, DrawingItemStyle::PenWidth).toReal();
+
+		appendColor(mContent, penColor, "RG");
+		appendNumber(mContent, penWidth);
+		mContent += " w\n";
+
+		switch ((Qt::PenCapStyle)diagramStyleValue(style, DrawingItemStyle::PenCapStyle).toUInt())
+		{
+		case Qt::FlatCap: mContent += "0 J\n"; break;
+		case Qt::SquareCap: mContent += "2 J\n"; break;
+		default: mContent += "1 J\n"; break;
+		}
+
+		switch ((Qt::PenJoinStyle)diagramStyleValue(style, DrawingItemStyle::PenJoinStyle).toUInt())
+		{
+		case Qt::SvgMiterJoin:
+		case Qt::MiterJoin: mContent += "0 j\n"; break;
+		case Qt::BevelJoin: mContent += "2 j\n"; break;
+		default: mContent += "1 j\n"; break;
+		}
+
+		QVector<qreal> pattern = diagramDashPattern(penStyle, penWidth);
+		if (!pattern.isEmpty())
+		{
+			mContent += '[';
+			for(auto patternIter = pattern.begin(); patternIter != pattern.end(); patternIter++)
+			{
+				if (patternIter != pattern.begin()) mContent += ' ';
+				appendNumber(mContent, *patternIter);
+			}
+			mContent += "] 0 d\n";
+		}
+
+		strokeOpacity = diagramStyleValue(style, DrawingItemStyle::PenOpacity).toReal() * penColor.alphaF();
+	}
+
+	if (hasBrush(style))
+	{
+		QColor brushColor = diagramStyleValue(style, DrawingItemStyle::BrushColor).value<QColor>();
+
+		appendColor(mContent, brushColor, "rg");
+		fillOpacity = diagramStyleValue(style, DrawingItemStyle::BrushOpacity).toReal() * brushColor.alphaF();
+	}
+
+	if (strokeOpacity < 1.0 || fillOpacity < 1.0) writeGraphicsState(strokeOpacity, fillOpacity);
+}
+
+void PdfWriter::writeGraphicsState(qreal strokeOpacity, qreal fillOpacity)
+{
+	QPair<qreal,qreal> graphicsState(strokeOpacity, fillOpacity);
+
+	int index = mGraphicsStates.indexOf(graphicsState);
+	if (index < 0)
+	{
+		index = mGraphicsStates.size();
+		mGraphicsStates.append(graphicsState);
+	}
+
+	mContent += "/GS" + QByteArray::number(index + 1) + " gs\n";
+}
+
+void PdfWriter::writeTransform(const QTransform& transform)
+{
+	if (!transform.isIdentity())
+	{
+		appendNumber(mContent, transform.m11());
+		mContent += ' ';
+		appendNumber(mContent, transform.m12());
+		mContent += ' ';
+		appendNumber(mContent, transform.m21());
+		mContent += ' ';
+		appendNumber(mContent, transform.m22());
+		mContent += ' ';
+		appendPoint(mContent, QPointF(transform.dx(), transform.dy()));
+		mContent += " cm\n";
+	}
+}
+
+//==================================================================================================
+
+bool PdfWriter::beginContent()
+{
+	mContent.resize(0);
+	mContent.reserve(PdfWriterContentBlockSize + 4096);
+	mContentLength = 0;
+
+	mStream = new z_stream;
+	memset(mStream, 0, sizeof(z_stream));
+	if (deflateInit(mStream, Z_DEFAULT_COMPRESSION) != Z_OK)
+	{
+		delete mStream;
+		mStream = nullptr;
+		mErrorMessage = "Error compressing file: " + mFilePath;
+		return false;
+	}
+
+	mCompressedContent.resize(PdfWriterContentBlockSize);
+	return true;
+}
+
+bool PdfWriter::deflateContent(bool finish)
+{
+	if (!mStream) return false;
+
+	mStream->next_in = reinterpret_cast<Bytef*>(mContent.data());
+	mStream->avail_in = mContent.size();
+
+	int result = Z_OK;
+	do
+	{
+		mStream->next_out = reinterpret_cast<Bytef*>(mCompressedContent.data());
+		mStream->avail_out = mCompressedContent.size();
+
+		result = deflate(mStream, (finish) ? Z_FINISH : Z_NO_FLUSH);
+		if (result == Z_STREAM_ERROR)
+		{
+			mErrorMessage = "Error compressing file: " + mFilePath;
+			break;
+		}
+
+		int length = mCompressedContent.size() - mStream->avail_out;
+		writeData(QByteArray::fromRawData(mCompressedContent.constData(), length));
+		mContentLength += length;
+	} while (mStream->avail_out == 0 || (finish && result != Z_STREAM_END));
+
+	mContent.resize(0);
+
+	if (finish || !mErrorMessage.isEmpty())
+	{
+		deflateEnd(mStream);
+		delete mStream;
+		mStream = nullptr;
+	}
+
+	return mErrorMessage.isEmpty();
+}
+
+//==================================================================================================
+
+int PdfWriter::newObject()
+{
+	mObjectOffsets.append(0);
+	return mObjectOffsets.size() - 1;
+}
+
+void PdfWriter::beginObject(int objectNumber)
+{
+	mObjectOffsets[objectNumber] = mPosition;
+	writeData(QByteArray::number(objectNumber) + " 0 obj\n");
+}
+
+void PdfWriter::endObject()
+{
+	writeData("endobj\n");
+}
+
+void PdfWriter::writeStream(const QByteArray& dictionary, const QByteArray& data)
+{
+	writeData("<< " + dictionary + " /Length " + QByteArray::number(data.size()) + " >>\nstream\n");
+	writeData(data);
+	writeData("\nendstream\n");
+}
+
+int PdfWriter::writeCompressedStream(QByteArray dictionary, const QByteArray& data)
+{
+	QByteArray compressedData((int)compressBound(data.size()), 0);
+	uLongf compressedLength = compressedData.size();
+	if (compress2(reinterpret_cast<Bytef*>(compressedData.data()), &compressedLength,
+		reinterpret_cast<const Bytef*>(data.constData()), data.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+	{
+		mErrorMessage = "Error compressing file: " + mFilePath;
+		return 0;
+	}
+	compressedData.resize((int)compressedLength);
+
+	if (!dictionary.isEmpty()) dictionary += ' ';
+	dictionary += "/Filter /FlateDecode";
+
+	int objectNumber = newObject();
+	beginObject(objectNumber);
+	writeStream(dictionary, compressedData);
+	endObject();
+
+	return objectNumber;
+}
+
+void PdfWriter::writeData(const QByteArray& data)
+{
+	if (data.isEmpty() || !mErrorMessage.isEmpty()) return;
+
+	if (mDevice->write(data) == data.size()) mPosition += data.size();
+	else mErrorMessage = "Error writing file: " + mFilePath;
+}
+
+//==================================================================================================
+
+bool PdfWriter::hasPen(DrawingItemStyle* style) const
+{
+	// Pen and brush are only drawn when the style sets them, as with the other writers
+	return ((style->hasValue(DrawingItemStyle::PenStyle) || style->hasValue(DrawingItemStyle::PenColor) ||
+		style->hasValue(DrawingItemStyle::PenWidth)) &&
+		(Qt::PenStyle)diagramStyleValue(style, DrawingItemStyle::PenStyle).toUInt() != Qt::NoPen);
+}
+
+bool PdfWriter::hasBrush(DrawingItemStyle* style) const
+{
+	return (style->hasValue(DrawingItemStyle::BrushColor) &&
+		diagramStyleValue(style, DrawingItemStyle::BrushColor).value<QColor>().alpha() > 0 &&
+		diagramStyleValue(style, DrawingItemStyle::BrushOpacity).toReal() > 0);
+}
+
+QByteArray PdfWriter::paintOperator(DrawingItemStyle* style, Qt::FillRule fillRule) const
+{
+	bool stroke = hasPen(style), fill = hasBrush(style);
+	QByteArray paintOperator = "n";
+
+	if (stroke && fill) paintOperator = "B";
+	else if (fill) paintOperator = "f";
+	else if (stroke) paintOperator = "S";
+
+	if (fill && fillRule == Qt::OddEvenFill) paintOperator += '*';
+
+	return paintOperator;
+}
+
+qreal PdfWriter::strokeMargin(DrawingItemStyle* style) const
+{
+	// Miter joins can reach out to the default miter limit
+	qreal penWidth = hasPen(style) ? diagramStyleValue(style, DrawingItemStyle::PenWidth).toReal() : 0;
+	Qt::PenJoinStyle joinStyle = (Qt::PenJoinStyle)diagramStyleValue(style, DrawingItemStyle::PenJoinStyle).toUInt();
+
+	return (joinStyle == Qt::MiterJoin || joinStyle == Qt::SvgMiterJoin) ? penWidth * 5 : penWidth;
+}
+
+//==================================================================================================
+
+QPainterPath PdfWriter::arcPath(const QLineF& arc) const
+{
+	// Same arc as the "A rx ry 0 0 0" elliptical arc written by the other exporters: a quarter
+	// ellipse centered on the corner of the bounding rect from which it runs counterclockwise
+	QPainterPath path;
+	qreal rx = qAbs(arc.dx()), ry = qAbs(arc.dy());
+
+	path.moveTo(arc.p1());
+
+	if (rx == 0 || ry == 0)
+	{
+		path.lineTo(arc.p2());
+		return path;
+	}
+
+	QPointF center(arc.x2(), arc.y1());
+	qreal startAngle = qAtan2((arc.y1() - center.y()) / ry, (arc.x1() - center.x()) / rx);
+	qreal sweepAngle = qAtan2((arc.y2() - center.y()) / ry, (arc.x2() - center.x()) / rx) - startAngle;
+
+	if (sweepAngle > M_PI) sweepAngle -= 2 * M_PI;
+	else if (sweepAngle <= -M_PI) sweepAngle += 2 * M_PI;
+
+	if (sweepAngle > 0)
+	{
+		center = QPointF(arc.x1(), arc.y2());
+		startAngle = qAtan2((arc.y1() - center.y()) / ry, (arc.x1() - center.x()) / rx);
+		sweepAngle = -sweepAngle;
+	}
+
+	// QPainterPath angles run counterclockwise on screen, opposite to scene angles
+	path.arcTo(QRectF(center.x() - rx, center.y() - ry, 2 * rx, 2 * ry),
+		-qRadiansToDegrees(startAngle), -qRadiansToDegrees(sweepAngle));
+
+	return path;
+}
+
+QPointF PdfWriter::captionAnchor(DrawingItemStyle* style, const QRectF& rect) const
+{
+	Qt::Alignment horizontalAlign = (Qt::Alignment)diagramStyleValue(style, DrawingItemStyle::TextHorizontalAlignment).toUInt();
+	Qt::Alignment verticalAlign = (Qt::Alignment)diagramStyleValue(style, DrawingItemStyle::TextVerticalAlignment).toUInt();
+	QPointF anchor = rect.center();
+
+	if (horizontalAlign & Qt::AlignLeft) anchor.setX(rect.left());
+	else if (horizontalAlign & Qt::AlignRight) anchor.setX(rect.right());
+
+	if (verticalAlign & Qt::AlignTop) anchor.setY(rect.top());
+	else if (verticalAlign & Qt::AlignBottom) anchor.setY(rect.bottom());
+
+	return anchor;
+}
+
+int PdfWriter::glyphCode(const QRawFont& rawFont, const QString& fontKey, quint32 glyphIndex, const QString& text)
+{
+	// Returns the font index times PdfWriterFontCodes plus the glyph's code within that font.
+	// Codes are handed out as glyphs are first used, and a font that runs out of codes is
+	// continued in a new one.
+	QPair<QString,quint32> key(fontKey, glyphIndex);
+	int fontCode = mGlyphCodes.value(key, -1);
+	if (fontCode >= 0) return fontCode;
+
+	int fontIndex = mFontIndex.value(fontKey, -1);
+	if (fontIndex < 0 || mFonts[fontIndex].glyphIndexes.size() >= PdfWriterFontCodes)
+	{
+		Font font;
+		font.rawFont = rawFont;
+		font.objectNumber = 0;
+
+		mFonts.append(font);
+		fontIndex = mFonts.size() - 1;
+		mFontIndex.insert(fontKey, fontIndex);
+	}
+
+	Font& font = mFonts[fontIndex];
+	fontCode = fontIndex * PdfWriterFontCodes + font.glyphIndexes.size();
+	font.glyphIndexes.append(glyphIndex);
+	font.characters.append(glyphCharacters(rawFont, glyphIndex, text));
+	mGlyphCodes.insert(key, fontCode);
+
+	return fontCode;
+}
+
+QString PdfWriter::glyphCharacters(const QRawFont& rawFont, quint32 glyphIndex, const QString& text) const
+{
+	// The first character of the text that maps to the glyph; glyphs that only come from shaping,
+	// such as ligatures, have no text of their own
+	for(int i = 0; i < text.size(); i++)
+	{
+		int length = (text[i].isHighSurrogate() && i + 1 < text.size()) ? 2 : 1;
+		QString character = text.mid(i, length);
+		QVector<quint32> characterGlyphs = rawFont.glyphIndexesForString(character);
+
+		if (!characterGlyphs.isEmpty() && characterGlyphs.first() == glyphIndex) return character;
+		i += length - 1;
+	}
+
+	return QString();
+}
+
+//==================================================================================================
+
+void PdfWriter::appendNumber(QByteArray& data, qreal value) const
+{
+	char buffer[DiagramNumberMaxLength];
+	int length = formatDiagramNumber(value, buffer);
+
+	if (memchr(buffer, 'e', length))
+	{
+		// PDF numbers have no exponent notation
+		QByteArray fixed = QByteArray::number(value, 'f', 6);
+		while (fixed.endsWith('0')) fixed.chop(1);
+		if (fixed.endsWith('.')) fixed.chop(1);
+		if (fixed == "-0") fixed = "0";
+		data += fixed;
+	}
+	else data.append(buffer, length);
+}
+
+void PdfWriter::appendPoint(QByteArray& data, const QPointF& point) const
+{
+	appendNumber(data, point.x());
+	data += ' ';
+	appendNumber(data, point.y());
+}
+
+void PdfWriter::appendHex(QByteArray& data, uint value, int digits) const
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	for(int i = digits - 1; i >= 0; i--)
+		data += hexDigits[(value >> (4 * i)) & 0xF];
+}
+
+void PdfWriter::appendColor(QByteArray& data, const QColor& color, const char* op) const
+{
+	appendNumber(data, color.redF());
+	data += ' ';
+	appendNumber(data, color.greenF());
+	data += ' ';
+	appendNumber(data, color.blueF());
+	data += ' ';
+	data += op;
+	data += '\n';
+}
+
+void PdfWriter::appendPath(QByteArray& data, const QPainterPath& path) const
+{
+	int count = path.elementCount();
+	QPointF subpathStart;
+
+	for(int i = 0; i < count; i++)
+	{
+		QPainterPath::Element element = path.elementAt(i);
+
+		switch (element.type)
+		{
+		case QPainterPath::MoveToElement:
+			appendPoint(data, element);
+			data += " m\n";
+			subpathStart = element;
+			break;
+		case QPainterPath::LineToElement:
+			appendPoint(data, element);
+			data += " l\n";
+			break;
+		case QPainterPath::CurveToElement:
+			if (i + 2 < count)
+			{
+				appendPoint(data, element);
+				data += ' ';
+				appendPoint(data, path.elementAt(i + 1));
+				data += ' ';
+				appendPoint(data, path.elementAt(i + 2));
+				data += " c\n";
+				i += 2;
+			}
+			break;
+		default:
+			break;
+		}
+
+		// Subpaths that end where they started are closed so that strokes join at that point
+		if (element.type != QPainterPath::MoveToElement && (i + 1 >= count || path.elementAt(i + 1).isMoveTo()) &&
+			QPointF(path.elementAt(i)) == subpathStart) data += "h\n";
+	}
+}
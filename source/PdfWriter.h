@@ -0,0 +1,156 @@
+/* PdfWriter.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PDFWRITER_H
+#define PDFWRITER_H
+
+#include <DiagramWidget.h>
+
+class QPrinter;
+typedef struct z_stream_s z_stream;
+
+// Writes the drawing as a single-page PDF straight from the item model.  Each distinct path item
+// symbol is written once as a Form XObject and placed with a transform, and the page content is
+// compressed as it is written out, so only the shared geometry is held in memory.  Captions are
+// written as text in Type 3 fonts that hold the outline of each glyph used, so they can be selected
+// and searched without embedding whole font files.
+class PdfWriter
+{
+private:
+	struct Form
+	{
+		QPainterPath path;
+		QByteArray paintOperator;
+		qreal strokeMargin;
+		int objectNumber;
+	};
+
+	struct Font
+	{
+		QRawFont rawFont;
+		QVector<quint32> glyphIndexes;
+		QStringList characters;
+		int objectNumber;
+	};
+
+	DiagramWidget* mDiagram;
+	QPrinter* mPrinter;
+	QString mFilePath;
+
+	QString mErrorMessage;
+
+	// Internal variables
+	QRectF mVisibleRect;
+	QSizeF mPageSize;
+	QTransform mPageTransform;
+
+	QIODevice* mDevice;
+	qint64 mPosition;
+	QVector<qint64> mObjectOffsets;
+
+	z_stream* mStream;
+	QByteArray mContent;
+	QByteArray mCompressedContent;
+	qint64 mContentLength;
+
+	QList<Form> mForms;
+	QHash<QByteArray,int> mFormIndex;
+	QHash<DrawingItem*,int> mItemForms;
+
+	QList<Font> mFonts;
+	QHash<QString,int> mFontIndex;
+	QHash<QPair<QString,quint32>,int> mGlyphCodes;
+
+	QList<QPair<qreal,qreal>> mGraphicsStates;
+
+public:
+	PdfWriter();
+	~PdfWriter();
+
+	bool write(DiagramWidget* diagram, QPrinter* printer, const QString& filePath);
+	QString errorMessage() const;
+
+private:
+	void analyzeDiagram();
+	void analyzeItems(const QList<DrawingItem*>& items);
+	void analyzePathItem(DrawingPathItem* item);
+	int addForm(const QByteArray& key, const QPainterPath& path, const QByteArray& paintOperator);
+
+	void writePdf();
+	void writeForms();
+	void writeFonts();
+	void writePageContent();
+	void writeResources(int resourcesObject);
+
+	void writeItems(const QList<DrawingItem*>& items);
+	void writeLineItem(DrawingLineItem* item);
+	void writeArcItem(DrawingArcItem* item);
+	void writePolylineItem(DrawingPolylineItem* item);
+	void writeCurveItem(DrawingCurveItem* item);
+	void writeRectItem(DrawingRectItem* item);
+	void writeEllipseItem(DrawingEllipseItem* item);
+	void writePolygonItem(DrawingPolygonItem* item);
+	void writeTextItem(DrawingTextItem* item);
+	void writeTextRectItem(DrawingTextRectItem* item);
+	void writeTextEllipseItem(DrawingTextEllipseItem* item);
+	void writeTextPolygonItem(DrawingTextPolygonItem* item);
+	void writePathItem(DrawingPathItem* item);
+	void writeItemGroup(DrawingItemGroup* item);
+
+	void writeShape(DrawingItem* item, const QPainterPath& path, bool closed, const QString& caption = QString(),
+		const QRectF& captionRect = QRectF());
+	void writeArrows(DrawingItem* item, const QPainterPath& path);
+	void writeArrow(DrawingItemStyle* style, bool start, const QPointF& tip, const QPointF& direction);
+	void writeCaption(DrawingItem* item, const QString& caption, const QRectF& rect);
+	void writeGlyphs(const QGlyphRun& glyphRun, const QString& text, const QPointF& origin, qreal fontSize,
+		int& currentFont);
+	void writeStyle(DrawingItemStyle* style);
+	void writeGraphicsState(qreal strokeOpacity, qreal fillOpacity);
+	void writeTransform(const QTransform& transform);
+
+	bool beginContent();
+	bool deflateContent(bool finish);
+
+	int newObject();
+	void beginObject(int objectNumber);
+	void endObject();
+	void writeStream(const QByteArray& dictionary, const QByteArray& data);
+	int writeCompressedStream(QByteArray dictionary, const QByteArray& data);
+	void writeData(const QByteArray& data);
+
+private:
+	bool hasPen(DrawingItemStyle* style) const;
+	bool hasBrush(DrawingItemStyle* style) const;
+	QByteArray paintOperator(DrawingItemStyle* style, Qt::FillRule fillRule) const;
+	qreal strokeMargin(DrawingItemStyle* style) const;
+
+	QPainterPath arcPath(const QLineF& arc) const;
+	QPointF captionAnchor(DrawingItemStyle* style, const QRectF& rect) const;
+	int glyphCode(const QRawFont& rawFont, const QString& fontKey, quint32 glyphIndex, const QString& text);
+	QString glyphCharacters(const QRawFont& rawFont, quint32 glyphIndex, const QString& text) const;
+
+	void appendNumber(QByteArray& data, qreal value) const;
+	void appendPoint(QByteArray& data, const QPointF& point) const;
+	void appendHex(QByteArray& data, uint value, int digits) const;
+	void appendColor(QByteArray& data, const QColor& color, const char* op) const;
+	void appendPath(QByteArray& data, const QPainterPath& path) const;
+};
+
+#endif
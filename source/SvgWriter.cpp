@@ -0,0 +1,647 @@
+/* SvgWriter.cpp
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "SvgWriter.h"
+#include "DiagramExportStyle.h"
+#include "DiagramItemPlacement.h"
+#include "DiagramItemType.h"
+#include "DiagramOutputStream.h"
+
+SvgWriter::SvgWriter()
+{
+	mDiagram = nullptr;
+}
+
+SvgWriter::~SvgWriter() { }
+
+//==================================================================================================
+
+bool SvgWriter::write(DiagramWidget* diagram, const QSize& size, const QString& filePath)
+{
+	mFilePath = filePath;
+	mSize = size;
+	mDiagram = diagram;
+
+	mErrorMessage.clear();
+
+	mStyleClasses.clear();
+	mTextStyleClasses.clear();
+	mStyleClassIndex.clear();
+	mItemStyles.clear();
+	mMarkers.clear();
+	mMarkerIndex.clear();
+	mSymbols.clear();
+	mSymbolIndex.clear();
+	mItemSymbols.clear();
+
+	mDiagram->loadAllItems();
+	mVisibleRect = mDiagram->scene()->sceneRect();
+	analyzeItems(mDiagram->scene()->items());
+
+	QFile svgFile(mFilePath);
+	if (svgFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		DiagramOutputStream stream(&svgFile);
+
+		writeSvg(stream);
+
+		if (!stream.flush()) mErrorMessage = "Error writing file: " + mFilePath;
+		svgFile.close();
+	}
+	else mErrorMessage = "Error creating file: " + mFilePath;
+
+	return mErrorMessage.isEmpty();
+}
+
+QString SvgWriter::errorMessage() const
+{
+	return mErrorMessage;
+}
+
+//==================================================================================================
+
+void SvgWriter::analyzeItems(const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramItemGroupType:
+			analyzeItems(static_cast<DrawingItemGroup*>(*itemIter)->items());
+			break;
+		case DiagramPathItemType:
+			analyzeItemStyle((*itemIter)->style(), false);
+			analyzePathItem(static_cast<DrawingPathItem*>(*itemIter));
+			break;
+		case DiagramTextItemType:
+		case DiagramTextRectItemType:
+		case DiagramTextEllipseItemType:
+		case DiagramTextPolygonItemType:
+			analyzeItemStyle((*itemIter)->style(), true);
+			break;
+		default:
+			analyzeItemStyle((*itemIter)->style(), false);
+			break;
+		}
+	}
+}
+
+void SvgWriter::analyzeItemStyle(DrawingItemStyle* style, bool hasText)
+{
+	// Items often carry their own copies of identical styles, so classes are shared by content
+	if (style && !mItemStyles.contains(style))
+	{
+		QString shapeClass = shapeStyleClass(style);
+		QString textClass = (hasText) ? textStyleClass(style) : QString();
+		QString key = shapeClass + "|" + textClass;
+		ItemStyle itemStyle;
+
+		itemStyle.classIndex = mStyleClassIndex.value(key, -1);
+		if (itemStyle.classIndex < 0)
+		{
+			itemStyle.classIndex = mStyleClasses.size();
+			mStyleClasses.append(shapeClass);
+			mTextStyleClasses.append(textClass);
+			mStyleClassIndex.insert(key, itemStyle.classIndex);
+		}
+
+		itemStyle.startMarkerIndex = addMarker(style, true);
+		itemStyle.endMarkerIndex = addMarker(style, false);
+
+		mItemStyles.insert(style, itemStyle);
+	}
+}
+
+void SvgWriter::analyzePathItem(DrawingPathItem* item)
+{
+	// Symbols are keyed on their geometry at their placed size; the position within the item is
+	// applied by the <use> element
+	QByteArray key;
+	QDataStream keyStream(&key, QIODevice::WriteOnly);
+	keyStream << item->path() << item->pathRect() << item->rect().size();
+
+	int index = mSymbolIndex.value(key, -1);
+	if (index < 0)
+	{
+		index = mSymbols.size();
+		mSymbols.append(item);
+		mSymbolIndex.insert(key, index);
+	}
+
+	mItemSymbols.insert(item, index);
+}
+
+//==================================================================================================
+
+QString SvgWriter::shapeStyleClass(DrawingItemStyle* style)
+{
+	QString css;
+
+	// Pen and brush are only drawn when the style sets them, as with the other writers; unset
+	// properties within them fall back to the defaults
+	bool hasPen = (style->hasValue(DrawingItemStyle::PenStyle) || style->hasValue(DrawingItemStyle::PenColor) ||
+		style->hasValue(DrawingItemStyle::PenWidth));
+	Qt::PenStyle penStyle = (Qt::PenStyle)diagramStyleValue(style, DrawingItemStyle::PenStyle).toUInt();
+	if (hasPen && penStyle != Qt::NoPen)
+	{
+		QColor penColor = diagramStyleValue(style, DrawingItemStyle::PenColor).value<QColor>();
+		qreal penOpacity = diagramStyleValue(style, DrawingItemStyle::PenOpacity).toReal() * penColor.alphaF();
+		qreal penWidth = diagramStyleValue(style, DrawingItemStyle::PenWidth).toReal();
+
+		css += "stroke:" + colorToHexString(penColor) + ";";
+		if (penOpacity < 1.0) css += "stroke-opacity:" + mBuffer.number(penOpacity) + ";";
+		css += "stroke-width:" + mBuffer.number(penWidth) + ";";
+
+		switch ((Qt::PenCapStyle)diagramStyleValue(style, DrawingItemStyle::PenCapStyle).toUInt())
+		{
+		case Qt::FlatCap: css += "stroke-linecap:butt;"; break;
+		case Qt::SquareCap: css += "stroke-linecap:square;"; break;
+		default: css += "stroke-linecap:round;"; break;
+		}
+
+		switch ((Qt::PenJoinStyle)diagramStyleValue(style, DrawingItemStyle::PenJoinStyle).toUInt())
+		{
+		case Qt::SvgMiterJoin:
+		case Qt::MiterJoin: css += "stroke-linejoin:miter;"; break;
+		case Qt::BevelJoin: css += "stroke-linejoin:bevel;"; break;
+		default: css += "stroke-linejoin:round;"; break;
+		}
+
+		if (penStyle != Qt::SolidLine) css += "stroke-dasharray:" + dashArrayToString(penStyle, penWidth) + ";";
+	}
+	else css += "stroke:none;";
+
+	QColor brushColor = diagramStyleValue(style, DrawingItemStyle::BrushColor).value<QColor>();
+	qreal brushOpacity = diagramStyleValue(style, DrawingItemStyle::BrushOpacity).toReal() * brushColor.alphaF();
+	if (style->hasValue(DrawingItemStyle::BrushColor) && brushOpacity > 0)
+	{
+		css += "fill:" + colorToHexString(brushColor) + ";";
+		if (brushOpacity < 1.0) css += "fill-opacity:" + mBuffer.number(brushOpacity) + ";";
+	}
+	else css += "fill:none;";
+
+	return css;
+}
+
+QString SvgWriter::textStyleClass(DrawingItemStyle* style)
+{
+	QString css;
+	QString fontName = diagramStyleValue(style, DrawingItemStyle::FontName).toString();
+	QColor textColor = diagramStyleValue(style, DrawingItemStyle::TextColor).value<QColor>();
+	QString decoration;
+
+	css += "fill:" + colorToHexString(textColor) + ";";
+	if (textColor.alpha() < 255) css += "fill-opacity:" + mBuffer.number(textColor.alphaF()) + ";";
+	css += "stroke:none;";
+	css += "font-family:'" + fontName.replace("'", "\\'") + "';";
+	css += "font-size:" + mBuffer.number(diagramStyleValue(style, DrawingItemStyle::FontSize).toReal()) + "px;";
+
+	if (diagramStyleValue(style, DrawingItemStyle::FontBold).toBool()) css += "font-weight:bold;";
+	if (diagramStyleValue(style, DrawingItemStyle::FontItalic).toBool()) css += "font-style:italic;";
+
+	if (diagramStyleValue(style, DrawingItemStyle::FontUnderline).toBool()) decoration += " underline";
+	if (diagramStyleValue(style, DrawingItemStyle::FontStrikeThrough).toBool()) decoration += " line-through";
+	if (!decoration.isEmpty()) css += "text-decoration:" + decoration.mid(1) + ";";
+
+	return css;
+}
+
+int SvgWriter::addMarker(DrawingItemStyle* style, bool start)
+{
+	DrawingItemStyle::Property styleProperty = (start) ? DrawingItemStyle::StartArrowStyle : DrawingItemStyle::EndArrowStyle;
+	DrawingItemStyle::Property sizeProperty = (start) ? DrawingItemStyle::StartArrowSize : DrawingItemStyle::EndArrowSize;
+
+	if (!style->hasValue(styleProperty) || !style->hasValue(sizeProperty)) return -1;
+
+	DrawingItemStyle::ArrowStyle arrowStyle = (DrawingItemStyle::ArrowStyle)style->value(styleProperty).toUInt();
+	qreal size = style->value(sizeProperty).toReal();
+	QColor penColor = diagramStyleValue(style, DrawingItemStyle::PenColor).value<QColor>();
+	qreal penOpacity = diagramStyleValue(style, DrawingItemStyle::PenOpacity).toReal() * penColor.alphaF();
+	qreal penWidth = diagramStyleValue(style, DrawingItemStyle::PenWidth).toReal();
+	QColor fillColor = diagramArrowFillColor(arrowStyle, penColor, mDiagram->scene()->backgroundBrush().color());
+
+	// Marker geometry has its tip at the origin pointing along +x, the direction of the line
+	// at its end point
+	QPainterPath path = diagramArrowPath(arrowStyle, size);
+	if (path.isEmpty()) return -1;
+
+	QString marker = " markerUnits=\"userSpaceOnUse\" orient=\"auto\" overflow=\"visible\"><path d=\"";
+	marker += pathToString(path, (start) ? QTransform::fromScale(-1, 1) : QTransform());
+	marker += "\" style=\"fill:";
+	marker += (fillColor.isValid()) ? colorToHexString(fillColor) : QString("none");
+	marker += ";stroke:" + colorToHexString(penColor) + ";";
+	if (penOpacity < 1.0) marker += "stroke-opacity:" + mBuffer.number(penOpacity) + ";";
+	marker += "stroke-width:" + mBuffer.number(penWidth) + ";stroke-linejoin:miter\"/></marker>";
+
+	int index = mMarkerIndex.value(marker, -1);
+	if (index < 0)
+	{
+		index = mMarkers.size();
+		mMarkers.append(marker);
+		mMarkerIndex.insert(marker, index);
+	}
+
+	return index;
+}
+
+//==================================================================================================
+
+void SvgWriter::writeSvg(DiagramOutputStream& stream)
+{
+	stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	stream << "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\"";
+	stream << " width=\"" << mSize.width() << "\" height=\"" << mSize.height() << "\"";
+	stream << " viewBox=\"" << mVisibleRect.left() << " " << mVisibleRect.top() << " " <<
+		mVisibleRect.width() << " " << mVisibleRect.height() << "\">\n";
+
+	writeStyles(stream);
+	writeDefs(stream);
+
+	QColor backgroundColor = mDiagram->scene()->backgroundBrush().color();
+	if (backgroundColor.alpha() > 0)
+	{
+		stream << "<rect x=\"" << mVisibleRect.left() << "\" y=\"" << mVisibleRect.top() << "\" width=\"" <<
+			mVisibleRect.width() << "\" height=\"" << mVisibleRect.height() << "\" fill=\"" << backgroundColor << "\"";
+		if (backgroundColor.alpha() < 255) stream << " fill-opacity=\"" << backgroundColor.alphaF() << "\"";
+		stream << "/>\n";
+	}
+
+	writeItems(stream, mDiagram->scene()->items());
+
+	stream << "</svg>\n";
+}
+
+void SvgWriter::writeStyles(DiagramOutputStream& stream)
+{
+	stream << "<style type=\"text/css\"><![CDATA[\n";
+
+	for(int i = 0; i < mStyleClasses.size(); i++)
+	{
+		stream << ".s" << (i + 1) << "{" << mStyleClasses[i] << "}\n";
+		if (!mTextStyleClasses[i].isEmpty())
+			stream << ".s" << (i + 1) << " text{" << mTextStyleClasses[i] << "}\n";
+	}
+
+	stream << "]]></style>\n";
+}
+
+void SvgWriter::writeDefs(DiagramOutputStream& stream)
+{
+	stream << "<defs>\n";
+
+	for(int i = 0; i < mMarkers.size(); i++)
+		stream << "<marker id=\"a" << (i + 1) << "\"" << mMarkers[i] << "\n";
+
+	for(int i = 0; i < mSymbols.size(); i++)
+	{
+		// Path geometry is mapped from its own view box into the item's rect, relative to the
+		// rect's top-left corner
+		DrawingPathItem* item = mSymbols[i];
+		QRectF pathRect = item->pathRect();
+		QRectF rect = item->rect();
+		QTransform pathTransform;
+
+		pathTransform.scale((pathRect.width() != 0) ? rect.width() / pathRect.width() : 1.0,
+			(pathRect.height() != 0) ? rect.height() / pathRect.height() : 1.0);
+		pathTransform.translate(-pathRect.left(), -pathRect.top());
+
+		stream << "<path id=\"p" << (i + 1) << "\" d=\"" << pathToString(item->path(), pathTransform) << "\"/>\n";
+	}
+
+	stream << "</defs>\n";
+}
+
+//==================================================================================================
+
+void SvgWriter::writeItems(DiagramOutputStream& stream, const QList<DrawingItem*>& items)
+{
+	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
+	{
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramLineItemType: writeLineItem(stream, static_cast<DrawingLineItem*>(*itemIter)); break;
+		case DiagramArcItemType: writeArcItem(stream, static_cast<DrawingArcItem*>(*itemIter)); break;
+		case DiagramPolylineItemType: writePolylineItem(stream, static_cast<DrawingPolylineItem*>(*itemIter)); break;
+		case DiagramCurveItemType: writeCurveItem(stream, static_cast<DrawingCurveItem*>(*itemIter)); break;
+		case DiagramRectItemType: writeRectItem(stream, static_cast<DrawingRectItem*>(*itemIter)); break;
+		case DiagramEllipseItemType: writeEllipseItem(stream, static_cast<DrawingEllipseItem*>(*itemIter)); break;
+		case DiagramPolygonItemType: writePolygonItem(stream, static_cast<DrawingPolygonItem*>(*itemIter)); break;
+		case DiagramTextItemType: writeTextItem(stream, static_cast<DrawingTextItem*>(*itemIter)); break;
+		case DiagramTextRectItemType: writeTextRectItem(stream, static_cast<DrawingTextRectItem*>(*itemIter)); break;
+		case DiagramTextEllipseItemType: writeTextEllipseItem(stream, static_cast<DrawingTextEllipseItem*>(*itemIter)); break;
+		case DiagramTextPolygonItemType: writeTextPolygonItem(stream, static_cast<DrawingTextPolygonItem*>(*itemIter)); break;
+		case DiagramPathItemType: writePathItem(stream, static_cast<DrawingPathItem*>(*itemIter)); break;
+		case DiagramItemGroupType: writeItemGroup(stream, static_cast<DrawingItemGroup*>(*itemIter)); break;
+		default: break;
+		}
+	}
+}
+
+void SvgWriter::writeLineItem(DiagramOutputStream& stream, DrawingLineItem* item)
+{
+	QLineF line = item->line();
+
+	stream << "<line";
+	writeItemAttributes(stream, item);
+	stream << " x1=\"" << line.x1() << "\" y1=\"" << line.y1() << "\" x2=\"" << line.x2() << "\" y2=\"" << line.y2() << "\"";
+	writeMarkerAttributes(stream, item);
+	stream << "/>\n";
+}
+
+void SvgWriter::writeArcItem(DiagramOutputStream& stream, DrawingArcItem* item)
+{
+	QLineF line = item->arc();
+	QRectF rect = QRectF(line.p1(), line.p2()).normalized();
+
+	stream << "<path";
+	writeItemAttributes(stream, item);
+	stream << " d=\"M " << line.x1() << " " << line.y1() << " A " << rect.width() << " " << rect.height() <<
+		" 0 0 0 " << line.x2() << " " << line.y2() << "\"";
+	writeMarkerAttributes(stream, item);
+	stream << "/>\n";
+}
+
+void SvgWriter::writePolylineItem(DiagramOutputStream& stream, DrawingPolylineItem* item)
+{
+	stream << "<polyline";
+	writeItemAttributes(stream, item);
+	stream << " points=\"" << pointsToString(diagramItemPolygon(item->points())) << "\"";
+	writeMarkerAttributes(stream, item);
+	stream << "/>\n";
+}
+
+void SvgWriter::writeCurveItem(DiagramOutputStream& stream, DrawingCurveItem* item)
+{
+	stream << "<path";
+	writeItemAttributes(stream, item);
+	stream << " d=\"M " << item->curveStartPos().x() << " " << item->curveStartPos().y() <<
+		" C " << item->curveStartControlPos().x() << " " << item->curveStartControlPos().y() <<
+		" " << item->curveEndControlPos().x() << " " << item->curveEndControlPos().y() <<
+		" " << item->curveEndPos().x() << " " << item->curveEndPos().y() << "\"";
+	writeMarkerAttributes(stream, item);
+	stream << "/>\n";
+}
+
+void SvgWriter::writeRectItem(DiagramOutputStream& stream, DrawingRectItem* item)
+{
+	QRectF rect = item->rect();
+
+	stream << "<rect";
+	writeItemAttributes(stream, item);
+	stream << " x=\"" << rect.left() << "\" y=\"" << rect.top() << "\" width=\"" << rect.width() << "\" height=\"" << rect.height() << "\"";
+	if (item->cornerRadiusX() != 0) stream << " rx=\"" << item->cornerRadiusX() << "\"";
+	if (item->cornerRadiusY() != 0) stream << " ry=\"" << item->cornerRadiusY() << "\"";
+	stream << "/>\n";
+}
+
+void SvgWriter::writeEllipseItem(DiagramOutputStream& stream, DrawingEllipseItem* item)
+{
+	QRectF rect = item->ellipse();
+
+	stream << "<ellipse";
+	writeItemAttributes(stream, item);
+	stream << " cx=\"" << rect.center().x() << "\" cy=\"" << rect.center().y() << "\" rx=\"" << rect.width() / 2 <<
+		"\" ry=\"" << rect.height() / 2 << "\"/>\n";
+}
+
+void SvgWriter::writePolygonItem(DiagramOutputStream& stream, DrawingPolygonItem* item)
+{
+	stream << "<polygon";
+	writeItemAttributes(stream, item);
+	stream << " points=\"" << pointsToString(diagramItemPolygon(item->points())) << "\"/>\n";
+}
+
+void SvgWriter::writeTextItem(DiagramOutputStream& stream, DrawingTextItem* item)
+{
+	stream << "<g";
+	writeItemAttributes(stream, item);
+	stream << ">\n";
+	writeCaption(stream, item, item->caption(), QRectF());
+	stream << "</g>\n";
+}
+
+void SvgWriter::writeTextRectItem(DiagramOutputStream& stream, DrawingTextRectItem* item)
+{
+	QRectF rect = item->rect();
+
+	stream << "<g";
+	writeItemAttributes(stream, item);
+	stream << ">\n<rect x=\"" << rect.left() << "\" y=\"" << rect.top() << "\" width=\"" << rect.width() << "\" height=\"" << rect.height() << "\"";
+	if (item->cornerRadiusX() != 0) stream << " rx=\"" << item->cornerRadiusX() << "\"";
+	if (item->cornerRadiusY() != 0) stream << " ry=\"" << item->cornerRadiusY() << "\"";
+	stream << "/>\n";
+	writeCaption(stream, item, item->caption(), rect);
+	stream << "</g>\n";
+}
+
+void SvgWriter::writeTextEllipseItem(DiagramOutputStream& stream, DrawingTextEllipseItem* item)
+{
+	QRectF rect = item->ellipse();
+
+	stream << "<g";
+	writeItemAttributes(stream, item);
+	stream << ">\n<ellipse cx=\"" << rect.center().x() << "\" cy=\"" << rect.center().y() << "\" rx=\"" << rect.width() / 2 <<
+		"\" ry=\"" << rect.height() / 2 << "\"/>\n";
+	writeCaption(stream, item, item->caption(), rect);
+	stream << "</g>\n";
+}
+
+void SvgWriter::writeTextPolygonItem(DiagramOutputStream& stream, DrawingTextPolygonItem* item)
+{
+	QPolygonF polygon = diagramItemPolygon(item->points());
+
+	stream << "<g";
+	writeItemAttributes(stream, item);
+	stream << ">\n<polygon points=\"" << pointsToString(polygon) << "\"/>\n";
+	writeCaption(stream, item, item->caption(), polygon.boundingRect());
+	stream << "</g>\n";
+}
+
+void SvgWriter::writePathItem(DiagramOutputStream& stream, DrawingPathItem* item)
+{
+	QRectF rect = item->rect();
+
+	stream << "<use xlink:href=\"#p" << (mItemSymbols.value(item) + 1) << "\"";
+	writeItemAttributes(stream, item);
+	stream << " x=\"" << rect.left() << "\" y=\"" << rect.top() << "\"/>\n";
+}
+
+void SvgWriter::writeItemGroup(DiagramOutputStream& stream, DrawingItemGroup* item)
+{
+	stream << "<g transform=\"" << transformToString(item) << "\">\n";
+	writeItems(stream, item->items());
+	stream << "</g>\n";
+}
+
+//==================================================================================================
+
+void SvgWriter::writeItemAttributes(DiagramOutputStream& stream, DrawingItem* item)
+{
+	if (mItemStyles.contains(item->style()))
+		stream << " class=\"s" << (mItemStyles.value(item->style()).classIndex + 1) << "\"";
+
+	stream << " transform=\"" << transformToString(item) << "\"";
+}
+
+void SvgWriter::writeMarkerAttributes(DiagramOutputStream& stream, DrawingItem* item)
+{
+	ItemStyle itemStyle = mItemStyles.value(item->style(), ItemStyle{0, -1, -1});
+
+	if (itemStyle.startMarkerIndex >= 0) stream << " marker-start=\"url(#a" << (itemStyle.startMarkerIndex + 1) << ")\"";
+	if (itemStyle.endMarkerIndex >= 0) stream << " marker-end=\"url(#a" << (itemStyle.endMarkerIndex + 1) << ")\"";
+}
+
+void SvgWriter::writeCaption(DiagramOutputStream& stream, DrawingItem* item, const QString& caption, const QRectF& rect)
+{
+	// Line offsets are given in ems so that the text needs no font metrics at export time
+	const qreal lineSpacing = 1.2;
+
+	if (caption.isEmpty()) return;
+
+	QStringList lines = caption.split("\n");
+	Qt::Alignment horizontalAlign = (Qt::Alignment)diagramStyleValue(item->style(), DrawingItemStyle::TextHorizontalAlignment).toUInt();
+	Qt::Alignment verticalAlign = (Qt::Alignment)diagramStyleValue(item->style(), DrawingItemStyle::TextVerticalAlignment).toUInt();
+	qreal x = rect.center().x(), y = rect.center().y(), firstLineOffset;
+
+	stream << "<text xml:space=\"preserve\"";
+
+	if (horizontalAlign & Qt::AlignLeft)
+	{
+		x = rect.left();
+		stream << " text-anchor=\"start\"";
+	}
+	else if (horizontalAlign & Qt::AlignRight)
+	{
+		x = rect.right();
+		stream << " text-anchor=\"end\"";
+	}
+	else stream << " text-anchor=\"middle\"";
+
+	if (verticalAlign & Qt::AlignTop)
+	{
+		y = rect.top();
+		firstLineOffset = 0.8;
+	}
+	else if (verticalAlign & Qt::AlignBottom)
+	{
+		y = rect.bottom();
+		firstLineOffset = -0.2 - (lines.size() - 1) * lineSpacing;
+	}
+	else firstLineOffset = 0.35 - (lines.size() - 1) * lineSpacing / 2;
+
+	stream << " x=\"" << x << "\" y=\"" << y << "\">";
+
+	for(auto lineIter = lines.begin(); lineIter != lines.end(); lineIter++)
+	{
+		stream << "<tspan x=\"" << x << "\" dy=\"" << ((lineIter == lines.begin()) ? firstLineOffset : lineSpacing) << "em\">";
+		stream << lineIter->toHtmlEscaped() << "</tspan>";
+	}
+
+	stream << "</text>\n";
+}
+
+//==================================================================================================
+
+const QString& SvgWriter::colorToHexString(const QColor& color)
+{
+	mBuffer.clear();
+	mBuffer.append(color);
+	return mBuffer.string();
+}
+
+const QString& SvgWriter::dashArrayToString(Qt::PenStyle style, qreal penWidth)
+{
+	QVector<qreal> pattern = diagramDashPattern(style, penWidth);
+
+	mBuffer.clear();
+
+	if (pattern.isEmpty()) mBuffer.append("none");
+
+	for(auto patternIter = pattern.begin(); patternIter != pattern.end(); patternIter++)
+	{
+		if (patternIter != pattern.begin()) mBuffer.append(',');
+		mBuffer.append(*patternIter);
+	}
+
+	return mBuffer.string();
+}
+
+const QString& SvgWriter::pathToString(const QPainterPath& path, const QTransform& transform)
+{
+	mBuffer.clear();
+
+	for(int i = 0; i < path.elementCount(); i++)
+	{
+		QPainterPath::Element element = path.elementAt(i);
+
+		if (i > 0) mBuffer.append(' ');
+
+		switch (element.type)
+		{
+		case QPainterPath::MoveToElement: mBuffer.append("M "); break;
+		case QPainterPath::LineToElement: mBuffer.append("L "); break;
+		case QPainterPath::CurveToElement: mBuffer.append("C "); break;
+		default: break;
+		}
+
+		mBuffer.append(transform.map(QPointF(element.x, element.y)), ' ');
+	}
+
+	return mBuffer.string();
+}
+
+const QString& SvgWriter::pointsToString(const QPolygonF& points)
+{
+	mBuffer.clear();
+
+	for(auto pointIter = points.begin(); pointIter != points.end(); pointIter++)
+	{
+		if (pointIter != points.begin()) mBuffer.append(' ');
+		mBuffer.append(*pointIter, ',');
+	}
+
+	return mBuffer.string();
+}
+
+const QString& SvgWriter::transformToString(DrawingItem* item)
+{
+	QTransform transform = diagramItemTransform(item);
+
+	mBuffer.clear();
+
+	if (transform.type() <= QTransform::TxTranslate)
+	{
+		mBuffer.append("translate(");
+		mBuffer.append(QPointF(transform.dx(), transform.dy()), ',');
+		mBuffer.append(')');
+	}
+	else
+	{
+		mBuffer.append("matrix(");
+		mBuffer.append(QPointF(transform.m11(), transform.m12()), ',');
+		mBuffer.append(',');
+		mBuffer.append(QPointF(transform.m21(), transform.m22()), ',');
+		mBuffer.append(',');
+		mBuffer.append(QPointF(transform.dx(), transform.dy()), ',');
+		mBuffer.append(')');
+	}
+
+	return mBuffer.string();
+}
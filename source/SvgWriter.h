@@ -0,0 +1,111 @@
+/* SvgWriter.h
+ *
+ * Copyright (C) 2013-2017 Jason Allen
+ *
+ * This file is part of the jade application.
+ *
+ * jade is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * jade is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with jade.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef SVGWRITER_H
+#define SVGWRITER_H
+
+#include <DiagramWidget.h>
+#include "DiagramNumberFormat.h"
+
+class DiagramOutputStream;
+
+// Writes the drawing's items as structured SVG.  Each distinct path item symbol is defined once
+// and placed with <use>, and items with equal styles share a CSS class.
+class SvgWriter
+{
+private:
+	struct ItemStyle
+	{
+		int classIndex;
+		int startMarkerIndex;
+		int endMarkerIndex;
+	};
+
+	DiagramWidget* mDiagram;
+	QSize mSize;
+	QString mFilePath;
+
+	QString mErrorMessage;
+
+	// Internal variables
+	QRectF mVisibleRect;
+
+	QStringList mStyleClasses;
+	QStringList mTextStyleClasses;
+	QHash<QString,int> mStyleClassIndex;
+	QHash<DrawingItemStyle*,ItemStyle> mItemStyles;
+
+	QStringList mMarkers;
+	QHash<QString,int> mMarkerIndex;
+
+	QList<DrawingPathItem*> mSymbols;
+	QHash<QByteArray,int> mSymbolIndex;
+	QHash<DrawingPathItem*,int> mItemSymbols;
+
+	DiagramNumberBuffer mBuffer;
+
+public:
+	SvgWriter();
+	~SvgWriter();
+
+	bool write(DiagramWidget* diagram, const QSize& size, const QString& filePath);
+	QString errorMessage() const;
+
+private:
+	void analyzeItems(const QList<DrawingItem*>& items);
+	void analyzeItemStyle(DrawingItemStyle* style, bool hasText);
+	void analyzePathItem(DrawingPathItem* item);
+
+	QString shapeStyleClass(DrawingItemStyle* style);
+	QString textStyleClass(DrawingItemStyle* style);
+	int addMarker(DrawingItemStyle* style, bool start);
+
+	void writeSvg(DiagramOutputStream& stream);
+	void writeStyles(DiagramOutputStream& stream);
+	void writeDefs(DiagramOutputStream& stream);
+
+	void writeItems(DiagramOutputStream& stream, const QList<DrawingItem*>& items);
+	void writeLineItem(DiagramOutputStream& stream, DrawingLineItem* item);
+	void writeArcItem(DiagramOutputStream& stream, DrawingArcItem* item);
+	void writePolylineItem(DiagramOutputStream& stream, DrawingPolylineItem* item);
+	void writeCurveItem(DiagramOutputStream& stream, DrawingCurveItem* item);
+	void writeRectItem(DiagramOutputStream& stream, DrawingRectItem* item);
+	void writeEllipseItem(DiagramOutputStream& stream, DrawingEllipseItem* item);
+	void writePolygonItem(DiagramOutputStream& stream, DrawingPolygonItem* item);
+	void writeTextItem(DiagramOutputStream& stream, DrawingTextItem* item);
+	void writeTextRectItem(DiagramOutputStream& stream, DrawingTextRectItem* item);
+	void writeTextEllipseItem(DiagramOutputStream& stream, DrawingTextEllipseItem* item);
+	void writeTextPolygonItem(DiagramOutputStream& stream, DrawingTextPolygonItem* item);
+	void writePathItem(DiagramOutputStream& stream, DrawingPathItem* item);
+	void writeItemGroup(DiagramOutputStream& stream, DrawingItemGroup* item);
+
+	void writeItemAttributes(DiagramOutputStream& stream, DrawingItem* item);
+	void writeMarkerAttributes(DiagramOutputStream& stream, DrawingItem* item);
+	void writeCaption(DiagramOutputStream& stream, DrawingItem* item, const QString& caption, const QRectF& rect);
+
+private:
+	const QString& colorToHexString(const QColor& color);
+	const QString& dashArrayToString(Qt::PenStyle style, qreal penWidth);
+	const QString& pathToString(const QPainterPath& path, const QTransform& transform = QTransform());
+	const QString& pointsToString(const QPolygonF& points);
+	const QString& transformToString(DrawingItem* item);
+};
+
+#endif
@@ -19,9 +19,12 @@
  */
  
 #include "VsdxWriter.h"
+#include "DiagramItemType.h"
+#include "DiagramNumberFormat.h"
+#include "DiagramOutputStream.h"
+#include "DiagramZipWriter.h"
 #include <QtPrintSupport>
 #include <quazip.h>
-#include <quazipfile.h>
 
 VsdxWriter::VsdxWriter()
 {
@@ -80,21 +83,25 @@ void VsdxWriter::writeVsdx()
 
 	if (vsdxFile.open(QuaZip::mdCreate))
 	{
-		createFileInZip(&vsdxFile, "[Content_Types].xml", writeContentTypes());
+		DiagramZipWriter zipWriter(&vsdxFile);
 
-		createFileInZip(&vsdxFile, "_rels/.rels", writeRels());
+		createFileInZip(zipWriter, "[Content_Types].xml", writeContentTypes());
 
-		createFileInZip(&vsdxFile, "docProps/app.xml", writeApp());
-		createFileInZip(&vsdxFile, "docProps/core.xml", writeCore());
-		createFileInZip(&vsdxFile, "docProps/custom.xml", writeCustom());
+		createFileInZip(zipWriter, "_rels/.rels", writeRels());
 
-		createFileInZip(&vsdxFile, "visio/pages/_rels/pages.xml.rels", writePagesRels());
-		createFileInZip(&vsdxFile, "visio/pages/pages.xml", writePages());
-		createFileInZip(&vsdxFile, "visio/pages/page1.xml", writePage1());
+		createFileInZip(zipWriter, "docProps/app.xml", writeApp());
+		createFileInZip(zipWriter, "docProps/core.xml", writeCore());
+		createFileInZip(zipWriter, "docProps/custom.xml", writeCustom());
 
-		createFileInZip(&vsdxFile, "visio/_rels/document.xml.rels", writeDocumentRels());
-		createFileInZip(&vsdxFile, "visio/document.xml", writeDocument());
-		createFileInZip(&vsdxFile, "visio/windows.xml", writeWindows());
+		createFileInZip(zipWriter, "visio/pages/_rels/pages.xml.rels", writePagesRels());
+		createFileInZip(zipWriter, "visio/pages/pages.xml", writePages());
+		createPageFileInZip(zipWriter, "visio/pages/page1.xml");
+
+		createFileInZip(zipWriter, "visio/_rels/document.xml.rels", writeDocumentRels());
+		createFileInZip(zipWriter, "visio/document.xml", writeDocument());
+		createFileInZip(zipWriter, "visio/windows.xml", writeWindows());
+
+		if (!zipWriter.finish() && mErrorMessage.isEmpty()) mErrorMessage = zipWriter.errorMessage();
 
 		vsdxFile.close();
 	}
@@ -277,20 +284,16 @@ QString VsdxWriter::writePages()
 	return pages;
 }
 
-QString VsdxWriter::writePage1()
+void VsdxWriter::writePage1(DiagramOutputStream& stream)
 {
-	QString page;
-
-	page += "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
-	page += "<PageContents xmlns=\"http://schemas.microsoft.com/office/visio/2012/main\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\" xml:space=\"preserve\">\n";
-	page += "  <Shapes>\n";
+	stream << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+	stream << "<PageContents xmlns=\"http://schemas.microsoft.com/office/visio/2012/main\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\" xml:space=\"preserve\">\n";
+	stream << "  <Shapes>\n";
 
-	page += writeItems(mDiagram->scene()->items());
+	writeItems(stream, mDiagram->scene()->items());
 
-	page += "  </Shapes>\n";
-	page += "</PageContents>\n";
-
-	return page;
+	stream << "  </Shapes>\n";
+	stream << "</PageContents>\n";
 }
 
 QString VsdxWriter::writeDocumentRels()
@@ -345,65 +348,55 @@ QString VsdxWriter::writeWindows()
 	return windows;
 }
 
-void VsdxWriter::createFileInZip(QuaZip* zip, const QString& path, const QString& content)
+void VsdxWriter::createFileInZip(DiagramZipWriter& zip, const QString& path, const QString& content)
 {
-	QuaZipFile outputFile(zip);
+	zip.addFile(path, content.toUtf8());
+}
 
-	if (outputFile.open(QIODevice::WriteOnly, QuaZipNewInfo(path)))
+void VsdxWriter::createPageFileInZip(DiagramZipWriter& zip, const QString& path)
+{
+	// The page is streamed straight into the zip entry and deflated in chunks as it is written
+	if (zip.beginFile(path))
 	{
-		QTextStream outputStream(&outputFile);
-		outputStream << content;
-		outputStream.flush();
-		outputFile.close();
+		DiagramOutputStream outputStream(&zip);
+		writePage1(outputStream);
+
+		bool flushed = outputStream.flush();
+		if (!zip.endFile() || !flushed) mErrorMessage = "Error writing " + path + " in file: " + mFilePath;
 	}
-	else mErrorMessage = "Error creating " + path + " in file: " + zip->getZipName();
+	else mErrorMessage = "Error writing " + path + " in file: " + mFilePath;
 }
 
 //==================================================================================================
 
-QString VsdxWriter::writeItems(const QList<DrawingItem*>& items)
+void VsdxWriter::writeItems(DiagramOutputStream& stream, const QList<DrawingItem*>& items)
 {
-	QString itemStr;
 	int index = 1;
 
 	for(auto itemIter = items.begin(); itemIter != items.end(); itemIter++)
 	{
-		DrawingLineItem* lineItem = dynamic_cast<DrawingLineItem*>(*itemIter);
-		DrawingArcItem* arcItem = dynamic_cast<DrawingArcItem*>(*itemIter);
-		DrawingPolylineItem* polylineItem = dynamic_cast<DrawingPolylineItem*>(*itemIter);
-		DrawingCurveItem* curveItem = dynamic_cast<DrawingCurveItem*>(*itemIter);
-		DrawingRectItem* rectItem = dynamic_cast<DrawingRectItem*>(*itemIter);
-		DrawingEllipseItem* ellipseItem = dynamic_cast<DrawingEllipseItem*>(*itemIter);
-		DrawingPolygonItem* polygonItem = dynamic_cast<DrawingPolygonItem*>(*itemIter);
-		DrawingTextItem* textItem = dynamic_cast<DrawingTextItem*>(*itemIter);
-		DrawingTextRectItem* textRectItem = dynamic_cast<DrawingTextRectItem*>(*itemIter);
-		DrawingTextEllipseItem* textEllipseItem = dynamic_cast<DrawingTextEllipseItem*>(*itemIter);
-		DrawingTextPolygonItem* textPolygonItem = dynamic_cast<DrawingTextPolygonItem*>(*itemIter);
-		DrawingPathItem* pathItem = dynamic_cast<DrawingPathItem*>(*itemIter);
-		DrawingItemGroup* groupItem = dynamic_cast<DrawingItemGroup*>(*itemIter);
-
-		if (lineItem) itemStr += writeLineItem(lineItem, index);
-		else if (arcItem) itemStr += writeArcItem(arcItem, index);
-		else if (polylineItem) itemStr += writePolylineItem(polylineItem, index);
-		else if (curveItem) itemStr += writeCurveItem(curveItem, index);
-		else if (rectItem) itemStr += writeRectItem(rectItem, index);
-		else if (ellipseItem) itemStr += writeEllipseItem(ellipseItem, index);
-		else if (polygonItem) itemStr += writePolygonItem(polygonItem, index);
-		else if (textItem) itemStr += writeTextItem(textItem, index);
-		else if (textRectItem) itemStr += writeTextRectItem(textRectItem, index);
-		else if (textEllipseItem) itemStr += writeTextEllipseItem(textEllipseItem, index);
-		else if (textPolygonItem) itemStr += writeTextPolygonItem(textPolygonItem, index);
-		else if (pathItem) itemStr += writePathItem(pathItem, index);
-		else if (groupItem) itemStr += writeItemGroup(groupItem, index);
+		switch (diagramItemType(*itemIter))
+		{
+		case DiagramLineItemType: writeLineItem(stream, static_cast<DrawingLineItem*>(*itemIter), index); break;
+		case DiagramArcItemType: writeArcItem(stream, static_cast<DrawingArcItem*>(*itemIter), index); break;
+		case DiagramPolylineItemType: writePolylineItem(stream, static_cast<DrawingPolylineItem*>(*itemIter), index); break;
+		case DiagramCurveItemType: writeCurveItem(stream, static_cast<DrawingCurveItem*>(*itemIter), index); break;
+		case DiagramRectItemType: writeRectItem(stream, static_cast<DrawingRectItem*>(*itemIter), index); break;
+		case DiagramEllipseItemType: writeEllipseItem(stream, static_cast<DrawingEllipseItem*>(*itemIter), index); break;
+		case DiagramPolygonItemType: writePolygonItem(stream, static_cast<DrawingPolygonItem*>(*itemIter), index); break;
+		case DiagramTextItemType: writeTextItem(stream, static_cast<DrawingTextItem*>(*itemIter), index); break;
+		case DiagramTextRectItemType: writeTextRectItem(stream, static_cast<DrawingTextRectItem*>(*itemIter), index); break;
+		case DiagramTextEllipseItemType: writeTextEllipseItem(stream, static_cast<DrawingTextEllipseItem*>(*itemIter), index); break;
+		case DiagramTextPolygonItemType: writeTextPolygonItem(stream, static_cast<DrawingTextPolygonItem*>(*itemIter), index); break;
+		case DiagramPathItemType: writePathItem(stream, static_cast<DrawingPathItem*>(*itemIter), index); break;
+		case DiagramItemGroupType: writeItemGroup(stream, static_cast<DrawingItemGroup*>(*itemIter), index); break;
+		default: break;
+		}
 	}
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeLineItem(DrawingLineItem* item, int& index)
+void VsdxWriter::writeLineItem(DiagramOutputStream& stream, DrawingLineItem* item, int& index)
 {
-	QString itemStr;
-
 	QPointF startPoint = mapFromScene(item->mapToScene(item->line().p1()));
 	QPointF endPoint = mapFromScene(item->mapToScene(item->line().p2()));
 	QPointF centerPoint = (startPoint + endPoint) / 2;
@@ -412,43 +405,41 @@ QString VsdxWriter::writeLineItem(DrawingLineItem* item, int& index)
 	qreal length = qSqrt(width * width + height * height);
 	qreal angle = qAtan2(endPoint.y() - startPoint.y(), endPoint.x() - startPoint.x());
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "      <Cell N=\"PinX\" V=\"" + QString::number(centerPoint.x()) + "\"/>\n";
-	itemStr += "      <Cell N=\"PinY\" V=\"" + QString::number(centerPoint.y()) + "\"/>\n";
-	itemStr += "      <Cell N=\"Width\" V=\"" + QString::number(length) + "\"/>\n";
-	itemStr += "      <Cell N=\"Height\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"LocPinX\" V=\"" + QString::number(length * 0.5) + "\"/>\n";
-	itemStr += "      <Cell N=\"LocPinY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"" + QString::number(angle) + "\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"BeginX\" V=\"" + QString::number(startPoint.x()) + "\"/>\n";
-	itemStr += "      <Cell N=\"BeginY\" V=\"" + QString::number(startPoint.y()) + "\"/>\n";
-	itemStr += "      <Cell N=\"EndX\" V=\"" + QString::number(endPoint.x()) + "\"/>\n";
-	itemStr += "      <Cell N=\"EndY\" V=\"" + QString::number(endPoint.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "        <Cell N=\"NoFill\" V=\"1\"/>\n";
-	itemStr += "		<Cell N=\"NoLine\" V=\"0\"/>\n";
-	itemStr += "       <Row T=\"MoveTo\" IX=\"1\">\n";
-	itemStr += "         <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "         <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "       </Row>\n";
-	itemStr += "       <Row T=\"LineTo\" IX=\"2\">\n";
-	itemStr += "         <Cell N=\"X\" V=\"" + QString::number(length) + "\"/>\n";
-	itemStr += "         <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "       </Row>\n";
-	itemStr += "      </Section>\n";
-	itemStr += "	</Shape>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "      <Cell N=\"PinX\" V=\"" << centerPoint.x() << "\"/>\n";
+	stream << "      <Cell N=\"PinY\" V=\"" << centerPoint.y() << "\"/>\n";
+	stream << "      <Cell N=\"Width\" V=\"" << length << "\"/>\n";
+	stream << "      <Cell N=\"Height\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"LocPinX\" V=\"" << length * 0.5 << "\"/>\n";
+	stream << "      <Cell N=\"LocPinY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"" << angle << "\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"BeginX\" V=\"" << startPoint.x() << "\"/>\n";
+	stream << "      <Cell N=\"BeginY\" V=\"" << startPoint.y() << "\"/>\n";
+	stream << "      <Cell N=\"EndX\" V=\"" << endPoint.x() << "\"/>\n";
+	stream << "      <Cell N=\"EndY\" V=\"" << endPoint.y() << "\"/>\n";
+	stream << "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "        <Cell N=\"NoFill\" V=\"1\"/>\n";
+	stream << "		<Cell N=\"NoLine\" V=\"0\"/>\n";
+	stream << "       <Row T=\"MoveTo\" IX=\"1\">\n";
+	stream << "         <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "         <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "       </Row>\n";
+	stream << "       <Row T=\"LineTo\" IX=\"2\">\n";
+	stream << "         <Cell N=\"X\" V=\"" << length << "\"/>\n";
+	stream << "         <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "       </Row>\n";
+	stream << "      </Section>\n";
+	stream << "	</Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeArcItem(DrawingArcItem* item, int& index)
+void VsdxWriter::writeArcItem(DiagramOutputStream& stream, DrawingArcItem* item, int& index)
 {
 	QPointF curveStartPoint = mapFromScene(item->mapToScene(item->arc().p1()));
 	QPointF curveEndPoint = mapFromScene(item->mapToScene(item->arc().p2()));
@@ -473,12 +464,12 @@ QString VsdxWriter::writeArcItem(DrawingArcItem* item, int& index)
 		if ((curveStartPoint.x() < curveEndPoint.x() && curveStartPoint.y() < curveEndPoint.y()) ||
 			(curveStartPoint.x() > curveEndPoint.x() && curveStartPoint.y() > curveEndPoint.y()))
 		{
-			return writeCurveItem(item, curveStartPoint, curveStartControlPoint2,
+			writeCurveItem(stream, item, curveStartPoint, curveStartControlPoint2,
 				curveEndControlPoint2, curveEndPoint, index);
 		}
 		else
 		{
-			return writeCurveItem(item, curveStartPoint, curveStartControlPoint1,
+			writeCurveItem(stream, item, curveStartPoint, curveStartControlPoint1,
 				curveEndControlPoint1, curveEndPoint, index);
 		}
 	}
@@ -487,21 +478,19 @@ QString VsdxWriter::writeArcItem(DrawingArcItem* item, int& index)
 		if ((curveStartPoint.x() < curveEndPoint.x() && curveStartPoint.y() < curveEndPoint.y()) ||
 			(curveStartPoint.x() > curveEndPoint.x() && curveStartPoint.y() > curveEndPoint.y()))
 		{
-			return writeCurveItem(item, curveStartPoint, curveStartControlPoint1,
+			writeCurveItem(stream, item, curveStartPoint, curveStartControlPoint1,
 				curveEndControlPoint1, curveEndPoint, index);
 		}
 		else
 		{
-			return writeCurveItem(item, curveStartPoint, curveStartControlPoint2,
+			writeCurveItem(stream, item, curveStartPoint, curveStartControlPoint2,
 				curveEndControlPoint2, curveEndPoint, index);
 		}
 	}
 }
 
-QString VsdxWriter::writePolylineItem(DrawingPolylineItem* item, int& index)
+void VsdxWriter::writePolylineItem(DiagramOutputStream& stream, DrawingPolylineItem* item, int& index)
 {
-	QString itemStr;
-
 	QPolygonF polyline = mapFromScene(item->mapToScene(item->polyline()));
 	QPointF topLeft = polyline.boundingRect().topLeft();
 	QPointF bottomRight = polyline.boundingRect().bottomRight();
@@ -509,60 +498,56 @@ QString VsdxWriter::writePolylineItem(DrawingPolylineItem* item, int& index)
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 	int pointIndex = 1;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "        <Cell N=\"NoFill\" V=\"1\"/>\n";
-	itemStr += "		<Cell N=\"NoLine\" V=\"0\"/>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "        <Cell N=\"NoFill\" V=\"1\"/>\n";
+	stream << "		<Cell N=\"NoLine\" V=\"0\"/>\n";
 
 	for(auto polyIter = polyline.begin(), polyEnd = polyline.end(); polyIter != polyEnd; polyIter++)
 	{
 		if (pointIndex == 1)
-			itemStr += "        <Row T=\"MoveTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
+			stream << "        <Row T=\"MoveTo\" IX=\"" << pointIndex << "\">\n";
 		else
-			itemStr += "        <Row T=\"LineTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
-		itemStr += "          <Cell N=\"X\" V=\"" + QString::number(polyIter->x() - topLeft.x()) + "\"/>\n";
-		itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height - bottomRight.y() + polyIter->y()) + "\"/>\n";
-		itemStr += "        </Row>\n";
+			stream << "        <Row T=\"LineTo\" IX=\"" << pointIndex << "\">\n";
+		stream << "          <Cell N=\"X\" V=\"" << polyIter->x() - topLeft.x() << "\"/>\n";
+		stream << "          <Cell N=\"Y\" V=\"" << height - bottomRight.y() + polyIter->y() << "\"/>\n";
+		stream << "        </Row>\n";
 
 		pointIndex++;
 	}
 
-	itemStr += "      </Section>\n";
-	itemStr += "    </Shape>\n";
+	stream << "      </Section>\n";
+	stream << "    </Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeCurveItem(DrawingCurveItem* item, int& index)
+void VsdxWriter::writeCurveItem(DiagramOutputStream& stream, DrawingCurveItem* item, int& index)
 {
 	QPointF curveStartPoint = mapFromScene(item->mapToScene(item->curveStartPos()));
 	QPointF curveEndPoint = mapFromScene(item->mapToScene(item->curveEndPos()));
 	QPointF curveStartControlPoint = mapFromScene(item->mapToScene(item->curveStartControlPos()));
 	QPointF curveEndControlPoint = mapFromScene(item->mapToScene(item->curveEndControlPos()));
 
-	return writeCurveItem(item, curveStartPoint, curveStartControlPoint,
+	writeCurveItem(stream, item, curveStartPoint, curveStartControlPoint,
 		curveEndControlPoint, curveEndPoint, index);
 }
 
-QString VsdxWriter::writeCurveItem(DrawingItem* item, const QPointF& curveStartPoint, const QPointF& curveStartControlPoint,
+void VsdxWriter::writeCurveItem(DiagramOutputStream& stream, DrawingItem* item, const QPointF& curveStartPoint, const QPointF& curveStartControlPoint,
 	const QPointF& curveEndControlPoint, const QPointF& curveEndPoint, int& index)
 {
-	QString itemStr;
-
 	QPointF centerPoint = (curveStartPoint + curveEndPoint) / 2;
 	qreal width = qAbs(curveEndPoint.x() - curveStartPoint.x());
 	qreal height = qAbs(curveEndPoint.y() - curveStartPoint.y());
@@ -609,50 +594,46 @@ QString VsdxWriter::writeCurveItem(DrawingItem* item, const QPointF& curveStartP
 	qreal c = curveEndControlRel.x() / length;
 	qreal d = curveEndControlRel.y() / curveHeight + 0.5;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "      <Cell N=\"PinX\" V=\"" + QString::number(centerPoint.x()) + "\"/>\n";
-	itemStr += "      <Cell N=\"PinY\" V=\"" + QString::number(centerPoint.y()) + "\"/>\n";
-	itemStr += "      <Cell N=\"Width\" V=\"" + QString::number(length) + "\"/>\n";
-	itemStr += "      <Cell N=\"Height\" V=\"" + QString::number(curveHeight) + "\"/>\n";
-	itemStr += "      <Cell N=\"LocPinX\" V=\"" + QString::number(length * 0.5) + "\"/>\n";
-	itemStr += "      <Cell N=\"LocPinY\" V=\"" + QString::number(curveHeight * 0.5) + "\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"" + QString::number(angle) + "\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"BeginX\" V=\"" + QString::number(curveStartPoint.x()) + "\"/>\n";
-	itemStr += "      <Cell N=\"BeginY\" V=\"" + QString::number(curveStartPoint.y()) + "\"/>\n";
-	itemStr += "      <Cell N=\"EndX\" V=\"" + QString::number(curveEndPoint.x()) + "\"/>\n";
-	itemStr += "      <Cell N=\"EndY\" V=\"" + QString::number(curveEndPoint.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "        <Cell N=\"NoFill\" V=\"1\"/>\n";
-	itemStr += "		<Cell N=\"NoLine\" V=\"0\"/>\n";
-	itemStr += "       <Row T=\"MoveTo\" IX=\"1\">\n";
-	itemStr += "         <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "         <Cell N=\"Y\" V=\"" + QString::number(curveHeight * 0.5) + "\"/>\n";
-	itemStr += "       </Row>\n";
-	itemStr += "       <Row T=\"RelCubBezTo\" IX=\"2\">\n";
-	itemStr += "         <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "         <Cell N=\"Y\" V=\"0.5\"/>\n";
-	itemStr += "         <Cell N=\"A\" V=\"" + QString::number(a) + "\"/>\n";
-	itemStr += "         <Cell N=\"B\" V=\"" + QString::number(b) + "\"/>\n";
-	itemStr += "         <Cell N=\"C\" V=\"" + QString::number(c) + "\"/>\n";
-	itemStr += "         <Cell N=\"D\" V=\"" + QString::number(d) + "\"/>\n";
-	itemStr += "       </Row>\n";
-	itemStr += "      </Section>\n";
-	itemStr += "	</Shape>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "      <Cell N=\"PinX\" V=\"" << centerPoint.x() << "\"/>\n";
+	stream << "      <Cell N=\"PinY\" V=\"" << centerPoint.y() << "\"/>\n";
+	stream << "      <Cell N=\"Width\" V=\"" << length << "\"/>\n";
+	stream << "      <Cell N=\"Height\" V=\"" << curveHeight << "\"/>\n";
+	stream << "      <Cell N=\"LocPinX\" V=\"" << length * 0.5 << "\"/>\n";
+	stream << "      <Cell N=\"LocPinY\" V=\"" << curveHeight * 0.5 << "\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"" << angle << "\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"BeginX\" V=\"" << curveStartPoint.x() << "\"/>\n";
+	stream << "      <Cell N=\"BeginY\" V=\"" << curveStartPoint.y() << "\"/>\n";
+	stream << "      <Cell N=\"EndX\" V=\"" << curveEndPoint.x() << "\"/>\n";
+	stream << "      <Cell N=\"EndY\" V=\"" << curveEndPoint.y() << "\"/>\n";
+	stream << "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "        <Cell N=\"NoFill\" V=\"1\"/>\n";
+	stream << "		<Cell N=\"NoLine\" V=\"0\"/>\n";
+	stream << "       <Row T=\"MoveTo\" IX=\"1\">\n";
+	stream << "         <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "         <Cell N=\"Y\" V=\"" << curveHeight * 0.5 << "\"/>\n";
+	stream << "       </Row>\n";
+	stream << "       <Row T=\"RelCubBezTo\" IX=\"2\">\n";
+	stream << "         <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "         <Cell N=\"Y\" V=\"0.5\"/>\n";
+	stream << "         <Cell N=\"A\" V=\"" << a << "\"/>\n";
+	stream << "         <Cell N=\"B\" V=\"" << b << "\"/>\n";
+	stream << "         <Cell N=\"C\" V=\"" << c << "\"/>\n";
+	stream << "         <Cell N=\"D\" V=\"" << d << "\"/>\n";
+	stream << "       </Row>\n";
+	stream << "      </Section>\n";
+	stream << "	</Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeRectItem(DrawingRectItem* item, int& index)
+void VsdxWriter::writeRectItem(DiagramOutputStream& stream, DrawingRectItem* item, int& index)
 {
-	QString itemStr;
-
 	QRectF rect = mapFromScene(item->mapToScene(item->rect()).boundingRect());
 	QPointF topLeft = rect.normalized().topLeft();
 	QPointF bottomRight = rect.normalized().bottomRight();
@@ -660,92 +641,84 @@ QString VsdxWriter::writeRectItem(DrawingRectItem* item, int& index)
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 	qreal cornerRadius = qMin(item->cornerRadiusX(), item->cornerRadiusY()) * mDiagramScale;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "	  <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "	  <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
 	if (cornerRadius != 0)
-		itemStr += "	  <Cell N=\"Rounding\" V=\"" + QString::number(cornerRadius) + "\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "	  <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "		<Row T=\"RelMoveTo\" IX=\"1\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"2\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"3\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"1\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"4\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"1\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"5\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "	  </Section>\n";
-	itemStr += "	</Shape>\n";
+		stream << "	  <Cell N=\"Rounding\" V=\"" << cornerRadius << "\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "	  <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "		<Row T=\"RelMoveTo\" IX=\"1\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"2\">\n";
+	stream << "		  <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"3\">\n";
+	stream << "		  <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"1\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"4\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"1\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"5\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "	  </Section>\n";
+	stream << "	</Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeEllipseItem(DrawingEllipseItem* item, int& index)
+void VsdxWriter::writeEllipseItem(DiagramOutputStream& stream, DrawingEllipseItem* item, int& index)
 {
-	QString itemStr;
-
 	QRectF ellipse = mapFromScene(item->mapToScene(item->ellipse()).boundingRect());
 	QPointF topLeft = ellipse.normalized().topLeft();
 	QPointF bottomRight = ellipse.normalized().bottomRight();
 	qreal width = qAbs(bottomRight.x() - topLeft.x());
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "        <Row T=\"Ellipse\" IX=\"1\">\n";
-	itemStr += "          <Cell N=\"X\" V=\"" + QString::number(width * 0.5) + "\" F=\"Width*0.5\"/>\n";
-	itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height * 0.5) + "\" F=\"Height*0.5\"/>\n";
-	itemStr += "          <Cell N=\"A\" V=\"" + QString::number(width) + "\" U=\"DL\" F=\"Width*1\"/>\n";
-	itemStr += "          <Cell N=\"B\" V=\"" + QString::number(height * 0.5) + "\" U=\"DL\" F=\"Height*0.5\"/>\n";
-	itemStr += "          <Cell N=\"C\" V=\"" + QString::number(width * 0.5) + "\" U=\"DL\" F=\"Width*0.5\"/>\n";
-	itemStr += "          <Cell N=\"D\" V=\"" + QString::number(height) + "\" U=\"DL\" F=\"Height*1\"/>\n";
-	itemStr += "        </Row>\n";
-	itemStr += "      </Section>\n";
-	itemStr += "    </Shape>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "        <Row T=\"Ellipse\" IX=\"1\">\n";
+	stream << "          <Cell N=\"X\" V=\"" << width * 0.5 << "\" F=\"Width*0.5\"/>\n";
+	stream << "          <Cell N=\"Y\" V=\"" << height * 0.5 << "\" F=\"Height*0.5\"/>\n";
+	stream << "          <Cell N=\"A\" V=\"" << width << "\" U=\"DL\" F=\"Width*1\"/>\n";
+	stream << "          <Cell N=\"B\" V=\"" << height * 0.5 << "\" U=\"DL\" F=\"Height*0.5\"/>\n";
+	stream << "          <Cell N=\"C\" V=\"" << width * 0.5 << "\" U=\"DL\" F=\"Width*0.5\"/>\n";
+	stream << "          <Cell N=\"D\" V=\"" << height << "\" U=\"DL\" F=\"Height*1\"/>\n";
+	stream << "        </Row>\n";
+	stream << "      </Section>\n";
+	stream << "    </Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writePolygonItem(DrawingPolygonItem* item, int& index)
+void VsdxWriter::writePolygonItem(DiagramOutputStream& stream, DrawingPolygonItem* item, int& index)
 {
-	QString itemStr;
-
 	QPolygonF polygon = mapFromScene(item->mapToScene(item->polygon()));
 	QPointF topLeft = polygon.boundingRect().topLeft();
 	QPointF bottomRight = polygon.boundingRect().bottomRight();
@@ -753,50 +726,46 @@ QString VsdxWriter::writePolygonItem(DrawingPolygonItem* item, int& index)
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 	int pointIndex = 1;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
 
 	for(auto polyIter = polygon.begin(), polyEnd = polygon.end(); polyIter != polyEnd; polyIter++)
 	{
 		if (pointIndex == 1)
-			itemStr += "        <Row T=\"MoveTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
+			stream << "        <Row T=\"MoveTo\" IX=\"" << pointIndex << "\">\n";
 		else
-			itemStr += "        <Row T=\"LineTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
-		itemStr += "          <Cell N=\"X\" V=\"" + QString::number(polyIter->x() - topLeft.x()) + "\"/>\n";
-		itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height - bottomRight.y() + polyIter->y()) + "\"/>\n";
-		itemStr += "        </Row>\n";
+			stream << "        <Row T=\"LineTo\" IX=\"" << pointIndex << "\">\n";
+		stream << "          <Cell N=\"X\" V=\"" << polyIter->x() - topLeft.x() << "\"/>\n";
+		stream << "          <Cell N=\"Y\" V=\"" << height - bottomRight.y() + polyIter->y() << "\"/>\n";
+		stream << "        </Row>\n";
 
 		pointIndex++;
 	}
 
-	itemStr += "        <Row T=\"LineTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
-	itemStr += "          <Cell N=\"X\" V=\"" + QString::number(polygon.first().x() - topLeft.x()) + "\"/>\n";
-	itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height - bottomRight.y() + polygon.first().y()) + "\"/>\n";
-	itemStr += "        </Row>\n";
+	stream << "        <Row T=\"LineTo\" IX=\"" << pointIndex << "\">\n";
+	stream << "          <Cell N=\"X\" V=\"" << polygon.first().x() - topLeft.x() << "\"/>\n";
+	stream << "          <Cell N=\"Y\" V=\"" << height - bottomRight.y() + polygon.first().y() << "\"/>\n";
+	stream << "        </Row>\n";
 
-	itemStr += "      </Section>\n";
-	itemStr += "    </Shape>\n";
+	stream << "      </Section>\n";
+	stream << "    </Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeTextItem(DrawingTextItem* item, int& index)
+void VsdxWriter::writeTextItem(DiagramOutputStream& stream, DrawingTextItem* item, int& index)
 {
-	QString itemStr;
-
 	Qt::Alignment horizontalAlign = item->style()->hasValue(DrawingItemStyle::TextHorizontalAlignment) ?
 		(Qt::Alignment)item->style()->value(DrawingItemStyle::TextHorizontalAlignment).toUInt() : Qt::AlignHCenter;
 	Qt::Alignment verticalAlign = item->style()->hasValue(DrawingItemStyle::TextVerticalAlignment) ?
@@ -817,58 +786,54 @@ QString VsdxWriter::writeTextItem(DrawingTextItem* item, int& index)
 	qreal width = qAbs(bottomRight.x() - topLeft.x());
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(bottomRight.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "	  <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"LinePattern\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"LeftMargin\" V=\"0.027777778\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"RightMargin\" V=\"0.027777778\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"TopMargin\" V=\"0.0138888889\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"BottomMargin\" V=\"0.0138888889\" U=\"PT\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "	  <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "		<Row T=\"RelMoveTo\" IX=\"1\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"2\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"3\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"1\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"4\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"1\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"5\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "	  </Section>\n";
-	itemStr += "	  <Text>" + item->caption() + "</Text>\n";
-	itemStr += "	</Shape>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << bottomRight.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "	  <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"LinePattern\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"LeftMargin\" V=\"0.027777778\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"RightMargin\" V=\"0.027777778\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"TopMargin\" V=\"0.0138888889\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"BottomMargin\" V=\"0.0138888889\" U=\"PT\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "	  <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "		<Row T=\"RelMoveTo\" IX=\"1\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"2\">\n";
+	stream << "		  <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"3\">\n";
+	stream << "		  <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"1\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"4\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"1\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"5\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "	  </Section>\n";
+	stream << "	  <Text>" << item->caption() << "</Text>\n";
+	stream << "	</Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeTextRectItem(DrawingTextRectItem* item, int& index)
+void VsdxWriter::writeTextRectItem(DiagramOutputStream& stream, DrawingTextRectItem* item, int& index)
 {
-	QString itemStr;
-
 	QRectF rect = mapFromScene(item->mapToScene(item->rect()).boundingRect());
 	QPointF topLeft = rect.normalized().topLeft();
 	QPointF bottomRight = rect.normalized().bottomRight();
@@ -876,104 +841,96 @@ QString VsdxWriter::writeTextRectItem(DrawingTextRectItem* item, int& index)
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 	qreal cornerRadius = qMin(item->cornerRadiusX(), item->cornerRadiusY()) * mDiagramScale;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "	  <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "	  <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
 
 	if (cornerRadius != 0)
-		itemStr += "	  <Cell N=\"Rounding\" V=\"" + QString::number(cornerRadius) + "\"/>\n";
-
-	itemStr += "	  <Cell N=\"LeftMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"RightMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"TopMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"BottomMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "	  <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "		<Row T=\"RelMoveTo\" IX=\"1\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"2\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"3\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"1\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"1\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"4\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"1\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "		<Row T=\"RelLineTo\" IX=\"5\">\n";
-	itemStr += "		  <Cell N=\"X\" V=\"0\"/>\n";
-	itemStr += "		  <Cell N=\"Y\" V=\"0\"/>\n";
-	itemStr += "		</Row>\n";
-	itemStr += "	  </Section>\n";
-	itemStr += "	  <Text>" + item->caption() + "</Text>\n";
-	itemStr += "	</Shape>\n";
+		stream << "	  <Cell N=\"Rounding\" V=\"" << cornerRadius << "\"/>\n";
+
+	stream << "	  <Cell N=\"LeftMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"RightMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"TopMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"BottomMargin\" V=\"0\" U=\"PT\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "	  <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "		<Row T=\"RelMoveTo\" IX=\"1\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"2\">\n";
+	stream << "		  <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"3\">\n";
+	stream << "		  <Cell N=\"X\" V=\"1\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"1\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"4\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"1\"/>\n";
+	stream << "		</Row>\n";
+	stream << "		<Row T=\"RelLineTo\" IX=\"5\">\n";
+	stream << "		  <Cell N=\"X\" V=\"0\"/>\n";
+	stream << "		  <Cell N=\"Y\" V=\"0\"/>\n";
+	stream << "		</Row>\n";
+	stream << "	  </Section>\n";
+	stream << "	  <Text>" << item->caption() << "</Text>\n";
+	stream << "	</Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeTextEllipseItem(DrawingTextEllipseItem* item, int& index)
+void VsdxWriter::writeTextEllipseItem(DiagramOutputStream& stream, DrawingTextEllipseItem* item, int& index)
 {
-	QString itemStr;
-
 	QRectF ellipse = mapFromScene(item->mapToScene(item->ellipse()).boundingRect());
 	QPointF topLeft = ellipse.normalized().topLeft();
 	QPointF bottomRight = ellipse.normalized().bottomRight();
 	qreal width = qAbs(bottomRight.x() - topLeft.x());
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"LeftMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"RightMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"TopMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"BottomMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "        <Row T=\"Ellipse\" IX=\"1\">\n";
-	itemStr += "          <Cell N=\"X\" V=\"" + QString::number(width * 0.5) + "\" F=\"Width*0.5\"/>\n";
-	itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height * 0.5) + "\" F=\"Height*0.5\"/>\n";
-	itemStr += "          <Cell N=\"A\" V=\"" + QString::number(width) + "\" U=\"DL\" F=\"Width*1\"/>\n";
-	itemStr += "          <Cell N=\"B\" V=\"" + QString::number(height * 0.5) + "\" U=\"DL\" F=\"Height*0.5\"/>\n";
-	itemStr += "          <Cell N=\"C\" V=\"" + QString::number(width * 0.5) + "\" U=\"DL\" F=\"Width*0.5\"/>\n";
-	itemStr += "          <Cell N=\"D\" V=\"" + QString::number(height) + "\" U=\"DL\" F=\"Height*1\"/>\n";
-	itemStr += "        </Row>\n";
-	itemStr += "      </Section>\n";
-	itemStr += "	  <Text>" + item->caption() + "</Text>\n";
-	itemStr += "    </Shape>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"LeftMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"RightMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"TopMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"BottomMargin\" V=\"0\" U=\"PT\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "        <Row T=\"Ellipse\" IX=\"1\">\n";
+	stream << "          <Cell N=\"X\" V=\"" << width * 0.5 << "\" F=\"Width*0.5\"/>\n";
+	stream << "          <Cell N=\"Y\" V=\"" << height * 0.5 << "\" F=\"Height*0.5\"/>\n";
+	stream << "          <Cell N=\"A\" V=\"" << width << "\" U=\"DL\" F=\"Width*1\"/>\n";
+	stream << "          <Cell N=\"B\" V=\"" << height * 0.5 << "\" U=\"DL\" F=\"Height*0.5\"/>\n";
+	stream << "          <Cell N=\"C\" V=\"" << width * 0.5 << "\" U=\"DL\" F=\"Width*0.5\"/>\n";
+	stream << "          <Cell N=\"D\" V=\"" << height << "\" U=\"DL\" F=\"Height*1\"/>\n";
+	stream << "        </Row>\n";
+	stream << "      </Section>\n";
+	stream << "	  <Text>" << item->caption() << "</Text>\n";
+	stream << "    </Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeTextPolygonItem(DrawingTextPolygonItem* item, int& index)
+void VsdxWriter::writeTextPolygonItem(DiagramOutputStream& stream, DrawingTextPolygonItem* item, int& index)
 {
-	QString itemStr;
-
 	QPolygonF polygon = mapFromScene(item->mapToScene(item->polygon()));
 	QPointF topLeft = polygon.boundingRect().topLeft();
 	QPointF bottomRight = polygon.boundingRect().bottomRight();
@@ -981,55 +938,51 @@ QString VsdxWriter::writeTextPolygonItem(DrawingTextPolygonItem* item, int& inde
 	qreal height = qAbs(bottomRight.y() - topLeft.y());
 	int pointIndex = 1;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "      <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"LeftMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"RightMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"TopMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += "	  <Cell N=\"BottomMargin\" V=\"0\" U=\"PT\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "      <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "      <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "      <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"LeftMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"RightMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"TopMargin\" V=\"0\" U=\"PT\"/>\n";
+	stream << "	  <Cell N=\"BottomMargin\" V=\"0\" U=\"PT\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "      <Section N=\"Geometry\" IX=\"0\">\n";
 
 	for(auto polyIter = polygon.begin(), polyEnd = polygon.end(); polyIter != polyEnd; polyIter++)
 	{
 		if (pointIndex == 1)
-			itemStr += "        <Row T=\"MoveTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
+			stream << "        <Row T=\"MoveTo\" IX=\"" << pointIndex << "\">\n";
 		else
-			itemStr += "        <Row T=\"LineTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
-		itemStr += "          <Cell N=\"X\" V=\"" + QString::number(polyIter->x() - topLeft.x()) + "\"/>\n";
-		itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height - bottomRight.y() + polyIter->y()) + "\"/>\n";
-		itemStr += "        </Row>\n";
+			stream << "        <Row T=\"LineTo\" IX=\"" << pointIndex << "\">\n";
+		stream << "          <Cell N=\"X\" V=\"" << polyIter->x() - topLeft.x() << "\"/>\n";
+		stream << "          <Cell N=\"Y\" V=\"" << height - bottomRight.y() + polyIter->y() << "\"/>\n";
+		stream << "        </Row>\n";
 
 		pointIndex++;
 	}
 
-	itemStr += "        <Row T=\"LineTo\" IX=\"" + QString::number(pointIndex) + "\">\n";
-	itemStr += "          <Cell N=\"X\" V=\"" + QString::number(polygon.first().x() - topLeft.x()) + "\"/>\n";
-	itemStr += "          <Cell N=\"Y\" V=\"" + QString::number(height - bottomRight.y() + polygon.first().y()) + "\"/>\n";
-	itemStr += "        </Row>\n";
+	stream << "        <Row T=\"LineTo\" IX=\"" << pointIndex << "\">\n";
+	stream << "          <Cell N=\"X\" V=\"" << polygon.first().x() - topLeft.x() << "\"/>\n";
+	stream << "          <Cell N=\"Y\" V=\"" << height - bottomRight.y() + polygon.first().y() << "\"/>\n";
+	stream << "        </Row>\n";
 
-	itemStr += "      </Section>\n";
-	itemStr += "	  <Text>" + item->caption() + "</Text>\n";
-	itemStr += "    </Shape>\n";
+	stream << "      </Section>\n";
+	stream << "	  <Text>" << item->caption() << "</Text>\n";
+	stream << "    </Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writePathItem(DrawingPathItem* item, int& index)
+void VsdxWriter::writePathItem(DiagramOutputStream& stream, DrawingPathItem* item, int& index)
 {
-	QString itemStr;
-
 	QRectF rect = mapFromScene(item->mapToScene(item->rect()).boundingRect());
 	QPointF topLeft = rect.normalized().topLeft();
 	QPointF bottomRight = rect.normalized().bottomRight();
@@ -1042,22 +995,22 @@ QString VsdxWriter::writePathItem(DrawingPathItem* item, int& index)
 	QPointF prevPoint, curveEndPoint, curveStartControlPoint, curveEndControlPoint;
 	bool curveDataValid = false;
 
-	itemStr += "    <Shape ID=\"" + QString::number(index) + "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
-	itemStr += "	  <Cell N=\"PinX\" V=\"" + QString::number(topLeft.x()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"PinY\" V=\"" + QString::number(topLeft.y()) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Width\" V=\"" + QString::number(width) + "\"/>\n";
-	itemStr += "	  <Cell N=\"Height\" V=\"" + QString::number(height) + "\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
-	itemStr += "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
-	itemStr += "	  <Cell N=\"Angle\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
-	itemStr += "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
-	itemStr += writeItemStyle(item->style());
-	itemStr += "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
-	itemStr += "	  <Section N=\"Geometry\" IX=\"0\">\n";
-	itemStr += "        <Cell N=\"NoFill\" V=\"1\"/>\n";
-	itemStr += "		<Cell N=\"NoLine\" V=\"0\"/>\n";
+	stream << "    <Shape ID=\"" << index << "\" Type=\"Shape\" LineStyle=\"3\" FillStyle=\"3\" TextStyle=\"3\">\n";
+	stream << "	  <Cell N=\"PinX\" V=\"" << topLeft.x() << "\"/>\n";
+	stream << "	  <Cell N=\"PinY\" V=\"" << topLeft.y() << "\"/>\n";
+	stream << "	  <Cell N=\"Width\" V=\"" << width << "\"/>\n";
+	stream << "	  <Cell N=\"Height\" V=\"" << height << "\"/>\n";
+	stream << "	  <Cell N=\"LocPinX\" V=\"0\" F=\"Width*0\"/>\n";
+	stream << "	  <Cell N=\"LocPinY\" V=\"0\" F=\"Height*0\"/>\n";
+	stream << "	  <Cell N=\"Angle\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipX\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"FlipY\" V=\"0\"/>\n";
+	stream << "	  <Cell N=\"ResizeMode\" V=\"0\"/>\n";
+	writeItemStyle(stream, item->style());
+	stream << "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
+	stream << "	  <Section N=\"Geometry\" IX=\"0\">\n";
+	stream << "        <Cell N=\"NoFill\" V=\"1\"/>\n";
+	stream << "		<Cell N=\"NoLine\" V=\"0\"/>\n";
 
 	for(int i = 0; i < path.elementCount(); i++)
 	{
@@ -1068,19 +1021,19 @@ QString VsdxWriter::writePathItem(DrawingPathItem* item, int& index)
 		case QPainterPath::MoveToElement:
 			prevPoint.setX((element.x - pathRect.left()) / pathRect.width());
 			prevPoint.setY((pathRect.bottom() - element.y) / pathRect.height());
-			itemStr += "		<Row T=\"RelMoveTo\" IX=\"" + QString::number(pathIndex) + "\">\n";
-			itemStr += "		  <Cell N=\"X\" V=\"" + QString::number(prevPoint.x()) + "\"/>\n";
-			itemStr += "		  <Cell N=\"Y\" V=\"" + QString::number(prevPoint.y()) + "\"/>\n";
-			itemStr += "		</Row>\n";
+			stream << "		<Row T=\"RelMoveTo\" IX=\"" << pathIndex << "\">\n";
+			stream << "		  <Cell N=\"X\" V=\"" << prevPoint.x() << "\"/>\n";
+			stream << "		  <Cell N=\"Y\" V=\"" << prevPoint.y() << "\"/>\n";
+			stream << "		</Row>\n";
 			pathIndex++;
 			break;
 		case QPainterPath::LineToElement:
 			prevPoint.setX((element.x - pathRect.left()) / pathRect.width());
 			prevPoint.setY((pathRect.bottom() - element.y) / pathRect.height());
-			itemStr += "		<Row T=\"RelLineTo\" IX=\"" + QString::number(pathIndex) + "\">\n";
-			itemStr += "		  <Cell N=\"X\" V=\"" + QString::number(prevPoint.x()) + "\"/>\n";
-			itemStr += "		  <Cell N=\"Y\" V=\"" + QString::number(prevPoint.y()) + "\"/>\n";
-			itemStr += "		</Row>\n";
+			stream << "		<Row T=\"RelLineTo\" IX=\"" << pathIndex << "\">\n";
+			stream << "		  <Cell N=\"X\" V=\"" << prevPoint.x() << "\"/>\n";
+			stream << "		  <Cell N=\"Y\" V=\"" << prevPoint.y() << "\"/>\n";
+			stream << "		</Row>\n";
 			pathIndex++;
 			break;
 		case QPainterPath::CurveToElement:
@@ -1102,14 +1055,14 @@ QString VsdxWriter::writePathItem(DrawingPathItem* item, int& index)
 				QPointF curveStartControlRel = transform.map(curveStartControlPoint);
 				QPointF curveEndControlRel = transform.map(curveEndControlPoint);
 
-				itemStr += "		<Row T=\"RelCubBezTo\" IX=\"" + QString::number(pathIndex) + "\">\n";
-				itemStr += "		  <Cell N=\"X\" V=\"" + QString::number(curveEndPoint.x()) + "\"/>\n";
-				itemStr += "		  <Cell N=\"Y\" V=\"" + QString::number(curveEndPoint.y()) + "\"/>\n";
-				itemStr += "		  <Cell N=\"A\" V=\"" + QString::number(curveStartControlPoint.x()) + "\"/>\n";
-				itemStr += "		  <Cell N=\"B\" V=\"" + QString::number(curveStartControlPoint.y()) + "\"/>\n";
-				itemStr += "		  <Cell N=\"C\" V=\"" + QString::number(curveEndControlPoint.x()) + "\"/>\n";
-				itemStr += "		  <Cell N=\"D\" V=\"" + QString::number(curveEndControlPoint.y()) + "\"/>\n";
-				itemStr += "		</Row>\n";
+				stream << "		<Row T=\"RelCubBezTo\" IX=\"" << pathIndex << "\">\n";
+				stream << "		  <Cell N=\"X\" V=\"" << curveEndPoint.x() << "\"/>\n";
+				stream << "		  <Cell N=\"Y\" V=\"" << curveEndPoint.y() << "\"/>\n";
+				stream << "		  <Cell N=\"A\" V=\"" << curveStartControlPoint.x() << "\"/>\n";
+				stream << "		  <Cell N=\"B\" V=\"" << curveStartControlPoint.y() << "\"/>\n";
+				stream << "		  <Cell N=\"C\" V=\"" << curveEndControlPoint.x() << "\"/>\n";
+				stream << "		  <Cell N=\"D\" V=\"" << curveEndControlPoint.y() << "\"/>\n";
+				stream << "		</Row>\n";
 				pathIndex++;
 
 				prevPoint = curveEndPoint;
@@ -1125,71 +1078,65 @@ QString VsdxWriter::writePathItem(DrawingPathItem* item, int& index)
 		}
 	}
 
-	itemStr += "	  </Section>\n";
-	itemStr += "	</Shape>\n";
+	stream << "	  </Section>\n";
+	stream << "	</Shape>\n";
 
 	index++;
-
-	return itemStr;
 }
 
-QString VsdxWriter::writeItemGroup(DrawingItemGroup* item, int& index)
+void VsdxWriter::writeItemGroup(DiagramOutputStream& stream, DrawingItemGroup* item, int& index)
 {
-	QString itemStr;
-
-
-
-	return itemStr;
+	Q_UNUSED(stream);
+	Q_UNUSED(item);
+	Q_UNUSED(index);
 }
 
 //==================================================================================================
 
-QString VsdxWriter::writeItemStyle(DrawingItemStyle* style)
+void VsdxWriter::writeItemStyle(DiagramOutputStream& stream, DrawingItemStyle* style)
 {
-	QString styleStr;
-
 	// Pen style information
 	if (style->hasValue(DrawingItemStyle::PenColor))
-		styleStr += "	  <Cell N=\"LineColor\" V=\"" + colorToHexString(style->value(DrawingItemStyle::PenColor).value<QColor>()) + "\"/>\n";
+		stream << "	  <Cell N=\"LineColor\" V=\"" << colorToHexString(style->value(DrawingItemStyle::PenColor).value<QColor>()) << "\"/>\n";
 
 	if (style->hasValue(DrawingItemStyle::PenOpacity))
 	{
 		qreal alphaF = style->value(DrawingItemStyle::PenOpacity).toReal();
 		if (alphaF != 1.0)
-			styleStr += "	  <Cell N=\"LineColorTrans\" V=\"" + QString::number(1.0 - alphaF) + "\"/>\n";
+			stream << "	  <Cell N=\"LineColorTrans\" V=\"" << 1.0 - alphaF << "\"/>\n";
 	}
 
 	if (style->hasValue(DrawingItemStyle::PenStyle))
 	{
 		Qt::PenStyle penStyle = (Qt::PenStyle)style->value(DrawingItemStyle::PenStyle).toUInt();
 		if (penStyle == Qt::DotLine)
-			styleStr += "	  <Cell N=\"LinePattern\" V=\"10\"/>\n";
+			stream << "	  <Cell N=\"LinePattern\" V=\"10\"/>\n";
 
 		else if (penStyle == Qt::DashLine || penStyle == Qt::DashDotLine || penStyle == Qt::DashDotDotLine)
-			styleStr += "	  <Cell N=\"LinePattern\" V=\"9\"/>\n";
+			stream << "	  <Cell N=\"LinePattern\" V=\"9\"/>\n";
 	}
 
 	if (style->hasValue(DrawingItemStyle::PenWidth))
 	{
 		// Pen width of 16.0 = 1 pt.  1 pt = 1/72 in.
 		qreal penWidth = style->value(DrawingItemStyle::PenWidth).toReal();
-		styleStr += "	  <Cell N=\"LineWeight\" V=\"" + QString::number(penWidth / 16 / 72) + "\"/>\n";
+		stream << "	  <Cell N=\"LineWeight\" V=\"" << penWidth / 16 / 72 << "\"/>\n";
 	}
 
 	// Brush style information
 	if (style->hasValue(DrawingItemStyle::BrushColor))
-		styleStr += "	  <Cell N=\"FillForegnd\" V=\"" + colorToHexString(style->value(DrawingItemStyle::BrushColor).value<QColor>()) + "\"/>\n";
+		stream << "	  <Cell N=\"FillForegnd\" V=\"" << colorToHexString(style->value(DrawingItemStyle::BrushColor).value<QColor>()) << "\"/>\n";
 
 	if (style->hasValue(DrawingItemStyle::BrushOpacity))
 	{
 		qreal alphaF = style->value(DrawingItemStyle::BrushOpacity).toReal();
 		if (alphaF != 0.0 && alphaF != 1.0)
 		{
-			styleStr += "	  <Cell N=\"FillForegndTrans\" V=\"" + QString::number(1.0 - alphaF) + "\"/>\n";
-			styleStr += "	  <Cell N=\"FillBkgndTrans\" V=\"" + QString::number(1.0 - alphaF) + "\"/>\n";
+			stream << "	  <Cell N=\"FillForegndTrans\" V=\"" << 1.0 - alphaF << "\"/>\n";
+			stream << "	  <Cell N=\"FillBkgndTrans\" V=\"" << 1.0 - alphaF << "\"/>\n";
 		}
 		else if (alphaF == 0.0)
-			styleStr += "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
+			stream << "	  <Cell N=\"FillPattern\" V=\"0\"/>\n";
 	}
 
 	// Text alignment information
@@ -1202,7 +1149,7 @@ QString VsdxWriter::writeItemStyle(DrawingItemStyle* style)
 		else if (align & Qt::AlignBottom) alignValue = 2;
 
 		if (alignValue != 1)
-			styleStr += "	  <Cell N=\"VerticalAlign\" V=\"" + QString::number(alignValue) + "\"/>\n";
+			stream << "	  <Cell N=\"VerticalAlign\" V=\"" << alignValue << "\"/>\n";
 	}
 
 	if (style->hasValue(DrawingItemStyle::TextHorizontalAlignment))
@@ -1215,11 +1162,11 @@ QString VsdxWriter::writeItemStyle(DrawingItemStyle* style)
 
 		if (alignValue != 1)
 		{
-			styleStr += "      <Section N=\"Paragraph\">\n";
-			styleStr += "        <Row IX=\"0\">\n";
-			styleStr += "          <Cell N=\"HorzAlign\" V=\"" + QString::number(alignValue) + "\"/>\n";
-			styleStr += "        </Row>\n";
-			styleStr += "      </Section>\n";
+			stream << "      <Section N=\"Paragraph\">\n";
+			stream << "        <Row IX=\"0\">\n";
+			stream << "          <Cell N=\"HorzAlign\" V=\"" << alignValue << "\"/>\n";
+			stream << "        </Row>\n";
+			stream << "      </Section>\n";
 
 		}
 	}
@@ -1241,26 +1188,26 @@ QString VsdxWriter::writeItemStyle(DrawingItemStyle* style)
 	if (fontName != "" || fontSize != 0 || fontBold || fontItalic || fontUnderline || fontStrikeThrough ||
 		style->hasValue(DrawingItemStyle::TextColor))
 	{
-		uint fontStyle = 0;
+		int fontStyle = 0;
 		if (fontBold && fontItalic) fontStyle = 51;
 		else if (fontItalic) fontStyle = 34;
 		else if (fontBold) fontStyle = 17;
 		if (fontUnderline) fontStyle += 4;
 
-		styleStr += "	  <Section N=\"Character\">\n";
-		styleStr += "	    <Row IX=\"0\">\n";
+		stream << "	  <Section N=\"Character\">\n";
+		stream << "	    <Row IX=\"0\">\n";
 		if (fontName != "")
-			styleStr += "	      <Cell N=\"Font\" V=\"" + fontName + "\"/>\n";
+			stream << "	      <Cell N=\"Font\" V=\"" << fontName << "\"/>\n";
 		if (fontSize != 0)
-			styleStr += "	      <Cell N=\"Size\" V=\"" + QString::number(fontSize) + "\" U=\"PT\"/>\n";
+			stream << "	      <Cell N=\"Size\" V=\"" << fontSize << "\" U=\"PT\"/>\n";
 		if (fontStyle != 0)
-			styleStr += "	      <Cell N=\"Style\" V=\"" + QString::number(fontStyle) + "\"/>\n";
+			stream << "	      <Cell N=\"Style\" V=\"" << fontStyle << "\"/>\n";
 		if (fontStrikeThrough)
-			styleStr += "	      <Cell N=\"Strikethru\" V=\"1\"/>\n";
+			stream << "	      <Cell N=\"Strikethru\" V=\"1\"/>\n";
 		if (style->hasValue(DrawingItemStyle::TextColor))
-			styleStr += "	     <Cell N=\"Color\" V=\"" + colorToHexString(style->value(DrawingItemStyle::TextColor).value<QColor>()) + "\"/>\n";
-		styleStr += "	    </Row>\n";
-		styleStr += "	  </Section>\n";
+			stream << "	     <Cell N=\"Color\" V=\"" << colorToHexString(style->value(DrawingItemStyle::TextColor).value<QColor>()) << "\"/>\n";
+		stream << "	    </Row>\n";
+		stream << "	  </Section>\n";
 	}
 
 	// Start and end arrow information (style and size)
@@ -1291,8 +1238,8 @@ QString VsdxWriter::writeItemStyle(DrawingItemStyle* style)
 
 		if (arrowStr != "0")
 		{
-			styleStr += "	  <Cell N=\"BeginArrow\" V=\"" + arrowStr + "\"/>\n";
-			styleStr += "	  <Cell N=\"BeginArrowSize\" V=\"" + arrowSize + "\"/>\n";
+			stream << "	  <Cell N=\"BeginArrow\" V=\"" << arrowStr << "\"/>\n";
+			stream << "	  <Cell N=\"BeginArrowSize\" V=\"" << arrowSize << "\"/>\n";
 		}
 	}
 
@@ -1323,17 +1270,15 @@ QString VsdxWriter::writeItemStyle(DrawingItemStyle* style)
 
 		if (arrowStr != "0")
 		{
-			styleStr += "	  <Cell N=\"QuickStyleLineMatrix\" V=\"1\"/>\n";
-			styleStr += "	  <Cell N=\"QuickStyleFillMatrix\" V=\"1\"/>\n";
-			styleStr += "	  <Cell N=\"QuickStyleEffectsMatrix\" V=\"1\"/>\n";
-			styleStr += "	  <Cell N=\"QuickStyleFontMatrix\" V=\"1\"/>\n";
+			stream << "	  <Cell N=\"QuickStyleLineMatrix\" V=\"1\"/>\n";
+			stream << "	  <Cell N=\"QuickStyleFillMatrix\" V=\"1\"/>\n";
+			stream << "	  <Cell N=\"QuickStyleEffectsMatrix\" V=\"1\"/>\n";
+			stream << "	  <Cell N=\"QuickStyleFontMatrix\" V=\"1\"/>\n";
 
-			styleStr += "	  <Cell N=\"EndArrow\" V=\"" + arrowStr + "\"/>\n";
-			styleStr += "	  <Cell N=\"EndArrowSize\" V=\"" + arrowSize + "\"/>\n";
+			stream << "	  <Cell N=\"EndArrow\" V=\"" << arrowStr << "\"/>\n";
+			stream << "	  <Cell N=\"EndArrowSize\" V=\"" << arrowSize << "\"/>\n";
 		}
 	}
-
-	return styleStr;
 }
 
 //==================================================================================================
@@ -23,8 +23,9 @@
 
 #include <DiagramWidget.h>
 
+class DiagramOutputStream;
+class DiagramZipWriter;
 class QPrinter;
-class QuaZip;
 
 class VsdxWriter
 {
@@ -59,30 +60,31 @@ private:
 	QString writeCustom();
 	QString writePagesRels();
 	QString writePages();
-	QString writePage1();
+	void writePage1(DiagramOutputStream& stream);
 	QString writeDocumentRels();
 	QString writeDocument();
 	QString writeWindows();
-	void createFileInZip(QuaZip* zip, const QString& path, const QString& content);
+	void createFileInZip(DiagramZipWriter& zip, const QString& path, const QString& content);
+	void createPageFileInZip(DiagramZipWriter& zip, const QString& path);
 
-	QString writeItems(const QList<DrawingItem*>& items);
-	QString writeLineItem(DrawingLineItem* item, int& index);
-	QString writeArcItem(DrawingArcItem* item, int& index);
-	QString writePolylineItem(DrawingPolylineItem* item, int& index);
-	QString writeCurveItem(DrawingCurveItem* item, int& index);
-	QString writeCurveItem(DrawingItem* item, const QPointF& curveStartPoint, const QPointF& curveStartControlPoint,
+	void writeItems(DiagramOutputStream& stream, const QList<DrawingItem*>& items);
+	void writeLineItem(DiagramOutputStream& stream, DrawingLineItem* item, int& index);
+	void writeArcItem(DiagramOutputStream& stream, DrawingArcItem* item, int& index);
+	void writePolylineItem(DiagramOutputStream& stream, DrawingPolylineItem* item, int& index);
+	void writeCurveItem(DiagramOutputStream& stream, DrawingCurveItem* item, int& index);
+	void writeCurveItem(DiagramOutputStream& stream, DrawingItem* item, const QPointF& curveStartPoint, const QPointF& curveStartControlPoint,
 		const QPointF& curveEndControlPoint, const QPointF& curveEndPoint, int& index);
-	QString writeRectItem(DrawingRectItem* item, int& index);
-	QString writeEllipseItem(DrawingEllipseItem* item, int& index);
-	QString writePolygonItem(DrawingPolygonItem* item, int& index);
-	QString writeTextItem(DrawingTextItem* item, int& index);
-	QString writeTextRectItem(DrawingTextRectItem* item, int& index);
-	QString writeTextEllipseItem(DrawingTextEllipseItem* item, int& index);
-	QString writeTextPolygonItem(DrawingTextPolygonItem* item, int& index);
-	QString writePathItem(DrawingPathItem* item, int& index);
-	QString writeItemGroup(DrawingItemGroup* item, int& index);
+	void writeRectItem(DiagramOutputStream& stream, DrawingRectItem* item, int& index);
+	void writeEllipseItem(DiagramOutputStream& stream, DrawingEllipseItem* item, int& index);
+	void writePolygonItem(DiagramOutputStream& stream, DrawingPolygonItem* item, int& index);
+	void writeTextItem(DiagramOutputStream& stream, DrawingTextItem* item, int& index);
+	void writeTextRectItem(DiagramOutputStream& stream, DrawingTextRectItem* item, int& index);
+	void writeTextEllipseItem(DiagramOutputStream& stream, DrawingTextEllipseItem* item, int& index);
+	void writeTextPolygonItem(DiagramOutputStream& stream, DrawingTextPolygonItem* item, int& index);
+	void writePathItem(DiagramOutputStream& stream, DrawingPathItem* item, int& index);
+	void writeItemGroup(DiagramOutputStream& stream, DrawingItemGroup* item, int& index);
 
-	QString writeItemStyle(DrawingItemStyle* style);
+	void writeItemStyle(DiagramOutputStream& stream, DrawingItemStyle* style);
 
 	QPointF mapFromScene(const QPointF& pos) const;
 	QRectF mapFromScene(const QRectF& rect) const;
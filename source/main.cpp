@@ -19,11 +19,120 @@
  */
 
 #include "MainWindow.h"
+#include "DiagramBatchExporter.h"
+
+static int exportFiles(QApplication& app)
+{
+	// Returns 0 if every file was exported, 1 if any file failed, or 2 for usage errors
+	QCommandLineParser parser;
+	QCommandLineOption exportOption("export", "Export each file to <format> (png, svg, pdf, odg, or vsdx) and exit.", "format");
+	QCommandLineOption outOption("out", "Write exported files to <directory> instead of next to each input.", "directory");
+	QCommandLineOption jobsOption("jobs", "Export up to <n> files at once.", "n");
+	QCommandLineOption scaleOption("scale", "Scale factor for png and svg exports.", "scale");
+	QCommandLineOption threadsOption("threads", "Use up to <n> worker threads for each file.", "n");
+
+	parser.setApplicationDescription("Export jade drawings without opening the editor.");
+	QCommandLineOption helpOption = parser.addHelpOption();
+	parser.addOption(exportOption);
+	parser.addOption(outOption);
+	parser.addOption(jobsOption);
+	parser.addOption(scaleOption);
+	parser.addOption(threadsOption);
+	parser.addPositionalArgument("files", "Drawings to export.", "files...");
+
+	if (!parser.parse(app.arguments()))
+	{
+		QTextStream(stderr) << "jade: " << parser.errorText() << endl;
+		return 2;
+	}
+
+	if (parser.isSet(helpOption)) parser.showHelp(0);
+
+	DiagramBatchExporter exporter;
+	QStringList filePaths = parser.positionalArguments();
+	bool ok = true;
+
+	exporter.setFormat(DiagramBatchExporter::formatFromString(parser.value(exportOption)));
+	if (exporter.format() == DiagramBatchExporter::UnknownFormat)
+	{
+		QTextStream(stderr) << "jade: unknown export format: " << parser.value(exportOption) << endl;
+		return 2;
+	}
+
+	if (parser.isSet(outOption))
+	{
+		exporter.setOutputPath(parser.value(outOption));
+		if (!QDir().mkpath(exporter.outputPath()))
+		{
+			QTextStream(stderr) << "jade: unable to create directory: " << exporter.outputPath() << endl;
+			return 2;
+		}
+	}
+
+	if (parser.isSet(jobsOption))
+	{
+		exporter.setJobs(parser.value(jobsOption).toInt(&ok));
+		if (!ok)
+		{
+			QTextStream(stderr) << "jade: invalid number of jobs: " << parser.value(jobsOption) << endl;
+			return 2;
+		}
+	}
+
+	if (parser.isSet(threadsOption))
+	{
+		int threads = parser.value(threadsOption).toInt(&ok);
+		if (!ok || threads < 1)
+		{
+			QTextStream(stderr) << "jade: invalid number of threads: " << parser.value(threadsOption) << endl;
+			return 2;
+		}
+		QThreadPool::globalInstance()->setMaxThreadCount(threads);
+	}
+
+	if (parser.isSet(scaleOption))
+	{
+		exporter.setScale(parser.value(scaleOption).toDouble(&ok));
+		if (!ok || exporter.scale() <= 0)
+		{
+			QTextStream(stderr) << "jade: invalid scale: " << parser.value(scaleOption) << endl;
+			return 2;
+		}
+	}
+
+	if (filePaths.isEmpty())
+	{
+		QTextStream(stderr) << "jade: no files to export" << endl;
+		return 2;
+	}
+
+	// Item defaults come from the same settings file as the editor so exports match what the user sees
+	QSettings settings(MainWindow::configPath(), QSettings::IniFormat);
+	MainWindow::loadItemDefaults(settings);
+
+	return (exporter.exportFiles(filePaths) == 0) ? 0 : 1;
+}
+
+//==================================================================================================
 
 int main(int argc, char* argv[])
 {
+	bool batchExport = false;
+
+	// Batch exports never show a window, so they run on the offscreen platform unless told otherwise.
+	// The command-line help describes the batch export options, so it is handled there too.
+	for(int i = 1; i < argc && !batchExport; i++)
+	{
+		batchExport = (qstrcmp(argv[i], "--export") == 0 || qstrncmp(argv[i], "--export=", 9) == 0 ||
+			qstrcmp(argv[i], "--help") == 0 || qstrcmp(argv[i], "-h") == 0 || qstrcmp(argv[i], "-?") == 0);
+	}
+	if (batchExport && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
 	QApplication app(argc, argv);
 
+	if (batchExport) return exportFiles(app);
+
 	// Command-line arguments
 	QString filePath;
 	if (app.arguments().size() > 1)